@@ -44,6 +44,16 @@ void AbstractCliIO::cleanup()
 {
 }
 
+/**
+ * Check if every response has to be written on a single line.
+ * Can be reimplemented for clients which read one line per response.
+ * @return true if responses must not contain new lines, default is false.
+ */
+bool AbstractCliIO::requiresSingleLineResponses() const
+{
+  return false;
+}
+
 
 /**
  * Constructor.
@@ -68,6 +68,13 @@ public:
    */
   virtual void readLine() = 0;
 
+  /**
+   * Check if every response has to be written on a single line.
+   * Can be reimplemented for clients which read one line per response.
+   * @return true if responses must not contain new lines, default is false.
+   */
+  virtual bool requiresSingleLineResponses() const;
+
 public slots:
   /**
    * Start processing.
@@ -88,6 +95,20 @@ signals:
    * @param line line read from standard input
    */
   void lineReady(const QString& line);
+
+  /**
+   * Emitted before lineReady() by I/O handlers serving multiple clients
+   * when the line comes from another client than the previous line.
+   * @param clientId ID of client sending the next line
+   */
+  void clientChanged(int clientId);
+
+  /**
+   * Emitted by I/O handlers serving multiple clients when a client has
+   * disconnected.
+   * @param clientId ID of client
+   */
+  void clientDisconnected(int clientId);
 };
 
 
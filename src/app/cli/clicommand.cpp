@@ -51,6 +51,8 @@
 #include "batchimporter.h"
 #include "downloadclient.h"
 #include "dirrenamer.h"
+#include "renamepreviewmodel.h"
+#include "duplicatemodel.h"
 
 namespace {
 
@@ -694,6 +696,14 @@ void ImportCommand::startCommand()
     int fmtIdx = fmtName.toInt(&ok);
     if (!ok) {
       fmtIdx = ImportConfig::instance().importFormatNames().indexOf(fmtName);
+      if (fmtIdx == -1 && fmtName == QLatin1String("table")) {
+        // CSV or JSON file as exported by ExportCsv or ExportJson.
+        if (Frame::TagVersion tagMask = getTagMaskParameter(3);
+            !cli()->app()->importTagTable(tagMask, path)) {
+          setError(tr("Error"));
+        }
+        return;
+      }
       if (fmtIdx == -1) {
         QString errMsg = tr("%1 not found.").arg(fmtName);
         errMsg += QLatin1Char('\n');
@@ -701,7 +711,7 @@ void ImportCommand::startCommand()
         errMsg += QLatin1String(": ");
         errMsg += ImportConfig::instance().importFormatNames().join(
               QLatin1String(", "));
-        errMsg += QLatin1Char('.');
+        errMsg += QLatin1String(", table.");
         setError(errMsg);
         return;
       }
@@ -804,6 +814,28 @@ void BatchImportCommand::onReportImportEvent(int type, const QString& text)
 }
 
 
+FingerprintsCommand::FingerprintsCommand(Kid3Cli* processor)
+  : CliCommand(processor, QLatin1String("fingerprints"),
+               tr("Cached fingerprints"), QLatin1String("[S]\nS = \"clear\""))
+{
+}
+
+void FingerprintsCommand::startCommand()
+{
+  if (args().size() > 1) {
+    if (args().at(1) == QLatin1String("clear")) {
+      cli()->app()->clearFingerprintCache();
+    } else {
+      showUsage();
+    }
+    return;
+  }
+  cli()->writeResult(QVariantMap{
+    {QLatin1String("fingerprints"), cli()->app()->getCachedFingerprints()}
+  });
+}
+
+
 AlbumArtCommand::AlbumArtCommand(Kid3Cli* processor)
   : CliCommand(processor, QLatin1String("albumart"),
                tr("Download album cover artwork"),
@@ -935,7 +967,8 @@ void TextEncodingCommand::startCommand()
 
 RenameDirectoryCommand::RenameDirectoryCommand(Kid3Cli* processor)
   : CliCommand(processor, QLatin1String("renamedir"), tr("Rename folder"),
-       QLatin1String("[F] [S] [T]\nS = \"create\" | \"rename\" | \"dryrun\"")),
+       QLatin1String("[F] [S] [T]\nS = \"create\" | \"rename\" | \"dryrun\" | "
+                     "\"resume\" | \"rollback\"")),
     m_dryRun(false)
 {
 }
@@ -960,6 +993,18 @@ void RenameDirectoryCommand::startCommand()
         create = false;
       } else if (param == QLatin1String("dryrun")) {
         m_dryRun = true;
+      } else if (param == QLatin1String("resume") ||
+                 param == QLatin1String("rollback")) {
+        // Continue or revert a renaming which was interrupted.
+        if (!cli()->app()->getDirRenamer()->scheduleJournalActions(
+              param == QLatin1String("rollback"))) {
+          setError(tr("No interrupted renaming found"));
+        } else if (QString errMsg = cli()->app()->performRenameActions();
+                   !errMsg.isEmpty()) {
+          setError(errMsg);
+        }
+        terminate();
+        return;
       } else if (format.isEmpty()) {
         format = param;
       }
@@ -1163,9 +1208,74 @@ void ToId3v23Command::startCommand()
 }
 
 
+ResizeAlbumArtCommand::ResizeAlbumArtCommand(Kid3Cli* processor)
+  : CliCommand(processor, QLatin1String("resizeart"), tr("Resize album art"),
+               QLatin1String("[S]\nS = ") + tr("Maximum size in pixels"))
+{
+}
+
+void ResizeAlbumArtCommand::startCommand()
+{
+  int maxSize = 500;
+  if (args().size() > 1) {
+    bool ok;
+    maxSize = args().at(1).toInt(&ok);
+    if (!ok || maxSize <= 0) {
+      showUsage();
+      return;
+    }
+  }
+  cli()->app()->normalizeAlbumArt(maxSize);
+}
+
+
+DuplicatesCommand::DuplicatesCommand(Kid3Cli* processor)
+  : CliCommand(processor, QLatin1String("duplicates"), tr("Find duplicates"),
+               QLatin1String("[S]\nS = ") +
+               tr("Maximum duration difference in seconds"))
+{
+  setTimeout(60000);
+}
+
+void DuplicatesCommand::startCommand()
+{
+  int maxDurationDifference = 2;
+  if (args().size() > 1) {
+    bool ok;
+    maxDurationDifference = args().at(1).toInt(&ok);
+    if (!ok || maxDurationDifference < 0) {
+      showUsage();
+      return;
+    }
+  }
+  cli()->app()->findDuplicates(maxDurationDifference);
+  cli()->writeResult(QVariantMap{
+    {QLatin1String("duplicates"), cli()->app()->getDuplicateModel()->groups()}
+  });
+}
+
+
+MemoryCommand::MemoryCommand(Kid3Cli* processor)
+  : CliCommand(processor, QLatin1String("memory"),
+               tr("Display number of files with tags in memory"))
+{
+}
+
+void MemoryCommand::startCommand()
+{
+  cli()->writeResult(QVariantMap{
+    {QLatin1String("memory"), QVariantMap{
+       {QLatin1String("limit"), FileConfig::instance().maxResidentTagFiles()},
+       {QLatin1String("resident"), cli()->app()->residentTaggedFileCount()},
+       {QLatin1String("evicted"), cli()->app()->evictedTaggedFileCount()}
+     }}
+  });
+}
+
+
 TagToFilenameCommand::TagToFilenameCommand(Kid3Cli* processor)
   : CliCommand(processor, QLatin1String("fromtag"), tr("Filename from tag"),
-               QLatin1String("[F] [T]"))
+               QLatin1String("[F] [T] [S]\nS = \"dryrun\""))
 {
 }
 
@@ -1173,14 +1283,20 @@ void TagToFilenameCommand::startCommand()
 {
   Frame::TagVersion tagMask = Frame::TagNone;
   QString format;
-  for (int i = 1; i < qMin(args().size(), 3); ++i) {
+  bool dryRun = false;
+  for (int i = 1; i < qMin(args().size(), 4); ++i) {
     bool ok = false;
     if (tagMask == Frame::TagNone) {
       tagMask = getTagMaskParameter(i, false);
       ok = tagMask != Frame::TagNone;
     }
-    if (!ok && format.isEmpty()) {
-      format = args().at(i);
+    if (!ok) {
+      if (const QString& param = args().at(i);
+          param == QLatin1String("dryrun")) {
+        dryRun = true;
+      } else if (format.isEmpty()) {
+        format = param;
+      }
     }
   }
   if (tagMask == Frame::TagNone) {
@@ -1189,7 +1305,16 @@ void TagToFilenameCommand::startCommand()
   if (!format.isEmpty()) {
     FileConfig::instance().setToFilenameFormat(format);
   }
-  cli()->app()->getFilenameFromTags(tagMask);
+  if (dryRun) {
+    // The generated names are reused by a following fromtag command.
+    cli()->app()->previewFilenameFromTags(tagMask);
+    cli()->writeResult(QVariantMap{
+      {QLatin1String("renames"),
+       cli()->app()->getRenamePreviewModel()->changes()}
+    });
+  } else {
+    cli()->app()->getFilenameFromTags(tagMask);
+  }
 }
 
 
@@ -389,6 +389,17 @@ private slots:
   void onReportImportEvent(int type, const QString& text);
 };
 
+/** Show or clear cached audio fingerprints. */
+class FingerprintsCommand : public CliCommand {
+  Q_OBJECT
+public:
+  /** Constructor. */
+  explicit FingerprintsCommand(Kid3Cli* processor);
+
+protected:
+  void startCommand() override;
+};
+
 /** Download album cover art. */
 class AlbumArtCommand : public CliCommand {
   Q_OBJECT
@@ -530,6 +541,39 @@ protected:
   void startCommand() override;
 };
 
+/** Resize album art. */
+class ResizeAlbumArtCommand : public CliCommand {
+  Q_OBJECT
+public:
+  /** Constructor. */
+  explicit ResizeAlbumArtCommand(Kid3Cli* processor);
+
+protected:
+  void startCommand() override;
+};
+
+/** Find duplicate files. */
+class DuplicatesCommand : public CliCommand {
+  Q_OBJECT
+public:
+  /** Constructor. */
+  explicit DuplicatesCommand(Kid3Cli* processor);
+
+protected:
+  void startCommand() override;
+};
+
+/** Display number of files with tags in memory. */
+class MemoryCommand : public CliCommand {
+  Q_OBJECT
+public:
+  /** Constructor. */
+  explicit MemoryCommand(Kid3Cli* processor);
+
+protected:
+  void startCommand() override;
+};
+
 /** Set file name from tags. */
 class TagToFilenameCommand : public CliCommand {
   Q_OBJECT
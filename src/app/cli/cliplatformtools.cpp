@@ -0,0 +1,73 @@
+/**
+ * \file cliplatformtools.cpp
+ * Platform specific tools for the command line interface.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cliplatformtools.h"
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+
+/**
+ * Scale image data so that it fits into a square.
+ * This method is thread-safe.
+ * @param data image data
+ * @param maxSize maximum width and height in pixels
+ * @return image data in the same format scaled to fit into @a maxSize,
+ * empty if the image already fits or could not be scaled.
+ */
+QByteArray CliPlatformTools::scaleImageData(const QByteArray& data,
+                                            int maxSize) const
+{
+  QBuffer buffer;
+  buffer.setData(data);
+  if (!buffer.open(QIODevice::ReadOnly))
+    return QByteArray();
+
+  QImageReader reader(&buffer);
+  const QByteArray format = reader.format();
+  if (QSize size = reader.size(); size.isValid()) {
+    if (size.width() <= maxSize && size.height() <= maxSize)
+      return QByteArray();
+    // Let the image handler scale while decoding if it supports it,
+    // e.g. JPEG, which is much faster than decoding the full size.
+    reader.setScaledSize(size.scaled(maxSize, maxSize, Qt::KeepAspectRatio));
+  }
+  QImage image;
+  if (!reader.read(&image))
+    return QByteArray();
+  if (image.width() > maxSize || image.height() > maxSize) {
+    image = image.scaled(maxSize, maxSize, Qt::KeepAspectRatio,
+                         Qt::SmoothTransformation);
+  }
+
+  QByteArray scaledData;
+  QBuffer scaledBuffer(&scaledData);
+  if (!scaledBuffer.open(QIODevice::WriteOnly))
+    return QByteArray();
+  if (QImageWriter writer(&scaledBuffer, format); !writer.write(image))
+    return QByteArray();
+  return scaledData;
+}
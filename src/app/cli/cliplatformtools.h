@@ -0,0 +1,52 @@
+/**
+ * \file cliplatformtools.h
+ * Platform specific tools for the command line interface.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "coreplatformtools.h"
+
+/**
+ * Platform specific tools for the command line interface.
+ * Uses QtGui for image processing, but no GUI.
+ */
+class CliPlatformTools : public CorePlatformTools {
+public:
+  /**
+   * Destructor.
+   */
+  ~CliPlatformTools() override = default;
+
+  /**
+   * Scale image data so that it fits into a square.
+   * This method is thread-safe.
+   * @param data image data
+   * @param maxSize maximum width and height in pixels
+   * @return image data in the same format scaled to fit into @a maxSize,
+   * empty if the image already fits or could not be scaled.
+   */
+  QByteArray scaleImageData(const QByteArray& data,
+                            int maxSize) const override;
+};
@@ -257,6 +257,6 @@ void JsonCliFormatter::finishWriting()
   }
   io()->writeLine(QString::fromUtf8(
                     QJsonDocument(m_response).toJson(
-                      m_compact ? QJsonDocument::Compact
-                                : QJsonDocument::Indented)));
+                      m_compact || io()->requiresSingleLineResponses()
+                      ? QJsonDocument::Compact : QJsonDocument::Indented)));
 }
@@ -177,7 +177,8 @@ Kid3Cli::Kid3Cli(Kid3Application* app,
                  AbstractCliIO* io, const QStringList& args, QObject* parent) :
   AbstractCli(io, parent),
   m_app(app), m_args(args),
-  m_tagMask(Frame::TagV2V1), m_timeoutMs(0), m_fileNameChanged(false),
+  m_tagMask(Frame::TagV2V1), m_timeoutMs(0), m_clientId(-1),
+  m_restoringClientState(false), m_fileNameChanged(false),
   m_isInteractive(false)
 {
   m_formatters << new JsonCliFormatter(io)
@@ -202,6 +203,7 @@ Kid3Cli::Kid3Cli(Kid3Application* app,
          << new RevertCommand(this)
          << new ImportCommand(this)
          << new BatchImportCommand(this)
+         << new FingerprintsCommand(this)
          << new AlbumArtCommand(this)
          << new ExportCommand(this)
          << new PlaylistCommand(this)
@@ -213,6 +215,9 @@ Kid3Cli::Kid3Cli(Kid3Application* app,
          << new FilterCommand(this)
          << new ToId3v24Command(this)
          << new ToId3v23Command(this)
+         << new ResizeAlbumArtCommand(this)
+         << new DuplicatesCommand(this)
+         << new MemoryCommand(this)
          << new TagToFilenameCommand(this)
          << new FilenameToTagCommand(this)
          << new TagToOtherTagCommand(this)
@@ -227,6 +232,12 @@ Kid3Cli::Kid3Cli(Kid3Application* app,
           this, &Kid3Cli::updateSelection);
   connect(m_app, &Kid3Application::selectedFilesChanged,
           this, &Kid3Cli::updateSelection);
+  // Queued like lineReady(), so that the state of the client is switched
+  // just before its line is processed.
+  connect(io, &AbstractCliIO::clientChanged,
+          this, &Kid3Cli::switchClient, Qt::QueuedConnection);
+  connect(io, &AbstractCliIO::clientDisconnected,
+          this, &Kid3Cli::removeClient);
 #ifdef HAVE_READLINE
   m_completer.reset(new Kid3CliCompleter(m_cmds));
   m_completer->install();
@@ -682,6 +693,10 @@ void Kid3Cli::readLine(const QString& line)
     terminate();
     return;
   }
+  if (m_restoringClientState) {
+    m_pendingLine = line;
+    return;
+  }
   flushStandardOutput();
   if (CliCommand* cmd = commandForArgs(line)) {
     connect(cmd, &CliCommand::finished, this, &Kid3Cli::onCommandFinished);
@@ -753,7 +768,9 @@ bool Kid3Cli::parseOptions()
       writeLine(QLatin1String("kid3-cli " VERSION " (c) " RELEASE_YEAR
                               " Urs Fleisch"));
       writeLine(tr("Usage:") + QLatin1String(
-          " kid3-cli [-c command1] [-c command2 ...] [path ...]"));
+          " kid3-cli [--serve socket] [-c command1] [-c command2 ...] "
+          "[path ...]\n       kid3-cli --connect socket [-c command1] "
+          "[-c command2 ...] [path ...]"));
       writeHelp();
       flushStandardOutput();
       terminate();
@@ -792,6 +809,90 @@ void Kid3Cli::onInitialDirectoryOpened()
   }
 }
 
+/**
+ * Save the state of the current client and restore the state of another
+ * client before its next line is processed.
+ * A new client continues with the state of the previous client.
+ * @param clientId ID of client
+ */
+void Kid3Cli::switchClient(int clientId)
+{
+  if (clientId == m_clientId)
+    return;
+
+  if (m_clientId != -1) {
+    QStringList selectedFiles;
+    const FileProxyModel* model = m_app->getFileProxyModel();
+    const QModelIndexList indexes =
+        m_app->getFileSelectionModel()->selectedRows();
+    selectedFiles.reserve(indexes.size());
+    for (const QModelIndex& index : indexes) {
+      selectedFiles.append(model->filePath(index));
+    }
+    m_clientStates.insert(m_clientId,
+                          {m_app->getDirPath(), selectedFiles, m_tagMask});
+  }
+  m_clientId = clientId;
+
+  auto it = m_clientStates.find(clientId);
+  if (it == m_clientStates.end())
+    return;
+
+  const ClientState state = *it;
+  m_clientStates.erase(it);
+  m_tagMask = state.tagMask;
+  if (state.dirPath == m_app->getDirPath()) {
+    restoreSelection(state.selectedFiles);
+    return;
+  }
+  // Lines of the client wait until its directory is opened.
+  m_restoringClientState = true;
+  m_selectionToRestore = state.selectedFiles;
+  connect(m_app, &Kid3Application::directoryOpened,
+          this, &Kid3Cli::onClientDirectoryOpened);
+  if (!openDirectory({state.dirPath})) {
+    m_selectionToRestore.clear();
+  }
+}
+
+/**
+ * Forget the state of a client which has disconnected.
+ * @param clientId ID of client
+ */
+void Kid3Cli::removeClient(int clientId)
+{
+  m_clientStates.remove(clientId);
+}
+
+/**
+ * Restore the selection of a client when its directory has been opened
+ * and process the line which has been waiting for it.
+ */
+void Kid3Cli::onClientDirectoryOpened()
+{
+  disconnect(m_app, &Kid3Application::directoryOpened,
+             this, &Kid3Cli::onClientDirectoryOpened);
+  restoreSelection(m_selectionToRestore);
+  m_selectionToRestore.clear();
+  m_restoringClientState = false;
+  if (!m_pendingLine.isNull()) {
+    const QString line = m_pendingLine;
+    m_pendingLine.clear();
+    readLine(line);
+  }
+}
+
+/**
+ * Replace the selection with files of the current directory.
+ * @param filePaths paths of files to select
+ */
+void Kid3Cli::restoreSelection(const QStringList& filePaths)
+{
+  m_app->getFileSelectionModel()->clearSelection();
+  selectFile(filePaths);
+  updateSelection();
+}
+
 void Kid3Cli::executeNextArgCommand()
 {
   if (m_argCommands.isEmpty()) {
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <QHash>
 #include "abstractcli.h"
 #include "frame.h"
 #include "cliconfig.h"
@@ -237,7 +238,35 @@ private slots:
    */
   void onArgCommandFinished();
 
+  /**
+   * Save the state of the current client and restore the state of another
+   * client before its next line is processed.
+   * @param clientId ID of client
+   */
+  void switchClient(int clientId);
+
+  /**
+   * Forget the state of a client which has disconnected.
+   * @param clientId ID of client
+   */
+  void removeClient(int clientId);
+
+  /**
+   * Restore the selection of a client when its directory has been opened
+   * and process the line which has been waiting for it.
+   */
+  void onClientDirectoryOpened();
+
 private:
+  /** State of a client which is restored when it is served again. */
+  struct ClientState {
+    QString dirPath;
+    QStringList selectedFiles;
+    Frame::TagVersion tagMask;
+  };
+
+  void restoreSelection(const QStringList& filePaths);
+
   /**
    * Get command for a command line.
    * @param line command line
@@ -262,9 +291,17 @@ private:
   QString m_detailInfo;
   QString m_filename;
   QString m_tagFormat[Frame::Tag_NumValues];
+  /** States of the clients which are not served at the moment */
+  QHash<int, ClientState> m_clientStates;
+  /** Selection to restore after the directory of a client is opened */
+  QStringList m_selectionToRestore;
+  /** Line which waits until the state of its client is restored */
+  QString m_pendingLine;
   Frame::TagVersion m_tagMask;
   /** Overwrites command timeout, -1 to switch off, 0 for defaults, else ms. */
   int m_timeoutMs;
+  int m_clientId;
+  bool m_restoringClientState;
   bool m_fileNameChanged;
   bool m_isInteractive;
 };
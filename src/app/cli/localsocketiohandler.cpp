@@ -0,0 +1,260 @@
+/**
+ * \file localsocketiohandler.cpp
+ * CLI I/O Handler for clients connected to a local socket.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "localsocketiohandler.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+/** Time in milliseconds to wait for a running server when probing. */
+constexpr int PROBE_TIMEOUT_MS = 1000;
+
+/**
+ * Write a line to a client.
+ * @param client client socket
+ * @param line line to write
+ */
+void writeLineToClient(QLocalSocket* client, const QString& line)
+{
+  QByteArray data = line.toUtf8();
+  data.append('\n');
+  client->write(data);
+}
+
+}
+
+/**
+ * Constructor.
+ */
+LocalSocketIOHandler::LocalSocketIOHandler()
+  : m_server(new QLocalServer(this)), m_currentClientId(-1),
+    m_nextClientId(0), m_waitingForRequest(false)
+{
+  connect(m_server, &QLocalServer::newConnection,
+          this, &LocalSocketIOHandler::acceptConnections);
+}
+
+/**
+ * Start listening for client connections.
+ * @param name name of local socket, a file path on Unix
+ * @return true if ok.
+ */
+bool LocalSocketIOHandler::listen(const QString& name)
+{
+  m_errorString.clear();
+  // The socket of a running server must not be removed, only a socket file
+  // left over from a server which has crashed.
+  QLocalSocket probe;
+  probe.connectToServer(name);
+  if (probe.waitForConnected(PROBE_TIMEOUT_MS)) {
+    probe.disconnectFromServer();
+    m_errorString = tr("Server is already running");
+    return false;
+  }
+  if (probe.error() == QLocalSocket::ConnectionRefusedError) {
+    QLocalServer::removeServer(name);
+  }
+  m_server->setSocketOptions(QLocalServer::UserAccessOption);
+  return m_server->listen(name);
+}
+
+/**
+ * Get error message if listen() failed.
+ * @return error message.
+ */
+QString LocalSocketIOHandler::errorString() const
+{
+  return m_errorString.isEmpty() ? m_server->errorString() : m_errorString;
+}
+
+/**
+ * Start processing.
+ */
+void LocalSocketIOHandler::start()
+{
+  m_waitingForRequest = true;
+  emitNextRequest();
+}
+
+/**
+ * Stop processing.
+ */
+void LocalSocketIOHandler::stop()
+{
+  m_server->close();
+  const auto clients = m_server->findChildren<QLocalSocket*>();
+  for (QLocalSocket* client : clients) {
+    client->flush();
+    client->disconnectFromServer();
+  }
+  m_clients.clear();
+  deleteLater();
+}
+
+/**
+ * Read the next request.
+ * When a request is ready, lineReady() is emitted.
+ */
+void LocalSocketIOHandler::readLine()
+{
+  flushStandardOutput();
+  m_currentClient.clear();
+  m_waitingForRequest = true;
+  emitNextRequest();
+}
+
+/**
+ * Check if every response has to be written on a single line.
+ * @return true, clients read one line per response.
+ */
+bool LocalSocketIOHandler::requiresSingleLineResponses() const
+{
+  return true;
+}
+
+/**
+ * Emit lineReady() for the next request of the client whose turn it is
+ * if the command line processor is waiting for a request.
+ */
+void LocalSocketIOHandler::emitNextRequest()
+{
+  int idx = 0;
+  while (m_waitingForRequest && idx < m_clients.size()) {
+    const Client& client = m_clients.at(idx);
+    QLocalSocket* socket = client.socket;
+    if (!socket) {
+      m_clients.removeAt(idx);
+      continue;
+    }
+    // Responses cannot be sent to a disconnected client, and a client
+    // without a complete request must not block the other clients.
+    if (socket->state() != QLocalSocket::ConnectedState ||
+        !socket->canReadLine()) {
+      ++idx;
+      continue;
+    }
+
+    QString line = QString::fromUtf8(socket->readLine()).trimmed();
+    if (line.isEmpty())
+      continue;
+
+    // Every line must contain a complete request, otherwise the partial
+    // request would be combined with the next request.
+    if (QJsonParseError parseError;
+        line.startsWith(QLatin1Char('{')) &&
+        QJsonDocument::fromJson(line.toUtf8(), &parseError).isNull()) {
+      QJsonObject error;
+      error.insert(QLatin1String("code"), -32700);
+      error.insert(QLatin1String("message"),
+                   parseError.errorString() + QLatin1String(": ") + line);
+      QJsonObject response;
+      response.insert(QLatin1String("error"), error);
+      writeLineToClient(socket, QString::fromUtf8(
+                          QJsonDocument(response).toJson(
+                            QJsonDocument::Compact)));
+      continue;
+    }
+    // The other clients are served before the next request of this client.
+    const int clientId = client.id;
+    m_clients.append(m_clients.takeAt(idx));
+    m_currentClient = socket;
+    m_waitingForRequest = false;
+    if (clientId != m_currentClientId) {
+      m_currentClientId = clientId;
+      emit clientChanged(clientId);
+    }
+    emit lineReady(line);
+  }
+}
+
+/**
+ * Accept new client connections.
+ */
+void LocalSocketIOHandler::acceptConnections()
+{
+  while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+    m_clients.append({socket, m_nextClientId++});
+    connect(socket, &QLocalSocket::readyRead,
+            this, &LocalSocketIOHandler::emitNextRequest);
+    connect(socket, &QLocalSocket::disconnected,
+            this, &LocalSocketIOHandler::removeClient);
+    connect(socket, &QLocalSocket::disconnected,
+            socket, &QObject::deleteLater);
+  }
+  emitNextRequest();
+}
+
+/**
+ * Remove a client which has disconnected and continue with the other
+ * connections.
+ */
+void LocalSocketIOHandler::removeClient()
+{
+  if (auto socket = qobject_cast<QLocalSocket*>(sender())) {
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+      if (it->socket == socket) {
+        const int clientId = it->id;
+        m_clients.erase(it);
+        emit clientDisconnected(clientId);
+        break;
+      }
+    }
+  }
+  emitNextRequest();
+}
+
+/**
+ * Write a line to the client of the current request.
+ * @param line line to write
+ */
+void LocalSocketIOHandler::writeLine(const QString& line)
+{
+  if (m_currentClient) {
+    writeLineToClient(m_currentClient, line);
+  }
+}
+
+/**
+ * Write an error line to the client of the current request.
+ * @param line line to write
+ */
+void LocalSocketIOHandler::writeErrorLine(const QString& line)
+{
+  writeLine(line);
+}
+
+/**
+ * Flush the output to the client of the current request.
+ */
+void LocalSocketIOHandler::flushStandardOutput()
+{
+  if (m_currentClient) {
+    m_currentClient->flush();
+  }
+}
@@ -0,0 +1,145 @@
+/**
+ * \file localsocketiohandler.h
+ * CLI I/O Handler for clients connected to a local socket.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "abstractcli.h"
+#include <QPointer>
+#include <QList>
+
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * CLI I/O Handler for clients connected to a local socket.
+ *
+ * Clients send one request per line, usually a JSON-RPC request. The
+ * connections are served in turns, one request at a time, so that an idle
+ * client does not block the others. Every client has an ID, clientChanged()
+ * is emitted when the next request comes from another client, so that the
+ * command line processor can switch to the state of this client, e.g. its
+ * current directory and selected files. JSON responses are written on a single line, so that a client can read
+ * the response to each request with a single line read.
+ */
+class LocalSocketIOHandler : public AbstractCliIO {
+  Q_OBJECT
+public:
+  /**
+   * Constructor.
+   */
+  LocalSocketIOHandler();
+
+  /**
+   * Destructor.
+   */
+  ~LocalSocketIOHandler() override = default;
+
+  /**
+   * Start listening for client connections.
+   * @param name name of local socket, a file path on Unix
+   * @return true if ok.
+   */
+  bool listen(const QString& name);
+
+  /**
+   * Get error message if listen() failed.
+   * @return error message.
+   */
+  QString errorString() const;
+
+  /**
+   * Write a line to the client of the current request.
+   * @param line line to write
+   */
+  void writeLine(const QString& line) override;
+
+  /**
+   * Write an error line to the client of the current request.
+   * @param line line to write
+   */
+  void writeErrorLine(const QString& line) override;
+
+  /**
+   * Flush the output to the client of the current request.
+   */
+  void flushStandardOutput() override;
+
+  /**
+   * Read the next request.
+   * When a request is ready, lineReady() is emitted.
+   */
+  void readLine() override;
+
+  /**
+   * Check if every response has to be written on a single line.
+   * @return true, clients read one line per response.
+   */
+  bool requiresSingleLineResponses() const override;
+
+public slots:
+  /**
+   * Start processing.
+   * lineReady() is emitted when the first request is ready. To request
+   * subsequent lines, readLine() has to be called.
+   */
+  void start() override;
+
+  /**
+   * Stop processing.
+   * This will close all client connections and finally delete this object.
+   */
+  void stop() override;
+
+private slots:
+  /**
+   * Accept new client connections.
+   */
+  void acceptConnections();
+
+  /**
+   * Remove a client which has disconnected and continue with the other
+   * connections.
+   */
+  void removeClient();
+
+private:
+  /** Connected client. */
+  struct Client {
+    QPointer<QLocalSocket> socket;
+    int id;
+  };
+
+  void emitNextRequest();
+
+  QLocalServer* m_server;
+  /** Connected clients in the order in which they are served */
+  QList<Client> m_clients;
+  QPointer<QLocalSocket> m_currentClient;
+  QString m_errorString;
+  int m_currentClientId;
+  int m_nextClientId;
+  bool m_waitingForRequest;
+};
@@ -29,12 +29,20 @@
 #include <QDir>
 #include <QTimer>
 #include <QSettings>
+#include <QLocalSocket>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
 #include "kid3cli.h"
 #include "loadtranslation.h"
 #include "standardiohandler.h"
-#include "coreplatformtools.h"
+#include "localsocketiohandler.h"
+#include "textcliformatter.h"
+#include "cliplatformtools.h"
 #include "kid3application.h"
 #include "isettings.h"
+#include "performancetracer.h"
 
 #if defined Q_OS_WIN32 && defined Q_CC_MINGW
 // Disable command line globbing to avoid crash in QCoreApplication::arguments()
@@ -42,6 +50,109 @@
 int _CRT_glob = 0;
 #endif
 
+namespace {
+
+/**
+ * Forward commands to a kid3-cli server started with --serve.
+ *
+ * Commands which are not JSON requests are converted to compact JSON
+ * requests, so that each response is received on a single line.
+ *
+ * @param serverName name of local socket of server
+ * @param args command line arguments after --connect and the server name
+ *
+ * @return exit code of application.
+ */
+int forwardCommandsToServer(const QString& serverName, const QStringList& args)
+{
+  QTextStream cout(stdout, QIODevice::WriteOnly);
+  QTextStream cerr(stderr, QIODevice::WriteOnly);
+  QStringList commands;
+  QStringList paths;
+  for (auto it = args.constBegin(); it != args.constEnd(); ++it) {
+    if (*it == QLatin1String("-c")) {
+      if (++it == args.constEnd())
+        break;
+      commands.append(*it);
+    } else {
+      // The server resolves relative paths in its own working folder.
+      paths.append(QDir::current().absoluteFilePath(*it));
+    }
+  }
+  if (!paths.isEmpty()) {
+    // Like in the standalone mode, the paths are opened before the commands
+    // are executed.
+    QJsonObject obj;
+    obj.insert(QLatin1String("method"), QLatin1String("cd"));
+    obj.insert(QLatin1String("params"), QJsonArray::fromStringList(paths));
+    commands.prepend(QString::fromUtf8(
+                       QJsonDocument(obj).toJson(QJsonDocument::Compact)));
+  }
+
+  QLocalSocket socket;
+  socket.connectToServer(serverName);
+  if (!socket.waitForConnected()) {
+    cerr << socket.errorString() << QLatin1Char('\n');
+    return 1;
+  }
+
+  TextCliFormatter textFormatter(nullptr);
+  for (const QString& command : std::as_const(commands)) {
+    QJsonObject obj;
+    if (command.trimmed().startsWith(QLatin1Char('{'))) {
+      obj = QJsonDocument::fromJson(command.toUtf8()).object();
+    } else if (QStringList cmdArgs = textFormatter.parseArguments(command);
+               !cmdArgs.isEmpty()) {
+      obj.insert(QLatin1String("method"), cmdArgs.takeFirst());
+      obj.insert(QLatin1String("params"), QJsonArray::fromStringList(cmdArgs));
+    }
+    if (obj.isEmpty()) {
+      cerr << QLatin1String("Invalid command: ") << command
+           << QLatin1Char('\n');
+      return 1;
+    }
+    QByteArray request = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+    request.append('\n');
+    socket.write(request);
+
+    while (!socket.canReadLine()) {
+      if (!socket.waitForReadyRead(-1)) {
+        // The server closes the connection without a response when it exits.
+        if (socket.state() == QLocalSocket::UnconnectedState &&
+            obj.value(QLatin1String("method")).toString() ==
+            QLatin1String("exit")) {
+          return 0;
+        }
+        cerr << socket.errorString() << QLatin1Char('\n');
+        return 1;
+      }
+    }
+    const QJsonObject response =
+        QJsonDocument::fromJson(socket.readLine()).object();
+    if (response.contains(QLatin1String("error"))) {
+      cerr << response.value(QLatin1String("error")).toObject()
+              .value(QLatin1String("message")).toString() << QLatin1Char('\n');
+      return 1;
+    }
+    if (QJsonValue result = response.value(QLatin1String("result"));
+        result.isString()) {
+      cout << result.toString() << QLatin1Char('\n');
+    } else if (result.isBool()) {
+      cout << (result.toBool() ? "true" : "false") << QLatin1Char('\n');
+    } else if (result.isArray()) {
+      cout << QString::fromUtf8(QJsonDocument(result.toArray()).toJson())
+           << QLatin1Char('\n');
+    } else if (result.isObject()) {
+      cout << QString::fromUtf8(QJsonDocument(result.toObject()).toJson())
+           << QLatin1Char('\n');
+    }
+    cout.flush();
+  }
+  return 0;
+}
+
+}
+
 /**
  * Main program for command line interface.
  *
@@ -71,6 +182,25 @@ int main(int argc, char* argv[])
     qputenv("KID3_CONFIG_FILE",
             QCoreApplication::applicationDirPath().toLatin1() + "/kid3.ini");
   }
+  // --trace can be given anywhere, but not as the argument of -c.
+  for (int i = 1; i < args.size() - 1; ++i) {
+    if (args.at(i) == QLatin1String("--trace") &&
+        args.at(i - 1) != QLatin1String("-c")) {
+      PerformanceTracer::enable(args.at(i + 1));
+      args.removeAt(i);
+      args.removeAt(i);
+      break;
+    }
+  }
+  if (args.size() > 2 && args.at(1) == QLatin1String("--connect")) {
+    return forwardCommandsToServer(args.at(2), args.mid(3));
+  }
+  QString serverName;
+  if (args.size() > 2 && args.at(1) == QLatin1String("--serve")) {
+    serverName = args.at(2);
+    args.removeAt(1);
+    args.removeAt(1);
+  }
 
   // The Language setting has to be read bypassing the regular
   // configuration object because the language must be set before
@@ -83,7 +213,7 @@ int main(int argc, char* argv[])
         .value(QLatin1String("MainWindow/Language")).toString();
   Utils::loadTranslation(configuredLanguage);
 
-  ICorePlatformTools* platformTools = new CorePlatformTools;
+  ICorePlatformTools* platformTools = new CliPlatformTools;
   auto kid3App = new Kid3Application(platformTools);
 #ifdef HAVE_QTDBUS
   if (args.size() > 1 && args.at(1) == QLatin1String("--dbus")) {
@@ -91,7 +221,23 @@ int main(int argc, char* argv[])
     kid3App->activateDbusInterface();
   }
 #endif
-  Kid3Cli kid3cli(kid3App, new StandardIOHandler("kid3-cli> "), args);
+  AbstractCliIO* io;
+  if (serverName.isEmpty()) {
+    io = new StandardIOHandler("kid3-cli> ");
+  } else {
+    auto socketIO = new LocalSocketIOHandler;
+    if (!socketIO->listen(serverName)) {
+      QTextStream(stderr, QIODevice::WriteOnly)
+          << serverName << QLatin1String(": ") << socketIO->errorString()
+          << QLatin1Char('\n');
+      delete socketIO;
+      delete kid3App;
+      delete platformTools;
+      return 1;
+    }
+    io = socketIO;
+  }
+  Kid3Cli kid3cli(kid3App, io, args);
   QTimer::singleShot(0, &kid3cli, &Kid3Cli::execute);
   int rc = QCoreApplication::exec();
   delete kid3App;
@@ -30,6 +30,7 @@
 #include "clierror.h"
 #include "abstractcli.h"
 #include "frame.h"
+#include "taggedfile.h"
 
 /** @cond */
 namespace {
@@ -294,6 +295,54 @@ void TextCliFormatter::writeResult(const QVariantMap& map)
       }
     } else if (key == QLatin1String("files")) {
       printFiles(io(), it.value().toList(), 1);
+    } else if (key == QLatin1String("renames")) {
+      const QVariantList renames = it.value().toList();
+      for (const QVariant& var : renames) {
+        QVariantMap rename = var.toMap();
+        io()->writeLine(QLatin1String("- ") +
+                        rename.value(QLatin1String("source")).toString());
+        io()->writeLine(QLatin1String("+ ") +
+                        rename.value(QLatin1String("destination")).toString());
+      }
+    } else if (key == QLatin1String("duplicates")) {
+      const QVariantList groups = it.value().toList();
+      for (const QVariant& var : groups) {
+        QVariantMap group = var.toMap();
+        io()->writeLine(group.value(QLatin1String("artist")).toString() +
+                        QLatin1String(" - ") +
+                        group.value(QLatin1String("title")).toString());
+        const QVariantList files = group.value(QLatin1String("files")).toList();
+        for (const QVariant& fileVar : files) {
+          QVariantMap file = fileVar.toMap();
+          QString line = QLatin1String("  ");
+          if (uint duration = file.value(QLatin1String("duration")).toUInt();
+              duration != 0) {
+            line += TaggedFile::formatTime(duration);
+            line += QLatin1Char(' ');
+          }
+          line += file.value(QLatin1String("filePath")).toString();
+          io()->writeLine(line);
+        }
+      }
+    } else if (key == QLatin1String("fingerprints")) {
+      const QVariantList fingerprints = it.value().toList();
+      for (const QVariant& var : fingerprints) {
+        QVariantMap fingerprint = var.toMap();
+        io()->writeLine(TaggedFile::formatTime(
+                          fingerprint.value(QLatin1String("duration")).toUInt()) +
+                        QLatin1Char(' ') +
+                        fingerprint.value(QLatin1String("filePath")).toString());
+        io()->writeLine(QLatin1String("  ") +
+                        fingerprint.value(QLatin1String("fingerprint")).toString());
+      }
+    } else if (key == QLatin1String("memory")) {
+      QVariantMap value = it.value().toMap();
+      io()->writeLine(tr("Limit") % QLatin1String(": ") %
+                      value.value(QLatin1String("limit")).toString());
+      io()->writeLine(tr("Files with tags in memory") % QLatin1String(": ") %
+                      value.value(QLatin1String("resident")).toString());
+      io()->writeLine(tr("Evicted files") % QLatin1String(": ") %
+                      value.value(QLatin1String("evicted")).toString());
     } else if (key == QLatin1String("timeout")) {
       QString value = it.value().toString();
       io()->writeLine(tr("Timeout") % QLatin1String(": ") % value);
@@ -292,6 +292,10 @@ void KdeMainWindow::initActions()
   action->setStatusTip(tr("Rename Folder"));
   collection->addAction(QLatin1String("rename_directory"), action);
   connect(action, &QAction::triggered, impl(), &BaseMainWindowImpl::slotRenameDirectory);
+  action = new QAction(tr("&Filename from Tags Preview..."), this);
+  action->setStatusTip(tr("Filename from Tags Preview"));
+  collection->addAction(QLatin1String("preview_filename_from_tags"), action);
+  connect(action, &QAction::triggered, impl(), &BaseMainWindowImpl::slotPreviewFilenameFromTags);
   action = new QAction(tr("&Number Tracks..."), this);
   action->setStatusTip(tr("Number Tracks"));
   collection->addAction(QLatin1String("number_tracks"), action);
@@ -313,6 +317,10 @@ void KdeMainWindow::initActions()
       connect(action, &QAction::triggered, app(), &Kid3Application::convertToId3v23);
     }
   }
+  action = new QAction(tr("Resize &Album Art"), this);
+  action->setStatusTip(tr("Resize Album Art"));
+  collection->addAction(QLatin1String("normalize_album_art"), action);
+  connect(action, &QAction::triggered, app(), [this] { app()->normalizeAlbumArt(); });
 #ifdef HAVE_QTMULTIMEDIA
   action = new QAction(QIcon::fromTheme(QLatin1String("media-playback-start")),
                        tr("&Play"), this);
@@ -110,6 +110,20 @@ QObject* KdePlatformTools::createAudioPlayer(Kid3Application* app,
   return GuiPlatformTools::createAudioPlayer(app, dbusEnabled);
 }
 
+/**
+ * Scale image data so that it fits into a square.
+ * This method is thread-safe.
+ * @param data image data
+ * @param maxSize maximum width and height in pixels
+ * @return image data in the same format scaled to fit into @a maxSize,
+ * empty if the image already fits or could not be scaled.
+ */
+QByteArray KdePlatformTools::scaleImageData(const QByteArray& data,
+                                            int maxSize) const
+{
+  return GuiPlatformTools::scaleImageData(data, maxSize);
+}
+
 /**
  * Move file or directory to trash.
  *
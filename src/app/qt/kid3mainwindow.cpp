@@ -528,6 +528,16 @@ void Kid3MainWindow::initActions()
     impl(), &BaseMainWindowImpl::slotRenameDirectory);
   toolsMenu->addAction(toolsRenameDirectory);
 
+  auto toolsPreviewFilenameFromTags = new QAction(this);
+  toolsPreviewFilenameFromTags->setStatusTip(tr("Filename from Tags Preview"));
+  toolsPreviewFilenameFromTags->setText(tr("&Filename from Tags Preview..."));
+  toolsPreviewFilenameFromTags->setObjectName(
+        QLatin1String("preview_filename_from_tags"));
+  m_shortcutsModel->registerAction(toolsPreviewFilenameFromTags, menuTitle);
+  connect(toolsPreviewFilenameFromTags, &QAction::triggered,
+    impl(), &BaseMainWindowImpl::slotPreviewFilenameFromTags);
+  toolsMenu->addAction(toolsPreviewFilenameFromTags);
+
   auto toolsNumberTracks = new QAction(this);
   toolsNumberTracks->setStatusTip(tr("Number Tracks"));
   toolsNumberTracks->setText(tr("&Number Tracks..."));
@@ -570,6 +580,15 @@ void Kid3MainWindow::initActions()
     }
   }
 
+  auto toolsNormalizeAlbumArt = new QAction(this);
+  toolsNormalizeAlbumArt->setStatusTip(tr("Resize Album Art"));
+  toolsNormalizeAlbumArt->setText(tr("Resize &Album Art"));
+  toolsNormalizeAlbumArt->setObjectName(QLatin1String("normalize_album_art"));
+  m_shortcutsModel->registerAction(toolsNormalizeAlbumArt, menuTitle);
+  connect(toolsNormalizeAlbumArt, &QAction::triggered,
+    app(), [this] { app()->normalizeAlbumArt(); });
+  toolsMenu->addAction(toolsNormalizeAlbumArt);
+
 #ifdef HAVE_QTMULTIMEDIA
   toolsMenu->addSeparator();
   auto toolsPlay = new QAction(this);
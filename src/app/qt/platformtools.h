@@ -82,6 +82,17 @@ public:
   QObject* createAudioPlayer(Kid3Application* app,
                              bool dbusEnabled) const override;
 
+  /**
+   * Scale image data so that it fits into a square.
+   * This method is thread-safe.
+   * @param data image data
+   * @param maxSize maximum width and height in pixels
+   * @return image data in the same format scaled to fit into @a maxSize,
+   * empty if the image already fits or could not be scaled.
+   */
+  QByteArray scaleImageData(const QByteArray& data,
+                            int maxSize) const override;
+
   /**
    * Move file or directory to trash.
    *
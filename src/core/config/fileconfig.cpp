@@ -86,6 +86,7 @@ FileConfig::FileConfig()
     m_formatFromFilenameText(QString::fromLatin1(defaultFromFilenameFormats[0])),
     m_defaultCoverFileName(QLatin1String("folder.jpg")),
     m_textEncoding(QLatin1String("System")),
+    m_maxResidentTagFiles(0),
     m_preserveTime(false),
     m_markChanges(true),
     m_loadLastOpenedFile(true),
@@ -115,6 +116,7 @@ void FileConfig::writeToConfig(ISettings* config) const
   config->setValue(QLatin1String("PreserveTime"), QVariant(m_preserveTime));
   config->setValue(QLatin1String("MarkChanges"), QVariant(m_markChanges));
   config->setValue(QLatin1String("LoadLastOpenedFile"), QVariant(m_loadLastOpenedFile));
+  config->setValue(QLatin1String("MaxResidentTagFiles"), QVariant(m_maxResidentTagFiles));
   config->setValue(QLatin1String("TextEncoding"), QVariant(m_textEncoding));
   config->setValue(QLatin1String("DefaultCoverFileName"), QVariant(m_defaultCoverFileName));
   config->endGroup();
@@ -163,6 +165,8 @@ void FileConfig::readFromConfig(ISettings* config)
                     QString::fromLatin1(defaultFromFilenameFormats[0])).toString();
   m_loadLastOpenedFile = config->value(QLatin1String("LoadLastOpenedFile"),
                                        m_loadLastOpenedFile).toBool();
+  m_maxResidentTagFiles = config->value(QLatin1String("MaxResidentTagFiles"),
+                                        m_maxResidentTagFiles).toInt();
   m_textEncoding = config->value(QLatin1String("TextEncoding"),
                                  QLatin1String("System")).toString();
   m_defaultCoverFileName = config->value(QLatin1String("DefaultCoverFileName"),
@@ -332,3 +336,11 @@ void FileConfig::setLoadLastOpenedFile(bool loadLastOpenedFile)
     emit loadLastOpenedFileChanged(m_loadLastOpenedFile);
   }
 }
+
+void FileConfig::setMaxResidentTagFiles(int maxResidentTagFiles)
+{
+  if (m_maxResidentTagFiles != maxResidentTagFiles) {
+    m_maxResidentTagFiles = maxResidentTagFiles;
+    emit maxResidentTagFilesChanged(m_maxResidentTagFiles);
+  }
+}
@@ -84,6 +84,9 @@ class KID3_CORE_EXPORT FileConfig : public StoredConfig<FileConfig> {
   /** true to open last opened file on startup */
   Q_PROPERTY(bool loadLastOpenedFile READ loadLastOpenedFile
              WRITE setLoadLastOpenedFile NOTIFY loadLastOpenedFileChanged)
+  /** maximum number of files with tags kept in memory, 0 for no limit */
+  Q_PROPERTY(int maxResidentTagFiles READ maxResidentTagFiles
+             WRITE setMaxResidentTagFiles NOTIFY maxResidentTagFilesChanged)
 
 public:
   /**
@@ -208,6 +211,12 @@ public:
   /** Set if the last opened file is loaded on startup. */
   void setLoadLastOpenedFile(bool loadLastOpenedFile);
 
+  /** Get maximum number of files with tags kept in memory, 0 for no limit. */
+  int maxResidentTagFiles() const { return m_maxResidentTagFiles; }
+
+  /** Set maximum number of files with tags kept in memory, 0 for no limit. */
+  void setMaxResidentTagFiles(int maxResidentTagFiles);
+
 signals:
   /** Emitted when @a nameFilter changed. */
   void nameFilterChanged(const QString& nameFilter);
@@ -254,6 +263,9 @@ signals:
   /** Emitted when @a loadLastOpenedFile changed. */
   void loadLastOpenedFileChanged(bool loadLastOpenedFile);
 
+  /** Emitted when @a maxResidentTagFiles changed. */
+  void maxResidentTagFilesChanged(int maxResidentTagFiles);
+
 private:
   friend FileConfig& StoredConfig<FileConfig>::instance();
 
@@ -269,6 +281,7 @@ private:
   QString m_defaultCoverFileName;
   QString m_lastOpenedFile;
   QString m_textEncoding;
+  int m_maxResidentTagFiles;
   bool m_preserveTime;
   bool m_markChanges;
   bool m_loadLastOpenedFile;
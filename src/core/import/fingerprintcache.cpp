@@ -0,0 +1,388 @@
+/**
+ * \file fingerprintcache.cpp
+ * Cache for audio fingerprints of files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fingerprintcache.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+namespace {
+
+/** Maximum number of FLAC metadata blocks skipped to find the audio. */
+constexpr int MAX_FLAC_METADATA_BLOCKS = 1024;
+
+/** Number of outdated lines tolerated before the cache file is compacted. */
+constexpr int MAX_OUTDATED_LINES = 64;
+
+/** Maximum time in ms to wait for another process using the cache file. */
+constexpr int LOCK_TIMEOUT_MS = 5000;
+
+/** Format version written in the first line of the cache file. */
+constexpr int FILE_FORMAT_VERSION = 1;
+
+/** Start of the first line of the cache file, followed by the version. */
+const char FILE_HEADER_PREFIX[] = "kid3-fingerprints\t";
+
+}
+
+/**
+ * Constructor.
+ * @param fileName path of cache file, empty to use "fingerprints.tsv" in
+ * the cache directory
+ */
+FingerprintCache::FingerprintCache(const QString& fileName)
+  : m_fileName(fileName), m_numOutdatedLines(0), m_loaded(false),
+    m_writable(true)
+{
+  if (m_fileName.isEmpty()) {
+    // The generic location is used, so that the cache is shared by
+    // kid3, kid3-qt and kid3-cli.
+    m_fileName = QStandardPaths::writableLocation(
+          QStandardPaths::GenericCacheLocation) +
+        QLatin1String("/kid3/fingerprints.tsv");
+  }
+}
+
+/**
+ * Get cache used by the application.
+ * @return fingerprint cache.
+ */
+FingerprintCache& FingerprintCache::instance()
+{
+  static FingerprintCache cache;
+  return cache;
+}
+
+/**
+ * Look up fingerprint of a file.
+ * An outdated entry is removed, it is removed from the cache file when the
+ * file is compacted.
+ * @param filePath absolute path of file
+ * @param fingerprint the fingerprint is returned here
+ * @param duration the duration in seconds is returned here
+ * @return true if an up to date entry was found.
+ */
+bool FingerprintCache::find(const QString& filePath, QString& fingerprint,
+                            int& duration)
+{
+  load();
+  auto it = m_entries.find(filePath);
+  if (it == m_entries.end())
+    return false;
+
+  if (FileKey key; !readFileKey(filePath, key) || !(key == it->key)) {
+    m_entries.erase(it);
+    ++m_numOutdatedLines;
+    return false;
+  }
+
+  fingerprint = it->fingerprint;
+  duration = it->duration;
+  return true;
+}
+
+/**
+ * Store fingerprint of a file.
+ * @param filePath absolute path of file
+ * @param fingerprint fingerprint
+ * @param duration duration in seconds
+ */
+void FingerprintCache::insert(const QString& filePath,
+                              const QString& fingerprint, int duration)
+{
+  if (fingerprint.isEmpty() ||
+      filePath.contains(QLatin1Char('\t')) ||
+      filePath.contains(QLatin1Char('\n')))
+    return;
+
+  Entry entry;
+  if (!readFileKey(filePath, entry.key))
+    return;
+
+  load();
+  entry.duration = duration;
+  entry.fingerprint = fingerprint;
+  if (m_entries.contains(filePath)) {
+    ++m_numOutdatedLines;
+  }
+  m_entries.insert(filePath, entry);
+
+  if (!m_writable ||
+      !QFileInfo(m_fileName).absoluteDir().mkpath(QLatin1String(".")))
+    return;
+
+  // Other Kid3 applications may append to the file at the same time.
+  QLockFile lock(lockFileName());
+  if (!lock.tryLock(LOCK_TIMEOUT_MS))
+    return;
+
+  if (QFile file(m_fileName); file.open(QIODevice::WriteOnly |
+                                        QIODevice::Append)) {
+    if (file.size() == 0) {
+      file.write(fileHeader());
+    }
+    file.write(entryLine(filePath, entry).toUtf8());
+  }
+}
+
+/**
+ * Get number of entries.
+ * @return number of entries.
+ */
+int FingerprintCache::size()
+{
+  load();
+  return static_cast<int>(m_entries.size());
+}
+
+/**
+ * Remove all entries and the cache file.
+ */
+void FingerprintCache::clear()
+{
+  m_entries.clear();
+  m_numOutdatedLines = 0;
+  m_loaded = true;
+  QLockFile lock(lockFileName());
+  if (lock.tryLock(LOCK_TIMEOUT_MS)) {
+    QFile::remove(m_fileName);
+  }
+}
+
+/**
+ * Get the identity of a file.
+ * The audio offset is the size of a leading ID3v2 tag and FLAC metadata
+ * blocks, for other formats it is 0.
+ * @param filePath path of file
+ * @param key the identity is returned here
+ * @return true if the file exists.
+ */
+bool FingerprintCache::readFileKey(const QString& filePath, FileKey& key)
+{
+  QFileInfo fi(filePath);
+  if (!fi.isFile())
+    return false;
+
+  key.size = fi.size();
+  key.modified = fi.lastModified().toMSecsSinceEpoch();
+  key.audioOffset = 0;
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    return true;
+
+  if (QByteArray header = file.read(10);
+      header.size() == 10 && header.startsWith("ID3")) {
+    // ID3v2 size is a 28 bit synchsafe integer, a footer has 10 bytes.
+    key.audioOffset = 10 +
+        ((static_cast<qint64>(header.at(6) & 0x7f) << 21) |
+         ((header.at(7) & 0x7f) << 14) |
+         ((header.at(8) & 0x7f) << 7) |
+         (header.at(9) & 0x7f));
+    if (header.at(5) & 0x10) {
+      key.audioOffset += 10;
+    }
+  }
+  if (file.seek(key.audioOffset) && file.read(4) == "fLaC") {
+    qint64 offset = key.audioOffset + 4;
+    for (int i = 0; i < MAX_FLAC_METADATA_BLOCKS; ++i) {
+      QByteArray blockHeader;
+      if (!file.seek(offset) ||
+          (blockHeader = file.read(4)).size() != 4)
+        break;
+
+      offset += 4 +
+          ((static_cast<quint8>(blockHeader.at(1)) << 16) |
+           (static_cast<quint8>(blockHeader.at(2)) << 8) |
+           static_cast<quint8>(blockHeader.at(3)));
+      if (blockHeader.at(0) & 0x80) {
+        key.audioOffset = offset;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Get line for an entry in the cache file.
+ * @param filePath path of file
+ * @param entry cache entry
+ * @return tab separated path, size, modification time, audio offset,
+ * duration and fingerprint terminated by a new line.
+ */
+QString FingerprintCache::entryLine(const QString& filePath,
+                                    const Entry& entry)
+{
+  return filePath + QLatin1Char('\t') +
+      QString::number(entry.key.size) + QLatin1Char('\t') +
+      QString::number(entry.key.modified) + QLatin1Char('\t') +
+      QString::number(entry.key.audioOffset) + QLatin1Char('\t') +
+      QString::number(entry.duration) + QLatin1Char('\t') +
+      entry.fingerprint + QLatin1Char('\n');
+}
+
+/**
+ * Parse a line of the cache file.
+ * @param line line written by entryLine()
+ * @param filePath the path of the file is returned here
+ * @param entry the cache entry is returned here
+ * @return true if the line is complete and valid.
+ */
+bool FingerprintCache::parseEntryLine(QByteArray line, QString& filePath,
+                                      Entry& entry)
+{
+  // A line without new line can be incomplete because another process is
+  // appending to the file.
+  if (!line.endsWith('\n'))
+    return false;
+
+  line.chop(1);
+  const QStringList fields = QString::fromUtf8(line).split(QLatin1Char('\t'));
+  if (fields.size() != 6 || fields.at(0).isEmpty())
+    return false;
+
+  bool sizeOk, modifiedOk, offsetOk, durationOk;
+  entry.key.size = fields.at(1).toLongLong(&sizeOk);
+  entry.key.modified = fields.at(2).toLongLong(&modifiedOk);
+  entry.key.audioOffset = fields.at(3).toLongLong(&offsetOk);
+  entry.duration = fields.at(4).toInt(&durationOk);
+  entry.fingerprint = fields.at(5);
+  filePath = fields.at(0);
+  return sizeOk && modifiedOk && offsetOk && durationOk &&
+      !entry.fingerprint.isEmpty();
+}
+
+/**
+ * Get first line of the cache file.
+ * @return header with format version.
+ */
+QByteArray FingerprintCache::fileHeader()
+{
+  return QByteArray(FILE_HEADER_PREFIX) +
+      QByteArray::number(FILE_FORMAT_VERSION) + '\n';
+}
+
+/**
+ * Get path of lock file used while the cache file is written.
+ * @return path of lock file.
+ */
+QString FingerprintCache::lockFileName() const
+{
+  return m_fileName + QLatin1String(".lock");
+}
+
+/**
+ * Read the cache file if it has not been read yet.
+ * The file is compacted if it contains many outdated lines, entries of
+ * files which have been deleted or modified are removed then.
+ */
+void FingerprintCache::load()
+{
+  if (m_loaded)
+    return;
+
+  m_loaded = true;
+  QLockFile lock(lockFileName());
+  const bool locked = lock.tryLock(LOCK_TIMEOUT_MS);
+  QFile file(m_fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  if (QByteArray header = file.readLine(); header != fileHeader()) {
+    // A file without header or with an older version is replaced,
+    // a file with a newer version is left alone.
+    if (header.startsWith(FILE_HEADER_PREFIX) &&
+        header.mid(static_cast<int>(qstrlen(FILE_HEADER_PREFIX))).trimmed()
+        .toInt() > FILE_FORMAT_VERSION) {
+      m_writable = false;
+    } else if (locked) {
+      file.close();
+      save();
+    }
+    return;
+  }
+
+  while (!file.atEnd()) {
+    QString filePath;
+    if (Entry entry; parseEntryLine(file.readLine(), filePath, entry)) {
+      // Later lines replace earlier entries for the same file.
+      if (m_entries.contains(filePath)) {
+        ++m_numOutdatedLines;
+      }
+      m_entries.insert(filePath, entry);
+    } else {
+      ++m_numOutdatedLines;
+    }
+  }
+  file.close();
+
+  if (locked && m_numOutdatedLines > MAX_OUTDATED_LINES + m_entries.size()) {
+    pruneEntries();
+    save();
+  }
+}
+
+/**
+ * Remove the entries of files which no longer exist or have been modified.
+ * Only the size and the modification time are checked, so that the files
+ * do not have to be opened.
+ */
+void FingerprintCache::pruneEntries()
+{
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (QFileInfo fi(it.key());
+        !fi.isFile() || fi.size() != it->key.size ||
+        fi.lastModified().toMSecsSinceEpoch() != it->key.modified) {
+      it = m_entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * Write all entries to the cache file.
+ * Has to be called while the lock file is locked.
+ */
+void FingerprintCache::save()
+{
+  QSaveFile file(m_fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    return;
+
+  file.write(fileHeader());
+  for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+    file.write(entryLine(it.key(), it.value()).toUtf8());
+  }
+  if (file.commit()) {
+    m_numOutdatedLines = 0;
+  }
+}
@@ -0,0 +1,141 @@
+/**
+ * \file fingerprintcache.h
+ * Cache for audio fingerprints of files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include "kid3api.h"
+
+/**
+ * Cache for audio fingerprints of files.
+ *
+ * Calculating a fingerprint requires decoding the whole audio stream, so
+ * fingerprints and durations are stored in a file in the cache directory,
+ * which is shared by all Kid3 applications. An entry is only used if the
+ * size, the modification time and the offset of the audio stream of the
+ * file have not changed since the fingerprint was calculated.
+ *
+ * The cache file starts with a line containing the format version, a file
+ * written by a newer version is not modified. New entries are appended to
+ * the cache file, the file is compacted when it is loaded and contains many
+ * outdated entries, entries of deleted or modified files are removed then.
+ * A lock file protects the cache file against concurrent writes from other
+ * Kid3 applications.
+ */
+class KID3_CORE_EXPORT FingerprintCache {
+public:
+  /**
+   * Constructor.
+   * @param fileName path of cache file, empty to use "fingerprints.tsv" in
+   * the cache directory
+   */
+  explicit FingerprintCache(const QString& fileName = QString());
+
+  /**
+   * Get cache used by the application.
+   * @return fingerprint cache.
+   */
+  static FingerprintCache& instance();
+
+  /**
+   * Get path of cache file.
+   * @return path of cache file.
+   */
+  QString fileName() const { return m_fileName; }
+
+  /**
+   * Look up fingerprint of a file.
+   * An outdated entry is removed, it is removed from the cache file when the
+   * file is compacted.
+   * @param filePath absolute path of file
+   * @param fingerprint the fingerprint is returned here
+   * @param duration the duration in seconds is returned here
+   * @return true if an up to date entry was found.
+   */
+  bool find(const QString& filePath, QString& fingerprint, int& duration);
+
+  /**
+   * Store fingerprint of a file.
+   * @param filePath absolute path of file
+   * @param fingerprint fingerprint
+   * @param duration duration in seconds
+   */
+  void insert(const QString& filePath, const QString& fingerprint,
+              int duration);
+
+  /**
+   * Get number of entries.
+   * @return number of entries.
+   */
+  int size();
+
+  /**
+   * Remove all entries and the cache file.
+   */
+  void clear();
+
+private:
+  friend class TestFingerprintCache;
+
+  /** Identity of a file when its fingerprint was calculated. */
+  struct FileKey {
+    qint64 size;        /**< size of file in bytes */
+    qint64 modified;    /**< modification time in ms since epoch */
+    qint64 audioOffset; /**< offset of audio stream after leading tags */
+
+    bool operator==(const FileKey& other) const {
+      return size == other.size && modified == other.modified &&
+          audioOffset == other.audioOffset;
+    }
+  };
+
+  /** Cached fingerprint. */
+  struct Entry {
+    FileKey key;
+    int duration;
+    QString fingerprint;
+  };
+
+  static bool readFileKey(const QString& filePath, FileKey& key);
+  static QString entryLine(const QString& filePath, const Entry& entry);
+  static bool parseEntryLine(QByteArray line, QString& filePath,
+                             Entry& entry);
+  static QByteArray fileHeader();
+  QString lockFileName() const;
+  void load();
+  void pruneEntries();
+  void save();
+
+  QString m_fileName;
+  QHash<QString, Entry> m_entries;
+  /** Number of lines in the cache file which are no longer used */
+  int m_numOutdatedLines;
+  bool m_loaded;
+  /** false if the cache file has been written by a newer version */
+  bool m_writable;
+};
@@ -32,6 +32,7 @@
 #include <QTimer>
 #include <QDateTime>
 #include "networkconfig.h"
+#include "performancetracer.h"
 
 
 /** Time when last request was sent to server */
@@ -68,7 +69,7 @@ static struct MinimumRequestIntervalInitializer {
  */
 HttpClient::HttpClient(QNetworkAccessManager* netMgr)
   : QObject(netMgr), m_netMgr(netMgr), m_rcvBodyLen(0),
-    m_requestTimer(new QTimer(this))
+    m_requestTimer(new QTimer(this)), m_requestStartTime(0)
 {
   setObjectName(QLatin1String("HttpClient"));
   m_requestTimer->setSingleShot(true);
@@ -96,6 +97,10 @@ HttpClient::~HttpClient()
 void HttpClient::networkReplyFinished()
 {
   if (auto reply = qobject_cast<QNetworkReply*>(sender())) {
+    if (PerformanceTracer::isEnabled()) {
+      PerformanceTracer::addSpan("HttpClient::request", m_requestStartTime,
+                                 reply->url().toString());
+    }
     QByteArray data(reply->readAll());
     m_rcvBodyType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
     m_rcvBodyLen = reply->header(QNetworkRequest::ContentLengthHeader).toUInt();
@@ -209,6 +214,7 @@ void HttpClient::sendRequest(const QUrl& url, const RawHeaderMap& headers)
   for (auto it = headers.constBegin(); it != headers.constEnd(); ++it) {
     request.setRawHeader(it.key(), it.value());
   }
+  m_requestStartTime = PerformanceTracer::now();
   QNetworkReply* reply = m_netMgr->get(request);
   m_reply = reply;
   connect(reply, &QNetworkReply::finished,
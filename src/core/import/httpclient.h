@@ -193,6 +193,8 @@ private:
     QUrl url;
     RawHeaderMap headers;
   } m_delayedSendRequestContext;
+  /** Trace time stamp when current request was sent */
+  qint64 m_requestStartTime;
 
   friend struct MinimumRequestIntervalInitializer;
 
@@ -168,12 +168,13 @@ bool ImportParser::getNextTags(const QString& text, TrackData& frames, int& pos)
     m_trackDuration.clear();
   } else if (pos == 0) {
     m_trackDuration.clear();
+    static const QRegularExpression durationRe(QLatin1String("(\\d+):(\\d+)"));
+    const int durationPos = m_codePos.value(QLatin1String("__duration"));
     int dsp = 0; // "duration search pos"
     int lastDsp = dsp;
     while ((idx = (match = m_re.match(text, dsp)).capturedStart()) != -1) {
-      QString durationStr = match.captured(m_codePos.value(QLatin1String("__duration")));
+      QString durationStr = match.captured(durationPos);
       int duration;
-      QRegularExpression durationRe(QLatin1String("(\\d+):(\\d+)"));
       auto durationMatch = durationRe.match(durationStr);
       if (durationMatch.hasMatch()) {
         duration = durationMatch.captured(1).toInt() * 60 +
@@ -0,0 +1,655 @@
+/**
+ * \file tagtableimporter.cpp
+ * Import of tag tables exported as CSV or JSON.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagtableimporter.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QRunnable>
+#include "trackdata.h"
+#include "performancetracer.h"
+
+namespace {
+
+/** Number of bytes read at once. */
+constexpr int BLOCK_SIZE = 4 * 1024 * 1024;
+
+/** Minimum number of bytes of rows parsed by a job. */
+constexpr int MIN_BYTES_PER_JOB = 256 * 1024;
+
+/**
+ * Find the end of a CSV record.
+ * A field starting with a double quote can contain line breaks as long as
+ * the record has fewer fields than the header, as in the ImportCsv script.
+ * @param data data
+ * @param pos begin of record
+ * @param end end of data
+ * @param numColumns number of columns in header
+ * @param atEnd true if no more data follows @a end
+ * @param fields if not null, begin and end of the fields are appended
+ * @return position behind the line break ending the record,
+ * -1 if the record is not complete.
+ */
+int scanCsvRecord(const char* data, int pos, int end, int numColumns,
+                  bool atEnd, QVector<int>* fields)
+{
+  int numFields = 0;
+  int fieldBegin = pos;
+  bool quoted = false;
+  auto addField = [&](int fieldEnd) {
+    if (fields) {
+      if (fieldEnd > fieldBegin && data[fieldEnd - 1] == '\r') {
+        --fieldEnd;
+      }
+      fields->append(fieldBegin);
+      fields->append(fieldEnd);
+    }
+    ++numFields;
+  };
+  for (int i = pos; i < end; ++i) {
+    const char c = data[i];
+    if (quoted) {
+      if (c == '"') {
+        if (i + 1 < end && data[i + 1] == '"') {
+          ++i;
+        } else if (i + 1 == end && !atEnd) {
+          return -1;
+        } else {
+          quoted = false;
+        }
+        continue;
+      }
+      if (c != '\n' || numFields + 1 < numColumns)
+        continue;
+
+      // All columns are present, the field was not quoted.
+      quoted = false;
+    }
+    if (c == '\t') {
+      addField(i);
+      fieldBegin = i + 1;
+    } else if (c == '\n') {
+      addField(i);
+      return i + 1;
+    } else if (c == '"' && i == fieldBegin) {
+      quoted = true;
+    }
+  }
+  if (!atEnd)
+    return -1;
+
+  addField(end);
+  return end;
+}
+
+/**
+ * Get value of a CSV field.
+ * @param data data
+ * @param begin begin of field
+ * @param end end of field
+ * @return value without surrounding quotes.
+ */
+QString csvValue(const char* data, int begin, int end)
+{
+  if (end - begin >= 2 && data[begin] == '"' && data[end - 1] == '"') {
+    QString value = QString::fromUtf8(data + begin + 1, end - begin - 2);
+    value.replace(QLatin1String("\"\""), QLatin1String("\""));
+    if (value.contains(QLatin1Char('\r'))) {
+      value.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+    }
+    return value;
+  }
+  return QString::fromUtf8(data + begin, end - begin);
+}
+
+/**
+ * Check if a CSV record is an empty line.
+ * @param data data
+ * @param begin begin of record
+ * @param end end of record
+ * @return true if empty.
+ */
+bool isEmptyCsvRecord(const char* data, int begin, int end)
+{
+  for (int i = begin; i < end; ++i) {
+    if (data[i] != '\r' && data[i] != '\n')
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Find the end of a JSON object.
+ * @param data data
+ * @param pos position of opening brace
+ * @param end end of data
+ * @return position behind the closing brace, -1 if the object is not
+ * complete.
+ */
+int scanJsonObject(const char* data, int pos, int end)
+{
+  int depth = 0;
+  bool inString = false;
+  bool escaped = false;
+  for (int i = pos; i < end; ++i) {
+    const char c = data[i];
+    if (inString) {
+      if (escaped) {
+        escaped = false;
+      } else if (c == '\\') {
+        escaped = true;
+      } else if (c == '"') {
+        inString = false;
+      }
+    } else if (c == '"') {
+      inString = true;
+    } else if (c == '{' || c == '[') {
+      ++depth;
+    } else if ((c == '}' || c == ']') && --depth == 0) {
+      return i + 1;
+    }
+  }
+  return -1;
+}
+
+}
+
+/**
+ * Job parsing the rows of a chunk.
+ */
+class TagTableParser : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param chunk chunk to parse
+   * @param isJson true if the rows are JSON objects, false for CSV records
+   * @param numColumns number of columns in CSV header
+   * @param filePathColumn index of "File Path" column in CSV header, -1 if
+   * not available
+   */
+  TagTableParser(TagTableImporter::Chunk* chunk, bool isJson, int numColumns,
+                 int filePathColumn)
+    : m_chunk(chunk), m_numColumns(numColumns),
+      m_filePathColumn(filePathColumn), m_isJson(isJson) {
+  }
+
+  /**
+   * Parse rows.
+   */
+  void run() override {
+    if (m_isJson) {
+      parseJson();
+    } else {
+      parseCsv();
+    }
+    // The data is no longer needed.
+    m_chunk->data.clear();
+  }
+
+private:
+  void parseCsv() {
+    const char* data = m_chunk->data.constData();
+    const QVector<int>& bounds = m_chunk->rowBounds;
+    m_chunk->rows.reserve(bounds.size() / 2);
+    QVector<int> fields;
+    for (int i = 0; i + 1 < bounds.size(); i += 2) {
+      fields.clear();
+      scanCsvRecord(data, bounds.at(i), bounds.at(i + 1), m_numColumns, true,
+                    &fields);
+      QStringList values;
+      values.reserve(fields.size() / 2);
+      for (int j = 0; j + 1 < fields.size(); j += 2) {
+        QString value = csvValue(data, fields.at(j), fields.at(j + 1));
+        // Backslashes are path separators on Windows.
+        if (j / 2 != m_filePathColumn && value.contains(QLatin1Char('\\'))) {
+          value.replace(QLatin1String("\\n"), QLatin1String("\n"))
+               .replace(QLatin1String("\\r"), QLatin1String("\r"))
+               .replace(QLatin1String("\\t"), QLatin1String("\t"));
+        }
+        values.append(value);
+      }
+      m_chunk->rows.append(values);
+    }
+  }
+
+  void parseJson() {
+    const char* data = m_chunk->data.constData();
+    const QVector<int>& bounds = m_chunk->rowBounds;
+    QStringList& columns = m_chunk->columns;
+    QHash<QString, int> columnOfName;
+    m_chunk->rows.reserve(bounds.size() / 2);
+    for (int i = 0; i + 1 < bounds.size(); i += 2) {
+      const QJsonObject obj = QJsonDocument::fromJson(
+            QByteArray::fromRawData(data + bounds.at(i),
+                                    bounds.at(i + 1) - bounds.at(i))).object();
+      QStringList values;
+      values.reserve(columns.size());
+      for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+        int column;
+        if (auto colIt = columnOfName.constFind(it.key());
+            colIt != columnOfName.constEnd()) {
+          column = *colIt;
+        } else {
+          column = columns.size();
+          columns.append(it.key());
+          columnOfName.insert(it.key(), column);
+        }
+        while (values.size() <= column) {
+          values.append(QString());
+        }
+        values[column] = it.value().toVariant().toString();
+      }
+      m_chunk->rows.append(values);
+    }
+  }
+
+  TagTableImporter::Chunk* m_chunk;
+  int m_numColumns;
+  int m_filePathColumn;
+  bool m_isJson;
+};
+
+
+/**
+ * Constructor.
+ */
+TagTableImporter::TagTableImporter() : m_isJson(false)
+{
+}
+
+/**
+ * Read a table from a file.
+ * JSON is used if the file starts with '{', else CSV.
+ * @param path path to CSV or JSON file
+ * @return true if rows were read.
+ */
+bool TagTableImporter::readFile(const QString& path)
+{
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    clear();
+    return false;
+  }
+  return read(&file);
+}
+
+/**
+ * Read a table from a device.
+ * JSON is used if the data starts with '{', else CSV.
+ * @param device device open for reading
+ * @return true if rows were read.
+ */
+bool TagTableImporter::read(QIODevice* device)
+{
+  TraceSpan span("TagTableImporter::read");
+  clear();
+
+  QThreadPool threadPool;
+  QVector<Chunk*> chunks;
+  QByteArray buffer;
+  // Begin and end of the rows not yet passed to a job, offsets in buffer
+  QVector<int> bounds;
+  int pos = 0;
+  bool formatKnown = false;
+  bool atEnd = false;
+  int numColumns = 0;
+  int filePathColumn = -1;
+  // JSON scanner state outside of the rows
+  int depth = 0;
+  bool inString = false;
+  bool escaped = false;
+  bool inData = false;
+  bool dataDone = false;
+  QByteArray lastKey;
+
+  auto startJob = [&]() {
+    if (bounds.isEmpty())
+      return;
+
+    const int begin = bounds.first();
+    auto chunk = new Chunk;
+    chunk->data = buffer.mid(begin, bounds.last() - begin);
+    chunk->rowBounds.reserve(bounds.size());
+    for (int offset : std::as_const(bounds)) {
+      chunk->rowBounds.append(offset - begin);
+    }
+    bounds.clear();
+    chunks.append(chunk);
+    threadPool.start(new TagTableParser(chunk, m_isJson, numColumns,
+                                        filePathColumn));
+  };
+  auto addRow = [&](int begin, int end) {
+    bounds.append(begin);
+    bounds.append(end);
+    if (end - bounds.first() >= MIN_BYTES_PER_JOB) {
+      startJob();
+    }
+  };
+
+  while (!atEnd && !dataDone) {
+    QByteArray block = device->read(BLOCK_SIZE);
+    atEnd = block.isEmpty() || device->atEnd();
+    buffer.append(block);
+    const char* data = buffer.constData();
+    const int size = buffer.size();
+
+    if (!formatKnown) {
+      if (pos == 0 && buffer.startsWith("\xef\xbb\xbf")) {
+        pos = 3;
+      }
+      while (pos < size && (data[pos] == ' ' || data[pos] == '\t' ||
+                            data[pos] == '\r' || data[pos] == '\n')) {
+        ++pos;
+      }
+      if (pos < size) {
+        formatKnown = true;
+        m_isJson = data[pos] == '{';
+      }
+    }
+
+    if (formatKnown && !m_isJson) {
+      if (numColumns == 0) {
+        QVector<int> fields;
+        if (int end = scanCsvRecord(data, pos, size, 1, atEnd, &fields);
+            end >= 0) {
+          for (int j = 0; j + 1 < fields.size(); j += 2) {
+            m_columns.append(csvValue(data, fields.at(j), fields.at(j + 1)));
+          }
+          numColumns = m_columns.size();
+          filePathColumn = m_columns.indexOf(QLatin1String("File Path"));
+          pos = end;
+        }
+      }
+      if (numColumns > 0) {
+        while (pos < size) {
+          const int end = scanCsvRecord(data, pos, size, numColumns, atEnd,
+                                        nullptr);
+          if (end < 0)
+            break;
+
+          if (!isEmptyCsvRecord(data, pos, end)) {
+            addRow(pos, end);
+          }
+          pos = end;
+        }
+      }
+    } else if (formatKnown) {
+      while (pos < size && !dataDone) {
+        const char c = data[pos];
+        if (inString) {
+          if (escaped) {
+            escaped = false;
+          } else if (c == '\\') {
+            escaped = true;
+          } else if (c == '"') {
+            inString = false;
+          } else if (depth == 1 && lastKey.size() <= 4) {
+            lastKey.append(c);
+          }
+        } else if (inData && depth == 2 && c == '{') {
+          const int end = scanJsonObject(data, pos, size);
+          if (end < 0)
+            break;
+
+          addRow(pos, end);
+          pos = end;
+          continue;
+        } else if (c == '"') {
+          inString = true;
+          if (depth == 1) {
+            lastKey.clear();
+          }
+        } else if (c == '{' || c == '[') {
+          ++depth;
+          if (c == '[' && depth == 2 && lastKey == "data") {
+            inData = true;
+          }
+        } else if (c == '}' || c == ']') {
+          --depth;
+          if (inData && depth == 1) {
+            dataDone = true;
+          }
+        }
+        ++pos;
+      }
+    }
+
+    // Only keep the data which is still needed.
+    const int keep = bounds.isEmpty() ? pos : bounds.first();
+    if (keep > 0) {
+      buffer.remove(0, keep);
+      pos -= keep;
+      for (int& offset : bounds) {
+        offset -= keep;
+      }
+    }
+  }
+  startJob();
+  threadPool.waitForDone();
+
+  for (Chunk* chunk : std::as_const(chunks)) {
+    addChunkRows(*chunk);
+  }
+  qDeleteAll(chunks);
+  buildIndex();
+  return !m_rows.isEmpty();
+}
+
+/**
+ * Remove all rows.
+ */
+void TagTableImporter::clear()
+{
+  m_columns.clear();
+  m_rows.clear();
+  m_rowOfFilePath.clear();
+  m_rowOfFilename.clear();
+  m_isJson = false;
+}
+
+/**
+ * Add the parsed rows of a chunk to the table.
+ * @param chunk chunk parsed by a TagTableParser
+ */
+void TagTableImporter::addChunkRows(Chunk& chunk)
+{
+  bool sameColumns = true;
+  if (m_isJson) {
+    // The columns of the chunk are usually the same as in the previous
+    // chunks, so the rows can be used without remapping the columns.
+    const int numCommon = qMin(chunk.columns.size(), m_columns.size());
+    for (int i = 0; i < numCommon; ++i) {
+      if (chunk.columns.at(i) != m_columns.at(i)) {
+        sameColumns = false;
+        break;
+      }
+    }
+    if (sameColumns && chunk.columns.size() > m_columns.size()) {
+      m_columns = chunk.columns;
+    }
+  }
+  if (sameColumns) {
+    if (m_rows.isEmpty()) {
+      m_rows = std::move(chunk.rows);
+    } else {
+      m_rows.reserve(m_rows.size() + chunk.rows.size());
+      for (QStringList& values : chunk.rows) {
+        m_rows.append(std::move(values));
+      }
+    }
+    return;
+  }
+
+  // The JSON objects have other keys than the previous chunks, map the
+  // columns of the chunk to the columns of the table.
+  QVector<int> columnOfChunkColumn;
+  columnOfChunkColumn.reserve(chunk.columns.size());
+  for (const QString& name : std::as_const(chunk.columns)) {
+    int column = m_columns.indexOf(name);
+    if (column == -1) {
+      column = m_columns.size();
+      m_columns.append(name);
+    }
+    columnOfChunkColumn.append(column);
+  }
+  m_rows.reserve(m_rows.size() + chunk.rows.size());
+  for (const QStringList& chunkValues : std::as_const(chunk.rows)) {
+    QStringList values;
+    for (int i = 0; i < chunkValues.size(); ++i) {
+      const int column = columnOfChunkColumn.at(i);
+      while (values.size() <= column) {
+        values.append(QString());
+      }
+      values[column] = chunkValues.at(i);
+    }
+    m_rows.append(values);
+  }
+}
+
+/**
+ * Index the rows by file path and file name.
+ */
+void TagTableImporter::buildIndex()
+{
+  const int filePathColumn = m_columns.indexOf(QLatin1String("File Path"));
+  if (filePathColumn == -1)
+    return;
+
+  const int numRows = m_rows.size();
+  m_rowOfFilePath.reserve(numRows);
+  m_rowOfFilename.reserve(numRows);
+  for (int row = 0; row < numRows; ++row) {
+    const QStringList& values = m_rows.at(row);
+    if (filePathColumn >= values.size())
+      continue;
+
+    const QString& filePath = values.at(filePathColumn);
+    if (filePath.isEmpty())
+      continue;
+
+    m_rowOfFilePath.insert(filePath, row);
+    const QString filename =
+        filePath.mid(filePath.lastIndexOf(QLatin1Char('/')) + 1);
+    if (auto it = m_rowOfFilename.find(filename);
+        it != m_rowOfFilename.end()) {
+      if (*it != row) {
+        *it = -1;
+      }
+    } else {
+      m_rowOfFilename.insert(filename, row);
+    }
+  }
+}
+
+/**
+ * Find row for a file.
+ * The row is looked up by the absolute file path and if not found by
+ * the file name, if it is unique in the table.
+ * @param absFilename absolute path of file
+ * @return row, -1 if not found.
+ */
+int TagTableImporter::findRow(const QString& absFilename) const
+{
+  if (auto it = m_rowOfFilePath.constFind(absFilename);
+      it != m_rowOfFilePath.constEnd()) {
+    return *it;
+  }
+  return m_rowOfFilename.value(
+        absFilename.mid(absFilename.lastIndexOf(QLatin1Char('/')) + 1), -1);
+}
+
+/**
+ * Set frames of track data from the rows.
+ * The rows are matched by file path, if no track data can be matched
+ * that way, the rows are applied in the order of the track data.
+ * @param trackDataVector track data to be filled with imported values
+ * @param tagNr tag number of the frames in the track data
+ * @return number of track data entries set from a row.
+ */
+int TagTableImporter::applyTo(ImportTrackDataVector& trackDataVector,
+                              Frame::TagNumber tagNr) const
+{
+  TraceSpan span("TagTableImporter::applyTo");
+  // Find the columns with frames of the tag, names are prefixed with "v1"
+  // for tag 1 and "v3" for tag 3.
+  QVector<int> columns;
+  QVector<Frame::ExtendedType> types;
+  const int numColumns = m_columns.size();
+  for (int column = 0; column < numColumns; ++column) {
+    const QString& name = m_columns.at(column);
+    if (name == QLatin1String("File Path") ||
+        name == QLatin1String("Duration"))
+      continue;
+
+    Frame::TagNumber columnTagNr = Frame::Tag_2;
+    QString frameName = name;
+    if (name.startsWith(QLatin1String("v1"))) {
+      columnTagNr = Frame::Tag_1;
+      frameName.remove(0, 2);
+    } else if (name.startsWith(QLatin1String("v3"))) {
+      columnTagNr = Frame::Tag_3;
+      frameName.remove(0, 2);
+    }
+    if (columnTagNr == tagNr) {
+      columns.append(column);
+      types.append(Frame::ExtendedType(frameName));
+    }
+  }
+  if (columns.isEmpty())
+    return 0;
+
+  auto applyRow = [&columns, &types](ImportTrackData& trackData,
+                                     const QStringList& values) {
+    for (int i = 0; i < columns.size(); ++i) {
+      if (const int column = columns.at(i); column < values.size()) {
+        if (const QString& value = values.at(column); !value.isEmpty()) {
+          trackData.setValue(types.at(i), value);
+        }
+      }
+    }
+  };
+
+  int numApplied = 0;
+  if (hasFilePaths()) {
+    for (auto it = trackDataVector.begin(); it != trackDataVector.end(); ++it) {
+      if (int row = findRow(it->getAbsFilename()); row >= 0) {
+        applyRow(*it, m_rows.at(row));
+        ++numApplied;
+      }
+    }
+  }
+  if (numApplied == 0) {
+    // Like the import scripts, apply the rows in the order of the files
+    // if no file is found.
+    numApplied = qMin(static_cast<int>(trackDataVector.size()),
+                      static_cast<int>(m_rows.size()));
+    for (int row = 0; row < numApplied; ++row) {
+      applyRow(trackDataVector[row], m_rows.at(row));
+    }
+  }
+  return numApplied;
+}
@@ -0,0 +1,138 @@
+/**
+ * \file tagtableimporter.h
+ * Import of tag tables exported as CSV or JSON.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QHash>
+#include <QStringList>
+#include "frame.h"
+#include "kid3api.h"
+
+class QIODevice;
+class ImportTrackDataVector;
+
+/**
+ * Import of tag tables exported as CSV or JSON.
+ *
+ * The tables have the format written by the ExportCsv and ExportJson
+ * scripts: CSV files have tab separated columns with the frame names in the
+ * first line, JSON files contain an object with a "data" array of objects
+ * with frame names as keys. Frame names with a "v1" or "v3" prefix are used
+ * for tag 1 and tag 3, the "File Path" column identifies the file of a row.
+ *
+ * The data is read in blocks, the rows are split into chunks which are
+ * parsed in parallel by worker threads. The rows are indexed by file path
+ * and file name, so that they can be applied to track data without
+ * searching.
+ */
+class KID3_CORE_EXPORT TagTableImporter {
+public:
+  /**
+   * Constructor.
+   */
+  TagTableImporter();
+
+  /**
+   * Read a table from a file.
+   * JSON is used if the file starts with '{', else CSV.
+   * @param path path to CSV or JSON file
+   * @return true if rows were read.
+   */
+  bool readFile(const QString& path);
+
+  /**
+   * Read a table from a device.
+   * JSON is used if the data starts with '{', else CSV.
+   * @param device device open for reading
+   * @return true if rows were read.
+   */
+  bool read(QIODevice* device);
+
+  /**
+   * Remove all rows.
+   */
+  void clear();
+
+  /**
+   * Get names of columns.
+   * @return column names.
+   */
+  QStringList columnNames() const { return m_columns; }
+
+  /**
+   * Get number of rows.
+   * @return number of rows.
+   */
+  int rowCount() const { return static_cast<int>(m_rows.size()); }
+
+  /**
+   * Check if the rows are indexed by file path.
+   * @return true if there is a "File Path" column.
+   */
+  bool hasFilePaths() const { return !m_rowOfFilePath.isEmpty(); }
+
+  /**
+   * Find row for a file.
+   * The row is looked up by the absolute file path and if not found by
+   * the file name, if it is unique in the table.
+   * @param absFilename absolute path of file
+   * @return row, -1 if not found.
+   */
+  int findRow(const QString& absFilename) const;
+
+  /**
+   * Set frames of track data from the rows.
+   * The rows are matched by file path, if no track data can be matched
+   * that way, the rows are applied in the order of the track data.
+   * @param trackDataVector track data to be filled with imported values
+   * @param tagNr tag number of the frames in the track data
+   * @return number of track data entries set from a row.
+   */
+  int applyTo(ImportTrackDataVector& trackDataVector,
+              Frame::TagNumber tagNr) const;
+
+private:
+  friend class TagTableParser;
+
+  /** Rows of a chunk parsed by a worker thread. */
+  struct Chunk {
+    QByteArray data;            /**< data containing the rows */
+    QVector<int> rowBounds;     /**< begin and end of rows in data */
+    QStringList columns;        /**< column names used in JSON rows */
+    QVector<QStringList> rows;  /**< values indexed by column */
+  };
+
+  void addChunkRows(Chunk& chunk);
+  void buildIndex();
+
+  QStringList m_columns;
+  QVector<QStringList> m_rows;
+  QHash<QString, int> m_rowOfFilePath;
+  /** Rows for file names, -1 if the file name is not unique */
+  QHash<QString, int> m_rowOfFilename;
+  bool m_isJson;
+};
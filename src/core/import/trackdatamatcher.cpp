@@ -252,8 +252,8 @@ bool TrackDataMatcher::matchWithTrack(TrackDataModel* trackDataModel)
 bool TrackDataMatcher::matchWithTitle(TrackDataModel* trackDataModel)
 {
   struct MatchData {
-    QSet<QString> fileWords;  // words in file name
-    QSet<QString> titleWords; // words in title
+    QVector<int> fileWords;  // IDs of words in file name
+    QVector<int> titleWords; // IDs of words in title
     int assignedTo = -1;   // number of file import is assigned to, -1 if not assigned
     int assignedFrom = -1; // number of import assigned to file, -1 if not assigned
   };
@@ -261,6 +261,7 @@ bool TrackDataMatcher::matchWithTitle(TrackDataModel* trackDataModel)
   bool failed = false;
   ImportTrackDataVector trackDataVector(trackDataModel->getTrackData());
   if (const int numTracks = trackDataVector.size(); numTracks > 0) {
+    WordIdMap wordIds;
     auto md = new MatchData[numTracks];
     int numFiles = 0, numImports = 0;
     int i = 0;
@@ -270,11 +271,11 @@ bool TrackDataMatcher::matchWithTitle(TrackDataModel* trackDataModel)
       if (i >= numTracks) {
         break;
       }
-      md[i].fileWords = it->getFilenameWords();
+      md[i].fileWords = it->getFilenameWords(wordIds);
       if (!md[i].fileWords.isEmpty()) {
         ++numFiles;
       }
-      md[i].titleWords = it->getTitleWords();
+      md[i].titleWords = it->getTitleWords(wordIds);
       if (!md[i].titleWords.isEmpty()) {
         ++numImports;
       }
@@ -293,7 +294,8 @@ bool TrackDataMatcher::matchWithTitle(TrackDataModel* trackDataModel)
           for (int comparedTrack = 0; comparedTrack < numTracks; ++comparedTrack) {
             if (md[comparedTrack].assignedTo == -1) {
               if (int comparedMatch =
-                    (md[i].fileWords & md[comparedTrack].titleWords).size();
+                    ImportTrackData::countCommonWords(
+                      md[i].fileWords, md[comparedTrack].titleWords);
                   comparedMatch > bestMatch) {
                 bestMatch = comparedMatch;
                 bestTrack = comparedTrack;
@@ -320,7 +322,8 @@ bool TrackDataMatcher::matchWithTitle(TrackDataModel* trackDataModel)
           for (int comparedTrack = 0; comparedTrack < numTracks; ++comparedTrack) {
             if (md[comparedTrack].assignedFrom == -1) {
               if (int comparedMatch =
-                    (md[comparedTrack].fileWords & md[i].titleWords).size();
+                    ImportTrackData::countCommonWords(
+                      md[comparedTrack].fileWords, md[i].titleWords);
                   comparedMatch > bestMatch) {
                 bestMatch = comparedMatch;
                 bestTrack = comparedTrack;
@@ -80,26 +80,60 @@ QByteArray CoreTaggedFileIconProvider::iconIdForTaggedFile(
     const TaggedFile* taggedFile) const
 {
   if (taggedFile) {
-    if (taggedFile->isChanged()) {
-      return "modified";
+    int tagVersions = 0;
+    FOR_ALL_TAGS(tagNr) {
+      if (taggedFile->hasTag(tagNr))
+        tagVersions |= Frame::tagVersionFromNumber(tagNr);
     }
-    if (!taggedFile->isTagInformationRead())
-      return "null";
-
-    QByteArray id;
-    if (taggedFile->hasTag(Frame::Tag_1))
-      id += "v1";
-    if (taggedFile->hasTag(Frame::Tag_2))
-      id += "v2";
-    if (taggedFile->hasTag(Frame::Tag_3))
-      id += "v3";
-    if (id.isEmpty())
-      id = "notag";
-    return id;
+    return iconIdForTagState(taggedFile->isChanged(),
+                             taggedFile->isTagInformationRead(), tagVersions);
   }
   return "";
 }
 
+/**
+ * Get an icon for an icon ID.
+ *
+ * @param id icon ID as returned by iconIdForTaggedFile()
+ *
+ * @return icon for @a id.
+ */
+QVariant CoreTaggedFileIconProvider::iconForIconId(const QByteArray& id)
+{
+  Q_UNUSED(id)
+  return QVariant();
+}
+
+/**
+ * Get an icon ID for the state of the tags of a file.
+ *
+ * @param changed true if the file is modified
+ * @param tagInformationRead true if the tag information has been read
+ * @param tagVersions present tags, combination of Frame::TagVersion values
+ *
+ * @return icon ID as returned by iconIdForTaggedFile().
+ */
+QByteArray CoreTaggedFileIconProvider::iconIdForTagState(
+    bool changed, bool tagInformationRead, int tagVersions)
+{
+  if (changed) {
+    return "modified";
+  }
+  if (!tagInformationRead)
+    return "null";
+
+  QByteArray id;
+  if (tagVersions & Frame::TagV1)
+    id += "v1";
+  if (tagVersions & Frame::TagV2)
+    id += "v2";
+  if (tagVersions & Frame::TagV3)
+    id += "v3";
+  if (id.isEmpty())
+    id = "notag";
+  return id;
+}
+
 /**
  * Get pixmap for an icon ID.
  * @param id icon ID as returned by iconIdForTaggedFile(), or data for image
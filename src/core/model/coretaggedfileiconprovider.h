@@ -89,6 +89,27 @@ public:
    */
   virtual QByteArray iconIdForTaggedFile(const TaggedFile* taggedFile) const;
 
+  /**
+   * Get an icon for an icon ID.
+   *
+   * @param id icon ID as returned by iconIdForTaggedFile()
+   *
+   * @return icon for @a id.
+   */
+  virtual QVariant iconForIconId(const QByteArray& id);
+
+  /**
+   * Get an icon ID for the state of the tags of a file.
+   *
+   * @param changed true if the file is modified
+   * @param tagInformationRead true if the tag information has been read
+   * @param tagVersions present tags, combination of Frame::TagVersion values
+   *
+   * @return icon ID as returned by iconIdForTaggedFile().
+   */
+  static QByteArray iconIdForTagState(bool changed, bool tagInformationRead,
+                                      int tagVersions);
+
   /**
    * Get pixmap for an icon ID.
    * @param id icon ID as returned by iconIdForTaggedFile(), or data for image
@@ -28,11 +28,29 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QCoreApplication>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <QMutex>
+#include <QSet>
+#include <QLockFile>
+#include <QScopedPointer>
+#include <QDateTime>
+#include <QAtomicInt>
+#ifdef Q_OS_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "trackdata.h"
 #include "saferename.h"
 #include "taggedfilesystemmodel.h"
 #include "modeliterator.h"
 #include "formatconfig.h"
+#include "performancetracer.h"
 
 /**
  * Data collected by DirNameFormatReplacer during a rename session.
@@ -224,8 +242,156 @@ QString parentDirectory(const QString& dir)
   return parent;
 }
 
+
+/**
+ * Write-ahead journal of rename actions.
+ *
+ * All actions are written before the first one is performed, every completed
+ * action is then recorded, so that an interrupted renaming can be resumed or
+ * rolled back. Each line contains a JSON array, ["action", type, src, dest]
+ * or ["done", index of action]. Every renaming uses its own journal, which is
+ * locked while it is written, so that journals of processes which were
+ * interrupted can be told apart from journals in use. An existing journal is
+ * never overwritten.
+ */
+class RenameJournal {
+public:
+  /**
+   * Create journal file.
+   * @param path path to journal
+   * @return true if ok, false if the journal could not be created or
+   * already exists.
+   */
+  bool open(const QString& path) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_lockFile.reset(new QLockFile(path + QLatin1String(".lock")));
+    if (!m_lockFile->tryLock(0)) {
+      m_lockFile.reset();
+      return false;
+    }
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+      m_lockFile.reset();
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Check if journal is open.
+   * @return true if open.
+   */
+  bool isOpen() const { return m_file.isOpen(); }
+
+  /**
+   * Record an action.
+   * @param type type of action
+   * @param src source file or directory name
+   * @param dest destination file or directory name
+   */
+  void addAction(int type, const QString& src, const QString& dest) {
+    writeRecord({QLatin1String("action"), type, src, dest});
+  }
+
+  /**
+   * Write the recorded actions to the storage device, so that they are
+   * available when the system crashes while the actions are performed.
+   */
+  void commit() {
+    QMutexLocker locker(&m_mutex);
+    m_file.flush();
+#ifdef Q_OS_WIN32
+    ::_commit(m_file.handle());
+#elif defined Q_OS_LINUX
+    ::fdatasync(m_file.handle());
+#else
+    ::fsync(m_file.handle());
+#endif
+  }
+
+  /**
+   * Record that an action has been completed.
+   * Can be called from any thread.
+   * @param index index of action
+   */
+  void markDone(int index) {
+    writeRecord({QLatin1String("done"), index});
+    QMutexLocker locker(&m_mutex);
+    m_file.flush();
+  }
+
+  /**
+   * Remove journal after all actions have been performed.
+   */
+  void remove() {
+    if (m_file.isOpen()) {
+      m_file.close();
+      m_file.remove();
+    }
+    m_lockFile.reset();
+  }
+
+private:
+  void writeRecord(const QJsonArray& record) {
+    QMutexLocker locker(&m_mutex);
+    m_file.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+    m_file.write("\n", 1);
+  }
+
+  QFile m_file;
+  QScopedPointer<QLockFile> m_lockFile;
+  QMutex m_mutex;
+};
+
+/**
+ * Get directory containing the rename journals.
+ * @return directory path.
+ */
+QString journalDirectory()
+{
+  return QStandardPaths::writableLocation(
+        QStandardPaths::AppLocalDataLocation);
 }
 
+}
+
+
+/**
+ * Job renaming a file in a thread pool.
+ */
+class DirRenamer::FileMover : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param src source file name
+   * @param dest destination file name
+   * @param index index of action in journal
+   * @param journal journal, can be null
+   * @param errorMsg error message is stored here
+   */
+  FileMover(const QString& src, const QString& dest, int index,
+            RenameJournal* journal, QString* errorMsg)
+    : m_src(src), m_dest(dest), m_index(index), m_journal(journal),
+      m_errorMsg(errorMsg) {
+  }
+
+  /**
+   * Rename file.
+   */
+  void run() override {
+    if (renameFile(m_src, m_dest, m_errorMsg) && m_journal) {
+      m_journal->markDone(m_index);
+    }
+  }
+
+private:
+  QString m_src;
+  QString m_dest;
+  int m_index;
+  RenameJournal* m_journal;
+  QString* m_errorMsg;
+};
+
 /**
  * Constructor.
  * @param parent parent object
@@ -343,17 +509,18 @@ bool DirRenamer::renameDirectory(
 
 /**
  * Rename a file.
+ * Can be called from any thread, the file handle of the tagged file must
+ * be closed before.
  *
  * @param oldfn    old file name
  * @param newfn    new file name
  * @param errorMsg if not NULL and an error occurred, a message is
  *                 appended here, otherwise it is not touched
- * @param index    model index of item to rename
  *
  * @return true if rename successful or newfn already exists.
  */
 bool DirRenamer::renameFile(const QString& oldfn, const QString& newfn,
-                const QPersistentModelIndex& index, QString* errorMsg) const
+                            QString* errorMsg)
 {
   if (QFileInfo(newfn).isFile()) {
     return true;
@@ -370,12 +537,7 @@ bool DirRenamer::renameFile(const QString& oldfn, const QString& newfn,
     }
     return false;
   }
-  if (TaggedFile* taggedFile =
-      TaggedFileSystemModel::getTaggedFileOfIndex(index)) {
-    // The file must be closed before renaming on Windows.
-    taggedFile->closeFileHandle();
-  }
-  if (Utils::safeRename(oldfn, newfn) && QFileInfo(newfn).isFile()) {
+  if (Utils::moveFile(oldfn, newfn) && QFileInfo(newfn).isFile()) {
     return true;
   }
   if (errorMsg) {
@@ -384,6 +546,29 @@ bool DirRenamer::renameFile(const QString& oldfn, const QString& newfn,
   return false;
 }
 
+/** Only defined for generation of translation files */
+#define REMOVE_DIR_FAILED_FOR_PO QT_TRANSLATE_NOOP("@default", "Remove folder %1 failed\n")
+
+/**
+ * Remove a directory if it is empty.
+ *
+ * @param dir      directory path
+ * @param errorMsg if not NULL and an error occurred, a message is
+ *                 appended here, otherwise it is not touched
+ *
+ * @return true if directory does not exist or was removed.
+ */
+bool DirRenamer::removeDirectory(const QString& dir, QString* errorMsg) const
+{
+  if (!QFileInfo::exists(dir) || QDir().rmdir(dir)) {
+    return true;
+  }
+  if (errorMsg) {
+    errorMsg->append(tr("Remove folder %1 failed\n").arg(dir));
+  }
+  return false;
+}
+
 /**
  * Generate new directory name according to current settings.
  *
@@ -645,34 +830,252 @@ void DirRenamer::endScheduleActions()
 /**
  * Perform the scheduled rename actions.
  *
+ * File renames are performed concurrently until a directory action or a
+ * rename of the same path depends on them. The actions are recorded in a
+ * journal, which is removed when all actions have been performed.
+ *
  * @param errorMsg if not 0 and an error occurred, a message is appended here,
  *                 otherwise it is not touched
  */
 void DirRenamer::performActions(QString* errorMsg)
 {
-  for (auto it = m_actions.constBegin(); it != m_actions.constEnd(); ++it) {
-    switch (it->m_type) {
+  TraceSpan span("DirRenamer::performActions");
+  RenameJournal journal;
+  if (!m_actions.isEmpty()) {
+    if (const QString path = journalPath(); journal.open(path)) {
+      for (const RenameAction& action : std::as_const(m_actions)) {
+        journal.addAction(action.m_type, action.m_src, action.m_dest);
+      }
+      journal.commit();
+    } else {
+      qWarning("Could not create %s", qPrintable(path));
+    }
+  }
+  if (!m_recoveredJournalPath.isEmpty()) {
+    // The remaining actions of a recovered journal are now in the journal
+    // of this process.
+    QFile::remove(m_recoveredJournalPath);
+    m_recoveredJournalPath.clear();
+  }
+  RenameJournal* journalPtr = journal.isOpen() ? &journal : nullptr;
+
+  // Moving files is I/O bound, use more threads than cores.
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(qMax(QThread::idealThreadCount(), 4));
+  QVector<QString> fileErrors(m_actions.size());
+  QList<int> pendingActions;
+  // Source and destination paths of pending file renames and their parent
+  // directories, an action touching one of them has to wait.
+  QSet<QString> pendingPaths;
+  QSet<QString> pendingDirs;
+  auto addPendingPath = [&pendingPaths, &pendingDirs](const QString& path) {
+    pendingPaths.insert(path);
+    QString dir = path;
+    int slashPos;
+    while ((slashPos = dir.lastIndexOf(QLatin1Char('/'))) > 0) {
+      dir.truncate(slashPos);
+      if (pendingDirs.contains(dir))
+        break;
+      pendingDirs.insert(dir);
+    }
+  };
+  auto finishPending = [&]() {
+    threadPool.waitForDone();
+    for (int idx : std::as_const(pendingActions)) {
+      if (errorMsg) {
+        errorMsg->append(fileErrors.at(idx));
+      }
+    }
+    pendingActions.clear();
+    pendingPaths.clear();
+    pendingDirs.clear();
+  };
+
+  for (int i = 0; i < m_actions.size(); ++i) {
+    const RenameAction& action = m_actions.at(i);
+    if (action.m_type == RenameAction::RenameFile) {
+      if (pendingPaths.contains(action.m_src) ||
+          pendingPaths.contains(action.m_dest)) {
+        finishPending();
+      }
+      if (TaggedFile* taggedFile =
+          TaggedFileSystemModel::getTaggedFileOfIndex(action.m_index)) {
+        // The file must be closed before renaming on Windows.
+        taggedFile->closeFileHandle();
+      }
+      pendingActions.append(i);
+      addPendingPath(action.m_src);
+      addPendingPath(action.m_dest);
+      threadPool.start(new FileMover(action.m_src, action.m_dest, i,
+                                     journalPtr, &fileErrors[i]));
+      continue;
+    }
+
+    if (!pendingActions.isEmpty()) {
+      for (const QString& path : {action.m_src, action.m_dest}) {
+        if (!path.isEmpty() &&
+            (pendingPaths.contains(path) || pendingDirs.contains(path))) {
+          finishPending();
+          break;
+        }
+      }
+    }
+    bool ok = false;
+    switch (action.m_type) {
       case RenameAction::CreateDirectory:
-        createDirectory(it->m_dest, it->m_index, errorMsg);
+        ok = createDirectory(action.m_dest, action.m_index, errorMsg);
         break;
       case RenameAction::RenameDirectory:
-        if (renameDirectory(it->m_src, it->m_dest, it->m_index,
+        if (renameDirectory(action.m_src, action.m_dest, action.m_index,
                             errorMsg)) {
-          if (it->m_src == m_dirName) {
-            m_dirName = it->m_dest;
+          ok = true;
+          if (action.m_src == m_dirName) {
+            m_dirName = action.m_dest;
           }
         }
         break;
-      case RenameAction::RenameFile:
-        renameFile(it->m_src, it->m_dest, it->m_index, errorMsg);
+      case RenameAction::RemoveDirectory:
+        ok = removeDirectory(action.m_dest, errorMsg);
         break;
       case RenameAction::ReportError:
       default:
+        ok = true;
         if (errorMsg) {
-          *errorMsg += it->m_dest;
+          *errorMsg += action.m_dest;
         }
     }
+    if (ok && journalPtr) {
+      journalPtr->markDone(i);
+    }
   }
+  finishPending();
+  journal.remove();
+}
+
+/**
+ * Schedule actions from the journal of an unfinished renaming.
+ * The actions can then be performed using performActions().
+ *
+ * @param rollBack false to schedule the actions which have not been
+ *                 completed, true to schedule actions reverting the
+ *                 completed actions
+ *
+ * @return true if a journal was found.
+ */
+bool DirRenamer::scheduleJournalActions(bool rollBack)
+{
+  // Use the most recent journal which is not locked by a running process.
+  QString path;
+  const QFileInfoList journalInfos = QDir(journalDirectory()).entryInfoList(
+        {QLatin1String("renamejournal-*.jsonl")}, QDir::Files, QDir::Time);
+  for (const QFileInfo& journalInfo : journalInfos) {
+    if (QLockFile lockFile(journalInfo.filePath() + QLatin1String(".lock"));
+        lockFile.tryLock(0)) {
+      path = journalInfo.filePath();
+      break;
+    }
+  }
+  QFile file(path);
+  if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  RenameActionList journalActions;
+  QSet<int> doneActions;
+  while (!file.atEnd()) {
+    const QJsonArray record = QJsonDocument::fromJson(file.readLine()).array();
+    if (const QString kind = record.at(0).toString();
+        kind == QLatin1String("action") && record.size() == 4) {
+      int type = record.at(1).toInt();
+      journalActions.append(RenameAction(
+        type >= 0 && type < RenameAction::NumTypes
+          ? static_cast<RenameAction::Type>(type) : RenameAction::ReportError,
+        record.at(2).toString(), record.at(3).toString(),
+        QPersistentModelIndex()));
+    } else if (kind == QLatin1String("done") && record.size() == 2) {
+      doneActions.insert(record.at(1).toInt());
+    }
+  }
+  file.close();
+
+  clearActions();
+  auto scheduleAction = [this](RenameAction::Type type,
+                               const QString& src, const QString& dest) {
+    RenameAction action(type, src, dest, QPersistentModelIndex());
+    m_actions.append(action);
+    emit actionScheduled(describeAction(action));
+  };
+  for (const RenameAction& action : std::as_const(journalActions)) {
+    if (action.m_type == RenameAction::RenameFile) {
+      // Remove partial copy of interrupted move across file systems.
+      QFile::remove(action.m_dest + QLatin1String(".kid3part"));
+    }
+  }
+  if (!rollBack) {
+    for (int i = 0; i < journalActions.size(); ++i) {
+      const RenameAction& action = journalActions.at(i);
+      if (doneActions.contains(i) ||
+          action.m_type == RenameAction::ReportError ||
+          (action.m_type == RenameAction::RenameDirectory &&
+           !QFileInfo::exists(action.m_src) &&
+           QFileInfo(action.m_dest).isDir())) {
+        continue;
+      }
+      scheduleAction(action.m_type, action.m_src, action.m_dest);
+    }
+  } else {
+    for (int i = journalActions.size() - 1; i >= 0; --i) {
+      // Renames are reverted if they have been performed, even if this was
+      // not recorded before the interruption.
+      const RenameAction& action = journalActions.at(i);
+      bool renamed = !QFileInfo::exists(action.m_src) &&
+          QFileInfo::exists(action.m_dest);
+      switch (action.m_type) {
+        case RenameAction::RenameFile:
+        case RenameAction::RenameDirectory:
+          if (renamed) {
+            scheduleAction(action.m_type, action.m_dest, action.m_src);
+          }
+          break;
+        case RenameAction::CreateDirectory:
+          if (doneActions.contains(i)) {
+            scheduleAction(RenameAction::RemoveDirectory, QString(),
+                           action.m_dest);
+          }
+          break;
+        case RenameAction::RemoveDirectory:
+          if (doneActions.contains(i)) {
+            scheduleAction(RenameAction::CreateDirectory, QString(),
+                           action.m_dest);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  if (m_actions.isEmpty()) {
+    QFile::remove(path);
+  } else {
+    m_recoveredJournalPath = path;
+  }
+  return true;
+}
+
+/**
+ * Get a new path for a journal file of this process.
+ * The name contains the process ID, the time and a sequence number, so that
+ * a process which has the same ID as an interrupted process does not use
+ * the journal of the interrupted process.
+ * @return path of journal.
+ */
+QString DirRenamer::journalPath()
+{
+  static QAtomicInt sequenceNumber;
+  return journalDirectory() + QLatin1String("/renamejournal-") +
+      QString::number(QCoreApplication::applicationPid()) + QLatin1Char('-') +
+      QString::number(QDateTime::currentMSecsSinceEpoch()) + QLatin1Char('-') +
+      QString::number(sequenceNumber.fetchAndAddRelaxed(1)) +
+      QLatin1String(".jsonl");
 }
 
 /**
@@ -686,6 +1089,7 @@ QStringList DirRenamer::describeAction(const RenameAction& action) const
     QT_TRANSLATE_NOOP("@default", "Create folder"),
     QT_TRANSLATE_NOOP("@default", "Rename folder"),
     QT_TRANSLATE_NOOP("@default", "Rename file"),
+    QT_TRANSLATE_NOOP("@default", "Remove folder"),
     QT_TRANSLATE_NOOP("@default", "Error")
   };
   static constexpr unsigned numTypeStr = std::size(typeStr);
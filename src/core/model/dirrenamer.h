@@ -124,6 +124,18 @@ public:
    */
   void performActions(QString* errorMsg);
 
+  /**
+   * Schedule actions from the journal of an unfinished renaming.
+   * The actions can then be performed using performActions().
+   *
+   * @param rollBack false to schedule the actions which have not been
+   *                 completed, true to schedule actions reverting the
+   *                 completed actions
+   *
+   * @return true if a journal was found.
+   */
+  bool scheduleJournalActions(bool rollBack);
+
   /**
    * Set directory name.
    * This should be done before calling performActions(), so that the directory
@@ -160,6 +172,8 @@ signals:
   void actionScheduled(const QStringList& actionStrs);
 
 private:
+  friend class TestDirRenamer;
+
   /**
    * An action performed while renaming a directory.
    */
@@ -170,6 +184,7 @@ private:
       CreateDirectory,
       RenameDirectory,
       RenameFile,
+      RemoveDirectory,
       ReportError,
       NumTypes
     };
@@ -208,6 +223,8 @@ private:
   /** List of rename actions. */
   typedef QList<RenameAction> RenameActionList;
 
+  class FileMover;
+
   /**
    * Create a directory if it does not exist.
    *
@@ -238,17 +255,35 @@ private:
 
   /**
    * Rename a file.
+   * Can be called from any thread, the file handle of the tagged file must
+   * be closed before.
    *
    * @param oldfn    old file name
    * @param newfn    new file name
    * @param errorMsg if not NULL and an error occurred, a message is
    *                 appended here, otherwise it is not touched
-   * @param index    model index of item to rename
    *
    * @return true if rename successful or newfn already exists.
    */
-  bool renameFile(const QString& oldfn, const QString& newfn,
-                  const QPersistentModelIndex& index, QString* errorMsg) const;
+  static bool renameFile(const QString& oldfn, const QString& newfn,
+                         QString* errorMsg);
+
+  /**
+   * Remove a directory if it is empty.
+   *
+   * @param dir      directory path
+   * @param errorMsg if not NULL and an error occurred, a message is
+   *                 appended here, otherwise it is not touched
+   *
+   * @return true if directory does not exist or was removed.
+   */
+  bool removeDirectory(const QString& dir, QString* errorMsg) const;
+
+  /**
+   * Get a new path for a journal file of this process.
+   * @return path of journal.
+   */
+  static QString journalPath();
 
   /**
    * Add a rename action.
@@ -303,6 +338,8 @@ private:
   Frame::TagVersion m_tagVersion;
   QString m_format;
   QString m_dirName;
+  /** Journal loaded by scheduleJournalActions(), removed when performed */
+  QString m_recoveredJournalPath;
   bool m_aborted;
   bool m_actionCreate;
 };
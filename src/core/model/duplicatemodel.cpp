@@ -0,0 +1,602 @@
+/**
+ * \file duplicatemodel.cpp
+ * Groups of files which are probably duplicates of the same track.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "duplicatemodel.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QHash>
+#include <QVariantMap>
+#include <QtAlgorithms>
+#include <algorithm>
+#include "taggedfile.h"
+#include "trackdata.h"
+#include "modeliterator.h"
+#include "fileproxymodel.h"
+#include "fingerprintcache.h"
+#include "performancetracer.h"
+#include "threadpooljobs.h"
+
+namespace {
+
+/** Number of files read before their words are extracted. */
+constexpr int FILES_PER_BATCH = 1024;
+
+/** Maximum ratio of different bits in fingerprints of the same recording. */
+constexpr double MAX_FINGERPRINT_BIT_ERROR_RATE = 0.3;
+
+/** Maximum shift of fingerprints compared, an item is about 0.12 s. */
+constexpr int MAX_FINGERPRINT_OFFSET = 16;
+
+/** Minimum number of fingerprint items which have to overlap. */
+constexpr int MIN_FINGERPRINT_OVERLAP = 32;
+
+/** Artist and title of a file which has been read. */
+struct ScannedFile {
+  QString filePath;
+  QString artist;
+  QString title;
+  quint32 duration;
+  /** Sorted words of artist, unit separator, words of title, empty if
+      there is no title */
+  QString key;
+};
+
+/**
+ * Job extracting the words of a range of files.
+ */
+class DuplicateKeyGenerator : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param files scanned files
+   * @param begin index of first file to process
+   * @param end index after last file to process
+   */
+  DuplicateKeyGenerator(ScannedFile* files, int begin, int end)
+    : m_files(files), m_begin(begin), m_end(end) {
+  }
+
+  /**
+   * Extract the words.
+   */
+  void run() override {
+    for (int i = m_begin; i < m_end; ++i) {
+      ScannedFile& file = m_files[i];
+      // The order of the artist words is ignored to match e.g.
+      // "Beatles, The", the title words keep their order.
+      if (const QString titleWords =
+            WordIdMap::words(file.title).join(QLatin1Char(' '));
+          !titleWords.isEmpty()) {
+        file.key = sortedWords(file.artist);
+        file.key += QChar(0x1f);
+        file.key += titleWords;
+      }
+    }
+  }
+
+private:
+  /**
+   * Get words of a string without duplicates.
+   * The words are not mapped to IDs, so that the jobs do not have to share
+   * a word table.
+   * @param str string
+   * @return case folded words without diacritics in ascending order,
+   * separated by spaces.
+   */
+  static QString sortedWords(const QString& str) {
+    QStringList words = WordIdMap::words(str);
+    words.sort();
+    words.removeDuplicates();
+    return words.join(QLatin1Char(' '));
+  }
+
+  ScannedFile* m_files;
+  int m_begin;
+  int m_end;
+};
+
+/**
+ * Decode a compressed Chromaprint fingerprint.
+ * @param fingerprint base64 encoded fingerprint as stored in the
+ * FingerprintCache
+ * @return fingerprint items, empty if @a fingerprint is invalid.
+ */
+QVector<quint32> decodeFingerprint(const QString& fingerprint)
+{
+  const QByteArray data = QByteArray::fromBase64(
+        fingerprint.toLatin1(),
+        QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+  if (data.size() < 4)
+    return {};
+
+  // The first byte is the algorithm, followed by the number of items.
+  const int numItems = (static_cast<quint8>(data.at(1)) << 16) |
+      (static_cast<quint8>(data.at(2)) << 8) | static_cast<quint8>(data.at(3));
+  const auto bytes = reinterpret_cast<const quint8*>(data.constData()) + 4;
+  const qint64 numBits = static_cast<qint64>(data.size() - 4) * 8;
+  qint64 bitPos = 0;
+  auto readBits = [bytes, numBits, &bitPos](int count) {
+    if (bitPos + count > numBits)
+      return -1;
+
+    int value = 0;
+    for (int i = 0; i < count; ++i, ++bitPos) {
+      value |= ((bytes[bitPos >> 3] >> (bitPos & 7)) & 1) << i;
+    }
+    return value;
+  };
+
+  // Each item is XORed with its predecessor, the positions of the set bits
+  // are stored as differences in 3 bit values terminated by 0. A value of 7
+  // is continued by a 5 bit value stored after all 3 bit values.
+  QVector<int> values;
+  for (int numTerminated = 0; numTerminated < numItems;) {
+    const int value = readBits(3);
+    if (value < 0)
+      return {};
+
+    values.append(value);
+    if (value == 0) {
+      ++numTerminated;
+    }
+  }
+  bitPos = (bitPos + 7) & ~7;
+
+  QVector<quint32> items;
+  items.reserve(numItems);
+  quint32 item = 0;
+  quint32 changedBits = 0;
+  int bit = 0;
+  for (int value : std::as_const(values)) {
+    if (value == 0) {
+      item ^= changedBits;
+      items.append(item);
+      changedBits = 0;
+      bit = 0;
+    } else {
+      if (value == 7) {
+        const int extraValue = readBits(5);
+        if (extraValue < 0)
+          return {};
+
+        value += extraValue;
+      }
+      bit += value;
+      if (bit > 32)
+        return {};
+
+      changedBits |= 1U << (bit - 1);
+    }
+  }
+  return items;
+}
+
+/**
+ * Check if two fingerprints are from the same recording.
+ * The fingerprints are compared with small shifts, so that different
+ * silence at the start of the files does not matter.
+ * @param lhs fingerprint items
+ * @param rhs fingerprint items
+ * @return true if the bit error rate is small enough for some shift.
+ */
+bool isSameRecording(const QVector<quint32>& lhs, const QVector<quint32>& rhs)
+{
+  for (int offset = -MAX_FINGERPRINT_OFFSET; offset <= MAX_FINGERPRINT_OFFSET;
+       ++offset) {
+    const int lhsBegin = qMax(offset, 0);
+    const int rhsBegin = qMax(-offset, 0);
+    const int overlap = qMin(lhs.size() - lhsBegin, rhs.size() - rhsBegin);
+    if (overlap < MIN_FINGERPRINT_OVERLAP)
+      continue;
+
+    const int maxErrors = static_cast<int>(
+          overlap * 32 * MAX_FINGERPRINT_BIT_ERROR_RATE);
+    int errors = 0;
+    for (int i = 0; i < overlap && errors <= maxErrors; ++i) {
+      errors += qPopulationCount(lhs.at(lhsBegin + i) ^ rhs.at(rhsBegin + i));
+    }
+    if (errors <= maxErrors)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Assign the files of a group to subgroups using their cached audio
+ * fingerprints.
+ * Files with fingerprints of the same recording are in the same subgroup.
+ * Files without an up to date fingerprint cannot be checked and are put
+ * into the first subgroup.
+ * @param filePaths paths of files
+ * @return subgroup index for every file.
+ */
+QVector<int> fingerprintSubgroups(const QStringList& filePaths)
+{
+  FingerprintCache& cache = FingerprintCache::instance();
+  const int numFiles = static_cast<int>(filePaths.size());
+  QVector<int> subgroups(numFiles, 0);
+  QVector<QVector<quint32>> fingerprints(numFiles);
+  int numFingerprints = 0;
+  for (int i = 0; i < numFiles; ++i) {
+    QString fingerprint;
+    if (int duration;
+        cache.find(filePaths.at(i), fingerprint, duration)) {
+      fingerprints[i] = decodeFingerprint(fingerprint);
+      if (!fingerprints.at(i).isEmpty()) {
+        ++numFingerprints;
+      }
+    }
+  }
+  if (numFingerprints < 2)
+    return subgroups;
+
+  // Index of a file with fingerprint for every subgroup
+  QVector<int> firstFiles;
+  for (int i = 0; i < numFiles; ++i) {
+    if (fingerprints.at(i).isEmpty())
+      continue;
+
+    int subgroup = 0;
+    while (subgroup < firstFiles.size() &&
+           !isSameRecording(fingerprints.at(i),
+                            fingerprints.at(firstFiles.at(subgroup)))) {
+      ++subgroup;
+    }
+    if (subgroup == firstFiles.size()) {
+      firstFiles.append(i);
+    }
+    subgroups[i] = subgroup;
+  }
+  return subgroups;
+}
+
+}
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+DuplicateModel::DuplicateModel(QObject* parent)
+  : QAbstractTableModel(parent)
+{
+  setObjectName(QLatin1String("DuplicateModel"));
+}
+
+/**
+ * Get item flags for index.
+ * @param index model index
+ * @return item flags
+ */
+Qt::ItemFlags DuplicateModel::flags(const QModelIndex& index) const
+{
+  if (index.isValid())
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+  return QAbstractTableModel::flags(index);
+}
+
+/**
+ * Get data for a given role.
+ * @param index model index
+ * @param role item data role
+ * @return data for role
+ */
+QVariant DuplicateModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid() ||
+      index.row() < 0 || index.row() >= m_entries.size() ||
+      index.column() < 0 || index.column() >= CI_NumColumns)
+    return QVariant();
+  const Entry& entry = m_entries.at(index.row());
+  if (role == Qt::DisplayRole || role == Qt::EditRole) {
+    const Group& group = m_groups.at(entry.group);
+    switch (index.column()) {
+    case CI_Group:
+      return entry.group + 1;
+    case CI_Artist:
+      return group.artist;
+    case CI_Title:
+      return group.title;
+    case CI_Duration:
+      return entry.duration != 0
+          ? TaggedFile::formatTime(entry.duration) : QString();
+    case CI_FilePath:
+      return entry.filePath;
+    default:
+      break;
+    }
+  }
+  return QVariant();
+}
+
+/**
+ * Get data for header section.
+ * @param section column or row
+ * @param orientation horizontal or vertical
+ * @param role item data role
+ * @return header data for role
+ */
+QVariant DuplicateModel::headerData(
+    int section, Qt::Orientation orientation, int role) const
+{
+  if (role != Qt::DisplayRole)
+    return QVariant();
+  if (orientation == Qt::Horizontal) {
+    switch (section) {
+    case CI_Group:
+      return tr("Group");
+    case CI_Artist:
+      return tr("Artist");
+    case CI_Title:
+      return tr("Title");
+    case CI_Duration:
+      return tr("Duration");
+    case CI_FilePath:
+      return tr("File");
+    default:
+      return section + 1;
+    }
+  }
+  return section + 1;
+}
+
+/**
+ * Get number of rows.
+ * @param parent parent model index, invalid for table models
+ * @return number of rows,
+ * if parent is valid number of children (0 for table models)
+ */
+int DuplicateModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : static_cast<int>(m_entries.size());
+}
+
+/**
+ * Get number of columns.
+ * @param parent parent model index, invalid for table models
+ * @return number of columns,
+ * if parent is valid number of children (0 for table models)
+ */
+int DuplicateModel::columnCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : CI_NumColumns;
+}
+
+/**
+ * Find groups of files with the same artist and title and similar
+ * durations.
+ * Files without title are ignored.
+ * @param it iterator over the files to check
+ * @param maxDurationDifference maximum difference of the durations in
+ * seconds of files in a group, files with unknown duration are added to
+ * the first group
+ * @return number of groups found.
+ */
+int DuplicateModel::findDuplicates(AbstractTaggedFileIterator& it,
+                                   int maxDurationDifference)
+{
+  TraceSpan span("DuplicateModel::findDuplicates");
+
+  // Files with the same artist and title words are in the same bucket,
+  // the files of a bucket are linked using their next index.
+  struct BucketFile {
+    QString filePath;
+    quint32 duration;
+    int next;
+  };
+  struct Bucket {
+    QString artist;
+    QString title;
+    int head;
+    int size;
+  };
+  QHash<QString, int> bucketOfKey;
+  QVector<Bucket> buckets;
+  QVector<BucketFile> bucketFiles;
+
+  auto addToBuckets = [&](QVector<ScannedFile>& files) {
+    for (ScannedFile& file : files) {
+      if (file.key.isEmpty())
+        continue;
+
+      int bucketIdx;
+      if (auto bucketIt = bucketOfKey.constFind(file.key);
+          bucketIt != bucketOfKey.constEnd()) {
+        bucketIdx = *bucketIt;
+      } else {
+        bucketIdx = static_cast<int>(buckets.size());
+        bucketOfKey.insert(file.key, bucketIdx);
+        buckets.append({file.artist, file.title, -1, 0});
+      }
+      Bucket& bucket = buckets[bucketIdx];
+      bucketFiles.append({file.filePath, file.duration, bucket.head});
+      bucket.head = static_cast<int>(bucketFiles.size()) - 1;
+      ++bucket.size;
+    }
+    files.clear();
+  };
+
+  // The words of a batch are extracted by the jobs while the next batch
+  // is read.
+  QThreadPool threadPool;
+  QVector<ScannedFile> readFiles;
+  QVector<ScannedFile> extractingFiles;
+  auto startExtracting = [&]() {
+    threadPool.waitForDone();
+    addToBuckets(extractingFiles);
+    extractingFiles.swap(readFiles);
+    const int numFiles = static_cast<int>(extractingFiles.size());
+    if (numFiles == 0)
+      return;
+
+    Utils::startJobs(threadPool, numFiles, [&](int begin, int end) {
+      return new DuplicateKeyGenerator(extractingFiles.data(), begin, end);
+    });
+  };
+
+  readFiles.reserve(FILES_PER_BATCH);
+  while (it.hasNext()) {
+    TaggedFile* taggedFile = it.next();
+    const bool tagsWereRead = taggedFile->isTagInformationRead();
+    taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+    ScannedFile file;
+    for (Frame::TagNumber tagNr : {Frame::Tag_2, Frame::Tag_3, Frame::Tag_1}) {
+      Frame frame;
+      if (file.title.isEmpty() &&
+          taggedFile->getFrame(tagNr, Frame::FT_Title, frame)) {
+        file.title = frame.getValue();
+      }
+      if (file.artist.isEmpty() &&
+          taggedFile->getFrame(tagNr, Frame::FT_Artist, frame)) {
+        file.artist = frame.getValue();
+      }
+    }
+    TaggedFile::DetailInfo info;
+    taggedFile->getDetailInfo(info);
+    file.duration = info.duration;
+    file.filePath = taggedFile->getAbsFilename();
+    // Only keep the tags in memory which were there before.
+    if (!tagsWereRead && !taggedFile->isChanged()) {
+      taggedFile->clearTags(false);
+      taggedFile->closeFileHandle();
+    }
+    if (!file.title.isEmpty()) {
+      readFiles.append(file);
+      if (readFiles.size() >= FILES_PER_BATCH) {
+        startExtracting();
+      }
+    }
+  }
+  startExtracting();
+  startExtracting();
+
+  // Split the buckets into groups of files with similar durations.
+  beginResetModel();
+  m_entries.clear();
+  m_groups.clear();
+  QVector<int> fileIdxs;
+  for (const Bucket& bucket : std::as_const(buckets)) {
+    if (bucket.size < 2)
+      continue;
+
+    fileIdxs.clear();
+    for (int idx = bucket.head; idx != -1; idx = bucketFiles.at(idx).next) {
+      fileIdxs.append(idx);
+    }
+    // The files are linked in reverse order, files with unknown duration
+    // are sorted first.
+    std::reverse(fileIdxs.begin(), fileIdxs.end());
+    std::stable_sort(fileIdxs.begin(), fileIdxs.end(),
+                     [&bucketFiles](int lhs, int rhs) {
+      return bucketFiles.at(lhs).duration < bucketFiles.at(rhs).duration;
+    });
+    int groupBegin = 0;
+    while (groupBegin < fileIdxs.size()) {
+      int groupEnd = groupBegin;
+      while (groupEnd < fileIdxs.size() &&
+             bucketFiles.at(fileIdxs.at(groupEnd)).duration == 0) {
+        ++groupEnd;
+      }
+      if (groupEnd < fileIdxs.size()) {
+        const quint32 firstDuration =
+            bucketFiles.at(fileIdxs.at(groupEnd)).duration;
+        while (groupEnd < fileIdxs.size() &&
+               bucketFiles.at(fileIdxs.at(groupEnd)).duration - firstDuration <=
+               static_cast<quint32>(maxDurationDifference)) {
+          ++groupEnd;
+        }
+      }
+      if (groupEnd - groupBegin >= 2) {
+        // Split the group if cached fingerprints show different recordings.
+        QStringList filePaths;
+        for (int i = groupBegin; i < groupEnd; ++i) {
+          filePaths.append(bucketFiles.at(fileIdxs.at(i)).filePath);
+        }
+        const QVector<int> subgroups = fingerprintSubgroups(filePaths);
+        const int numSubgroups =
+            *std::max_element(subgroups.constBegin(), subgroups.constEnd()) + 1;
+        for (int subgroup = 0; subgroup < numSubgroups; ++subgroup) {
+          const int numRows = static_cast<int>(
+                std::count(subgroups.constBegin(), subgroups.constEnd(),
+                           subgroup));
+          if (numRows < 2)
+            continue;
+
+          const int groupIdx = static_cast<int>(m_groups.size());
+          m_groups.append({bucket.artist, bucket.title,
+                           static_cast<int>(m_entries.size()), numRows});
+          for (int i = groupBegin; i < groupEnd; ++i) {
+            if (subgroups.at(i - groupBegin) == subgroup) {
+              const BucketFile& bucketFile = bucketFiles.at(fileIdxs.at(i));
+              m_entries.append({groupIdx, bucketFile.duration,
+                                bucketFile.filePath});
+            }
+          }
+        }
+      }
+      groupBegin = groupEnd;
+    }
+  }
+  endResetModel();
+  return static_cast<int>(m_groups.size());
+}
+
+/**
+ * Get the groups.
+ * @return list of maps with "artist", "title" and "files", which is a list
+ * of maps with "filePath" and "duration".
+ */
+QVariantList DuplicateModel::groups() const
+{
+  QVariantList result;
+  for (const Group& group : m_groups) {
+    QVariantList files;
+    for (int row = group.firstRow; row < group.firstRow + group.numRows;
+         ++row) {
+      const Entry& entry = m_entries.at(row);
+      files.append(QVariantMap{
+        {QLatin1String("filePath"), entry.filePath},
+        {QLatin1String("duration"), entry.duration}
+      });
+    }
+    result.append(QVariantMap{
+      {QLatin1String("artist"), group.artist},
+      {QLatin1String("title"), group.title},
+      {QLatin1String("files"), files}
+    });
+  }
+  return result;
+}
+
+/**
+ * Remove all entries.
+ */
+void DuplicateModel::clear()
+{
+  beginResetModel();
+  m_entries.clear();
+  m_groups.clear();
+  endResetModel();
+}
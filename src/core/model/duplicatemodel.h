@@ -0,0 +1,171 @@
+/**
+ * \file duplicatemodel.h
+ * Groups of files which are probably duplicates of the same track.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QVariantList>
+#include "kid3api.h"
+
+class AbstractTaggedFileIterator;
+
+/**
+ * Groups of files which are probably duplicates of the same track.
+ *
+ * The files are read one after the other, only their path, duration and
+ * a bucket for their artist and title are kept, tags which were not in
+ * memory before are freed again. Artist and title are compared as lists
+ * of case folded words without diacritics and punctuation, the words are
+ * extracted on worker threads while the next files are read. The order of
+ * the title words matters, the order of the artist words does not. Files
+ * in the same bucket are split into groups if their durations differ by
+ * more than a tolerance. If the FingerprintCache has up to date
+ * fingerprints for files of a group, files with fingerprints of different
+ * recordings are put into different groups.
+ *
+ * Embedded pictures are not compared, because reading and hashing them
+ * would make checking large collections much slower, and copies of a
+ * track often differ in their cover art.
+ *
+ * The model has a row for every file in a group, the rows of a group
+ * are adjacent.
+ */
+class KID3_CORE_EXPORT DuplicateModel : public QAbstractTableModel {
+  Q_OBJECT
+public:
+  /** Column indexes. */
+  enum ColumnIndex {
+    CI_Group,     /**< Number of group */
+    CI_Artist,    /**< Artist of group */
+    CI_Title,     /**< Title of group */
+    CI_Duration,  /**< Duration of file */
+    CI_FilePath,  /**< Path of file */
+    CI_NumColumns /**< Number of columns */
+  };
+
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit DuplicateModel(QObject* parent = nullptr);
+
+  /**
+   * Destructor.
+   */
+  ~DuplicateModel() override = default;
+
+  /**
+   * Get item flags for index.
+   * @param index model index
+   * @return item flags
+   */
+  Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+  /**
+   * Get data for a given role.
+   * @param index model index
+   * @param role item data role
+   * @return data for role
+   */
+  QVariant data(const QModelIndex& index,
+                int role = Qt::DisplayRole) const override;
+
+  /**
+   * Get data for header section.
+   * @param section column or row
+   * @param orientation horizontal or vertical
+   * @param role item data role
+   * @return header data for role
+   */
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+  /**
+   * Get number of rows.
+   * @param parent parent model index, invalid for table models
+   * @return number of rows,
+   * if parent is valid number of children (0 for table models)
+   */
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+  /**
+   * Get number of columns.
+   * @param parent parent model index, invalid for table models
+   * @return number of columns,
+   * if parent is valid number of children (0 for table models)
+   */
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+  /**
+   * Find groups of files with the same artist and title and similar
+   * durations.
+   * Files without title are ignored.
+   * @param it iterator over the files to check
+   * @param maxDurationDifference maximum difference of the durations in
+   * seconds of files in a group, files with unknown duration are added to
+   * the first group
+   * @return number of groups found.
+   */
+  int findDuplicates(AbstractTaggedFileIterator& it, int maxDurationDifference);
+
+  /**
+   * Get number of groups.
+   * @return number of groups.
+   */
+  int groupCount() const { return static_cast<int>(m_groups.size()); }
+
+  /**
+   * Get the groups.
+   * @return list of maps with "artist", "title" and "files", which is a list
+   * of maps with "filePath" and "duration".
+   */
+  QVariantList groups() const;
+
+  /**
+   * Remove all entries.
+   */
+  void clear();
+
+private:
+  /** File in a group. */
+  struct Entry {
+    int group;         /**< index of group */
+    quint32 duration;  /**< duration in seconds, 0 if unknown */
+    QString filePath;  /**< absolute path of file */
+  };
+
+  /** Group of duplicate files. */
+  struct Group {
+    QString artist;    /**< artist of first file */
+    QString title;     /**< title of first file */
+    int firstRow;      /**< row of first file */
+    int numRows;       /**< number of files */
+  };
+
+  QVector<Entry> m_entries;
+  QVector<Group> m_groups;
+};
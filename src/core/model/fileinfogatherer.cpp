@@ -56,10 +56,14 @@
 #  include <unistd.h>
 #  include <sys/types.h>
 #endif
+#ifdef Q_OS_LINUX
+#  include <sys/vfs.h>
+#endif
 #if defined(Q_OS_VXWORKS)
 #  include "qplatformdefs.h"
 #endif
 #include "abstractfiledecorationprovider.h"
+#include "performancetracer.h"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -128,6 +132,15 @@ bool qt_test_isFetchedRoot()
 }
 #endif
 
+/** Time to wait for more changes before a changed directory is rescanned. */
+static const int rescanDelayMs = 250;
+/** Interval for polling directories which cannot be watched. */
+static const int pollIntervalMs = 5000;
+/** Every this many polls, the entries of polled directories are checked. */
+static const int fullRescanPolls = 12;
+/** Maximum number of polled directories in addition to the root. */
+static const int maxPolledPaths = 8;
+
 static QString translateDriveName(const QFileInfo &drive)
 {
     QString driveName = drive.absoluteFilePath();
@@ -146,7 +159,7 @@ static QString translateDriveName(const QFileInfo &drive)
 FileInfoGatherer::FileInfoGatherer(QObject *parent)
     : QThread(parent), holdOffOnUpdates(false), abort(false),
 #ifndef QT_NO_FILESYSTEMWATCHER
-      watcher(nullptr),
+      watcher(nullptr), pollCount(0),
 #endif
 #ifdef Q_OS_WIN
       m_resolveSymlinks(true),
@@ -155,8 +168,13 @@ FileInfoGatherer::FileInfoGatherer(QObject *parent)
 {
 #ifndef QT_NO_FILESYSTEMWATCHER
     watcher = new QFileSystemWatcher(this);
-    connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(list(QString)));
+    connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(scheduleRescan(QString)));
     connect(watcher, SIGNAL(fileChanged(QString)), this, SLOT(updateFile(QString)));
+    rescanTimer.setSingleShot(true);
+    rescanTimer.setInterval(rescanDelayMs);
+    connect(&rescanTimer, SIGNAL(timeout()), this, SLOT(processPendingRescans()));
+    pollTimer.setInterval(pollIntervalMs);
+    connect(&pollTimer, SIGNAL(timeout()), this, SLOT(poll()));
 
 #  if defined(Q_OS_WIN) && !defined(Q_OS_WINRT)
     const QVariant listener = watcher->property("_q_driveListener");
@@ -247,14 +265,165 @@ void FileInfoGatherer::fetchExtendedInformation(const QString &path, const QStri
     this->path.push(path);
     this->files.push(files);
     condition.wakeAll();
+    const bool rescan = rescanPaths.contains(path);
+    locker.unlock();
 
 #ifndef QT_NO_FILESYSTEMWATCHER
     if (files.isEmpty()
+        && !rescan
         && !path.isEmpty()
         && !path.startsWith(QLatin1String("//")) /*don't watch UNC path*/) {
-        if (!watcher->directories().contains(path))
-            watcher->addPath(path);
+        watchDirectory(path);
+    }
+#else
+    Q_UNUSED(rescan)
+#endif
+}
+
+#ifndef QT_NO_FILESYSTEMWATCHER
+/*
+    Watch directory \a path, poll it if it is on a network file system
+    or the watcher cannot add it, e.g. because the inotify limit is reached.
+    Only the root and the most recently listed directories are polled.
+    Must be called without mutex locked.
+*/
+void FileInfoGatherer::watchDirectory(const QString &path)
+{
+    if (watchedPaths.contains(path))
+        return;
+    if (int idx = polledPaths.indexOf(path); idx >= 0) {
+        polledPaths.move(idx, polledPaths.size() - 1);
+        return;
+    }
+    if (!isNetworkFileSystem(path) && watcher->addPath(path)) {
+        watchedPaths.insert(path);
+        return;
+    }
+    polledPaths.append(path);
+    const int maxSize = polledPaths.contains(polledRootPath)
+            ? maxPolledPaths + 1 : maxPolledPaths;
+    while (polledPaths.size() > maxSize) {
+        // Drop the least recently listed directory, but not the root.
+        unpollDirectory(polledPaths.at(
+                polledPaths.first() == polledRootPath ? 1 : 0));
+    }
+    if (!pollTimer.isActive())
+        pollTimer.start();
+}
+
+/*
+    Stop polling directory \a path.
+*/
+void FileInfoGatherer::unpollDirectory(const QString &path)
+{
+    polledPaths.removeOne(path);
+    pendingRescans.remove(path);
+    QMutexLocker locker(&mutex);
+    quickRescanPaths.remove(path);
+    directoryStamps.remove(path);
+}
+
+/*
+    Set the root directory \a path of the model, which is polled as long as
+    it is the root even if other directories are listed.
+*/
+void FileInfoGatherer::setRootPath(const QString &path)
+{
+    polledRootPath = path;
+}
+#endif
+
+/*
+    Check if \a path is on a file system where changes made by other hosts
+    are not reported to the watcher.
+*/
+bool FileInfoGatherer::isNetworkFileSystem(const QString &path)
+{
+#ifdef Q_OS_LINUX
+    struct statfs buf;
+    if (::statfs(QFile::encodeName(path).constData(), &buf) == 0) {
+        switch (static_cast<quint32>(buf.f_type)) {
+        case 0x6969:     // NFS
+        case 0x517b:     // SMB
+        case 0xff534d42: // CIFS
+        case 0xfe534d42: // SMB2
+        case 0x73757245: // CODA
+        case 0x5346414f: // AFS
+        case 0x01021997: // 9P
+            return true;
+        default:
+            break;
+        }
+    }
+#else
+    Q_UNUSED(path)
+#endif
+    return false;
+}
+
+/*
+    Rescan changed directory \a path after the changes have settled,
+    so that a burst of changes, e.g. while a file is downloaded, only
+    causes a single rescan.
+*/
+void FileInfoGatherer::scheduleRescan(const QString &path)
+{
+#ifndef QT_NO_FILESYSTEMWATCHER
+    pendingRescans.insert(path);
+    rescanTimer.start();
+#else
+    Q_UNUSED(path)
+#endif
+}
+
+/*
+    Queue rescans for the changed directories.
+    Only the entries which were added, removed or modified since the last
+    listing are reported.
+*/
+void FileInfoGatherer::processPendingRescans()
+{
+#ifndef QT_NO_FILESYSTEMWATCHER
+    const QSet<QString> dirs = pendingRescans;
+    pendingRescans.clear();
+    for (const QString &dir : dirs) {
+        {
+            QMutexLocker locker(&mutex);
+            rescanPaths.insert(dir);
+        }
+        fetchExtendedInformation(dir, QStringList());
+    }
+#endif
+}
+
+/*
+    Rescan the directories which cannot be watched.
+    Usually only the modification time of the directories is checked, which
+    changes when entries are added, removed or renamed. Files which are
+    modified in place are found when all entries are checked every
+    fullRescanPolls polls.
+*/
+void FileInfoGatherer::poll()
+{
+#ifndef QT_NO_FILESYSTEMWATCHER
+    if (polledPaths.isEmpty()) {
+        pollTimer.stop();
+        return;
+    }
+    const bool fullRescan = ++pollCount % fullRescanPolls == 0;
+    {
+        QMutexLocker locker(&mutex);
+        for (const QString &dir : std::as_const(polledPaths)) {
+            if (fullRescan)
+                quickRescanPaths.remove(dir);
+            else
+                quickRescanPaths.insert(dir);
+        }
+    }
+    for (const QString &dir : std::as_const(polledPaths)) {
+        pendingRescans.insert(dir);
     }
+    processPendingRescans();
 #endif
 }
 
@@ -292,10 +461,18 @@ void FileInfoGatherer::clear()
     QMutexLocker locker(&mutex);
     watcher->removePaths(watcher->files());
     watcher->removePaths(watcher->directories());
+    watchedPaths.clear();
+    polledPaths.clear();
+    pendingRescans.clear();
+    pollTimer.stop();
+    quickRescanPaths.clear();
+    directoryStamps.clear();
 #endif
 
     path.clear();
     files.clear();
+    rescanPaths.clear();
+    snapshots.clear();
 }
 
 /*
@@ -319,8 +496,11 @@ void FileInfoGatherer::addPath(const QString &path)
 void FileInfoGatherer::removePath(const QString &path)
 {
 #ifndef QT_NO_FILESYSTEMWATCHER
-    QMutexLocker locker(&mutex);
     watcher->removePath(path);
+    watchedPaths.remove(path);
+    unpollDirectory(path);
+    QMutexLocker locker(&mutex);
+    snapshots.remove(path);
 #else
     Q_UNUSED(path);
 #endif
@@ -333,6 +513,11 @@ void FileInfoGatherer::removePath(const QString &path)
 */
 void FileInfoGatherer::list(const QString &directoryPath)
 {
+    {
+        // An explicit listing shall report all entries, not only the changes.
+        QMutexLocker locker(&mutex);
+        rescanPaths.remove(directoryPath);
+    }
     fetchExtendedInformation(directoryPath, QStringList());
 }
 
@@ -368,9 +553,18 @@ void FileInfoGatherer::run()
         const QStringList thisList = constFiles.front();
 #endif
         files.pop_front();
+        const bool rescan = thisList.isEmpty() && rescanPaths.remove(thisPath);
+#ifndef QT_NO_FILESYSTEMWATCHER
+        const bool quick = rescan && quickRescanPaths.remove(thisPath);
+#else
+        const bool quick = false;
+#endif
         locker.unlock();
 
-        getFileInfos(thisPath, thisList);
+        if (rescan)
+            rescanDirectory(thisPath, quick);
+        else
+            getFileInfos(thisPath, thisList);
     }
 }
 
@@ -418,6 +612,7 @@ ExtendedInformation FileInfoGatherer::getInfo(const QFileInfo &fileInfo) const
  */
 void FileInfoGatherer::getFileInfos(const QString &path, const QStringList &files)
 {
+    TraceSpan span("FileInfoGatherer::getFileInfos", path);
     // List drives
     if (path.isEmpty()) {
 #ifdef QT_BUILD_INTERNAL
@@ -453,6 +648,7 @@ void FileInfoGatherer::getFileInfos(const QString &path, const QStringList &file
 
     QStringList allFiles;
     if (files.isEmpty()) {
+        FileStamps stamps;
         QDirIterator dirIt(path, QDir::AllEntries | QDir::System | QDir::Hidden);
 #if QT_VERSION >= 0x050e00
         while (!abort.loadRelaxed() && dirIt.hasNext())
@@ -463,8 +659,18 @@ void FileInfoGatherer::getFileInfos(const QString &path, const QStringList &file
             dirIt.next();
             fileInfo = dirIt.fileInfo();
             allFiles.append(fileInfo.fileName());
+            stamps.insert(fileInfo.fileName(), fileStamp(fileInfo));
             fetch(fileInfo, base, firstTime, updatedFiles, path);
         }
+#if QT_VERSION >= 0x050e00
+        if (!abort.loadRelaxed())
+#else
+        if (!abort.load())
+#endif
+        {
+            QMutexLocker locker(&mutex);
+            snapshots.insert(path, stamps);
+        }
     }
     if (!allFiles.isEmpty())
         emit newListOfFiles(path, allFiles);
@@ -485,6 +691,104 @@ void FileInfoGatherer::getFileInfos(const QString &path, const QStringList &file
     emit directoryLoaded(path);
 }
 
+/*
+    Report only the entries of \a path which were added, removed or
+    modified since the last listing, so that a change of a single file
+    does not cause the whole directory to be updated.
+    If \a quick is set, the entries are only checked if the modification
+    time of the directory has changed.
+ */
+void FileInfoGatherer::rescanDirectory(const QString &path, bool quick)
+{
+    FileStamps oldStamps;
+#ifndef QT_NO_FILESYSTEMWATCHER
+    FileStamp oldDirStamp = {0, 0};
+    bool hasOldDirStamp = false;
+#endif
+    {
+        QMutexLocker locker(&mutex);
+        auto it = snapshots.constFind(path);
+        if (it == snapshots.constEnd()) {
+            locker.unlock();
+            getFileInfos(path, QStringList());
+            return;
+        }
+        oldStamps = *it;
+#ifndef QT_NO_FILESYSTEMWATCHER
+        if (auto dit = directoryStamps.constFind(path);
+            dit != directoryStamps.constEnd()) {
+            oldDirStamp = *dit;
+            hasOldDirStamp = true;
+        }
+#endif
+    }
+
+#ifndef QT_NO_FILESYSTEMWATCHER
+    // Polled directories are rescanned with quick set, a single stat of the
+    // directory avoids iterating all its entries on a network share.
+    const FileStamp dirStamp = quick || hasOldDirStamp
+            ? fileStamp(QFileInfo(path)) : FileStamp{0, 0};
+    if (quick && hasOldDirStamp && dirStamp == oldDirStamp)
+        return;
+#else
+    Q_UNUSED(quick)
+#endif
+
+    TraceSpan span("FileInfoGatherer::rescanDirectory", path);
+    FileStamps newStamps;
+    newStamps.reserve(oldStamps.size());
+    QVector<QPair<QString, QFileInfo> > updatedFiles;
+    QDirIterator dirIt(path, QDir::AllEntries | QDir::System | QDir::Hidden);
+#if QT_VERSION >= 0x050e00
+    while (!abort.loadRelaxed() && dirIt.hasNext())
+#else
+    while (!abort.load() && dirIt.hasNext())
+#endif
+    {
+        dirIt.next();
+        const QFileInfo fileInfo = dirIt.fileInfo();
+        const QString fileName = fileInfo.fileName();
+        const FileStamp stamp = fileStamp(fileInfo);
+        auto it = oldStamps.constFind(fileName);
+        if (it == oldStamps.constEnd() || *it != stamp)
+            updatedFiles.append(QPair<QString, QFileInfo>(fileName, fileInfo));
+        newStamps.insert(fileName, stamp);
+    }
+#if QT_VERSION >= 0x050e00
+    if (abort.loadRelaxed())
+#else
+    if (abort.load())
+#endif
+        return;
+
+    QStringList removedFiles;
+    for (auto it = oldStamps.constBegin(); it != oldStamps.constEnd(); ++it) {
+        if (!newStamps.contains(it.key()))
+            removedFiles.append(it.key());
+    }
+    {
+        QMutexLocker locker(&mutex);
+        // Do not store the snapshot if the path has been removed meanwhile.
+        if (snapshots.contains(path)) {
+            snapshots.insert(path, newStamps);
+#ifndef QT_NO_FILESYSTEMWATCHER
+            if (quick || hasOldDirStamp)
+                directoryStamps.insert(path, dirStamp);
+#endif
+        }
+    }
+    if (!removedFiles.isEmpty())
+        emit filesRemoved(path, removedFiles);
+    if (!updatedFiles.isEmpty())
+        emit updates(path, updatedFiles);
+    emit directoryLoaded(path);
+}
+
+FileInfoGatherer::FileStamp FileInfoGatherer::fileStamp(const QFileInfo &fileInfo)
+{
+    return {fileInfo.lastModified().toMSecsSinceEpoch(), fileInfo.size()};
+}
+
 void FileInfoGatherer::fetch(const QFileInfo &fileInfo, QElapsedTimer &base, bool &firstTime, QVector<QPair<QString, QFileInfo> > &updatedFiles, const QString &path) {
     updatedFiles.append(QPair<QString, QFileInfo>(fileInfo.fileName(), fileInfo));
     QElapsedTimer current;
@@ -72,6 +72,9 @@
 #include <qdatetime.h>
 #include <qdir.h>
 #include <qelapsedtimer.h>
+#include <qtimer.h>
+#include <qset.h>
+#include <qhash.h>
 
 #ifdef USE_QT_PRIVATE_HEADERS
 #include <private/qfilesystemengine_p.h>
@@ -179,6 +182,7 @@ Q_OBJECT
 Q_SIGNALS:
     void updates(const QString &directory, const QVector<QPair<QString, QFileInfo> > &updates);
     void newListOfFiles(const QString &directory, const QStringList &listOfFiles) const;
+    void filesRemoved(const QString &directory, const QStringList &fileNames) const;
     void nameResolved(const QString &fileName, const QString &resolvedName) const;
     void directoryLoaded(const QString &path);
 
@@ -194,6 +198,9 @@ public:
     AbstractFileDecorationProvider *decorationProvider() const;
     bool resolveSymlinks() const;
     bool setHoldOffOnUpdates(bool holdoff);
+#ifndef QT_NO_FILESYSTEMWATCHER
+    void setRootPath(const QString &path);
+#endif
 
 public Q_SLOTS:
     void list(const QString &directoryPath);
@@ -205,12 +212,33 @@ public Q_SLOTS:
 private Q_SLOTS:
     void driveAdded();
     void driveRemoved();
+    void scheduleRescan(const QString &path);
+    void processPendingRescans();
+    void poll();
 
 private:
+    /** Modification time and size of a directory entry. */
+    struct FileStamp {
+        qint64 lastModified;
+        qint64 size;
+        bool operator==(const FileStamp &other) const {
+            return lastModified == other.lastModified && size == other.size;
+        }
+        bool operator!=(const FileStamp &other) const {
+            return !operator==(other);
+        }
+    };
+    typedef QHash<QString, FileStamp> FileStamps;
+
     void run() Q_DECL_OVERRIDE;
     // called by run():
     void getFileInfos(const QString &path, const QStringList &files);
+    void rescanDirectory(const QString &path, bool quick);
     void fetch(const QFileInfo &fileInfo, QElapsedTimer &base, bool &firstTime, QVector<QPair<QString, QFileInfo> > &updatedFiles, const QString &path);
+    static FileStamp fileStamp(const QFileInfo &fileInfo);
+    void watchDirectory(const QString &path);
+    void unpollDirectory(const QString &path);
+    static bool isNetworkFileSystem(const QString &path);
 
 private:
     mutable QMutex mutex;
@@ -219,11 +247,33 @@ private:
     QStack<QString> path;
     QStack<QStringList> files;
     bool holdOffOnUpdates;
+    // directories with a snapshot which only need to report changes
+    QSet<QString> rescanPaths;
+    // snapshots of listed directories
+    QHash<QString, FileStamps> snapshots;
+#ifndef QT_NO_FILESYSTEMWATCHER
+    // polled directories which are only rescanned if their stamp changed
+    QSet<QString> quickRescanPaths;
+    // stamps of polled directories when their entries were checked
+    QHash<QString, FileStamp> directoryStamps;
+#endif
     // end protected by mutex
     QAtomicInt abort;
 
 #ifndef QT_NO_FILESYSTEMWATCHER
     QFileSystemWatcher *watcher;
+    // directories watched by watcher
+    QSet<QString> watchedPaths;
+    // directories which are polled because they cannot be watched,
+    // the most recently listed last
+    QStringList polledPaths;
+    // root directory of the model, which is never dropped from polledPaths
+    QString polledRootPath;
+    // changed directories waiting for rescanTimer
+    QSet<QString> pendingRescans;
+    QTimer rescanTimer;
+    QTimer pollTimer;
+    int pollCount;
 #endif
 #ifdef Q_OS_WIN
     bool m_resolveSymlinks; // not accessed by run()
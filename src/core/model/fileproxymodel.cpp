@@ -29,6 +29,7 @@
 #include <QRegularExpression>
 #include "taggedfilesystemmodel.h"
 #include "itaggedfilefactory.h"
+#include "performancetracer.h"
 #include "config.h"
 
 namespace {
@@ -285,6 +286,10 @@ void FileProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
                  this, &FileProxyModel::onDirectoryLoaded);
       disconnect(m_fsModel, &TaggedFileSystemModel::fileModificationChanged,
                  this, &FileProxyModel::onFileModificationChanged);
+      disconnect(m_fsModel, &TaggedFileSystemModel::modificationCountChanged,
+                 this, &FileProxyModel::onModificationCountChanged);
+      disconnect(m_fsModel, &TaggedFileSystemModel::taggedFileAboutToBeDeleted,
+                 this, &FileProxyModel::taggedFileAboutToBeDeleted);
     }
     m_fsModel = fsModel;
     if (m_fsModel) {
@@ -294,6 +299,10 @@ void FileProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
               this, &FileProxyModel::onDirectoryLoaded);
       connect(m_fsModel, &TaggedFileSystemModel::fileModificationChanged,
               this, &FileProxyModel::onFileModificationChanged);
+      connect(m_fsModel, &TaggedFileSystemModel::modificationCountChanged,
+              this, &FileProxyModel::onModificationCountChanged);
+      connect(m_fsModel, &TaggedFileSystemModel::taggedFileAboutToBeDeleted,
+              this, &FileProxyModel::taggedFileAboutToBeDeleted);
     }
   }
   QSortFilterProxyModel::setSourceModel(sourceModel);
@@ -399,11 +408,38 @@ void FileProxyModel::sort(int column, Qt::SortOrder order)
       }
       srcModel->sort(column, order);
     } else {
+      if (m_fsModel) {
+        m_fsModel->prepareTagColumnSort();
+      }
       QSortFilterProxyModel::sort(column, order);
     }
   }
 }
 
+/**
+ * Compare two items for sorting.
+ * Tag columns are compared using the sort ranks of the column store of
+ * the source model, so that no strings have to be compared.
+ *
+ * @param left left source index
+ * @param right right source index
+ *
+ * @return true if @a left is less than @a right.
+ */
+bool FileProxyModel::lessThan(const QModelIndex& left,
+                              const QModelIndex& right) const
+{
+  if (m_fsModel &&
+      left.column() >= TaggedFileSystemModel::NUM_FILESYSTEM_COLUMNS) {
+    if (int leftRank = m_fsModel->tagColumnSortRank(left),
+            rightRank = m_fsModel->tagColumnSortRank(right);
+        leftRank != -2 && rightRank != -2) {
+      return leftRank < rightRank;
+    }
+  }
+  return QSortFilterProxyModel::lessThan(left, right);
+}
+
 /**
  * Sets the name filters to apply against the existing files.
  * @param filters list of strings containing wildcards like "*.mp3"
@@ -622,6 +658,10 @@ bool FileProxyModel::passesExcludeFolderFilters(const QString& dirPath) const
  * TaggedFile or if has a TaggedFile which is null.
  */
 TaggedFile* FileProxyModel::getTaggedFileOfIndex(const QModelIndex& index) {
+  if (const auto model = qobject_cast<const FileProxyModel*>(index.model());
+      model && model->m_fsModel) {
+    return model->m_fsModel->taggedFileOfIndex(model->mapToSource(index));
+  }
   return TaggedFileSystemModel::getTaggedFileOfIndex(index);
 }
 
@@ -650,6 +690,9 @@ QString FileProxyModel::getPathIfIndexOfDir(const QModelIndex& index) {
  */
 TaggedFile* FileProxyModel::readWithId3V24(TaggedFile* taggedFile)
 {
+  TraceSpan span("FileProxyModel::readWithId3V24", [taggedFile] {
+    return taggedFile->getFilename();
+  });
   const QPersistentModelIndex& index = taggedFile->getIndex();
   if (TaggedFile* tagLibFile = TaggedFileSystemModel::createTaggedFile(
           TaggedFile::TF_ID3v24, taggedFile->getFilename(), index)) {
@@ -676,6 +719,9 @@ TaggedFile* FileProxyModel::readWithId3V24(TaggedFile* taggedFile)
  */
 TaggedFile* FileProxyModel::readWithId3V23(TaggedFile* taggedFile)
 {
+  TraceSpan span("FileProxyModel::readWithId3V23", [taggedFile] {
+    return taggedFile->getFilename();
+  });
   const QPersistentModelIndex& index = taggedFile->getIndex();
   if (TaggedFile* id3libFile = TaggedFileSystemModel::createTaggedFile(
           TaggedFile::TF_ID3v23, taggedFile->getFilename(), index)) {
@@ -727,6 +773,9 @@ TaggedFile* FileProxyModel::readWithId3V24IfId3V24(TaggedFile* taggedFile)
  */
 TaggedFile* FileProxyModel::readWithOggFlac(TaggedFile* taggedFile)
 {
+  TraceSpan span("FileProxyModel::readWithOggFlac", [taggedFile] {
+    return taggedFile->getFilename();
+  });
   const QPersistentModelIndex& index = taggedFile->getIndex();
   if (TaggedFile* tagLibFile = TaggedFileSystemModel::createTaggedFile(
           TaggedFile::TF_OggFlac, taggedFile->getFilename(), index)) {
@@ -779,6 +828,9 @@ TaggedFile* FileProxyModel::readWithOggFlacIfInvalidOgg(TaggedFile* taggedFile)
  */
 TaggedFile* FileProxyModel::readTagsFromTaggedFile(TaggedFile* taggedFile)
 {
+  TraceSpan span("FileProxyModel::readTagsFromTaggedFile", [taggedFile] {
+    return taggedFile->getFilename();
+  });
   taggedFile->readTags(false);
   taggedFile = readWithId3V24IfId3V24(taggedFile);
   taggedFile = readWithOggFlacIfInvalidOgg(taggedFile);
@@ -807,6 +859,26 @@ void FileProxyModel::onFileModificationChanged(const QModelIndex& srcIndex,
   }
 }
 
+/**
+ * Called when the source model emits modificationCountChanged() at the end
+ * of a batch edit.
+ * @param delta change of number of modified files
+ */
+void FileProxyModel::onModificationCountChanged(int delta)
+{
+  bool lastIsModified = isModified();
+  if (delta >= 0) {
+    m_numModifiedFiles += static_cast<unsigned int>(delta);
+  } else if (static_cast<unsigned int>(-delta) < m_numModifiedFiles) {
+    m_numModifiedFiles -= static_cast<unsigned int>(-delta);
+  } else {
+    m_numModifiedFiles = 0;
+  }
+  if (bool newIsModified = isModified(); newIsModified != lastIsModified) {
+    emit modifiedChanged(newIsModified);
+  }
+}
+
 /**
  * Get icon provider.
  * @return icon provider.
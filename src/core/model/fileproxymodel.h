@@ -349,6 +349,13 @@ signals:
    */
   void modifiedChanged(bool modified);
 
+  /**
+   * Emitted before the tagged file of a file is deleted or replaced by
+   * another tagged file.
+   * @param filePath path of file
+   */
+  void taggedFileAboutToBeDeleted(const QString& filePath);
+
 protected slots:
   /**
    * Reset internal data of the model.
@@ -368,6 +375,13 @@ private slots:
    */
   void onFileModificationChanged(const QModelIndex& srcIndex, bool modified);
 
+  /**
+   * Called when the source model emits modificationCountChanged() at the end
+   * of a batch edit.
+   * @param delta change of number of modified files
+   */
+  void onModificationCountChanged(int delta);
+
   /**
    * Called when the source model emits directoryLoaded().
    */
@@ -394,6 +408,19 @@ protected:
    */
   bool filterAcceptsRow(int srcRow, const QModelIndex& srcParent) const override;
 
+  /**
+   * Compare two items for sorting.
+   * Tag columns are compared using the sort ranks of the column store of
+   * the source model, so that no strings have to be compared.
+   *
+   * @param left left source index
+   * @param right right source index
+   *
+   * @return true if @a left is less than @a right.
+   */
+  bool lessThan(const QModelIndex& left,
+                const QModelIndex& right) const override;
+
 private:
   /**
    * Check if a directory path passes the include folder filters.
@@ -27,6 +27,7 @@
 #include "fileproxymodeliterator.h"
 #include <QTimer>
 #include "fileproxymodel.h"
+#include "performancetracer.h"
 
 /**
  * Constructor.
@@ -98,6 +99,7 @@ void FileProxyModelIterator::start(const QList<QPersistentModelIndex>& indexes)
  */
 void FileProxyModelIterator::fetchNext()
 {
+  TraceSpan span("FileProxyModelIterator::fetchNext");
   int count = 0;
   while (!m_aborted) {
     if (m_nodes.isEmpty()) {
@@ -10,6 +10,7 @@
  * - Remove moc includes
  * - Remove dependencies to Qt5::Widgets
  * - Do not display a message box from setData(), this will crash without GUI
+ * - Store row of data of derived model in nodes
  */
 /****************************************************************************
 **
@@ -61,6 +62,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <utility>
 
 #ifdef Q_OS_WIN
 #  include <QtCore/QVarLengthArray>
@@ -178,6 +180,61 @@ QFileInfo FileSystemModel::fileInfo(const QModelIndex &index) const
     return d->node(index)->fileInfo();
 }
 
+/*!
+    Returns the row of the data which a derived model has stored for the
+    item under the given \a index, or -1 if no row has been set.
+    The row is kept in the node of the item, so that no persistent index is
+    needed to associate data with an item.
+*/
+int FileSystemModel::dataRow(const QModelIndex &index) const
+{
+    Q_D(const FileSystemModel);
+    if (!index.isValid())
+        return -1;
+    Q_ASSERT(index.model() == this);
+    return d->node(index)->dataRow;
+}
+
+/*!
+    Sets the \a row of the data which a derived model has stored for the
+    item under the given \a index, -1 to remove the association.
+*/
+void FileSystemModel::setDataRow(const QModelIndex &index, int row)
+{
+    Q_D(FileSystemModel);
+    if (!index.isValid())
+        return;
+    Q_ASSERT(index.model() == this);
+    d->node(index)->dataRow = row;
+}
+
+/*!
+    Removes the data rows from all nodes without calling dataRowRemoved().
+*/
+void FileSystemModel::resetDataRows()
+{
+    Q_D(FileSystemModel);
+    QVector<FileSystemModelPrivate::FileSystemNode*> nodes{&d->root};
+    while (!nodes.isEmpty()) {
+        FileSystemModelPrivate::FileSystemNode *node = nodes.takeLast();
+        node->dataRow = -1;
+        for (auto it = node->children.constBegin();
+             it != node->children.constEnd();
+             ++it) {
+            nodes.append(it.value());
+        }
+    }
+}
+
+/*!
+    Called when the node with the data \a row is removed from the model.
+    Derived models can reimplement this function to release the data.
+*/
+void FileSystemModel::dataRowRemoved(int row)
+{
+    Q_UNUSED(row)
+}
+
 /*!
     \fn void QFileSystemModel::rootPathChanged(const QString &newPath);
 
@@ -191,6 +248,13 @@ QFileInfo FileSystemModel::fileInfo(const QModelIndex &index) const
     renamed to \a newName.  The file is located in the directory \a path.
 */
 
+/*!
+    \fn void FileSystemModel::fileModificationTimeChanged(const QModelIndex &index)
+
+    This signal is emitted when the file at \a index has been modified on
+    disk, i.e. its modification time has changed.
+*/
+
 /*!
     \since 4.7
     \fn void QFileSystemModel::directoryLoaded(const QString &path)
@@ -1444,6 +1508,9 @@ QModelIndex FileSystemModel::setRootPath(const QString &newPath)
     } else {
         newRootIndex = d->index(newPathDir.path());
     }
+#ifndef QT_NO_FILESYSTEMWATCHER
+    d->fileInfoGatherer.setRootPath(d->rootDir.path());
+#endif
     fetchMore(newRootIndex);
     emit rootPathChanged(longNewPath);
     d->forceSort = true;
@@ -1721,6 +1788,23 @@ void FileSystemModelPrivate::_q_directoryChanged(const QString &directory, const
         removeNode(parentNode, toRemove[i]);
 }
 
+/*!
+     \internal
+
+    Remove the \a files which have been deleted from \a directory without
+    comparing the whole directory listing.
+ */
+void FileSystemModelPrivate::_q_filesRemoved(const QString &directory, const QStringList &files)
+{
+    FileSystemModelPrivate::FileSystemNode *parentNode = node(directory, false);
+    if (parentNode->children.count() == 0)
+        return;
+    for (const QString &fileName : files) {
+        if (parentNode->children.contains(fileName))
+            removeNode(parentNode, fileName);
+    }
+}
+
 /*!
     \internal
 
@@ -1780,6 +1864,7 @@ void FileSystemModelPrivate::removeNode(FileSystemModelPrivate::FileSystemNode *
         fileInfoGatherer.removePath(node->info->fileInfo().filePath());
     }
 #endif
+    releaseDataRows(node);
     delete node;
     // cleanup sort files after removing rather then re-sorting which is O(n)
     if (vLocation >= 0) {
@@ -1792,6 +1877,26 @@ void FileSystemModelPrivate::removeNode(FileSystemModelPrivate::FileSystemNode *
         q->endRemoveRows();
 }
 
+/*!
+    \internal
+
+    Notify the model about the data rows of \a node and its descendants,
+    which are about to be deleted.
+ */
+void FileSystemModelPrivate::releaseDataRows(FileSystemNode *node)
+{
+    Q_Q(FileSystemModel);
+    if (node->dataRow != -1) {
+        q->dataRowRemoved(node->dataRow);
+        node->dataRow = -1;
+    }
+    for (auto it = node->children.constBegin();
+         it != node->children.constEnd();
+         ++it) {
+        releaseDataRows(it.value());
+    }
+}
+
 /*!
     \internal
 
@@ -1858,6 +1963,7 @@ void FileSystemModelPrivate::_q_fileSystemChanged(const QString &path, const QVe
     Q_Q(FileSystemModel);
     QVector<QString> rowsToUpdate;
     QStringList newFiles;
+    QStringList modifiedFiles;
     FileSystemModelPrivate::FileSystemNode *parentNode = node(path, false);
     QModelIndex parentIndex = index(parentNode);
     for (const auto &update : updates) {
@@ -1884,6 +1990,10 @@ void FileSystemModelPrivate::_q_fileSystemChanged(const QString &path, const QVe
         }
 
         if (*node != info ) {
+            if (node->info && node->isFile() &&
+                node->lastModified() != info.lastModified()) {
+                modifiedFiles.append(fileName);
+            }
             node->populate(info);
             bypassFilters.remove(node);
             // brand new information.
@@ -1943,6 +2053,12 @@ void FileSystemModelPrivate::_q_fileSystemChanged(const QString &path, const QVe
         addVisibleFiles(parentNode, newFiles);
     }
 
+    for (const QString &fileName : std::as_const(modifiedFiles)) {
+        if (FileSystemNode *node = parentNode->children.value(fileName)) {
+            emit q->fileModificationTimeChanged(this->index(node));
+        }
+    }
+
     if (newFiles.count() > 0 || (sortColumn != 0 && rowsToUpdate.count() > 0)) {
         forceSort = true;
         delayedSort();
@@ -1987,6 +2103,8 @@ void FileSystemModelPrivate::init()
 #ifndef QT_NO_FILESYSTEMWATCHER
     q->connect(&fileInfoGatherer, SIGNAL(newListOfFiles(QString,QStringList)),
                q, SLOT(_q_directoryChanged(QString,QStringList)));
+    q->connect(&fileInfoGatherer, SIGNAL(filesRemoved(QString,QStringList)),
+               q, SLOT(_q_filesRemoved(QString,QStringList)));
     q->connect(&fileInfoGatherer, SIGNAL(updates(QString,QVector<QPair<QString,QFileInfo> >)),
             q, SLOT(_q_fileSystemChanged(QString,QVector<QPair<QString,QFileInfo> >)));
     q->connect(&fileInfoGatherer, SIGNAL(nameResolved(QString,QString)),
@@ -9,6 +9,7 @@
  * - Allow compilation without Qt private headers (USE_QT_PRIVATE_HEADERS)
  * - Replace include guards by #pragma once
  * - Remove dependencies to Qt5::Widgets
+ * - Store row of data of derived model in nodes
  */
 /****************************************************************************
 **
@@ -73,6 +74,7 @@ Q_SIGNALS:
     void fileRenamed(const QString &path, const QString &oldName, const QString &newName);
     void directoryLoaded(const QString &path);
     void fileRenameFailed(const QString &path, const QString &oldName, const QString &newName);
+    void fileModificationTimeChanged(const QModelIndex &index);
 
 public:
     enum Roles {
@@ -169,11 +171,17 @@ protected:
     void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE;
     bool event(QEvent *event) Q_DECL_OVERRIDE;
 
+    int dataRow(const QModelIndex &index) const;
+    void setDataRow(const QModelIndex &index, int row);
+    void resetDataRows();
+    virtual void dataRowRemoved(int row);
+
 private:
     Q_DECLARE_PRIVATE(FileSystemModel)
     Q_DISABLE_COPY(FileSystemModel)
 
     Q_PRIVATE_SLOT(d_func(), void _q_directoryChanged(const QString &directory, const QStringList &list))
+    Q_PRIVATE_SLOT(d_func(), void _q_filesRemoved(const QString &directory, const QStringList &list))
     Q_PRIVATE_SLOT(d_func(), void _q_performDelayedSort())
     Q_PRIVATE_SLOT(d_func(), void _q_fileSystemChanged(const QString &path, const QVector<QPair<QString, QFileInfo> > &))
     Q_PRIVATE_SLOT(d_func(), void _q_resolvedName(const QString &fileName, const QString &resolvedName))
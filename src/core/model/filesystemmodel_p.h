@@ -10,6 +10,7 @@
  * - Allow compilation with Qt versions < 5.7
  * - Replace include guards by #pragma once
  * - Remove dependencies to Qt5::Widgets
+ * - Store row of data of derived model in nodes
  */
 /****************************************************************************
 **
@@ -112,7 +113,7 @@ public:
     {
     public:
         explicit FileSystemNode(const QString &filename = QString(), FileSystemNode *p = 0)
-            : fileName(filename), populatedChildren(false), isVisible(false), dirtyChildrenIndex(-1), parent(p), info(0) {}
+            : fileName(filename), populatedChildren(false), isVisible(false), dirtyChildrenIndex(-1), dataRow(-1), parent(p), info(0) {}
         ~FileSystemNode() {
             qDeleteAll(children);
             delete info;
@@ -127,6 +128,7 @@ public:
             children.clear();
             visibleChildren.clear();
             dirtyChildrenIndex = -1;
+            dataRow = -1;
             parent = Q_NULLPTR;
             delete info;
             info = Q_NULLPTR;
@@ -247,6 +249,8 @@ public:
         QHash<FileSystemModelNodePathKey, FileSystemNode *> children;
         QList<QString> visibleChildren;
         int dirtyChildrenIndex;
+        // row of the data stored by a derived model, -1 if none
+        int dataRow;
         FileSystemNode *parent;
 
 
@@ -293,6 +297,7 @@ public:
     bool filtersAcceptsNode(const FileSystemNode *node) const;
     bool passNameFilters(const FileSystemNode *node) const;
     void removeNode(FileSystemNode *parentNode, const QString &name);
+    void releaseDataRows(FileSystemNode *node);
     FileSystemNode* addNode(FileSystemNode *parentNode, const QString &fileName, const QFileInfo &info);
     void addVisibleFiles(FileSystemNode *parentNode, const QStringList &newFiles);
     void removeVisibleFile(FileSystemNode *parentNode, int vLocation);
@@ -337,6 +342,7 @@ public:
     QString time(const QModelIndex &index) const;
 
     void _q_directoryChanged(const QString &directory, const QStringList &files);
+    void _q_filesRemoved(const QString &directory, const QStringList &files);
     void _q_performDelayedSort();
     void _q_fileSystemChanged(const QString &path, const QVector<QPair<QString, QFileInfo> > &);
     void _q_resolvedName(const QString &fileName, const QString &resolvedName);
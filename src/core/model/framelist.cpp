@@ -138,9 +138,8 @@ bool FrameList::selectByRow(int row)
 void FrameList::setModelFromTaggedFile()
 {
   if (m_taggedFile) {
-    FrameCollection frames;
-    m_taggedFile->getAllFrames(m_tagNr, frames);
-    m_frameTableModel->transferFrames(frames);
+    const FrameCollection& frames = m_taggedFile->getAllFramesCached(m_tagNr);
+    m_frameTableModel->setFrames(frames);
   }
 }
 
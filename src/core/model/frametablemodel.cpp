@@ -620,10 +620,32 @@ void FrameTableModel::clearFrames()
  * @param src frames to move into frame collection, will be cleared
  */
 void FrameTableModel::transferFrames(FrameCollection& src)
+{
+  const int oldNumFrames = beginReplaceFrames(static_cast<int>(src.size()));
+  m_frames.clear();
+  src.swap(m_frames);
+  endReplaceFrames(oldNumFrames);
+}
+
+/**
+ * Set frames of frame collection.
+ * @param frames frames to copy into frame collection
+ */
+void FrameTableModel::setFrames(const FrameCollection& frames)
+{
+  const int oldNumFrames = beginReplaceFrames(static_cast<int>(frames.size()));
+  m_frames = frames;
+  endReplaceFrames(oldNumFrames);
+}
+
+/**
+ * Start replacing all frames.
+ * @param newNumFrames number of frames after the replacement
+ * @return number of frames before the replacement.
+ */
+int FrameTableModel::beginReplaceFrames(int newNumFrames)
 {
   int oldNumFrames = static_cast<int>(m_frames.size());
-  int newNumFrames = static_cast<int>(src.size());
-  int numRowsChanged = qMin(oldNumFrames, newNumFrames);
   // Mark model as temporarily invalid to avoid the following issue:
   // A file has one more frame than another, e.g. a comment frame. The file
   // with more frames is selected, and the frame below genre (e.g. disc number)
@@ -640,9 +662,17 @@ void FrameTableModel::transferFrames(FrameCollection& src)
     beginRemoveRows(QModelIndex(), newNumFrames, oldNumFrames - 1);
   else if (newNumFrames > oldNumFrames)
     beginInsertRows(QModelIndex(), oldNumFrames, newNumFrames - 1);
+  return oldNumFrames;
+}
 
-  m_frames.clear();
-  src.swap(m_frames);
+/**
+ * End replacing all frames started with beginReplaceFrames().
+ * @param oldNumFrames number of frames before the replacement
+ */
+void FrameTableModel::endReplaceFrames(int oldNumFrames)
+{
+  int newNumFrames = static_cast<int>(m_frames.size());
+  int numRowsChanged = qMin(oldNumFrames, newNumFrames);
   updateFrameRowMapping();
   resizeFrameSelected();
   m_temporarilyInvalid = false;
@@ -684,9 +714,9 @@ QSet<QString> FrameTableModel::getCompletionsForType(
 /**
  * Set values which are different inactive.
  *
- * @param others frames to compare, will be modified
+ * @param others frames to compare
  */
-void FrameTableModel::filterDifferent(FrameCollection& others)
+void FrameTableModel::filterDifferent(const FrameCollection& others)
 {
   int oldNumFrames = static_cast<int>(m_frames.size());
 
@@ -251,6 +251,12 @@ public:
    */
   void transferFrames(FrameCollection& src);
 
+  /**
+   * Set frames of frame collection.
+   * @param frames frames to copy into frame collection
+   */
+  void setFrames(const FrameCollection& frames);
+
   /**
    * Start filtering different values.
    */
@@ -259,9 +265,9 @@ public:
   /**
    * Set values which are different inactive.
    *
-   * @param others frames to compare, will be modified
+   * @param others frames to compare
    */
-  void filterDifferent(FrameCollection& others);
+  void filterDifferent(const FrameCollection& others);
 
   /**
    * End filtering different values.
@@ -328,6 +334,19 @@ private:
    */
   int rowOf(FrameCollection::iterator frameIt) const;
 
+  /**
+   * Start replacing all frames.
+   * @param newNumFrames number of frames after the replacement
+   * @return number of frames before the replacement.
+   */
+  int beginReplaceFrames(int newNumFrames);
+
+  /**
+   * End replacing all frames started with beginReplaceFrames().
+   * @param oldNumFrames number of frames before the replacement
+   */
+  void endReplaceFrames(int oldNumFrames);
+
   /**
    * Resize the bit array with the frame selection to match the frames size.
    */
@@ -27,6 +27,7 @@
 #include "kid3application.h"
 #include <cerrno>
 #include <cstring>
+#include <functional>
 #if QT_VERSION >= 0x060000
 #include <QStringConverter>
 #else
@@ -37,8 +38,12 @@
 #include <QTimer>
 #include <QCoreApplication>
 #include <QPluginLoader>
+#include <QJsonObject>
 #include <QElapsedTimer>
 #include <QUrl>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
 #if QT_VERSION >= 0x050c00
 #include <QScopeGuard>
 #endif
@@ -62,17 +67,23 @@
 #include "filefilter.h"
 #include "modeliterator.h"
 #include "trackdatamodel.h"
+#include "renamepreviewmodel.h"
+#include "duplicatemodel.h"
+#include "tagwritequeue.h"
 #include "timeeventmodel.h"
 #include "frameobjectmodel.h"
 #include "playlistmodel.h"
 #include "imagedataprovider.h"
 #include "pictureframe.h"
 #include "textimporter.h"
+#include "tagtableimporter.h"
+#include "fingerprintcache.h"
 #include "importparser.h"
 #include "textexporter.h"
 #include "serverimporter.h"
 #include "saferename.h"
 #include "configstore.h"
+#include "performancetracer.h"
 #include "formatconfig.h"
 #include "tagconfig.h"
 #include "fileconfig.h"
@@ -95,6 +106,12 @@
 
 namespace {
 
+/**
+ * Maximum size of the unique pictures collected by normalizeAlbumArt()
+ * before they are scaled and set in the files.
+ */
+constexpr qint64 MAX_PENDING_PICTURE_BYTES = 64 * 1024 * 1024;
+
 /**
  * Get the file name of the plugin from the plugin name.
  * @param pluginName name of the plugin
@@ -117,6 +134,37 @@ QString pluginFileName(const QString& pluginName)
   return fileName;
 }
 
+/**
+ * Check if a plugin can be loaded when it is used.
+ * @param iid interface ID from the plugin metadata
+ * @return true for importer and user command plugins.
+ */
+bool isDeferrablePluginInterface(const QString& iid)
+{
+  return iid == QLatin1String(
+        qobject_interface_iid<IServerImporterFactory*>()) ||
+      iid == QLatin1String(
+        qobject_interface_iid<IServerTrackImporterFactory*>()) ||
+      iid == QLatin1String(
+        qobject_interface_iid<IUserCommandProcessor*>());
+}
+
+/**
+ * Get the plugin name from the plugin metadata without loading the plugin.
+ * The object name of the Kid3 plugins is their class name without the
+ * "Plugin" suffix, e.g. "MusicBrainzImport" for MusicBrainzImportPlugin.
+ * @param metaData metadata returned by QPluginLoader::metaData()
+ * @return plugin name, empty if not found.
+ */
+QString pluginNameFromMetaData(const QJsonObject& metaData)
+{
+  QString name = metaData.value(QLatin1String("className")).toString();
+  if (name.endsWith(QLatin1String("Plugin"))) {
+    name.chop(6);
+  }
+  return name;
+}
+
 /**
  * Get text encoding from tag config as frame text encoding.
  * @return frame text encoding.
@@ -191,6 +239,50 @@ void extractFileFieldIndex(
   }
 }
 
+/**
+ * Iterator passing the files of another iterator and reporting the number
+ * of files returned, so that the operation using it can be aborted.
+ */
+class ProgressTaggedFileIterator : public AbstractTaggedFileIterator {
+public:
+  /**
+   * Constructor.
+   * @param it iterator providing the files
+   * @param progress called with the number of files returned every
+   * FILES_PER_PROGRESS_REPORT files, returns true to abort
+   */
+  ProgressTaggedFileIterator(AbstractTaggedFileIterator& it,
+                             const std::function<bool (int)>& progress)
+    : m_it(it), m_progress(progress), m_numFiles(0), m_aborted(false) {
+  }
+
+  bool hasNext() const override { return !m_aborted && m_it.hasNext(); }
+
+  TaggedFile* next() override {
+    if (++m_numFiles % FILES_PER_PROGRESS_REPORT == 0) {
+      m_aborted = m_progress(m_numFiles);
+    }
+    return m_it.next();
+  }
+
+  TaggedFile* peekNext() const override { return m_it.peekNext(); }
+
+  /**
+   * Check if the operation was aborted.
+   * @return true if aborted.
+   */
+  bool isAborted() const { return m_aborted; }
+
+private:
+  /** Number of files between calls of the progress function. */
+  static constexpr int FILES_PER_PROGRESS_REPORT = 256;
+
+  AbstractTaggedFileIterator& m_it;
+  std::function<bool (int)> m_progress;
+  int m_numFiles;
+  bool m_aborted;
+};
+
 /**
  * Get the internal rating frame name with optional field.
  * @param frame frame containing rating
@@ -254,6 +346,41 @@ QString ratingTypeName(const Frame& frame,
   return name;
 }
 
+/**
+ * Scales a picture on a worker thread.
+ */
+class PictureScaler : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param platformTools platform tools used to scale the image
+   * @param data image data, replaced by the scaled data, which is empty
+   * if the image is not scaled
+   * @param maxSize maximum width and height in pixels
+   * @param numDone incremented when finished
+   */
+  PictureScaler(const ICorePlatformTools* platformTools, QByteArray& data,
+                int maxSize, QAtomicInt& numDone)
+    : m_platformTools(platformTools), m_data(data), m_maxSize(maxSize),
+      m_numDone(numDone) {
+  }
+
+  /**
+   * Scale the picture.
+   */
+  void run() override {
+    TraceSpan span("PictureScaler::run");
+    m_data = m_platformTools->scaleImageData(m_data, m_maxSize);
+    m_numDone.ref();
+  }
+
+private:
+  const ICorePlatformTools* m_platformTools;
+  QByteArray& m_data;
+  const int m_maxSize;
+  QAtomicInt& m_numDone;
+};
+
 }
 
 /** Fallback for path to search for plugins */
@@ -275,12 +402,14 @@ Kid3Application::Kid3Application(ICorePlatformTools* platformTools,
   m_fileSelectionModel(new QItemSelectionModel(m_fileProxyModel, this)),
   m_dirSelectionModel(new QItemSelectionModel(m_dirProxyModel, this)),
   m_trackDataModel(new TrackDataModel(m_platformTools->iconProvider(), this)),
-  m_netMgr(new QNetworkAccessManager(this)),
-  m_downloadClient(new DownloadClient(m_netMgr)),
+  m_netMgr(nullptr),
+  m_downloadClient(nullptr),
   m_textExporter(new TextExporter(this)),
   m_tagSearcher(new TagSearcher(this)),
   m_dirRenamer(new DirRenamer(this)),
-  m_batchImporter(new BatchImporter(m_netMgr)),
+  m_renamePreviewModel(new RenamePreviewModel(this)),
+  m_duplicateModel(new DuplicateModel(this)),
+  m_batchImporter(nullptr),
   m_player(nullptr),
   m_expressionFileFilter(nullptr),
   m_downloadImageDest(ImageForSelectedFiles),
@@ -298,6 +427,7 @@ Kid3Application::Kid3Application(ICorePlatformTools* platformTools,
 #endif
   m_filtered(false), m_selectionOperationRunning(false)
 {
+  PerformanceTracer::enableFromEnvironment();
   const TagConfig& tagCfg = TagConfig::instance();
   FOR_ALL_TAGS(tagNr) {
     bool id3v1 = tagNr == Frame::Tag_Id3v1;
@@ -323,6 +453,13 @@ Kid3Application::Kid3Application(ICorePlatformTools* platformTools,
   m_fileSystemModel->setReadOnly(false);
   const FileConfig& fileCfg = FileConfig::instance();
   m_fileSystemModel->setSortIgnoringPunctuation(fileCfg.sortIgnoringPunctuation());
+  connect(&fileCfg, &FileConfig::maxResidentTagFilesChanged,
+          m_fileSystemModel, &TaggedFileSystemModel::setMaxResidentTaggedFiles);
+  // Queued, so that files are not evicted while an operation processes
+  // them, also when the tags are read from a worker thread.
+  connect(m_fileSystemModel,
+          &TaggedFileSystemModel::residentTaggedFileLimitExceeded,
+          this, &Kid3Application::evictTags, Qt::QueuedConnection);
   m_fileProxyModel->setSourceModel(m_fileSystemModel);
   m_dirProxyModel->setSourceModel(m_fileSystemModel);
   connect(m_fileSelectionModel,
@@ -340,7 +477,6 @@ Kid3Application::Kid3Application(ICorePlatformTools* platformTools,
           this, &Kid3Application::selectedFilesUpdated);
 
   initPlugins();
-  m_batchImporter->setImporters(m_importers, m_trackDataModel);
 
 #ifdef Q_OS_ANDROID
   new AndroidUtils(this);
@@ -441,7 +577,7 @@ void Kid3Application::initPlugins()
   TagConfig& tagCfg = TagConfig::instance();
   importCfg.clearAvailablePlugins();
   tagCfg.clearAvailablePlugins();
-  const auto plugins = loadPlugins();
+  const auto plugins = loadPlugins(&m_deferredPluginFiles);
   for (QObject* plugin : plugins) {
     checkPlugin(plugin);
   }
@@ -515,9 +651,11 @@ void Kid3Application::setPluginsPathFallback(const QString& path)
 
 /**
  * Load plugins.
+ * @param deferredPluginFiles if not null, importer and user command plugins
+ * are not loaded, their paths are added to this list instead
  * @return list of plugin instances.
  */
-QObjectList Kid3Application::loadPlugins()
+QObjectList Kid3Application::loadPlugins(QStringList* deferredPluginFiles)
 {
   QObjectList plugins = QPluginLoader::staticInstances();
 
@@ -560,6 +698,26 @@ QObjectList Kid3Application::loadPlugins()
         continue;
       }
       QPluginLoader loader(pluginsDir.absoluteFilePath(fileName));
+      if (deferredPluginFiles) {
+        // The interface is in the metadata, which can be read without
+        // loading the library.
+        if (const QJsonObject metaData = loader.metaData();
+            isDeferrablePluginInterface(
+              metaData.value(QLatin1String("IID")).toString())) {
+          // The plugin name is registered now, so that it is available
+          // in the settings before the plugin is loaded.
+          if (QString name = pluginNameFromMetaData(metaData);
+              !name.isEmpty()) {
+            if (!availablePlugins.contains(name)) {
+              availablePlugins.append(name);
+            }
+            if (disabledPlugins.contains(name))
+              continue;
+          }
+          deferredPluginFiles->append(loader.fileName());
+          continue;
+        }
+      }
       if (QObject* plugin = loader.instance()) {
         if (QString name(plugin->objectName()); disabledPlugins.contains(name)) {
           availablePlugins.append(name);
@@ -578,6 +736,110 @@ QObjectList Kid3Application::loadPlugins()
   return plugins;
 }
 
+/**
+ * Load the plugins which have been deferred by initPlugins().
+ * Importer and user command plugins are only loaded when they are used, so
+ * that applications which do not need them, e.g. a single kid3-cli command
+ * to get a tag, start faster.
+ */
+void Kid3Application::loadDeferredPlugins()
+{
+  if (m_deferredPluginFiles.isEmpty())
+    return;
+
+  TraceSpan span("Kid3Application::loadDeferredPlugins");
+  ImportConfig& importCfg = ImportConfig::instance();
+  const QStringList disabledPlugins = importCfg.disabledPlugins();
+  const QStringList fileNames = m_deferredPluginFiles;
+  m_deferredPluginFiles.clear();
+  for (const QString& fileName : fileNames) {
+    QPluginLoader loader(fileName);
+    if (QObject* plugin = loader.instance()) {
+      if (QString name(plugin->objectName()); disabledPlugins.contains(name)) {
+        if (QStringList availablePlugins = importCfg.availablePlugins();
+            !availablePlugins.contains(name)) {
+          availablePlugins.append(name);
+          importCfg.setAvailablePlugins(availablePlugins);
+        }
+        loader.unload();
+      } else {
+        checkPlugin(plugin);
+      }
+    }
+  }
+  if (m_batchImporter) {
+    m_batchImporter->setImporters(m_importers, m_trackDataModel);
+  }
+}
+
+/**
+ * Get network access manager, it is created on first use.
+ * @return network access manager.
+ */
+QNetworkAccessManager* Kid3Application::networkAccessManager()
+{
+  if (!m_netMgr) {
+    m_netMgr = new QNetworkAccessManager(this);
+  }
+  return m_netMgr;
+}
+
+/**
+ * Get download client, it is created on first use.
+ * @return download client.
+ */
+DownloadClient* Kid3Application::getDownloadClient()
+{
+  if (!m_downloadClient) {
+    m_downloadClient = new DownloadClient(networkAccessManager());
+  }
+  return m_downloadClient;
+}
+
+/**
+ * Get available server importers.
+ * @return list of server importers.
+ */
+QList<ServerImporter*> Kid3Application::getServerImporters()
+{
+  loadDeferredPlugins();
+  return m_importers;
+}
+
+/**
+ * Get available server track importers.
+ * @return list of server track importers.
+ */
+QList<ServerTrackImporter*> Kid3Application::getServerTrackImporters()
+{
+  loadDeferredPlugins();
+  return m_trackImporters;
+}
+
+/**
+ * Get available user command processors.
+ * @return list of user command processors.
+ */
+QList<IUserCommandProcessor*> Kid3Application::getUserCommandProcessors()
+{
+  loadDeferredPlugins();
+  return m_userCommandProcessors;
+}
+
+/**
+ * Get batch importer, it is created on first use.
+ * @return batch importer.
+ */
+BatchImporter* Kid3Application::getBatchImporter()
+{
+  if (!m_batchImporter) {
+    loadDeferredPlugins();
+    m_batchImporter = new BatchImporter(networkAccessManager());
+    m_batchImporter->setImporters(m_importers, m_trackDataModel);
+  }
+  return m_batchImporter;
+}
+
 /**
  * Check type of a loaded plugin and register it.
  * @param plugin instance returned by plugin loader
@@ -587,28 +849,32 @@ void Kid3Application::checkPlugin(QObject* plugin)
   if (auto importerFactory =
       qobject_cast<IServerImporterFactory*>(plugin)) {
     ImportConfig& importCfg = ImportConfig::instance();
-    QStringList availablePlugins = importCfg.availablePlugins();
-    availablePlugins.append(plugin->objectName());
-    importCfg.setAvailablePlugins(availablePlugins);
+    if (QStringList availablePlugins = importCfg.availablePlugins();
+        !availablePlugins.contains(plugin->objectName())) {
+      availablePlugins.append(plugin->objectName());
+      importCfg.setAvailablePlugins(availablePlugins);
+    }
     if (!importCfg.disabledPlugins().contains(plugin->objectName())) {
       const auto keys = importerFactory->serverImporterKeys();
       for (const QString& key : keys) {
         m_importers.append(importerFactory->createServerImporter(
-                             key, m_netMgr, m_trackDataModel));
+                             key, networkAccessManager(), m_trackDataModel));
       }
     }
   }
   if (auto importerFactory =
       qobject_cast<IServerTrackImporterFactory*>(plugin)) {
     ImportConfig& importCfg = ImportConfig::instance();
-    QStringList availablePlugins = importCfg.availablePlugins();
-    availablePlugins.append(plugin->objectName());
-    importCfg.setAvailablePlugins(availablePlugins);
+    if (QStringList availablePlugins = importCfg.availablePlugins();
+        !availablePlugins.contains(plugin->objectName())) {
+      availablePlugins.append(plugin->objectName());
+      importCfg.setAvailablePlugins(availablePlugins);
+    }
     if (!importCfg.disabledPlugins().contains(plugin->objectName())) {
       const auto keys = importerFactory->serverTrackImporterKeys();
       for (const QString& key : keys) {
         m_trackImporters.append(importerFactory->createServerTrackImporter(
-                             key, m_netMgr, m_trackDataModel));
+                             key, networkAccessManager(), m_trackDataModel));
       }
     }
   }
@@ -632,9 +898,11 @@ void Kid3Application::checkPlugin(QObject* plugin)
   if (auto userCommandProcessor =
       qobject_cast<IUserCommandProcessor*>(plugin)) {
     ImportConfig& importCfg = ImportConfig::instance();
-    QStringList availablePlugins = importCfg.availablePlugins();
-    availablePlugins.append(plugin->objectName());
-    importCfg.setAvailablePlugins(availablePlugins);
+    if (QStringList availablePlugins = importCfg.availablePlugins();
+        !availablePlugins.contains(plugin->objectName())) {
+      availablePlugins.append(plugin->objectName());
+      importCfg.setAvailablePlugins(availablePlugins);
+    }
     if (!importCfg.disabledPlugins().contains(plugin->objectName())) {
       m_userCommandProcessors.append(userCommandProcessor);
     }
@@ -647,6 +915,9 @@ void Kid3Application::checkPlugin(QObject* plugin)
  */
 QStringList Kid3Application::getServerImporterNames() const
 {
+  // Loading the deferred plugins does not change the observable state,
+  // the importers are only created later than at startup.
+  const_cast<Kid3Application*>(this)->loadDeferredPlugins();
   QStringList names;
   const auto importers = m_importers;
   for (const ServerImporter* importer : importers) {
@@ -813,6 +1084,8 @@ void Kid3Application::readConfig()
   const TagConfig& tagCfg = TagConfig::instance();
   FrameCollection::setQuickAccessFrames(tagCfg.quickAccessFrames());
   Frame::setNamesForCustomFrames(tagCfg.customFrames());
+  m_fileSystemModel->setMaxResidentTaggedFiles(
+        FileConfig::instance().maxResidentTagFiles());
 }
 
 /**
@@ -1010,6 +1283,41 @@ void Kid3Application::unloadAllTags()
 #endif
 }
 
+/**
+ * Get number of files with tags in memory.
+ * @return number of files with tags read.
+ */
+int Kid3Application::residentTaggedFileCount() const
+{
+  return m_fileSystemModel->residentTaggedFileCount();
+}
+
+/**
+ * Get number of files whose tags have been freed because more files than
+ * configured in FileConfig::maxResidentTagFiles() had their tags in memory.
+ * @return number of evicted files since the folder was opened.
+ */
+int Kid3Application::evictedTaggedFileCount() const
+{
+  return m_fileSystemModel->evictedTaggedFileCount();
+}
+
+/**
+ * Free the tags of the least recently used files which are not selected
+ * when too many files have their tags in memory.
+ */
+void Kid3Application::evictTags()
+{
+  QSet<const TaggedFile*> selectedFiles;
+  const auto selectedIndexes = m_fileSelectionModel->selectedRows();
+  for (const QModelIndex& index : selectedIndexes) {
+    if (TaggedFile* taggedFile = FileProxyModel::getTaggedFileOfIndex(index)) {
+      selectedFiles.insert(taggedFile);
+    }
+  }
+  m_fileSystemModel->evictTags(selectedFiles);
+}
+
 /**
  * Get directory path of opened directory.
  * @return directory path.
@@ -1044,6 +1352,7 @@ QModelIndex Kid3Application::currentOrRootIndex() const
  */
 QStringList Kid3Application::saveDirectory(QStringList* errorDescriptions)
 {
+  TraceSpan span("Kid3Application::saveDirectory");
   QStringList errorFiles;
   int numFiles = 0, totalFiles = 0;
 #if QT_VERSION >= 0x050c00
@@ -1053,11 +1362,16 @@ QStringList Kid3Application::saveDirectory(QStringList* errorDescriptions)
   });
 #endif
 
+  // Files on network shares are written concurrently, the others
+  // sequentially.
+  TagWriteQueue writeQueue(FileConfig::instance().preserveTime());
+
   // Get number of files to be saved to display correct progressbar
   TaggedFileIterator countIt(m_fileProxyModelRootIndex);
   while (countIt.hasNext()) {
-    if (countIt.next()->isChanged()) {
+    if (TaggedFile* taggedFile = countIt.next(); taggedFile->isChanged()) {
       ++totalFiles;
+      writeQueue.enqueue(taggedFile);
     }
   }
   QString operationName = tr("Saving folder...");
@@ -1067,61 +1381,38 @@ QStringList Kid3Application::saveDirectory(QStringList* errorDescriptions)
   if (errorDescriptions) {
     errorDescriptions->clear();
   }
-  TaggedFileIterator it(m_fileProxyModelRootIndex);
-  while (it.hasNext()) {
-    TaggedFile* taggedFile = it.next();
-    QString fileName = taggedFile->getFilename();
-    if (taggedFile->isFilenameChanged() &&
-        Utils::replaceIllegalFileNameCharacters(fileName)) {
-      taggedFile->setFilename(fileName);
+  if (!writeQueue.isEmpty()) {
+    // The progress handler can process events, it is only called between
+    // the batches, when no file is written by a worker thread.
+    while (writeQueue.writeNextBatch()) {
+      emit longRunningOperationProgress(operationName, writeQueue.doneCount(),
+                                        totalFiles, &aborted);
+      if (aborted)
+        break;
     }
-    bool renamed = false;
-    if (errorDescriptions) {
-      errno = 0;
+    numFiles = writeQueue.doneCount();
+    const auto failures = writeQueue.failures();
+    for (const TagWriteQueue::Failure& failure : failures) {
+      errorFiles.push_back(failure.taggedFile->getAbsFilename());
+      if (errorDescriptions) {
+        errorDescriptions->append(errorNumberDescription(failure.errorNumber));
+      }
     }
+  }
+
+  TaggedFileIterator it(m_fileProxyModelRootIndex);
+  while (!aborted && it.hasNext()) {
+    TaggedFile* taggedFile = it.next();
+    if (writeQueue.contains(taggedFile)) continue;
     if (!taggedFile->isChanged()) continue; // do not consider a non-changed file when reporting progress.
-    if (!taggedFile->writeTags(false, &renamed,
-                               FileConfig::instance().preserveTime())) {
-      if (QDir dir(taggedFile->getDirname());
-          dir.exists(fileName) && taggedFile->isFilenameChanged()) {
-        // File is renamed to a file name which already exists.
-        // Try another file name ending with a number.
-        QString baseName = fileName;
-        QString ext;
-        if (int dotPos = baseName.lastIndexOf(QLatin1Char('.')); dotPos != -1) {
-          ext = baseName.mid(dotPos);
-          baseName.truncate(dotPos);
-        }
-        baseName.append(QLatin1Char('('));
-        ext.prepend(QLatin1Char(')'));
-        bool ok = false;
-        for (int nr = 1; nr < 100; ++nr) {
-          if (QString newName = baseName + QString::number(nr) + ext;
-              !dir.exists(newName)) {
-            taggedFile->setFilename(newName);
-            ok = taggedFile->writeTags(false, &renamed,
-                                       FileConfig::instance().preserveTime());
-            break;
-          }
-        }
-        if (ok) {
-          goto done_with_this_file;
-        }
-        taggedFile->setFilename(fileName);
-      }
-      QString errorMsg = taggedFile->getAbsFilename();
-      errorFiles.push_back(errorMsg);
+    if (QString errorDescription;
+        !writeTaggedFile(taggedFile,
+                         errorDescriptions ? &errorDescription : nullptr)) {
+      errorFiles.push_back(taggedFile->getAbsFilename());
       if (errorDescriptions) {
-        QString errorDescription;
-        if (const int errnum = errno) {
-          if (const char* errdesc = ::strerror(errnum)) {
-            errorDescription = QString::fromUtf8(errdesc);
-          }
-        }
         errorDescriptions->append(errorDescription);
       }
     }
-done_with_this_file:
     ++numFiles;
     emit longRunningOperationProgress(operationName, numFiles, totalFiles,
                                       &aborted);
@@ -1150,6 +1441,81 @@ QStringList Kid3Application::saveDirectory()
   return saveDirectory(nullptr);
 }
 
+/**
+ * Write the tags of a file.
+ * Illegal characters in a new file name are replaced. If the file shall be
+ * renamed to a file name which already exists, a number is appended to the
+ * file name.
+ *
+ * @param taggedFile tagged file
+ * @param errorDescription if not NULL, a description of the error is
+ * returned here, a null string if no description is available
+ *
+ * @return true if ok.
+ */
+bool Kid3Application::writeTaggedFile(TaggedFile* taggedFile,
+                                      QString* errorDescription)
+{
+  QString fileName = taggedFile->getFilename();
+  if (taggedFile->isFilenameChanged() &&
+      Utils::replaceIllegalFileNameCharacters(fileName)) {
+    taggedFile->setFilename(fileName);
+  }
+  bool renamed = false;
+  errno = 0;
+  if (taggedFile->writeTags(false, &renamed,
+                            FileConfig::instance().preserveTime())) {
+    taggedFile->markTagsWritten();
+    return true;
+  }
+  const int errorNumber = errno;
+  if (QDir dir(taggedFile->getDirname());
+      dir.exists(fileName) && taggedFile->isFilenameChanged()) {
+    // File is renamed to a file name which already exists.
+    // Try another file name ending with a number.
+    QString baseName = fileName;
+    QString ext;
+    if (int dotPos = baseName.lastIndexOf(QLatin1Char('.')); dotPos != -1) {
+      ext = baseName.mid(dotPos);
+      baseName.truncate(dotPos);
+    }
+    baseName.append(QLatin1Char('('));
+    ext.prepend(QLatin1Char(')'));
+    for (int nr = 1; nr < 100; ++nr) {
+      if (QString newName = baseName + QString::number(nr) + ext;
+          !dir.exists(newName)) {
+        taggedFile->setFilename(newName);
+        if (taggedFile->writeTags(false, &renamed,
+                                  FileConfig::instance().preserveTime())) {
+          taggedFile->markTagsWritten();
+          return true;
+        }
+        break;
+      }
+    }
+    taggedFile->setFilename(fileName);
+  }
+  if (errorDescription) {
+    *errorDescription = errorNumberDescription(errorNumber);
+  }
+  return false;
+}
+
+/**
+ * Get description of an error number.
+ * @param errorNumber errno value
+ * @return description, null string if @a errorNumber is 0 or unknown.
+ */
+QString Kid3Application::errorNumberDescription(int errorNumber)
+{
+  if (errorNumber) {
+    if (const char* errdesc = ::strerror(errorNumber)) {
+      return QString::fromUtf8(errdesc);
+    }
+  }
+  return QString();
+}
+
 /**
  * Merge entries of two string lists.
  *
@@ -1192,6 +1558,8 @@ QStringList Kid3Application::mergeStringLists(
 void Kid3Application::frameModelsToTags()
 {
   if (!m_currentSelection.isEmpty()) {
+    // Coalesce the change notifications of the files into a few signals.
+    m_fileSystemModel->beginBatchEdit();
     FOR_ALL_TAGS(tagNr) {
       FrameCollection frames(m_framesModel[tagNr]->getEnabledFrames());
       for (auto it = m_currentSelection.constBegin();
@@ -1202,6 +1570,7 @@ void Kid3Application::frameModelsToTags()
         }
       }
     }
+    m_fileSystemModel->endBatchEdit();
   }
 }
 
@@ -1372,6 +1741,72 @@ bool Kid3Application::importTags(Frame::TagVersion tagMask,
   return false;
 }
 
+/**
+ * Import a tag table exported as CSV or JSON, e.g. with the ExportCsv or
+ * ExportJson script.
+ * The rows are assigned to the files of all loaded folders using the
+ * "File Path" column, if no file is found, they are assigned to the files
+ * of the current folder in their order.
+ *
+ * @param tagMask tag mask
+ * @param path    path of CSV or JSON file
+ *
+ * @return true if ok.
+ */
+bool Kid3Application::importTagTable(Frame::TagVersion tagMask,
+                                     const QString& path)
+{
+  TagTableImporter importer;
+  if (!importer.readFile(path))
+    return false;
+
+  // Notify the views once after the tags of all files have been set.
+  m_fileSystemModel->beginBatchEdit();
+  FOR_TAGS_IN_MASK(tagNr, tagMask) {
+    const Frame::TagVersion tagVersion = Frame::tagVersionFromNumber(tagNr);
+    ImportTrackDataVector trackDataVector;
+    if (importer.hasFilePaths()) {
+      // Search the files of all loaded folders, only files with a row in
+      // the table are read.
+      TaggedFileIterator it(currentOrRootIndex());
+      while (it.hasNext()) {
+        if (TaggedFile* taggedFile = it.next();
+            importer.findRow(taggedFile->getAbsFilename()) >= 0) {
+          taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+          trackDataVector.push_back(ImportTrackData(*taggedFile, tagVersion));
+        }
+      }
+    }
+    if (trackDataVector.isEmpty()) {
+      filesToTrackData(tagVersion, trackDataVector);
+    }
+    if (importer.applyTo(trackDataVector, tagNr) == 0)
+      continue;
+
+    const FrameFilter flt = frameModel(tagNr)->getEnabledFrameFilter(true);
+    for (auto it = trackDataVector.begin(); it != trackDataVector.end(); ++it) {
+      if (TaggedFile* taggedFile = it->getTaggedFile()) {
+        // The tags may have been evicted while the other files were read.
+        taggedFile->readTags(false);
+        it->removeDisabledFrames(flt);
+        formatFramesIfEnabled(*it);
+        if (tagNr == Frame::Tag_Id3v1) {
+          taggedFile->setFrames(tagNr, *it, false);
+        } else {
+          it->markChangedFrames(taggedFile->getAllFramesCached(tagNr));
+          taggedFile->setFrames(tagNr, *it, true);
+        }
+      }
+    }
+  }
+  m_fileSystemModel->endBatchEdit();
+
+  if (getFileSelectionModel()->hasSelection()) {
+    emit selectedFilesUpdated();
+  }
+  return true;
+}
+
 /**
  * Import from tags.
  *
@@ -1680,9 +2115,7 @@ void Kid3Application::trackDataModelToFiles(Frame::TagVersion tagVersion)
         if (tagNr == Frame::Tag_Id3v1) {
           taggedFile->setFrames(tagNr, *it, false);
         } else {
-          FrameCollection oldFrames;
-          taggedFile->getAllFrames(tagNr, oldFrames);
-          it->markChangedFrames(oldFrames);
+          it->markChangedFrames(taggedFile->getAllFramesCached(tagNr));
           taggedFile->setFrames(tagNr, *it, true);
         }
       }
@@ -1713,7 +2146,7 @@ void Kid3Application::downloadImage(const QUrl& url, DownloadImageDestination de
 {
   if (QUrl imgurl(DownloadClient::getImageUrl(url)); !imgurl.isEmpty()) {
     m_downloadImageDest = dest;
-    m_downloadClient->startDownload(imgurl);
+    getDownloadClient()->startDownload(imgurl);
   }
 }
 
@@ -1743,7 +2176,7 @@ void Kid3Application::batchImport(const BatchImportProfile& profile,
   m_batchImportAlbums.clear();
   m_batchImportTrackDataList.clear();
   m_lastProcessedDirName.clear();
-  m_batchImporter->clearAborted();
+  getBatchImporter()->clearAborted();
   m_batchImporter->emitReportImportEvent(BatchImporter::ReadingDirectory,
                                          QString());
   // If no directories are selected, process files of the current directory.
@@ -2107,21 +2540,144 @@ void Kid3Application::getTagsFromFilename(Frame::TagVersion tagMask)
 void Kid3Application::getFilenameFromTags(Frame::TagVersion tagVersion)
 {
   emit fileSelectionUpdateRequested();
+  const QString format = FileConfig::instance().toFilenameFormat();
   QItemSelectionModel* selectModel = getFileSelectionModel();
   SelectedTaggedFileIterator it(getRootIndex(),
                                 selectModel,
                                 false);
   while (it.hasNext()) {
     TaggedFile* taggedFile = it.next();
-    if (TrackData trackData(*taggedFile, tagVersion);
-        !trackData.isEmptyOrInactive()) {
-      taggedFile->setFilenameFormattedIfEnabled(
-        trackData.formatFilenameFromTags(FileConfig::instance().toFilenameFormat()));
+    // Use the name from the preview if the tags have not been changed since.
+    QString fn;
+    if (!m_renamePreviewModel->findFilename(taggedFile, tagVersion, format,
+                                            fn)) {
+      fn = RenamePreviewModel::filenameFromTags(taggedFile, tagVersion,
+                                                format);
+    }
+    if (!fn.isNull()) {
+      taggedFile->setFilename(fn);
     }
   }
+  m_renamePreviewModel->clear();
   emit selectedFilesUpdated();
 }
 
+/**
+ * Generate the file names which getFilenameFromTags() would set without
+ * changing the files.
+ * The result is available in getRenamePreviewModel() and is reused by
+ * getFilenameFromTags() for files whose tags have not been changed since.
+ *
+ * @param tagVersion tag version
+ *
+ * @return number of files which would be renamed.
+ */
+int Kid3Application::previewFilenameFromTags(Frame::TagVersion tagVersion)
+{
+  emit fileSelectionUpdateRequested();
+  QList<TaggedFile*> taggedFiles;
+  SelectedTaggedFileIterator it(getRootIndex(),
+                                getFileSelectionModel(),
+                                false);
+  while (it.hasNext()) {
+    taggedFiles.append(it.next());
+  }
+  m_renamePreviewModel->setFilenamesFromTags(
+        taggedFiles, tagVersion, FileConfig::instance().toFilenameFormat());
+  return m_renamePreviewModel->changedCount();
+}
+
+/**
+ * Find files in the selection which are probably duplicates because they
+ * have the same artist and title and similar durations.
+ * If no files are selected, all files are checked.
+ * The result is available in getDuplicateModel().
+ * longRunningOperationProgress() is emitted while reading the files.
+ *
+ * @param maxDurationDifference maximum difference of the durations in
+ * seconds of files in a group
+ *
+ * @return number of groups of duplicates.
+ */
+int Kid3Application::findDuplicates(int maxDurationDifference)
+{
+  emit fileSelectionUpdateRequested();
+
+  int totalFiles = 0;
+  SelectedTaggedFileIterator countIt(getRootIndex(),
+                                     getFileSelectionModel(),
+                                     true);
+  while (countIt.hasNext()) {
+    countIt.next();
+    ++totalFiles;
+  }
+  const QString operationName = tr("Finding duplicates...");
+  bool aborted = false;
+  emit longRunningOperationProgress(operationName, -1, totalFiles, &aborted);
+
+  SelectedTaggedFileIterator it(getRootIndex(),
+                                getFileSelectionModel(),
+                                true);
+  ProgressTaggedFileIterator progressIt(
+        it, [this, &operationName, totalFiles, &aborted](int numFiles) {
+    emit longRunningOperationProgress(operationName, numFiles, totalFiles,
+                                      &aborted);
+    return aborted;
+  });
+  int numGroups = 0;
+  if (!aborted) {
+    numGroups = m_duplicateModel->findDuplicates(progressIt,
+                                                 maxDurationDifference);
+    if (progressIt.isAborted()) {
+      // Partial results would miss duplicates.
+      m_duplicateModel->clear();
+      numGroups = 0;
+    }
+  }
+  emit longRunningOperationProgress(operationName, totalFiles, totalFiles,
+                                    &aborted);
+  return numGroups;
+}
+
+/**
+ * Get the cached audio fingerprints of the selected files.
+ * If no files are selected, all files are used. Only files which have not
+ * changed since their fingerprint was calculated by an AcoustID import
+ * are returned.
+ *
+ * @return list of maps with "filePath", "duration" and "fingerprint".
+ */
+QVariantList Kid3Application::getCachedFingerprints()
+{
+  emit fileSelectionUpdateRequested();
+  FingerprintCache& cache = FingerprintCache::instance();
+  QVariantList fingerprints;
+  SelectedTaggedFileIterator it(getRootIndex(),
+                                getFileSelectionModel(),
+                                true);
+  while (it.hasNext()) {
+    const QString filePath = it.next()->getAbsFilename();
+    QString fingerprint;
+    int duration;
+    if (cache.find(filePath, fingerprint, duration)) {
+      fingerprints.append(QVariantMap{
+        {QLatin1String("filePath"), filePath},
+        {QLatin1String("duration"), duration},
+        {QLatin1String("fingerprint"), fingerprint}
+      });
+    }
+  }
+  return fingerprints;
+}
+
+/**
+ * Remove all cached audio fingerprints.
+ */
+void Kid3Application::clearFingerprintCache()
+{
+  FingerprintCache::instance().clear();
+}
+
 /**
  * Get the selected file.
  *
@@ -3486,6 +4042,8 @@ void Kid3Application::setAllFilesFileFilter() {
  */
 void Kid3Application::notifyConfigurationChange()
 {
+  TaggedFile::invalidateAllFrameCaches();
+  m_renamePreviewModel->clear();
   const auto factories = FileProxyModel::taggedFileFactories();
   for (ITaggedFileFactory* factory : factories) {
     const auto keys = factory->taggedFileKeys();
@@ -3534,8 +4092,10 @@ void Kid3Application::convertToId3v24()
         bool renamed;
         int storedFeatures = taggedFile->activeTaggedFileFeatures();
         taggedFile->setActiveTaggedFileFeatures(TaggedFile::TF_ID3v24);
-        taggedFile->writeTags(true, &renamed,
-                              FileConfig::instance().preserveTime());
+        if (taggedFile->writeTags(true, &renamed,
+                                  FileConfig::instance().preserveTime())) {
+          taggedFile->markTagsWritten();
+        }
         taggedFile->setActiveTaggedFileFeatures(storedFeatures);
         taggedFile->readTags(true);
       }
@@ -3585,8 +4145,10 @@ void Kid3Application::convertToId3v23()
         bool renamed;
         int storedFeatures = taggedFile->activeTaggedFileFeatures();
         taggedFile->setActiveTaggedFileFeatures(TaggedFile::TF_ID3v23);
-        taggedFile->writeTags(true, &renamed,
-                              FileConfig::instance().preserveTime());
+        if (taggedFile->writeTags(true, &renamed,
+                                  FileConfig::instance().preserveTime())) {
+          taggedFile->markTagsWritten();
+        }
         taggedFile->setActiveTaggedFileFeatures(storedFeatures);
         taggedFile->readTags(true);
       }
@@ -3595,6 +4157,162 @@ void Kid3Application::convertToId3v23()
   emit selectedFilesUpdated();
 }
 
+/**
+ * Resize the pictures of the selected files which are larger than a given
+ * size.
+ * Identical pictures are decoded and scaled only once, the unique pictures
+ * are scaled in parallel on worker threads, and the result is set in all
+ * files containing the picture. The files are not saved. To limit the
+ * memory used, the files are processed in batches whose unique pictures
+ * have a total size of at most MAX_PENDING_PICTURE_BYTES.
+ * longRunningOperationProgress() is emitted while scaling pictures.
+ *
+ * @param maxSize maximum width and height in pixels
+ *
+ * @return number of files with resized pictures.
+ */
+int Kid3Application::normalizeAlbumArt(int maxSize)
+{
+  TraceSpan span("Kid3Application::normalizeAlbumArt");
+  if (maxSize <= 0)
+    return 0;
+
+  emit fileSelectionUpdateRequested();
+
+  int totalFiles = 0;
+  SelectedTaggedFileIterator countIt(getRootIndex(),
+                                     getFileSelectionModel(),
+                                     true);
+  while (countIt.hasNext()) {
+    countIt.next();
+    ++totalFiles;
+  }
+  const QString operationName = tr("Resizing pictures...");
+  bool aborted = false;
+  emit longRunningOperationProgress(operationName, -1, totalFiles, &aborted);
+
+  // Collect the unique pictures, pictureIndexes maps the data to the index
+  // in scaledPictures, or -1 for pictures which are small enough.
+  QHash<QByteArray, int> pictureIndexes;
+  QVector<QByteArray> scaledPictures;
+  QList<QPersistentModelIndex> filesWithPictures;
+  qint64 pendingBytes = 0;
+  int numFilesDone = 0;
+  int numFiles = 0;
+  SelectedTaggedFileIterator it(getRootIndex(),
+                                getFileSelectionModel(),
+                                true);
+  while (!aborted) {
+    TaggedFile* taggedFile = it.hasNext()
+        ? FileProxyModel::readTagsFromTaggedFile(it.next()) : nullptr;
+    if (taggedFile) {
+      ++numFilesDone;
+      const FrameCollection& frames =
+          taggedFile->getAllFramesCached(Frame::Tag_Picture);
+      bool hasPicturesToScale = false;
+      for (auto frameIt = frames.findByExtendedType(
+             Frame::ExtendedType(Frame::FT_Picture));
+           frameIt != frames.cend() &&
+           frameIt->getType() == Frame::FT_Picture;
+           ++frameIt) {
+        QByteArray data;
+        if (!PictureFrame::getData(*frameIt, data) || data.isEmpty())
+          continue;
+
+        auto idxIt = pictureIndexes.constFind(data);
+        if (idxIt == pictureIndexes.constEnd()) {
+          // The dimensions can be found in the header for the common
+          // formats, so that pictures which are small enough are not
+          // decoded at all.
+          int idx = -1;
+          if (PictureFrame::ImageProperties imgProps(data);
+              imgProps.isNull() ||
+              imgProps.width() > maxSize || imgProps.height() > maxSize) {
+            idx = scaledPictures.size();
+            scaledPictures.append(data);
+            pendingBytes += data.size();
+          }
+          idxIt = pictureIndexes.insert(data, idx);
+        }
+        if (*idxIt != -1) {
+          hasPicturesToScale = true;
+        }
+      }
+      if (hasPicturesToScale) {
+        filesWithPictures.append(taggedFile->getIndex());
+      }
+      if (pendingBytes < MAX_PENDING_PICTURE_BYTES)
+        continue;
+    }
+
+    // Scale the collected pictures and set them in the files.
+    QThreadPool pool;
+    QAtomicInt numScaled;
+    for (QByteArray& data : scaledPictures) {
+      pool.start(new PictureScaler(m_platformTools, data, maxSize,
+                                   numScaled));
+    }
+    while (!pool.waitForDone(100)) {
+      emit longRunningOperationProgress(operationName, numFilesDone,
+                                        totalFiles, &aborted);
+      if (aborted) {
+        pool.clear();
+        pool.waitForDone();
+        break;
+      }
+    }
+    if (aborted)
+      break;
+
+    for (const QPersistentModelIndex& index :
+         std::as_const(filesWithPictures)) {
+      TaggedFile* fileWithPictures =
+          FileProxyModel::getTaggedFileOfIndex(index);
+      if (!fileWithPictures)
+        continue;
+
+      // Copy the frames, the cached frames are invalidated by setFrame().
+      const FrameCollection frames(
+            fileWithPictures->getAllFramesCached(Frame::Tag_Picture));
+      bool changed = false;
+      for (auto frameIt = frames.findByExtendedType(
+             Frame::ExtendedType(Frame::FT_Picture));
+           frameIt != frames.cend() &&
+           frameIt->getType() == Frame::FT_Picture;
+           ++frameIt) {
+        QByteArray data;
+        if (!PictureFrame::getData(*frameIt, data))
+          continue;
+
+        if (int idx = pictureIndexes.value(data, -1); idx != -1) {
+          if (const QByteArray& scaledData = scaledPictures.at(idx);
+              !scaledData.isEmpty()) {
+            Frame frame(*frameIt);
+            PictureFrame::setData(frame, scaledData);
+            fileWithPictures->setFrame(Frame::Tag_Picture, frame);
+            changed = true;
+          }
+        }
+      }
+      if (changed) {
+        ++numFiles;
+      }
+    }
+    pictureIndexes.clear();
+    scaledPictures.clear();
+    filesWithPictures.clear();
+    pendingBytes = 0;
+    emit longRunningOperationProgress(operationName, numFilesDone,
+                                      totalFiles, &aborted);
+    if (!taggedFile)
+      break;
+  }
+  emit longRunningOperationProgress(operationName, totalFiles, totalFiles,
+                                    &aborted);
+  emit selectedFilesUpdated();
+  return numFiles;
+}
+
 /**
  * Get value of frame.
  * To get binary data like a picture, the name of a file to write can be
@@ -4150,6 +4868,16 @@ void Kid3Application::setCoverArtImageData(const QByteArray& picture)
   }
 }
 
+/**
+ * Change the coverArtImageId property, so that QML images request the
+ * picture again, e.g. when it has been decoded in the background.
+ */
+void Kid3Application::reloadCoverArtImage()
+{
+  setNextCoverArtImageId();
+  emit coverArtImageIdChanged(m_coverArtImageId);
+}
+
 /**
  * Set the coverArtImageId property to a new value.
  * This can be used to trigger an update of QML images.
@@ -71,6 +71,8 @@ class ICorePlatformTools;
 class IUserCommandProcessor;
 class ImageDataProvider;
 class FileFilter;
+class RenamePreviewModel;
+class DuplicateModel;
 
 /**
  * Kid3 application logic, independent of GUI.
@@ -249,10 +251,10 @@ public:
   ISettings* getSettings() const;
 
   /**
-   * Get download client.
+   * Get download client, it is created on first use.
    * @return download client.
    */
-  DownloadClient* getDownloadClient() { return m_downloadClient; }
+  DownloadClient* getDownloadClient();
 
   /**
    * Get text exporter.
@@ -264,7 +266,7 @@ public:
    * Get available server importers.
    * @return list of server importers.
    */
-  QList<ServerImporter*> getServerImporters() { return m_importers; }
+  QList<ServerImporter*> getServerImporters();
 
   /**
    * Get names of available server track importers.
@@ -276,17 +278,13 @@ public:
    * Get available server track importers.
    * @return list of server track importers.
    */
-  QList<ServerTrackImporter*> getServerTrackImporters() {
-    return m_trackImporters;
-  }
+  QList<ServerTrackImporter*> getServerTrackImporters();
 
   /**
    * Get available user command processors.
    * @return list of user command processors.
    */
-  QList<IUserCommandProcessor*> getUserCommandProcessors() {
-    return m_userCommandProcessors;
-  }
+  QList<IUserCommandProcessor*> getUserCommandProcessors();
 
   /**
    * Get tag searcher.
@@ -301,10 +299,22 @@ public:
   DirRenamer* getDirRenamer() { return m_dirRenamer; }
 
   /**
-   * Get batch importer.
+   * Get preview of file names generated from tags.
+   * @return rename preview model, filled by previewFilenameFromTags().
+   */
+  RenamePreviewModel* getRenamePreviewModel() { return m_renamePreviewModel; }
+
+  /**
+   * Get groups of duplicate files.
+   * @return duplicate model, filled by findDuplicates().
+   */
+  DuplicateModel* getDuplicateModel() { return m_duplicateModel; }
+
+  /**
+   * Get batch importer, it is created on first use.
    * @return batch importer.
    */
-  BatchImporter* getBatchImporter() { return m_batchImporter; }
+  BatchImporter* getBatchImporter();
 
   /**
    * Get audio player.
@@ -422,6 +432,28 @@ public:
    */
   Q_INVOKABLE QStringList saveDirectory();
 
+  /**
+   * Write the tags of a file.
+   * Illegal characters in a new file name are replaced. If the file shall be
+   * renamed to a file name which already exists, a number is appended to the
+   * file name.
+   *
+   * @param taggedFile tagged file
+   * @param errorDescription if not NULL, a description of the error is
+   * returned here, a null string if no description is available
+   *
+   * @return true if ok.
+   */
+  static bool writeTaggedFile(TaggedFile* taggedFile,
+                              QString* errorDescription = nullptr);
+
+  /**
+   * Get description of an error number.
+   * @param errorNumber errno value
+   * @return description, null string if @a errorNumber is 0 or unknown.
+   */
+  static QString errorNumberDescription(int errorNumber);
+
   /**
    * Merge entries of two string lists.
    *
@@ -478,6 +510,21 @@ public:
   Q_INVOKABLE bool importTags(Frame::TagVersion tagMask, const QString& path,
                               int fmtIdx);
 
+  /**
+   * Import a tag table exported as CSV or JSON, e.g. with the ExportCsv or
+   * ExportJson script.
+   * The rows are assigned to the files of all loaded folders using the
+   * "File Path" column, if no file is found, they are assigned to the files
+   * of the current folder in their order.
+   *
+   * @param tagMask tag mask
+   * @param path    path of CSV or JSON file
+   *
+   * @return true if ok.
+   */
+  Q_INVOKABLE bool importTagTable(Frame::TagVersion tagMask,
+                                  const QString& path);
+
   /**
    * Import from tags.
    *
@@ -814,6 +861,19 @@ public:
    */
   int filterTotalCount() const { return m_filterTotal; }
 
+  /**
+   * Get number of files with tags in memory.
+   * @return number of files with tags read.
+   */
+  Q_INVOKABLE int residentTaggedFileCount() const;
+
+  /**
+   * Get number of files whose tags have been freed because more files than
+   * configured in FileConfig::maxResidentTagFiles() had their tags in memory.
+   * @return number of evicted files since the folder was opened.
+   */
+  Q_INVOKABLE int evictedTaggedFileCount() const;
+
   /**
    * Get height of status bar on Android.
    * @return height of status bar in density-independent pixels.
@@ -911,6 +971,12 @@ public:
    */
   Q_INVOKABLE void setCoverArtImageData(const QByteArray& picture);
 
+  /**
+   * Change the coverArtImageId property, so that QML images request the
+   * picture again, e.g. when it has been decoded in the background.
+   */
+  void reloadCoverArtImage();
+
   /**
    * Open a file select dialog to get a file name.
    * For script support, is only supported when a GUI is available.
@@ -961,9 +1027,11 @@ public:
 
   /**
    * Load plugins.
+   * @param deferredPluginFiles if not null, importer and user command plugins
+   * are not loaded, their paths are added to this list instead
    * @return list of plugin instances.
    */
-  static QObjectList loadPlugins();
+  static QObjectList loadPlugins(QStringList* deferredPluginFiles = nullptr);
 
 public slots:
   /**
@@ -1028,6 +1096,21 @@ public slots:
    */
   void convertToId3v23();
 
+  /**
+   * Resize the pictures of the selected files which are larger than a given
+   * size.
+   * Identical pictures are decoded and scaled only once, the unique pictures
+   * are scaled in parallel on worker threads, and the result is set in all
+   * files containing the picture. The files are not saved. To limit the
+   * memory used, the files are processed in batches.
+   * longRunningOperationProgress() is emitted while scaling pictures.
+   *
+   * @param maxSize maximum width and height in pixels
+   *
+   * @return number of files with resized pictures.
+   */
+  int normalizeAlbumArt(int maxSize = 500);
+
   /**
    * Copy tags into copy buffer.
    *
@@ -1079,6 +1162,47 @@ public slots:
    */
   void getFilenameFromTags(Frame::TagVersion tagVersion);
 
+  /**
+   * Generate the file names which getFilenameFromTags() would set without
+   * changing the files.
+   * The result is available in getRenamePreviewModel() and is reused by
+   * getFilenameFromTags() for files whose tags have not been changed since.
+   *
+   * @param tagVersion tag version
+   *
+   * @return number of files which would be renamed.
+   */
+  int previewFilenameFromTags(Frame::TagVersion tagVersion);
+
+  /**
+   * Find files in the selection which are probably duplicates because they
+   * have the same artist and title and similar durations.
+   * If no files are selected, all files are checked.
+   * The result is available in getDuplicateModel().
+   * longRunningOperationProgress() is emitted while reading the files.
+   *
+   * @param maxDurationDifference maximum difference of the durations in
+   * seconds of files in a group
+   *
+   * @return number of groups of duplicates.
+   */
+  Q_INVOKABLE int findDuplicates(int maxDurationDifference = 2);
+
+  /**
+   * Get the cached audio fingerprints of the selected files.
+   * If no files are selected, all files are used. Only files which have not
+   * changed since their fingerprint was calculated by an AcoustID import
+   * are returned.
+   *
+   * @return list of maps with "filePath", "duration" and "fingerprint".
+   */
+  Q_INVOKABLE QVariantList getCachedFingerprints();
+
+  /**
+   * Remove all cached audio fingerprints.
+   */
+  Q_INVOKABLE void clearFingerprintCache();
+
   /**
    * Edit selected frame.
    * @param tagNr tag number
@@ -1512,6 +1636,12 @@ private slots:
    */
   void onDirectoryLoaded();
 
+  /**
+   * Free the tags of the least recently used files which are not selected
+   * when too many files have their tags in memory.
+   */
+  void evictTags();
+
   /**
    * Called when a frame is edited.
    * @param frame edited frame, 0 if canceled
@@ -1558,6 +1688,17 @@ private:
    */
   void checkPlugin(QObject* plugin);
 
+  /**
+   * Load the plugins which have been deferred by initPlugins().
+   */
+  void loadDeferredPlugins();
+
+  /**
+   * Get network access manager, it is created on first use.
+   * @return network access manager.
+   */
+  QNetworkAccessManager* networkAccessManager();
+
   /**
    * Update frame models to contain contents of selected files.
    * @param indexes tagged file indexes
@@ -1629,6 +1770,10 @@ private:
   TagSearcher* m_tagSearcher;
   /** Directory renamer */
   DirRenamer* m_dirRenamer;
+  /** Preview of file names generated from tags */
+  RenamePreviewModel* m_renamePreviewModel;
+  /** Groups of duplicate files */
+  DuplicateModel* m_duplicateModel;
   /** Batch importer */
   BatchImporter* m_batchImporter;
   /** Audio player */
@@ -1655,6 +1800,8 @@ private:
   QList<ServerTrackImporter*> m_trackImporters;
   /** Processors for user commands */
   QList<IUserCommandProcessor*> m_userCommandProcessors;
+  /** Paths of plugins which are loaded when they are used */
+  QStringList m_deferredPluginFiles;
   /** Current directory */
   QString m_dirName;
   /** Stored current selection with the list of all selected items */
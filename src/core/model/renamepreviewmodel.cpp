@@ -0,0 +1,374 @@
+/**
+ * \file renamepreviewmodel.cpp
+ * Preview of file names generated from tags.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "renamepreviewmodel.h"
+#include <QRunnable>
+#include <QDir>
+#include <QVariantMap>
+#include "taggedfile.h"
+#include "trackdata.h"
+#include "formatconfig.h"
+#include "performancetracer.h"
+#include "threadpooljobs.h"
+
+namespace {
+
+/**
+ * Job generating the file names of a range of files.
+ * Only the track data detached from the tagged files is used, so that
+ * neither the model nor the tagged files are accessed from the worker
+ * threads.
+ */
+class FilenameGenerator : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param trackDataVector track data detached from the tagged files
+   * @param newNames generated file names are stored here, must have the
+   * same size as @a trackDataVector
+   * @param begin index of first file to process
+   * @param end index after last file to process
+   * @param format file name format
+   * @param fnCfg file name format configuration
+   */
+  FilenameGenerator(const QVector<TrackData>& trackDataVector,
+                    QString* newNames, int begin, int end,
+                    const QString& format, const FormatConfig& fnCfg)
+    : m_trackDataVector(trackDataVector), m_newNames(newNames),
+      m_begin(begin), m_end(end), m_format(format), m_fnCfg(fnCfg) {
+  }
+
+  /**
+   * Generate the file names.
+   */
+  void run() override {
+    for (int i = m_begin; i < m_end; ++i) {
+      m_newNames[i] = RenamePreviewModel::filenameFromTrackData(
+            m_trackDataVector.at(i), m_format, m_fnCfg);
+    }
+  }
+
+private:
+  const QVector<TrackData>& m_trackDataVector;
+  QString* m_newNames;
+  int m_begin;
+  int m_end;
+  QString m_format;
+  const FormatConfig& m_fnCfg;
+};
+
+}
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+RenamePreviewModel::RenamePreviewModel(QObject* parent)
+  : QAbstractTableModel(parent), m_tagVersion(Frame::TagNone)
+{
+  setObjectName(QLatin1String("RenamePreviewModel"));
+}
+
+/**
+ * Get item flags for index.
+ * @param index model index
+ * @return item flags
+ */
+Qt::ItemFlags RenamePreviewModel::flags(const QModelIndex& index) const
+{
+  if (index.isValid())
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+  return QAbstractTableModel::flags(index);
+}
+
+/**
+ * Get data for a given role.
+ * @param index model index
+ * @param role item data role
+ * @return data for role
+ */
+QVariant RenamePreviewModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid() ||
+      index.row() < 0 || index.row() >= m_entries.size() ||
+      index.column() < 0 || index.column() >= CI_NumColumns)
+    return QVariant();
+  const Entry& entry = m_entries.at(index.row());
+  if (role == Qt::DisplayRole || role == Qt::EditRole) {
+    if (index.column() == CI_OldName) {
+      return entry.oldName;
+    }
+    return entry.newName.isNull() ? entry.oldName : entry.newName;
+  }
+  if (role == Qt::ToolTipRole) {
+    return entry.dirName;
+  }
+  if (role == Qt::CheckStateRole && index.column() == CI_NewName) {
+    // Mark the files which will be renamed.
+    return !entry.newName.isNull() && entry.newName != entry.oldName
+        ? Qt::Checked : Qt::Unchecked;
+  }
+  return QVariant();
+}
+
+/**
+ * Get data for header section.
+ * @param section column or row
+ * @param orientation horizontal or vertical
+ * @param role item data role
+ * @return header data for role
+ */
+QVariant RenamePreviewModel::headerData(
+    int section, Qt::Orientation orientation, int role) const
+{
+  if (role != Qt::DisplayRole)
+    return QVariant();
+  if (orientation == Qt::Horizontal) {
+    switch (section) {
+    case CI_OldName:
+      return tr("Old Name");
+    case CI_NewName:
+      return tr("New Name");
+    default:
+      return section + 1;
+    }
+  }
+  return section + 1;
+}
+
+/**
+ * Get number of rows.
+ * @param parent parent model index, invalid for table models
+ * @return number of rows,
+ * if parent is valid number of children (0 for table models)
+ */
+int RenamePreviewModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : static_cast<int>(m_entries.size());
+}
+
+/**
+ * Get number of columns.
+ * @param parent parent model index, invalid for table models
+ * @return number of columns,
+ * if parent is valid number of children (0 for table models)
+ */
+int RenamePreviewModel::columnCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : CI_NumColumns;
+}
+
+/**
+ * Generate new file names from the tags of files.
+ * The tags of the files must have been read.
+ * @param taggedFiles tagged files
+ * @param tagVersion tag version
+ * @param format file name format
+ */
+void RenamePreviewModel::setFilenamesFromTags(
+    const QList<TaggedFile*>& taggedFiles, Frame::TagVersion tagVersion,
+    const QString& format)
+{
+  TraceSpan span("RenamePreviewModel::setFilenamesFromTags");
+  const int numFiles = static_cast<int>(taggedFiles.size());
+  // Everything depending on the model, the tagged files or the configuration
+  // is resolved in this thread, the jobs only get the detached track data.
+  const FormatConfig& fnCfg = FilenameFormatConfig::instance();
+  QVector<TrackData> trackDataVector;
+  trackDataVector.reserve(numFiles);
+  QHash<QString, int> numTracksOfDir;
+  for (TaggedFile* taggedFile : taggedFiles) {
+    const QString dirName = taggedFile->getDirname();
+    auto it = numTracksOfDir.constFind(dirName);
+    if (it == numTracksOfDir.constEnd()) {
+      it = numTracksOfDir.insert(dirName,
+                                 taggedFile->getTotalNumberOfTracksInDir());
+    }
+    trackDataVector.append(TrackData(*taggedFile, tagVersion));
+    trackDataVector.last().detachFromTaggedFile(*it);
+  }
+
+  const QVector<QString> newNames =
+      filenamesFromTrackData(trackDataVector, format, fnCfg);
+
+  beginResetModel();
+  m_entries.clear();
+  m_rowOfFile.clear();
+  m_entries.reserve(numFiles);
+  m_rowOfFile.reserve(numFiles);
+  for (int i = 0; i < numFiles; ++i) {
+    TaggedFile* taggedFile = taggedFiles.at(i);
+    m_rowOfFile.insert(taggedFile, i);
+    m_entries.append({taggedFile, taggedFile->getTagChangeCount(),
+                      taggedFile->getDirname(), taggedFile->getFilename(),
+                      newNames.at(i)});
+  }
+  m_tagVersion = tagVersion;
+  m_format = format;
+  endResetModel();
+}
+
+/**
+ * Get file name generated by setFilenamesFromTags() if it is still valid.
+ * @param taggedFile tagged file
+ * @param tagVersion tag version
+ * @param format file name format
+ * @param newName the new file name is returned here, null if the file
+ * shall not be renamed because its tags are empty
+ * @return true if a valid file name was found.
+ */
+bool RenamePreviewModel::findFilename(
+    TaggedFile* taggedFile, Frame::TagVersion tagVersion,
+    const QString& format, QString& newName) const
+{
+  if (tagVersion != m_tagVersion || format != m_format)
+    return false;
+
+  if (auto it = m_rowOfFile.constFind(taggedFile);
+      it != m_rowOfFile.constEnd()) {
+    // The file name is compared too, the tagged file could have been deleted
+    // and another one allocated at the same address. No persistent index is
+    // kept for the entries, the model would have to update them on every
+    // change of its rows.
+    if (const Entry& entry = m_entries.at(*it);
+        entry.tagChangeCount == taggedFile->getTagChangeCount() &&
+        entry.oldName == taggedFile->getFilename() &&
+        entry.dirName == taggedFile->getDirname()) {
+      newName = entry.newName;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Get number of files which would be renamed.
+ * @return number of changed file names.
+ */
+int RenamePreviewModel::changedCount() const
+{
+  int count = 0;
+  for (const Entry& entry : m_entries) {
+    if (!entry.newName.isNull() && entry.newName != entry.oldName) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * Get the changed file names.
+ * @return list of maps with "source" and "destination" file paths.
+ */
+QVariantList RenamePreviewModel::changes() const
+{
+  QVariantList result;
+  for (const Entry& entry : m_entries) {
+    if (!entry.newName.isNull() && entry.newName != entry.oldName) {
+      QDir dir(entry.dirName);
+      result.append(QVariantMap{
+        {QLatin1String("source"), dir.filePath(entry.oldName)},
+        {QLatin1String("destination"), dir.filePath(entry.newName)}
+      });
+    }
+  }
+  return result;
+}
+
+/**
+ * Remove all entries.
+ */
+void RenamePreviewModel::clear()
+{
+  if (!m_entries.isEmpty()) {
+    beginResetModel();
+    m_entries.clear();
+    m_rowOfFile.clear();
+    endResetModel();
+  }
+  m_tagVersion = Frame::TagNone;
+  m_format.clear();
+}
+
+/**
+ * Generate a file name from the tags of a file.
+ * Has to be called in the thread of the model.
+ * @param taggedFile tagged file, its tags must have been read
+ * @param tagVersion tag version
+ * @param format file name format
+ * @return new file name, null if the tags are empty.
+ */
+QString RenamePreviewModel::filenameFromTags(
+    TaggedFile* taggedFile, Frame::TagVersion tagVersion,
+    const QString& format)
+{
+  return filenameFromTrackData(TrackData(*taggedFile, tagVersion), format,
+                               FilenameFormatConfig::instance());
+}
+
+/**
+ * Generate file names from track data.
+ * Large numbers of files are processed in parallel jobs.
+ * @param trackDataVector track data detached from the tagged files
+ * @param format file name format
+ * @param fnCfg file name format configuration
+ * @return new file names, null for files with empty tags.
+ */
+QVector<QString> RenamePreviewModel::filenamesFromTrackData(
+    const QVector<TrackData>& trackDataVector, const QString& format,
+    const FormatConfig& fnCfg)
+{
+  QVector<QString> newNames(trackDataVector.size());
+  Utils::runJobs(static_cast<int>(trackDataVector.size()),
+                 [&](int begin, int end) {
+    return new FilenameGenerator(trackDataVector, newNames.data(), begin, end,
+                                 format, fnCfg);
+  });
+  return newNames;
+}
+
+/**
+ * Generate a file name from track data.
+ * Can be called from any thread if the track data has been detached from
+ * its tagged file.
+ * @param trackData track data
+ * @param format file name format
+ * @param fnCfg file name format configuration
+ * @return new file name, null if the tags are empty.
+ */
+QString RenamePreviewModel::filenameFromTrackData(
+    const TrackData& trackData, const QString& format,
+    const FormatConfig& fnCfg)
+{
+  if (trackData.isEmptyOrInactive())
+    return QString();
+
+  QString fn = trackData.formatFilenameFromTags(format);
+  if (fnCfg.formatWhileEditing()) {
+    fnCfg.formatString(fn);
+  }
+  return fn;
+}
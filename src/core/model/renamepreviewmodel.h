@@ -0,0 +1,201 @@
+/**
+ * \file renamepreviewmodel.h
+ * Preview of file names generated from tags.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QHash>
+#include <QVariantList>
+#include "frame.h"
+#include "kid3api.h"
+
+class TaggedFile;
+class TrackData;
+class FormatConfig;
+
+/**
+ * Preview of file names generated from tags.
+ *
+ * The new names are generated in parallel and kept together with the change
+ * counter of the tags, so that they can be applied without generating them
+ * again as long as the tags and the format are not changed.
+ */
+class KID3_CORE_EXPORT RenamePreviewModel : public QAbstractTableModel {
+  Q_OBJECT
+public:
+  /** Column indexes. */
+  enum ColumnIndex {
+    CI_OldName,   /**< Current file name */
+    CI_NewName,   /**< File name generated from tags */
+    CI_NumColumns /**< Number of columns */
+  };
+
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit RenamePreviewModel(QObject* parent = nullptr);
+
+  /**
+   * Destructor.
+   */
+  ~RenamePreviewModel() override = default;
+
+  /**
+   * Get item flags for index.
+   * @param index model index
+   * @return item flags
+   */
+  Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+  /**
+   * Get data for a given role.
+   * @param index model index
+   * @param role item data role
+   * @return data for role
+   */
+  QVariant data(const QModelIndex& index,
+                int role = Qt::DisplayRole) const override;
+
+  /**
+   * Get data for header section.
+   * @param section column or row
+   * @param orientation horizontal or vertical
+   * @param role item data role
+   * @return header data for role
+   */
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+  /**
+   * Get number of rows.
+   * @param parent parent model index, invalid for table models
+   * @return number of rows,
+   * if parent is valid number of children (0 for table models)
+   */
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+  /**
+   * Get number of columns.
+   * @param parent parent model index, invalid for table models
+   * @return number of columns,
+   * if parent is valid number of children (0 for table models)
+   */
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+  /**
+   * Generate new file names from the tags of files.
+   * The tags of the files must have been read.
+   * @param taggedFiles tagged files
+   * @param tagVersion tag version
+   * @param format file name format
+   */
+  void setFilenamesFromTags(const QList<TaggedFile*>& taggedFiles,
+                            Frame::TagVersion tagVersion,
+                            const QString& format);
+
+  /**
+   * Get file name generated by setFilenamesFromTags() if it is still valid.
+   * @param taggedFile tagged file
+   * @param tagVersion tag version
+   * @param format file name format
+   * @param newName the new file name is returned here, null if the file
+   * shall not be renamed because its tags are empty
+   * @return true if a valid file name was found.
+   */
+  bool findFilename(TaggedFile* taggedFile, Frame::TagVersion tagVersion,
+                    const QString& format, QString& newName) const;
+
+  /**
+   * Get number of files which would be renamed.
+   * @return number of changed file names.
+   */
+  int changedCount() const;
+
+  /**
+   * Get the changed file names.
+   * @return list of maps with "source" and "destination" file paths.
+   */
+  QVariantList changes() const;
+
+  /**
+   * Remove all entries.
+   */
+  void clear();
+
+  /**
+   * Generate a file name from the tags of a file.
+   * Has to be called in the thread of the model.
+   * @param taggedFile tagged file, its tags must have been read
+   * @param tagVersion tag version
+   * @param format file name format
+   * @return new file name, null if the tags are empty.
+   */
+  static QString filenameFromTags(TaggedFile* taggedFile,
+                                  Frame::TagVersion tagVersion,
+                                  const QString& format);
+
+  /**
+   * Generate file names from track data.
+   * Large numbers of files are processed in parallel jobs.
+   * @param trackDataVector track data detached from the tagged files
+   * @param format file name format
+   * @param fnCfg file name format configuration
+   * @return new file names, null for files with empty tags.
+   */
+  static QVector<QString> filenamesFromTrackData(
+      const QVector<TrackData>& trackDataVector, const QString& format,
+      const FormatConfig& fnCfg);
+
+  /**
+   * Generate a file name from track data.
+   * Can be called from any thread if the track data has been detached from
+   * its tagged file.
+   * @param trackData track data
+   * @param format file name format
+   * @param fnCfg file name format configuration
+   * @return new file name, null if the tags are empty.
+   */
+  static QString filenameFromTrackData(const TrackData& trackData,
+                                       const QString& format,
+                                       const FormatConfig& fnCfg);
+
+private:
+  /** Preview of a file. */
+  struct Entry {
+    TaggedFile* taggedFile;        /**< tagged file */
+    uint tagChangeCount;           /**< tag change counter of tagged file */
+    QString dirName;               /**< directory name */
+    QString oldName;               /**< current file name */
+    QString newName;               /**< generated file name */
+  };
+
+  QVector<Entry> m_entries;
+  QHash<TaggedFile*, int> m_rowOfFile;
+  Frame::TagVersion m_tagVersion;
+  QString m_format;
+};
@@ -0,0 +1,469 @@
+/**
+ * \file taggedfilecolumnstore.cpp
+ * Column store with values of tagged files displayed in the file list.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "taggedfilecolumnstore.h"
+#include <QCollator>
+#include <algorithm>
+#include <utility>
+#include "taggedfile.h"
+#include "performancetracer.h"
+
+namespace {
+
+/** Minimum number of interned values before unused values are pruned. */
+constexpr int MIN_PRUNE_LIMIT = 4096;
+
+}
+
+/**
+ * Constructor.
+ * @param frameTypes types of the frames stored, one column per frame type
+ */
+TaggedFileColumnStore::TaggedFileColumnStore(
+    const QList<Frame::Type>& frameTypes)
+  : m_frameTypes(frameTypes),
+    m_frameValueIds(static_cast<int>(frameTypes.size())),
+    m_pruneLimit(MIN_PRUNE_LIMIT),
+    m_lruHead(-1), m_lruTail(-1), m_numResidentRows(0)
+{
+}
+
+/**
+ * Add a row for a tagged file.
+ * @param taggedFile tagged file, can be null
+ * @return row.
+ */
+int TaggedFileColumnStore::addRow(TaggedFile* taggedFile)
+{
+  int row;
+  if (!m_freeRows.isEmpty()) {
+    row = m_freeRows.takeLast();
+    m_taggedFiles[row] = taggedFile;
+    m_flags[row] = 0;
+  } else {
+    row = m_taggedFiles.size();
+    m_taggedFiles.append(taggedFile);
+    m_tagChangeCounts.append(0);
+    m_flags.append(0);
+    m_lruNewer.append(-2);
+    m_lruOlder.append(-2);
+    for (auto& ids : m_frameValueIds) {
+      ids.append(-1);
+    }
+  }
+  return row;
+}
+
+/**
+ * Remove a row, the tagged file is not deleted.
+ * @param row row returned by addRow()
+ */
+void TaggedFileColumnStore::removeRow(int row)
+{
+  removeResidentRow(row);
+  m_taggedFiles[row] = nullptr;
+  m_flags[row] = 0;
+  for (auto& ids : m_frameValueIds) {
+    ids[row] = -1;
+  }
+  m_freeRows.append(row);
+}
+
+/**
+ * Replace the tagged file of a row, the old tagged file is not deleted.
+ * @param row row returned by addRow()
+ * @param taggedFile tagged file, can be null
+ */
+void TaggedFileColumnStore::setTaggedFile(int row, TaggedFile* taggedFile)
+{
+  removeResidentRow(row);
+  m_taggedFiles[row] = taggedFile;
+  m_flags[row] = 0;
+}
+
+/**
+ * Get all tagged files in the store.
+ * @return tagged files, can contain null pointers.
+ */
+QVector<TaggedFile*> TaggedFileColumnStore::taggedFiles() const
+{
+  return m_taggedFiles;
+}
+
+/**
+ * Remove all rows, the tagged files are not deleted.
+ */
+void TaggedFileColumnStore::clear()
+{
+  m_taggedFiles.clear();
+  m_tagChangeCounts.clear();
+  m_flags.clear();
+  m_lruNewer.clear();
+  m_lruOlder.clear();
+  m_lruHead = -1;
+  m_lruTail = -1;
+  m_numResidentRows = 0;
+  for (auto& ids : m_frameValueIds) {
+    ids.clear();
+  }
+  m_freeRows.clear();
+  m_strings.clear();
+  m_stringIds.clear();
+  m_ranks.clear();
+  m_sortedIds.clear();
+  m_equalToPrevious.clear();
+  m_pruneLimit = MIN_PRUNE_LIMIT;
+}
+
+/**
+ * Get flags of a row.
+ * The file is not read to get the flags. If the tags of the tagged file
+ * have not been read, only the summary of evicted tags is available.
+ * @param row row returned by addRow()
+ * @return combination of Flag values, 0 if the tags have not been read
+ * and no summary is available.
+ */
+int TaggedFileColumnStore::flags(int row)
+{
+  const TaggedFile* taggedFile = m_taggedFiles.at(row);
+  if (!taggedFile)
+    return 0;
+
+  if (!taggedFile->isTagInformationRead()) {
+    return (m_flags.at(row) & Evicted) ? m_flags.at(row) : 0;
+  }
+  updateRowIfChanged(row);
+  return m_flags.at(row);
+}
+
+/**
+ * Get ID of frame value.
+ * @param row row returned by addRow()
+ * @param column column of frame type
+ * @return ID of interned value, -1 if the frame does not exist.
+ */
+int TaggedFileColumnStore::frameValueId(int row, int column)
+{
+  updateRowIfChanged(row);
+  return m_frameValueIds.at(column).at(row);
+}
+
+/**
+ * Get frame value.
+ * @param row row returned by addRow()
+ * @param column column of frame type
+ * @return value, null if the frame does not exist.
+ */
+QString TaggedFileColumnStore::frameValue(int row, int column)
+{
+  int id = frameValueId(row, column);
+  return id >= 0 ? m_strings.at(id) : QString();
+}
+
+/**
+ * Get sort rank of frame value.
+ * Values are compared case insensitively with numbers in numeric order,
+ * frames which do not exist are ranked first.
+ * @param row row returned by addRow()
+ * @param column column of frame type
+ * @return rank, -1 if the frame does not exist.
+ */
+int TaggedFileColumnStore::frameValueRank(int row, int column)
+{
+  int id = frameValueId(row, column);
+  if (id < 0)
+    return -1;
+
+  if (m_ranks.size() != m_strings.size()) {
+    updateRanks();
+  }
+  return m_ranks.at(id);
+}
+
+/**
+ * Update all rows, so that frameValueRank() can be used without reading
+ * tagged files, e.g. before sorting.
+ */
+void TaggedFileColumnStore::updateAllRows()
+{
+  TraceSpan span("TaggedFileColumnStore::updateAllRows");
+  const int numRows = m_taggedFiles.size();
+  for (int row = 0; row < numRows; ++row) {
+    updateRowIfChanged(row);
+  }
+  if (m_ranks.size() != m_strings.size()) {
+    updateRanks();
+  }
+}
+
+/**
+ * Mark a row as the most recently used row with tags in memory.
+ * @param row row returned by addRow()
+ */
+void TaggedFileColumnStore::touchResidentRow(int row)
+{
+  if (m_lruHead == row)
+    return;
+
+  removeResidentRow(row);
+  m_lruNewer[row] = -1;
+  m_lruOlder[row] = m_lruHead;
+  if (m_lruHead != -1) {
+    m_lruNewer[m_lruHead] = row;
+  } else {
+    m_lruTail = row;
+  }
+  m_lruHead = row;
+  ++m_numResidentRows;
+}
+
+/**
+ * Remove a row from the rows with tags in memory.
+ * @param row row returned by addRow()
+ */
+void TaggedFileColumnStore::removeResidentRow(int row)
+{
+  const int newer = m_lruNewer.at(row);
+  if (newer == -2)
+    return;
+
+  const int older = m_lruOlder.at(row);
+  if (newer != -1) {
+    m_lruOlder[newer] = older;
+  } else {
+    m_lruHead = older;
+  }
+  if (older != -1) {
+    m_lruNewer[older] = newer;
+  } else {
+    m_lruTail = newer;
+  }
+  m_lruNewer[row] = -2;
+  m_lruOlder[row] = -2;
+  --m_numResidentRows;
+}
+
+/**
+ * Keep the current values of a row as a summary when the tags of its
+ * tagged file are evicted. Has to be called before the tags are cleared.
+ * @param row row returned by addRow()
+ */
+void TaggedFileColumnStore::keepSummary(int row)
+{
+  updateRowIfChanged(row);
+  m_flags[row] |= Evicted;
+}
+
+/**
+ * Discard the values of a row, so that they are updated from the tagged
+ * file on the next access, e.g. when the file was modified on disk.
+ * @param row row returned by addRow()
+ */
+void TaggedFileColumnStore::discardValues(int row)
+{
+  m_flags[row] = 0;
+}
+
+/**
+ * Update row if the tags of its tagged file have changed.
+ * @param row row
+ */
+void TaggedFileColumnStore::updateRowIfChanged(int row)
+{
+  if (const TaggedFile* taggedFile = m_taggedFiles.at(row);
+      taggedFile && (!(m_flags.at(row) & Valid) ||
+                     m_tagChangeCounts.at(row) !=
+                     taggedFile->getTagChangeCount())) {
+    if ((m_flags.at(row) & Evicted) && !taggedFile->isTagInformationRead()) {
+      // Keep the summary instead of reading the file again.
+      m_tagChangeCounts[row] = taggedFile->getTagChangeCount();
+    } else {
+      updateRow(row);
+    }
+  }
+}
+
+/**
+ * Update row from its tagged file.
+ * @param row row
+ */
+void TaggedFileColumnStore::updateRow(int row)
+{
+  if (m_strings.size() >= m_pruneLimit) {
+    pruneStrings();
+  }
+  TaggedFile* taggedFile = m_taggedFiles.at(row);
+  const int numColumns = m_frameTypes.size();
+  for (int column = 0; column < numColumns; ++column) {
+    // getFrame() can read the file, so the flags are set afterwards.
+    Frame frame;
+    m_frameValueIds[column][row] =
+        taggedFile->getFrame(Frame::Tag_2, m_frameTypes.at(column), frame)
+        ? intern(frame.getValue()) : -1;
+  }
+
+  quint8 flags = Valid;
+  if (taggedFile->isTagInformationRead()) {
+    flags |= TagInformationRead;
+    if (taggedFile->hasTag(Frame::Tag_1))
+      flags |= HasTag1;
+    if (taggedFile->hasTag(Frame::Tag_2))
+      flags |= HasTag2;
+    if (taggedFile->hasTag(Frame::Tag_3))
+      flags |= HasTag3;
+  }
+  m_flags[row] = flags;
+  m_tagChangeCounts[row] = taggedFile->getTagChangeCount();
+}
+
+/**
+ * Assign sort ranks to the interned values.
+ * Only the values interned since the last call are sorted, they are merged
+ * into the values already sorted using binary searches.
+ */
+void TaggedFileColumnStore::updateRanks()
+{
+  TraceSpan span("TaggedFileColumnStore::updateRanks");
+  QCollator collator;
+  collator.setNumericMode(true);
+  collator.setCaseSensitivity(Qt::CaseInsensitive);
+  auto lessThan = [this, &collator](int lhs, int rhs) {
+    return collator.compare(m_strings.at(lhs), m_strings.at(rhs)) < 0;
+  };
+  const int numStrings = m_strings.size();
+  const int numOldIds = m_sortedIds.size();
+  QVector<int> newIds;
+  newIds.reserve(numStrings - numOldIds);
+  for (int id = numOldIds; id < numStrings; ++id) {
+    newIds.append(id);
+  }
+  std::sort(newIds.begin(), newIds.end(), lessThan);
+
+  QVector<int> sortedIds;
+  QVector<bool> equalToPrevious;
+  sortedIds.reserve(numStrings);
+  equalToPrevious.reserve(numStrings);
+  auto appendId = [this, &collator, &sortedIds, &equalToPrevious](int id) {
+    equalToPrevious.append(
+          !sortedIds.isEmpty() &&
+          collator.compare(m_strings.at(sortedIds.last()),
+                           m_strings.at(id)) == 0);
+    sortedIds.append(id);
+  };
+  auto appendOldIds = [this, &appendId, &sortedIds, &equalToPrevious](
+      int begin, int end) {
+    if (begin < end) {
+      // Only the first value has a new predecessor.
+      appendId(m_sortedIds.at(begin));
+      for (int i = begin + 1; i < end; ++i) {
+        equalToPrevious.append(m_equalToPrevious.at(i));
+        sortedIds.append(m_sortedIds.at(i));
+      }
+    }
+  };
+  int oldPos = 0;
+  for (int id : newIds) {
+    const int insertPos = static_cast<int>(
+          std::upper_bound(m_sortedIds.constBegin() + oldPos,
+                           m_sortedIds.constEnd(), id, lessThan) -
+          m_sortedIds.constBegin());
+    appendOldIds(oldPos, insertPos);
+    appendId(id);
+    oldPos = insertPos;
+  }
+  appendOldIds(oldPos, numOldIds);
+  m_sortedIds.swap(sortedIds);
+  m_equalToPrevious.swap(equalToPrevious);
+
+  // Values which compare equal get the same rank.
+  m_ranks.resize(numStrings);
+  int rank = 0;
+  for (int i = 0; i < numStrings; ++i) {
+    if (i > 0 && !m_equalToPrevious.at(i)) {
+      ++rank;
+    }
+    m_ranks[m_sortedIds.at(i)] = rank;
+  }
+}
+
+/**
+ * Remove interned values which are not used by any row.
+ * The IDs of the remaining values are renumbered, the ranks are assigned
+ * again when they are needed.
+ */
+void TaggedFileColumnStore::pruneStrings()
+{
+  TraceSpan span("TaggedFileColumnStore::pruneStrings");
+  const int numStrings = m_strings.size();
+  QVector<int> newIdOfId(numStrings, -1);
+  for (const auto& ids : std::as_const(m_frameValueIds)) {
+    for (int id : ids) {
+      if (id >= 0) {
+        newIdOfId[id] = 0;
+      }
+    }
+  }
+  QVector<QString> strings;
+  for (int id = 0; id < numStrings; ++id) {
+    if (newIdOfId.at(id) == 0) {
+      newIdOfId[id] = strings.size();
+      strings.append(m_strings.at(id));
+    }
+  }
+  for (auto& ids : m_frameValueIds) {
+    for (int& id : ids) {
+      if (id >= 0) {
+        id = newIdOfId.at(id);
+      }
+    }
+  }
+  m_strings.swap(strings);
+  m_stringIds.clear();
+  const int numUsedStrings = m_strings.size();
+  m_stringIds.reserve(numUsedStrings);
+  for (int id = 0; id < numUsedStrings; ++id) {
+    m_stringIds.insert(m_strings.at(id), id);
+  }
+  m_ranks.clear();
+  m_sortedIds.clear();
+  m_equalToPrevious.clear();
+  m_pruneLimit = qMax(MIN_PRUNE_LIMIT, 2 * numUsedStrings);
+}
+
+/**
+ * Intern a string.
+ * @param str string
+ * @return ID of string.
+ */
+int TaggedFileColumnStore::intern(const QString& str)
+{
+  auto it = m_stringIds.constFind(str);
+  if (it == m_stringIds.constEnd()) {
+    it = m_stringIds.insert(str, m_strings.size());
+    m_strings.append(str);
+  }
+  return *it;
+}
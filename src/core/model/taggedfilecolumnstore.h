@@ -0,0 +1,242 @@
+/**
+ * \file taggedfilecolumnstore.h
+ * Column store with values of tagged files displayed in the file list.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include "frame.h"
+#include "kid3api.h"
+
+class TaggedFile;
+
+/**
+ * Column store with values of tagged files displayed in the file list.
+ *
+ * Every tagged file of the file system model gets a row in the store.
+ * The values are kept in one contiguous array per column: the tag presence
+ * flags used for the file icons and the values of the tag frames shown
+ * in the file list. Frame values are interned, so that equal values, e.g.
+ * the artist of an album, are only stored once and can be compared by
+ * their IDs. Interned values which are no longer used by any row are
+ * pruned when the number of values has doubled. For sorting, a rank is
+ * assigned to every interned value, new values are merged into the ranks
+ * of the existing values, so that rows can be compared without comparing
+ * strings.
+ *
+ * A row is updated from its tagged file when it is accessed and the tag
+ * change counter of the tagged file has changed since the last update.
+ *
+ * The rows of tagged files with tags in memory are kept in a list ordered
+ * by the time of their last use, so that the tags of the least recently used
+ * files can be evicted. The values of an evicted row are kept as a summary
+ * for the file list until the tags are read again.
+ */
+class KID3_CORE_EXPORT TaggedFileColumnStore {
+public:
+  /** Flags stored for each row. */
+  enum Flag {
+    HasTag1            = 1 << 0, /**< Tag 1 is present */
+    HasTag2            = 1 << 1, /**< Tag 2 is present */
+    HasTag3            = 1 << 2, /**< Tag 3 is present */
+    TagInformationRead = 1 << 3, /**< Tag information has been read */
+    Evicted            = 1 << 4, /**< Values kept after tags were evicted */
+    Valid              = 1 << 7  /**< Values are valid */
+  };
+
+  /**
+   * Constructor.
+   * @param frameTypes types of the frames stored, one column per frame type
+   */
+  explicit TaggedFileColumnStore(const QList<Frame::Type>& frameTypes);
+
+  /**
+   * Add a row for a tagged file.
+   * @param taggedFile tagged file, can be null
+   * @return row.
+   */
+  int addRow(TaggedFile* taggedFile);
+
+  /**
+   * Remove a row, the tagged file is not deleted.
+   * @param row row returned by addRow()
+   */
+  void removeRow(int row);
+
+  /**
+   * Replace the tagged file of a row, the old tagged file is not deleted.
+   * @param row row returned by addRow()
+   * @param taggedFile tagged file, can be null
+   */
+  void setTaggedFile(int row, TaggedFile* taggedFile);
+
+  /**
+   * Get tagged file of a row.
+   * @param row row returned by addRow()
+   * @return tagged file, null if none.
+   */
+  TaggedFile* taggedFile(int row) const { return m_taggedFiles.at(row); }
+
+  /**
+   * Get all tagged files in the store.
+   * @return tagged files, can contain null pointers.
+   */
+  QVector<TaggedFile*> taggedFiles() const;
+
+  /**
+   * Remove all rows, the tagged files are not deleted.
+   */
+  void clear();
+
+  /**
+   * Get column of a frame type.
+   * @param type frame type
+   * @return column, -1 if frame type is not stored.
+   */
+  int columnOfFrameType(Frame::Type type) const {
+    return m_frameTypes.indexOf(type);
+  }
+
+  /**
+   * Get flags of a row.
+   * The file is not read to get the flags. If the tags of the tagged file
+   * have not been read, only the summary of evicted tags is available.
+   * @param row row returned by addRow()
+   * @return combination of Flag values, 0 if the tags have not been read
+   * and no summary is available.
+   */
+  int flags(int row);
+
+  /**
+   * Get ID of frame value.
+   * @param row row returned by addRow()
+   * @param column column of frame type
+   * @return ID of interned value, -1 if the frame does not exist.
+   */
+  int frameValueId(int row, int column);
+
+  /**
+   * Get frame value.
+   * @param row row returned by addRow()
+   * @param column column of frame type
+   * @return value, null if the frame does not exist.
+   */
+  QString frameValue(int row, int column);
+
+  /**
+   * Get sort rank of frame value.
+   * Values are compared case insensitively with numbers in numeric order,
+   * frames which do not exist are ranked first.
+   * @param row row returned by addRow()
+   * @param column column of frame type
+   * @return rank, -1 if the frame does not exist.
+   */
+  int frameValueRank(int row, int column);
+
+  /**
+   * Update all rows, so that frameValueRank() can be used without reading
+   * tagged files, e.g. before sorting.
+   */
+  void updateAllRows();
+
+  /**
+   * Mark a row as the most recently used row with tags in memory.
+   * @param row row returned by addRow()
+   */
+  void touchResidentRow(int row);
+
+  /**
+   * Remove a row from the rows with tags in memory.
+   * @param row row returned by addRow()
+   */
+  void removeResidentRow(int row);
+
+  /**
+   * Get least recently used row with tags in memory.
+   * @return row, -1 if no row has tags in memory.
+   */
+  int leastRecentlyUsedResidentRow() const { return m_lruTail; }
+
+  /**
+   * Get next more recently used row with tags in memory.
+   * @param row row with tags in memory
+   * @return row, -1 if @a row is the most recently used row.
+   */
+  int moreRecentlyUsedResidentRow(int row) const { return m_lruNewer.at(row); }
+
+  /**
+   * Get number of rows with tags in memory.
+   * @return number of rows in the list of rows with tags in memory.
+   */
+  int residentRowCount() const { return m_numResidentRows; }
+
+  /**
+   * Keep the current values of a row as a summary when the tags of its
+   * tagged file are evicted. Has to be called before the tags are cleared.
+   * @param row row returned by addRow()
+   */
+  void keepSummary(int row);
+
+  /**
+   * Discard the values of a row, so that they are updated from the tagged
+   * file on the next access, e.g. when the file was modified on disk.
+   * @param row row returned by addRow()
+   */
+  void discardValues(int row);
+
+private:
+  void updateRowIfChanged(int row);
+  void updateRow(int row);
+  void updateRanks();
+  void pruneStrings();
+  int intern(const QString& str);
+
+  QList<Frame::Type> m_frameTypes;
+  QVector<TaggedFile*> m_taggedFiles;
+  QVector<uint> m_tagChangeCounts;
+  QVector<quint8> m_flags;
+  /** Value IDs indexed by column and row */
+  QVector<QVector<int>> m_frameValueIds;
+  QVector<int> m_freeRows;
+  QVector<QString> m_strings;
+  QHash<QString, int> m_stringIds;
+  /** Ranks indexed by value ID, smaller than m_strings if new IDs exist */
+  QVector<int> m_ranks;
+  /** Value IDs with ranks in sort order */
+  QVector<int> m_sortedIds;
+  /** True if value in m_sortedIds compares equal to its predecessor */
+  QVector<bool> m_equalToPrevious;
+  /** Number of interned values at which unused values are pruned */
+  int m_pruneLimit;
+  /** Next more recently used resident row, -1 for head, -2 if not resident */
+  QVector<int> m_lruNewer;
+  /** Next less recently used resident row, -1 for tail, -2 if not resident */
+  QVector<int> m_lruOlder;
+  int m_lruHead;
+  int m_lruTail;
+  int m_numResidentRows;
+};
@@ -139,12 +139,11 @@ void TaggedFileSelection::addTaggedFile(TaggedFile* taggedFile)
   FOR_ALL_TAGS(tagNr) {
     if (taggedFile->isTagSupported(tagNr)) {
       if (m_state.m_tagSupportedCount[tagNr] == 0) {
-        FrameCollection frames;
-        taggedFile->getAllFrames(tagNr, frames);
-        m_framesModel[tagNr]->transferFrames(frames);
+        const FrameCollection& frames = taggedFile->getAllFramesCached(tagNr);
+        m_framesModel[tagNr]->setFrames(frames);
       } else {
-        FrameCollection fileFrames;
-        taggedFile->getAllFrames(tagNr, fileFrames);
+        const FrameCollection& fileFrames =
+            taggedFile->getAllFramesCached(tagNr);
         m_framesModel[tagNr]->filterDifferent(fileFrames);
       }
       ++m_state.m_tagSupportedCount[tagNr];
@@ -25,11 +25,13 @@
  */
 
 #include "taggedfilesystemmodel.h"
+#include <QFile>
 #include "coretaggedfileiconprovider.h"
 #include "filesystemmodel.h"
 #include "itaggedfilefactory.h"
 #include "tagconfig.h"
 #include "saferename.h"
+#include "performancetracer.h"
 
 /** Only defined for generation of translation files */
 #define NAME_FOR_PO QT_TRANSLATE_NOOP("QFileSystemModel", "Name")
@@ -45,17 +47,165 @@
 
 QList<ITaggedFileFactory*> TaggedFileSystemModel::s_taggedFileFactories;
 
+namespace {
+
+/**
+ * Smallest limit for the number of files with tags in memory, so that
+ * operations which keep the files of a batch, e.g. replacing all
+ * occurrences, do not have their files evicted.
+ */
+constexpr int MIN_RESIDENT_TAGGED_FILES = 1024;
+
+/**
+ * Get feature which can be required to read a file with a given extension.
+ *
+ * Files with an ID3v2.4 or ID3v2.2 tag need a tagged file supporting
+ * ID3v2.4 (id3lib corrupts images in ID3v2.2 tags), Ogg files containing
+ * a FLAC stream need a tagged file supporting Ogg FLAC.
+ *
+ * @param fileName file name
+ *
+ * @return TaggedFile::TF_ID3v24, TaggedFile::TF_OggFlac or 0 if any
+ * tagged file can be used.
+ */
+int featureForExtension(const QString& fileName)
+{
+  if (QString ext = fileName.right(4).toLower();
+      ext == QLatin1String(".mp3") || ext == QLatin1String(".mp2") ||
+      ext == QLatin1String(".aac")) {
+    return TaggedFile::TF_ID3v24;
+  } else if (ext == QLatin1String(".ogg") || ext == QLatin1String(".oga")) {
+    return TaggedFile::TF_OggFlac;
+  }
+  return 0;
+}
+
+/**
+ * Check if the header of a file requires a feature.
+ *
+ * Finding this before the tagged file is created avoids reading such files
+ * twice, first with the default implementation and then with the one
+ * supporting the feature.
+ *
+ * @param filePath path to file
+ * @param feature feature returned by featureForExtension()
+ *
+ * @return true if the file needs a tagged file supporting @a feature.
+ */
+bool fileHeaderRequiresFeature(const QString& filePath, int feature)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  if (feature == TaggedFile::TF_ID3v24) {
+    // ID3v2 header: "ID3", major version, revision, flags, size
+    QByteArray header = file.read(10);
+    return header.size() == 10 && header.startsWith("ID3") &&
+        (header.at(3) == 4 || header.at(3) == 2);
+  }
+  if (feature == TaggedFile::TF_OggFlac) {
+    // Ogg page header has 27 bytes followed by the segment table, then the
+    // first packet of the stream, which is "\x7fFLAC" for Ogg FLAC.
+    QByteArray page = file.read(27 + 255 + 5);
+    if (page.size() > 27 && page.startsWith("OggS")) {
+      int packetPos = 27 + static_cast<unsigned char>(page.at(26));
+      return page.size() >= packetPos + 5 &&
+          page.mid(packetPos, 5) == QByteArray("\x7f" "FLAC");
+    }
+  }
+  return false;
+}
+
+/** Factories and their keys which can create tagged files for an extension. */
+typedef QList<QPair<ITaggedFileFactory*, QString>> FactoryKeyList;
+
+/**
+ * Get the factories and keys which support the extension of a file.
+ *
+ * The table from lower case extension to factory keys is built from
+ * ITaggedFileFactory::supportedFileExtensions() when called the first time
+ * and whenever the list of factories has changed, so that the cost per file
+ * does not depend on the number of factories and keys.
+ *
+ * @param factories tagged file factories
+ * @param fileName file name
+ *
+ * @return factories and keys in the order of the factories.
+ */
+const FactoryKeyList& factoryKeysForFileName(
+    const QList<ITaggedFileFactory*>& factories, const QString& fileName)
+{
+  static QList<ITaggedFileFactory*> tableFactories;
+  static QHash<QString, FactoryKeyList> factoryKeysForExtension;
+  static const FactoryKeyList noFactoryKeys;
+  if (tableFactories.isEmpty() || tableFactories != factories) {
+    tableFactories = factories;
+    factoryKeysForExtension.clear();
+    for (ITaggedFileFactory* factory : factories) {
+      const auto keys = factory->taggedFileKeys();
+      for (const QString& key : keys) {
+        const auto extensions = factory->supportedFileExtensions(key);
+        for (const QString& extension : extensions) {
+          FactoryKeyList& factoryKeys =
+              factoryKeysForExtension[extension.toLower()];
+          if (!factoryKeys.contains(qMakePair(factory, key))) {
+            factoryKeys.append(qMakePair(factory, key));
+          }
+        }
+      }
+    }
+  }
+  if (int dotPos = fileName.lastIndexOf(QLatin1Char('.')); dotPos != -1) {
+    auto it = factoryKeysForExtension.constFind(fileName.mid(dotPos).toLower());
+    if (it != factoryKeysForExtension.constEnd()) {
+      return *it;
+    }
+  }
+  return noFactoryKeys;
+}
+
+/**
+ * Check if the tagged file selected by the extension of a file supports
+ * a feature.
+ *
+ * @param factories tagged file factories
+ * @param fileName file name
+ * @param feature TaggedFile::Feature flag
+ *
+ * @return true if the first factory key for the extension supports
+ * @a feature.
+ */
+bool firstFactoryForFileNameSupports(
+    const QList<ITaggedFileFactory*>& factories, const QString& fileName,
+    int feature)
+{
+  const FactoryKeyList& factoryKeys =
+      factoryKeysForFileName(factories, fileName);
+  return !factoryKeys.isEmpty() &&
+      (factoryKeys.first().first->taggedFileFeatures(
+         factoryKeys.first().second) & feature) != 0;
+}
+
+}
+
 TaggedFileSystemModel::TaggedFileSystemModel(
     CoreTaggedFileIconProvider* iconProvider, QObject* parent)
-  : FileSystemModel(parent), m_iconProvider(iconProvider)
+  : FileSystemModel(parent),
+    m_tagFrameColumnTypes{
+      Frame::FT_Title, Frame::FT_Artist, Frame::FT_Album, Frame::FT_Comment,
+      Frame::FT_Date, Frame::FT_Track, Frame::FT_Genre
+    },
+    m_columnStore(m_tagFrameColumnTypes), m_iconProvider(iconProvider),
+    m_batchEditLevel(0), m_batchModificationDelta(0),
+    m_maxResidentTaggedFiles(0), m_numEvictedTaggedFiles(0),
+    m_evictionRequested(false)
 {
   setObjectName(QLatin1String("TaggedFileSystemModel"));
   connect(this, &QAbstractItemModel::rowsInserted,
           this, &TaggedFileSystemModel::updateInsertedRows);
-  m_tagFrameColumnTypes
-      << Frame::FT_Title << Frame::FT_Artist << Frame::FT_Album
-      << Frame::FT_Comment << Frame::FT_Date << Frame::FT_Track
-      << Frame::FT_Genre;
+  connect(this, &FileSystemModel::fileModificationTimeChanged,
+          this, &TaggedFileSystemModel::onFileModificationTimeChanged);
 }
 
 TaggedFileSystemModel::~TaggedFileSystemModel()
@@ -93,22 +243,20 @@ QVariant TaggedFileSystemModel::data(const QModelIndex& index, int role) const
       return retrieveTaggedFileVariant(index);
     }
     if (role == Qt::DecorationRole && index.column() == 0) {
-      if (TaggedFile* taggedFile = m_taggedFiles.value(index, nullptr)) {
-        return m_iconProvider->iconForTaggedFile(taggedFile);
+      if (int row = dataRow(index); row >= 0 && m_columnStore.taggedFile(row)) {
+        return m_iconProvider->iconForIconId(iconIdOfRow(row));
       }
     } else if (role == Qt::BackgroundRole && index.column() == 0) {
-      if (TaggedFile* taggedFile = m_taggedFiles.value(index, nullptr)) {
+      if (TaggedFile* taggedFile = taggedFileOfIndex(index)) {
         if (QVariant color = m_iconProvider->backgroundForTaggedFile(taggedFile);
             !color.isNull())
           return color;
       }
     } else if (role == IconIdRole && index.column() == 0) {
-      TaggedFile* taggedFile = m_taggedFiles.value(index, nullptr);
-      return taggedFile
-          ? m_iconProvider->iconIdForTaggedFile(taggedFile)
-          : QByteArray("");
+      int row = dataRow(index);
+      return row >= 0 ? iconIdOfRow(row) : QByteArray("");
     } else if (role == TruncatedRole && index.column() == 0) {
-      TaggedFile* taggedFile = m_taggedFiles.value(index, nullptr);
+      TaggedFile* taggedFile = taggedFileOfIndex(index);
       return taggedFile &&
           ((TagConfig::instance().markTruncations() &&
             taggedFile->getTruncationFlags(Frame::Tag_Id3v1) != 0) ||
@@ -119,23 +267,21 @@ QVariant TaggedFileSystemModel::data(const QModelIndex& index, int role) const
                index.column() >= NUM_FILESYSTEM_COLUMNS &&
                index.column() <
                NUM_FILESYSTEM_COLUMNS + m_tagFrameColumnTypes.size()) {
-      QPersistentModelIndex taggedFileIdx = index.sibling(index.row(), 0);
-      if (auto it = m_taggedFiles.constFind(taggedFileIdx);
-          it != m_taggedFiles.constEnd()) {
-        if (TaggedFile* taggedFile = *it) {
-          Frame::Type type = m_tagFrameColumnTypes.at(index.column() -
-                                                      NUM_FILESYSTEM_COLUMNS);
-          if (Frame frame; taggedFile->getFrame(Frame::Tag_2, type, frame)) {
-            QString value = frame.getValue();
-            if (type == Frame::FT_Track) {
-              bool ok;
-              int intValue = value.toInt(&ok);
-              if (ok) {
-                return intValue;
-              }
+      // The values are served from the column store, which only reads the
+      // tagged file again when its tags have changed.
+      // Indexes of all columns refer to the same node.
+      if (int row = dataRow(index); row >= 0) {
+        const int column = index.column() - NUM_FILESYSTEM_COLUMNS;
+        if (QString value = m_columnStore.frameValue(row, column);
+            !value.isNull()) {
+          if (m_tagFrameColumnTypes.at(column) == Frame::FT_Track) {
+            bool ok;
+            int intValue = value.toInt(&ok);
+            if (ok) {
+              return intValue;
             }
-            return value;
           }
+          return value;
         }
       }
       return QVariant();
@@ -146,6 +292,32 @@ QVariant TaggedFileSystemModel::data(const QModelIndex& index, int role) const
   return FileSystemModel::data(index, role);
 }
 
+/**
+ * Get icon ID for a row of the column store.
+ * The flags of the column store are used, so that files whose tags have
+ * been evicted keep their icon.
+ * @param row row in column store
+ * @return icon ID, empty if the row has no tagged file.
+ */
+QByteArray TaggedFileSystemModel::iconIdOfRow(int row) const
+{
+  const TaggedFile* taggedFile = m_columnStore.taggedFile(row);
+  if (!taggedFile)
+    return "";
+
+  const int flags = m_columnStore.flags(row);
+  int tagVersions = 0;
+  if (flags & TaggedFileColumnStore::HasTag1)
+    tagVersions |= Frame::TagV1;
+  if (flags & TaggedFileColumnStore::HasTag2)
+    tagVersions |= Frame::TagV2;
+  if (flags & TaggedFileColumnStore::HasTag3)
+    tagVersions |= Frame::TagV3;
+  return CoreTaggedFileIconProvider::iconIdForTagState(
+        taggedFile->isChanged(),
+        flags & TaggedFileColumnStore::TagInformationRead, tagVersions);
+}
+
 /**
  * Set data for a given role.
  * @param index model index
@@ -163,19 +335,15 @@ bool TaggedFileSystemModel::setData(const QModelIndex& index,
     if ((role == Qt::DisplayRole || role == Qt::EditRole) &&
         index.column() >= NUM_FILESYSTEM_COLUMNS &&
         index.column() < NUM_FILESYSTEM_COLUMNS + m_tagFrameColumnTypes.size()) {
-      QPersistentModelIndex taggedFileIdx = index.sibling(index.row(), 0);
-      if (auto it = m_taggedFiles.constFind(taggedFileIdx);
-          it != m_taggedFiles.constEnd()) {
-        if (TaggedFile* taggedFile = *it) {
-          if (Frame frame;
-              taggedFile->getFrame(
-                Frame::Tag_2,
-                m_tagFrameColumnTypes.at(index.column() -
-                                         NUM_FILESYSTEM_COLUMNS),
-                frame)) {
-            frame.setValue(value.toString());
-            return taggedFile->setFrame(Frame::Tag_2, frame);
-          }
+      if (TaggedFile* taggedFile = taggedFileOfIndex(index)) {
+        if (Frame frame;
+            taggedFile->getFrame(
+              Frame::Tag_2,
+              m_tagFrameColumnTypes.at(index.column() -
+                                       NUM_FILESYSTEM_COLUMNS),
+              frame)) {
+          frame.setValue(value.toString());
+          return taggedFile->setFrame(Frame::Tag_2, frame);
         }
       }
       return false;
@@ -207,6 +375,34 @@ QVariant TaggedFileSystemModel::headerData(
   return FileSystemModel::headerData(section, orientation, role);
 }
 
+/**
+ * Prepare sorting by a tag column.
+ * Updates the values of all files in the column store, so that
+ * tagColumnSortRank() does not have to read tagged files while sorting.
+ */
+void TaggedFileSystemModel::prepareTagColumnSort()
+{
+  m_columnStore.updateAllRows();
+}
+
+/**
+ * Get sort rank of the value in a tag column.
+ * @param index model index of a tag column
+ * @return rank of value, -1 if the file does not have the frame,
+ * -2 if the index does not have a tagged file.
+ */
+int TaggedFileSystemModel::tagColumnSortRank(const QModelIndex& index) const
+{
+  const int column = index.column() - NUM_FILESYSTEM_COLUMNS;
+  if (column >= 0 && column < m_tagFrameColumnTypes.size()) {
+    if (int row = dataRow(index);
+        row >= 0 && m_columnStore.taggedFile(row)) {
+      return m_columnStore.frameValueRank(row, column);
+    }
+  }
+  return -2;
+}
+
 /**
  * Rename file or directory of @a index to @a newName.
  * @return true if ok
@@ -228,6 +424,11 @@ bool TaggedFileSystemModel::rename(const QModelIndex& index,
 void TaggedFileSystemModel::notifyModificationChanged(const QModelIndex& index,
                                                       bool modified)
 {
+  if (m_batchEditLevel > 0) {
+    m_batchModificationDelta += modified ? 1 : -1;
+    addBatchChangedRow(index);
+    return;
+  }
   emit fileModificationChanged(index, modified);
 }
 
@@ -238,9 +439,145 @@ void TaggedFileSystemModel::notifyModificationChanged(const QModelIndex& index,
  */
 void TaggedFileSystemModel::notifyModelDataChanged(const QModelIndex& index)
 {
+  // This is called when the tags of a file have been read or cleared.
+  if (int row = dataRow(index); row >= 0) {
+    if (const TaggedFile* taggedFile = m_columnStore.taggedFile(row);
+        taggedFile && taggedFile->isTagInformationRead()) {
+      m_columnStore.touchResidentRow(row);
+      if (m_maxResidentTaggedFiles > 0 && !m_evictionRequested &&
+          m_columnStore.residentRowCount() > m_maxResidentTaggedFiles) {
+        m_evictionRequested = true;
+        emit residentTaggedFileLimitExceeded();
+      }
+    } else {
+      m_columnStore.removeResidentRow(row);
+    }
+  }
+  if (m_batchEditLevel > 0) {
+    addBatchChangedRow(index);
+    return;
+  }
   emit dataChanged(index, index);
 }
 
+/**
+ * Extend the range of changed rows of the folder of a file changed during
+ * a batch edit.
+ * @param index model index of changed file
+ */
+void TaggedFileSystemModel::addBatchChangedRow(const QModelIndex& index)
+{
+  if (!index.isValid())
+    return;
+
+  const int row = index.row();
+  if (auto it = m_batchRowRangeOfParent.find(index.parent());
+      it != m_batchRowRangeOfParent.end()) {
+    it->first = qMin(it->first, row);
+    it->second = qMax(it->second, row);
+  } else {
+    m_batchRowRangeOfParent.insert(index.parent(), qMakePair(row, row));
+  }
+}
+
+/**
+ * Start a batch edit.
+ * Until endBatchEdit() is called, the notifications from tagged files are
+ * collected instead of being emitted for each file.
+ */
+void TaggedFileSystemModel::beginBatchEdit()
+{
+  ++m_batchEditLevel;
+}
+
+/**
+ * End a batch edit started with beginBatchEdit().
+ * Emits modificationCountChanged() once and dataChanged() once for every
+ * folder with changed files, covering the range of changed rows.
+ */
+void TaggedFileSystemModel::endBatchEdit()
+{
+  if (m_batchEditLevel <= 0 || --m_batchEditLevel > 0)
+    return;
+
+  TraceSpan span("TaggedFileSystemModel::endBatchEdit");
+  QHash<QPersistentModelIndex, QPair<int, int>> rowRangeOfParent;
+  rowRangeOfParent.swap(m_batchRowRangeOfParent);
+  const int delta = m_batchModificationDelta;
+  m_batchModificationDelta = 0;
+
+  if (delta != 0) {
+    emit modificationCountChanged(delta);
+  }
+  const int lastColumn = columnCount() - 1;
+  for (auto it = rowRangeOfParent.constBegin();
+       it != rowRangeOfParent.constEnd();
+       ++it) {
+    // Rows of a folder could have been removed during the batch edit.
+    const QModelIndex parent = it.key();
+    if (const int lastRow = qMin(it->second, rowCount(parent) - 1);
+        parent.isValid() && it->first <= lastRow) {
+      emit dataChanged(index(it->first, 0, parent),
+                       index(lastRow, lastColumn, parent));
+    }
+  }
+}
+
+/**
+ * Set maximum number of files with tags kept in memory.
+ * @param maxFiles maximum number of files, 0 for no limit, values below
+ * 1024 are raised to 1024
+ */
+void TaggedFileSystemModel::setMaxResidentTaggedFiles(int maxFiles)
+{
+  m_maxResidentTaggedFiles = maxFiles > 0
+      ? qMax(maxFiles, MIN_RESIDENT_TAGGED_FILES) : 0;
+  if (m_maxResidentTaggedFiles > 0 && !m_evictionRequested &&
+      m_columnStore.residentRowCount() > m_maxResidentTaggedFiles) {
+    m_evictionRequested = true;
+    emit residentTaggedFileLimitExceeded();
+  }
+}
+
+/**
+ * Free the tags of the least recently used files until the number of files
+ * with tags in memory is below the limit set with setMaxResidentTaggedFiles().
+ * @param pinnedFiles files which shall not be evicted, e.g. selected files
+ * @return number of files evicted.
+ */
+int TaggedFileSystemModel::evictTags(const QSet<const TaggedFile*>& pinnedFiles)
+{
+  m_evictionRequested = false;
+  if (m_maxResidentTaggedFiles <= 0 ||
+      m_columnStore.residentRowCount() <= m_maxResidentTaggedFiles)
+    return 0;
+
+  TraceSpan span("TaggedFileSystemModel::evictTags");
+  // Evict some more files than necessary, so that this is not done again
+  // for every file read.
+  const int targetCount = m_maxResidentTaggedFiles -
+      m_maxResidentTaggedFiles / 8;
+  int numEvicted = 0;
+  int row = m_columnStore.leastRecentlyUsedResidentRow();
+  while (row != -1 && m_columnStore.residentRowCount() > targetCount) {
+    const int nextRow = m_columnStore.moreRecentlyUsedResidentRow(row);
+    if (TaggedFile* taggedFile = m_columnStore.taggedFile(row);
+        taggedFile && !taggedFile->isChanged() &&
+        !taggedFile->isConcurrentWriteInProgress() &&
+        !taggedFile->isPinned() && !pinnedFiles.contains(taggedFile)) {
+      m_columnStore.keepSummary(row);
+      taggedFile->clearTags(false);
+      taggedFile->closeFileHandle();
+      // Normally already done in notifyModelDataChanged() from clearTags().
+      m_columnStore.removeResidentRow(row);
+      ++numEvicted;
+    }
+    row = nextRow;
+  }
+  m_numEvictedTaggedFiles += numEvicted;
+  return numEvicted;
+}
+
 /**
  * Update the TaggedFile contents for rows inserted into the model.
  * @param parent parent model index
@@ -249,6 +586,7 @@ void TaggedFileSystemModel::notifyModelDataChanged(const QModelIndex& index)
  */
 void TaggedFileSystemModel::updateInsertedRows(const QModelIndex& parent,
                                                int start, int end) {
+  TraceSpan span("TaggedFileSystemModel::updateInsertedRows");
   const QAbstractItemModel* model = parent.model();
   if (!model)
     return;
@@ -258,6 +596,33 @@ void TaggedFileSystemModel::updateInsertedRows(const QModelIndex& parent,
   }
 }
 
+/**
+ * Invalidate the tags of a file which has been modified on disk.
+ * The tags are read again when they are accessed the next time. Files
+ * which are modified in the application and changes of the modification
+ * time caused by writing the tags in the application are ignored.
+ * @param index model index of file
+ */
+void TaggedFileSystemModel::onFileModificationTimeChanged(
+    const QModelIndex& index)
+{
+  TaggedFile* taggedFile = taggedFileOfIndex(index);
+  if (!taggedFile || taggedFile->isChanged() ||
+      taggedFile->isConcurrentWriteInProgress() ||
+      taggedFile->checkWrittenFileTime(lastModified(index).toMSecsSinceEpoch()))
+    return;
+
+  if (int row = dataRow(index); row >= 0) {
+    m_columnStore.discardValues(row);
+  }
+  if (taggedFile->isTagInformationRead()) {
+    taggedFile->clearTags(false);
+    taggedFile->closeFileHandle();
+  } else {
+    notifyModelDataChanged(index);
+  }
+}
+
 /**
  * Reset internal data of the model.
  * Is called from endResetModel().
@@ -274,9 +639,9 @@ void TaggedFileSystemModel::resetInternalData()
  * @return QVariant with tagged file, invalid QVariant if not found.
  */
 QVariant TaggedFileSystemModel::retrieveTaggedFileVariant(
-    const QPersistentModelIndex& index) const {
-  if (m_taggedFiles.contains(index))
-    return QVariant::fromValue(m_taggedFiles.value(index));
+    const QModelIndex& index) const {
+  if (int row = dataRow(index); row >= 0)
+    return QVariant::fromValue(m_columnStore.taggedFile(row));
   return QVariant();
 }
 
@@ -287,18 +652,29 @@ QVariant TaggedFileSystemModel::retrieveTaggedFileVariant(
  * @return true if index and value valid
  */
 bool TaggedFileSystemModel::storeTaggedFileVariant(
-    const QPersistentModelIndex& index, const QVariant& value) {
+    const QModelIndex& index, const QVariant& value) {
   if (index.isValid()) {
     if (value.isValid()) {
       if (value.canConvert<TaggedFile*>()) {
-        TaggedFile* oldItem = m_taggedFiles.value(index, nullptr);
-        delete oldItem;
-        m_taggedFiles.insert(index, value.value<TaggedFile*>());
+        auto taggedFile = value.value<TaggedFile*>();
+        if (int row = dataRow(index); row >= 0) {
+          if (m_columnStore.taggedFile(row)) {
+            emit taggedFileAboutToBeDeleted(filePath(index));
+          }
+          delete m_columnStore.taggedFile(row);
+          m_columnStore.setTaggedFile(row, taggedFile);
+        } else {
+          setDataRow(index, m_columnStore.addRow(taggedFile));
+        }
         return true;
       }
     } else {
-      if (TaggedFile* oldFile = m_taggedFiles.value(index, nullptr)) {
-        m_taggedFiles.remove(index);
+      if (int row = dataRow(index);
+          row >= 0 && m_columnStore.taggedFile(row)) {
+        TaggedFile* oldFile = m_columnStore.taggedFile(row);
+        emit taggedFileAboutToBeDeleted(filePath(index));
+        m_columnStore.removeRow(row);
+        setDataRow(index, -1);
         delete oldFile;
       }
     }
@@ -310,8 +686,29 @@ bool TaggedFileSystemModel::storeTaggedFileVariant(
  * Clear store with tagged files.
  */
 void TaggedFileSystemModel::clearTaggedFileStore() {
-  qDeleteAll(m_taggedFiles);
-  m_taggedFiles.clear();
+  const auto taggedFiles = m_columnStore.taggedFiles();
+  qDeleteAll(taggedFiles);
+  qDeleteAll(m_detachedTaggedFiles);
+  m_detachedTaggedFiles.clear();
+  m_columnStore.clear();
+  m_numEvictedTaggedFiles = 0;
+  m_batchRowRangeOfParent.clear();
+  m_batchModificationDelta = 0;
+  resetDataRows();
+}
+
+/**
+ * Called when the node of a file with a tagged file is removed.
+ * @param row row in column store
+ */
+void TaggedFileSystemModel::dataRowRemoved(int row)
+{
+  // The tagged file is not deleted here because it could still be referenced,
+  // e.g. by the selection, it is deleted when the model is reset.
+  if (TaggedFile* taggedFile = m_columnStore.taggedFile(row)) {
+    m_detachedTaggedFiles.append(taggedFile);
+  }
+  m_columnStore.removeRow(row);
 }
 
 /**
@@ -323,11 +720,40 @@ void TaggedFileSystemModel::initTaggedFileData(const QModelIndex& index) {
   if (dat.isValid() || isDir(index))
     return;
 
-  dat.setValue(createTaggedFile(fileName(index), index));
+  // The file header is only read if the tagged file selected by the
+  // extension could lack a feature required by the file, e.g. with id3lib
+  // before TagLib for MP3 files.
+  const QString name = fileName(index);
+  TaggedFile* taggedFile = nullptr;
+  if (int feature = featureForExtension(name);
+      feature != 0 &&
+      !firstFactoryForFileNameSupports(s_taggedFileFactories, name,
+                                       feature) &&
+      fileHeaderRequiresFeature(filePath(index), feature)) {
+    taggedFile = createTaggedFile(static_cast<TaggedFile::Feature>(feature),
+                                  name, index);
+  }
+  if (!taggedFile) {
+    taggedFile = createTaggedFile(name, index);
+  }
+  dat.setValue(taggedFile);
   setData(index, dat, TaggedFileRole);
 }
 
 
+/**
+ * Get tagged file stored for model index.
+ * Faster than data() with TaggedFileRole, no QVariant is used.
+ * @param index index of this model
+ * @return tagged file, null if none.
+ */
+TaggedFile* TaggedFileSystemModel::taggedFileOfIndex(
+    const QModelIndex& index) const
+{
+  int row = dataRow(index);
+  return row >= 0 ? m_columnStore.taggedFile(row) : nullptr;
+}
+
 /**
  * Get tagged file data of model index.
  *
@@ -340,6 +766,14 @@ bool TaggedFileSystemModel::getTaggedFileOfIndex(const QModelIndex& index,
                                                  TaggedFile** taggedFile) {
   if (!(index.isValid() && index.model() != nullptr))
     return false;
+  if (const auto model =
+        qobject_cast<const TaggedFileSystemModel*>(index.model())) {
+    if (int row = model->dataRow(index); row >= 0) {
+      *taggedFile = model->m_columnStore.taggedFile(row);
+      return true;
+    }
+    return false;
+  }
   QVariant data(index.model()->data(index, TaggedFileRole));
   if (!data.canConvert<TaggedFile*>())
     return false;
@@ -359,6 +793,10 @@ TaggedFile* TaggedFileSystemModel::getTaggedFileOfIndex(
     const QModelIndex& index) {
   if (!(index.isValid() && index.model() != nullptr))
     return nullptr;
+  if (const auto model =
+        qobject_cast<const TaggedFileSystemModel*>(index.model())) {
+    return model->taggedFileOfIndex(index);
+  }
   QVariant data(index.model()->data(index, TaggedFileRole));
   if (!data.canConvert<TaggedFile*>())
     return nullptr;
@@ -405,15 +843,12 @@ TaggedFile* TaggedFileSystemModel::createTaggedFile(
 TaggedFile* TaggedFileSystemModel::createTaggedFile(
     const QString& fileName,
     const QPersistentModelIndex& idx) {
-  TaggedFile* taggedFile = nullptr;
-  const auto factories = s_taggedFileFactories;
-  for (ITaggedFileFactory* factory : factories) {
-    const auto keys = factory->taggedFileKeys();
-    for (const QString& key : keys) {
-      taggedFile = factory->createTaggedFile(key, fileName, idx);
-      if (taggedFile) {
-        return taggedFile;
-      }
+  const FactoryKeyList& factoryKeys =
+      factoryKeysForFileName(s_taggedFileFactories, fileName);
+  for (const auto& factoryKey : factoryKeys) {
+    if (TaggedFile* taggedFile =
+        factoryKey.first->createTaggedFile(factoryKey.second, fileName, idx)) {
+      return taggedFile;
     }
   }
   return nullptr;
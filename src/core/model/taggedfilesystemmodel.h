@@ -26,8 +26,12 @@
 
 #pragma once
 
+#include <QSet>
+#include <QHash>
+#include <QPair>
 #include "filesystemmodel.h"
 #include "taggedfile.h"
+#include "taggedfilecolumnstore.h"
 #include "kid3api.h"
 
 class CoreTaggedFileIconProvider;
@@ -94,6 +98,21 @@ public:
   int columnCount(
       const QModelIndex& parent = QModelIndex()) const override;
 
+  /**
+   * Prepare sorting by a tag column.
+   * Updates the values of all files in the column store, so that
+   * tagColumnSortRank() does not have to read tagged files while sorting.
+   */
+  void prepareTagColumnSort();
+
+  /**
+   * Get sort rank of the value in a tag column.
+   * @param index model index of a tag column
+   * @return rank of value, -1 if the file does not have the frame,
+   * -2 if the index does not have a tagged file.
+   */
+  int tagColumnSortRank(const QModelIndex& index) const;
+
   /**
    * Rename file or directory of @a index to @a newName.
    * @return true if ok
@@ -120,6 +139,55 @@ public:
    */
   void notifyModelDataChanged(const QModelIndex& index);
 
+  /**
+   * Start a batch edit.
+   * Until endBatchEdit() is called, the notifications from tagged files are
+   * not emitted as signals for each file but collected, so that many files
+   * can be changed without the overhead of a signal per file. Batch edits
+   * can be nested, the collected changes are emitted when the outermost
+   * batch edit ends.
+   */
+  void beginBatchEdit();
+
+  /**
+   * End a batch edit started with beginBatchEdit().
+   * Emits modificationCountChanged() once and dataChanged() once for every
+   * folder with changed files, covering the range of changed rows.
+   */
+  void endBatchEdit();
+
+  /**
+   * Get maximum number of files with tags kept in memory.
+   * @return maximum number of files, 0 for no limit.
+   */
+  int maxResidentTaggedFiles() const { return m_maxResidentTaggedFiles; }
+
+  /**
+   * Get number of files with tags in memory.
+   * @return number of files with tags read.
+   */
+  int residentTaggedFileCount() const {
+    return m_columnStore.residentRowCount();
+  }
+
+  /**
+   * Get number of files with tags evicted by evictTags() since the model
+   * was reset.
+   * @return number of evicted files.
+   */
+  int evictedTaggedFileCount() const { return m_numEvictedTaggedFiles; }
+
+  /**
+   * Free the tags of the least recently used files until the number of files
+   * with tags in memory is below the limit set with
+   * setMaxResidentTaggedFiles(). Files which are modified, being written or
+   * pinned with TaggedFile::pin() are not evicted. The file list keeps displaying the values of evicted
+   * files until their tags are read again.
+   * @param pinnedFiles files which shall not be evicted, e.g. selected files
+   * @return number of files evicted.
+   */
+  int evictTags(const QSet<const TaggedFile*>& pinnedFiles);
+
   /**
    * Access to tagged file factories.
    * @return reference to tagged file factories.
@@ -154,6 +222,14 @@ public:
       const QString& fileName,
       const QPersistentModelIndex& idx);
 
+  /**
+   * Get tagged file stored for model index.
+   * Faster than data() with TaggedFileRole, no QVariant is used.
+   * @param index index of this model
+   * @return tagged file, null if none.
+   */
+  TaggedFile* taggedFileOfIndex(const QModelIndex& index) const;
+
   /**
    * Get tagged file data of model index.
    *
@@ -175,6 +251,14 @@ public:
    */
   static TaggedFile* getTaggedFileOfIndex(const QModelIndex& index);
 
+public slots:
+  /**
+   * Set maximum number of files with tags kept in memory.
+   * @param maxFiles maximum number of files, 0 for no limit, values below
+   * 1024 are raised to 1024
+   */
+  void setMaxResidentTaggedFiles(int maxFiles);
+
 signals:
   /**
    * Emitted when the modification state of a file changes.
@@ -183,6 +267,30 @@ signals:
    */
   void fileModificationChanged(const QModelIndex& index, bool modified);
 
+  /**
+   * Emitted at the end of a batch edit instead of fileModificationChanged()
+   * for each file.
+   * @param delta number of files which became modified minus number of
+   * files which became unmodified
+   */
+  void modificationCountChanged(int delta);
+
+  /**
+   * Emitted when more files than set with setMaxResidentTaggedFiles() have
+   * their tags in memory. Receivers shall call evictTags() from the event
+   * loop using a queued connection, so that files are not evicted while an
+   * operation processes them. Operations which keep files while returning
+   * to the event loop have to use TaggedFile::pin().
+   */
+  void residentTaggedFileLimitExceeded();
+
+  /**
+   * Emitted before the tagged file of a file is deleted or replaced by
+   * another tagged file.
+   * @param filePath path of file
+   */
+  void taggedFileAboutToBeDeleted(const QString& filePath);
+
 protected slots:
   /**
    * Reset internal data of the model.
@@ -203,13 +311,26 @@ private slots:
    */
   void updateInsertedRows(const QModelIndex& parent, int start, int end);
 
+  /**
+   * Invalidate the tags of a file which has been modified on disk.
+   * @param index model index of file
+   */
+  void onFileModificationTimeChanged(const QModelIndex& index);
+
+protected:
+  /**
+   * Called when the node of a file with a tagged file is removed.
+   * @param row row in column store
+   */
+  void dataRowRemoved(int row) override;
+
 private:
   /**
    * Retrieve tagged file for an index.
    * @param index model index
    * @return QVariant with tagged file, invalid QVariant if not found.
    */
-  QVariant retrieveTaggedFileVariant(const QPersistentModelIndex& index) const;
+  QVariant retrieveTaggedFileVariant(const QModelIndex& index) const;
 
   /**
    * Store tagged file from variant with index.
@@ -217,7 +338,7 @@ private:
    * @param value QVariant containing tagged file
    * @return true if index and value valid
    */
-  bool storeTaggedFileVariant(const QPersistentModelIndex& index,
+  bool storeTaggedFileVariant(const QModelIndex& index,
                               const QVariant& value);
 
   /**
@@ -225,15 +346,39 @@ private:
    */
   void clearTaggedFileStore();
 
+  /**
+   * Get icon ID for a row of the column store.
+   * @param row row in column store
+   * @return icon ID, empty if the row has no tagged file.
+   */
+  QByteArray iconIdOfRow(int row) const;
+
+  /**
+   * Extend the range of changed rows of the folder of a file changed during
+   * a batch edit.
+   * @param index model index of changed file
+   */
+  void addBatchChangedRow(const QModelIndex& index);
+
   /**
    * Initialize tagged file for model index.
    * @param index model index
    */
   void initTaggedFileData(const QModelIndex& index);
 
-  QHash<QPersistentModelIndex, TaggedFile*> m_taggedFiles;
   QList<Frame::Type> m_tagFrameColumnTypes;
+  /** Values of tagged files, updated lazily from const data() */
+  mutable TaggedFileColumnStore m_columnStore;
+  /** Tagged files of removed nodes, deleted when the model is reset */
+  QList<TaggedFile*> m_detachedTaggedFiles;
   CoreTaggedFileIconProvider* m_iconProvider;
+  /** First and last row of files changed during a batch edit by folder */
+  QHash<QPersistentModelIndex, QPair<int, int>> m_batchRowRangeOfParent;
+  int m_batchEditLevel;
+  int m_batchModificationDelta;
+  int m_maxResidentTaggedFiles;
+  int m_numEvictedTaggedFiles;
+  bool m_evictionRequested;
 
   static QList<ITaggedFileFactory*> s_taggedFileFactories;
 };
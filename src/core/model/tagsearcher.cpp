@@ -25,9 +25,58 @@
  */
 
 #include "tagsearcher.h"
+#include <QRunnable>
 #include "trackdatamodel.h"
 #include "fileproxymodel.h"
+#include "taggedfilesystemmodel.h"
 #include "bidirfileproxymodeliterator.h"
+#include "performancetracer.h"
+#include "threadpooljobs.h"
+
+namespace {
+
+/** Number of files collected by replaceAll() before they are processed. */
+constexpr int REPLACE_ALL_BATCH_SIZE = 512;
+
+}
+
+/**
+ * Job replacing all occurrences in a range of files.
+ */
+class FileReplacer : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param searcher tag searcher with search parameters
+   * @param taggedFiles tagged files with cached frames
+   * @param replacements replacements are stored here, must have the same
+   * size as @a taggedFiles
+   * @param begin index of first file to process
+   * @param end index after last file to process
+   */
+  FileReplacer(const TagSearcher* searcher,
+               const QList<TaggedFile*>& taggedFiles,
+               TagSearcher::FileReplacement* replacements, int begin, int end)
+    : m_searcher(searcher), m_taggedFiles(taggedFiles),
+      m_replacements(replacements), m_begin(begin), m_end(end) {
+  }
+
+  /**
+   * Replace in the files.
+   */
+  void run() override {
+    for (int i = m_begin; i < m_end; ++i) {
+      m_searcher->replaceInFile(m_taggedFiles.at(i), m_replacements[i]);
+    }
+  }
+
+private:
+  const TagSearcher* m_searcher;
+  const QList<TaggedFile*>& m_taggedFiles;
+  TagSearcher::FileReplacement* m_replacements;
+  int m_begin;
+  int m_end;
+};
 
 /**
  * Constructor.
@@ -64,7 +113,8 @@ bool TagSearcher::Position::isValid() const
  * @param parent parent object
  */
 TagSearcher::TagSearcher(QObject* parent) : QObject(parent),
-  m_fileProxyModel(nullptr), m_iterator(nullptr), m_aborted(false), m_started(false)
+  m_fileProxyModel(nullptr), m_iterator(nullptr), m_replaceAllCount(0),
+  m_aborted(false), m_started(false), m_replacingAll(false)
 {
 }
 
@@ -95,6 +145,24 @@ void TagSearcher::setModel(FileProxyModel* model)
     delete m_iterator;
     m_iterator = nullptr;
   }
+  if (m_fileProxyModel != model) {
+    if (m_fileProxyModel) {
+      disconnect(m_fileProxyModel, &QAbstractItemModel::modelAboutToBeReset,
+                 this, nullptr);
+      disconnect(m_fileProxyModel, &FileProxyModel::taggedFileAboutToBeDeleted,
+                 this, nullptr);
+    }
+    m_searchIndex.clear();
+    if (model) {
+      // The tagged files are deleted when the model is reset.
+      connect(model, &QAbstractItemModel::modelAboutToBeReset,
+              this, [this] { m_searchIndex.clear(); });
+      connect(model, &FileProxyModel::taggedFileAboutToBeDeleted,
+              this, [this](const QString& filePath) {
+        m_searchIndex.removeFile(filePath);
+      });
+    }
+  }
   m_fileProxyModel = model;
   if (m_fileProxyModel && !m_iterator) {
     m_iterator = new BiDirFileProxyModelIterator(m_fileProxyModel, this);
@@ -128,6 +196,9 @@ void TagSearcher::abort()
 {
   m_aborted = true;
   m_started = false;
+  m_replacingAll = false;
+  releaseReplaceAllFiles();
+  m_searchIndex.indexQueuedFiles();
   if (m_iterator) {
     m_iterator->abort();
   }
@@ -176,13 +247,45 @@ void TagSearcher::findNext(int advanceChars)
  */
 void TagSearcher::searchNextFile(const QPersistentModelIndex& index)
 {
+  if (m_replacingAll) {
+    if (index.isValid()) {
+      if (TaggedFile* taggedFile = FileProxyModel::getTaggedFileOfIndex(index)) {
+        // Files excluded by the index are skipped without reading them.
+        if (m_searchIndex.mayContain(taggedFile)) {
+          taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+          // Keep the tags until the batch is processed, the iterator
+          // returns to the event loop, where files can be evicted.
+          taggedFile->pin();
+          m_replaceAllFiles.append(taggedFile);
+        }
+        if (m_replaceAllFiles.size() >= REPLACE_ALL_BATCH_SIZE) {
+          emit progress(taggedFile->getFilename());
+          replaceInCollectedFiles();
+        }
+      }
+    } else {
+      replaceInCollectedFiles();
+      m_replacingAll = false;
+      m_started = false;
+      m_currentPosition.clear();
+      emit progress(tr("%n occurrences replaced", "", m_replaceAllCount));
+      emit textReplaced();
+    }
+    return;
+  }
+
   if (index.isValid()) {
     if (TaggedFile* taggedFile = FileProxyModel::getTaggedFileOfIndex(index)) {
       emit progress(taggedFile->getFilename());
-      taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+      // Files excluded by the index are skipped without reading them.
+      if (!m_searchIndex.mayContain(taggedFile))
+        return;
 
+      taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
       Position pos;
-      if (searchInFile(taggedFile, &pos, 1)) {
+      const bool found = searchInFile(taggedFile, &pos, 1);
+      m_searchIndex.queueFile(taggedFile);
+      if (found) {
         pos.m_fileIndex = index;
         m_currentPosition = pos;
         if (m_iterator) {
@@ -193,6 +296,9 @@ void TagSearcher::searchNextFile(const QPersistentModelIndex& index)
       }
     }
   } else {
+    // The files searched without entry in the index are indexed when the
+    // search is finished.
+    m_searchIndex.indexQueuedFiles();
     m_started = false;
     m_currentPosition.clear();
     emit progress(tr("Search finished"));
@@ -250,9 +356,8 @@ bool TagSearcher::searchInFile(TaggedFile* taggedFile, Position* pos,
   FOR_ALL_TAGS(tagNr) {
     if (Position::Part part = Position::tagNumberToPart(tagNr);
         pos->getPart() <= part) {
-      FrameCollection frames;
-      taggedFile->getAllFrames(tagNr, frames);
-      if (searchInFrames(frames, part, pos, advanceChars)) {
+      if (searchInFrames(taggedFile->getAllFramesCached(tagNr), part, pos,
+                         advanceChars)) {
         return true;
       }
     }
@@ -346,7 +451,7 @@ void TagSearcher::replaceNext()
           ++it;
         }
         if (it != end) {
-          auto& frame = const_cast<Frame&>(*it);
+          Frame frame(*it);
           QString str = frame.getValue();
           replaced = str.mid(m_currentPosition.getMatchedPos(),
                              m_currentPosition.getMatchedLength());
@@ -354,6 +459,8 @@ void TagSearcher::replaceNext()
           str.replace(m_currentPosition.getMatchedPos(),
                       m_currentPosition.getMatchedLength(), replaced);
           frame.setValueIfChanged(str);
+          // Reinsert at the same position among frames of the same type.
+          frames.insert(frames.erase(it), frame);
           taggedFile->setFrames(
                 Position::partToTagNumber(m_currentPosition.getPart()), frames);
         }
@@ -370,27 +477,207 @@ void TagSearcher::replaceNext()
 
 /**
  * Replace all occurrences.
+ * The files are collected from the current position to the end and then
+ * processed in batches, the textReplaced() signal is emitted once at the end.
  * @param params search parameters
  */
 void TagSearcher::replaceAll(const TagSearcher::Parameters& params)
 {
   setParameters(params);
-  disconnect(this, &TagSearcher::textFound, this, &TagSearcher::replaceThenFindNext);
-  connect(this, &TagSearcher::textFound, this, &TagSearcher::replaceThenFindNext,
-          Qt::QueuedConnection);
-  replaceNext();
+  if (!m_iterator || m_params.getSearchText().isEmpty())
+    return;
+
+  m_aborted = false;
+  m_replacingAll = true;
+  m_replaceAllCount = 0;
+  releaseReplaceAllFiles();
+  if (m_started) {
+    // Replace in the file of the current match starting at the match,
+    // then continue with the following files.
+    if (m_currentPosition.isValid()) {
+      if (TaggedFile* taggedFile = FileProxyModel::getTaggedFileOfIndex(
+            m_currentPosition.getFileIndex())) {
+        FileReplacement replacement;
+        replaceInFile(taggedFile, replacement, &m_currentPosition);
+        applyFileReplacement(taggedFile, replacement);
+      }
+    }
+    m_iterator->resume();
+  } else {
+    if (m_startIndex.isValid()) {
+      m_iterator->setCurrentIndex(m_startIndex);
+      m_startIndex = QPersistentModelIndex();
+    }
+    m_started = true;
+    m_iterator->start();
+  }
 }
 
 /**
- * If a text is found replace it and then search the next occurrence.
+ * Replace all occurrences in the files collected by replaceAll().
+ * The strings are searched and replaced in worker threads, the changed
+ * frames are then set with one call per tag and file.
  */
-void TagSearcher::replaceThenFindNext()
+void TagSearcher::replaceInCollectedFiles()
 {
-  if (!m_aborted && m_currentPosition.isValid()) {
-    replaceNext();
-  } else {
-    disconnect(this, &TagSearcher::textFound, this, &TagSearcher::replaceThenFindNext);
+  if (m_replaceAllFiles.isEmpty())
+    return;
+
+  TraceSpan span("TagSearcher::replaceInCollectedFiles");
+  const int numFiles = static_cast<int>(m_replaceAllFiles.size());
+  // Fill the frame caches and compile the regular expression in this thread,
+  // the jobs only read them. The files are pinned, so their tags are still
+  // in memory.
+  for (TaggedFile* taggedFile : std::as_const(m_replaceAllFiles)) {
+    FOR_ALL_TAGS(tagNr) {
+      taggedFile->getAllFramesCached(tagNr);
+    }
+  }
+  if (!m_regExp.pattern().isEmpty()) {
+    m_regExp.optimize();
+  }
+
+  QVector<FileReplacement> replacements(numFiles);
+  Utils::runJobs(numFiles, [&](int begin, int end) {
+    return new FileReplacer(this, m_replaceAllFiles, replacements.data(),
+                            begin, end);
+  });
+
+  // The model is notified once about all changed files.
+  auto fsModel = m_fileProxyModel
+      ? qobject_cast<TaggedFileSystemModel*>(m_fileProxyModel->sourceModel())
+      : nullptr;
+  if (fsModel) {
+    fsModel->beginBatchEdit();
+  }
+  for (int i = 0; i < numFiles; ++i) {
+    applyFileReplacement(m_replaceAllFiles.at(i), replacements.at(i));
+  }
+  if (fsModel) {
+    fsModel->endBatchEdit();
+  }
+  releaseReplaceAllFiles();
+}
+
+/**
+ * Unpin and forget the files collected by replaceAll().
+ */
+void TagSearcher::releaseReplaceAllFiles()
+{
+  for (TaggedFile* taggedFile : std::as_const(m_replaceAllFiles)) {
+    taggedFile->unpin();
+  }
+  m_replaceAllFiles.clear();
+}
+
+/**
+ * Set the changes made by replaceInFile() in a file.
+ * @param taggedFile tagged file
+ * @param replacement changes to set
+ */
+void TagSearcher::applyFileReplacement(TaggedFile* taggedFile,
+                                       const FileReplacement& replacement)
+{
+  if (replacement.count == 0)
+    return;
+
+  if (!replacement.filename.isNull()) {
+    taggedFile->setFilename(replacement.filename);
+  }
+  FOR_ALL_TAGS(tagNr) {
+    if (replacement.changedTags & Frame::tagVersionFromNumber(tagNr)) {
+      taggedFile->setFrames(tagNr, replacement.frames[tagNr]);
+    }
+  }
+  m_replaceAllCount += replacement.count;
+}
+
+/**
+ * Replace all occurrences in a file.
+ * Can be called from any thread, the frame caches of the file must be filled.
+ * @param taggedFile tagged file
+ * @param replacement the changes are stored here
+ * @param startPos if not null, only occurrences starting at this position
+ * are replaced, e.g. the position of the current match
+ */
+void TagSearcher::replaceInFile(TaggedFile* taggedFile,
+                                FileReplacement& replacement,
+                                const Position* startPos) const
+{
+  const Position::Part startPart = startPos
+      ? startPos->getPart() : Position::FileName;
+  if (startPart == Position::FileName &&
+      ((m_params.getFlags() & AllFrames) ||
+       (m_params.getFrameMask() & (1ULL << TrackDataModel::FT_FileName)))) {
+    QString filename = taggedFile->getFilename();
+    if (int count = replaceAllInString(
+          filename, startPos ? startPos->getMatchedPos() : 0); count > 0) {
+      replacement.filename = filename;
+      replacement.count += count;
+    }
+  }
+  FOR_ALL_TAGS(tagNr) {
+    const Position::Part part = Position::tagNumberToPart(tagNr);
+    if (part < startPart)
+      continue;
+
+    FrameCollection frames = taggedFile->getAllFramesCached(tagNr);
+    bool changed = false;
+    int frameNr = 0;
+    for (auto it = frames.begin(); it != frames.end(); ++it, ++frameNr) {
+      int startIdx = 0;
+      if (part == startPart) {
+        if (frameNr < startPos->getFrameIndex())
+          continue;
+        if (frameNr == startPos->getFrameIndex()) {
+          startIdx = startPos->getMatchedPos();
+        }
+      }
+      if ((m_params.getFlags() & AllFrames) ||
+          (m_params.getFrameMask() & (1ULL << it->getType()))) {
+        QString value = it->getValue();
+        if (int count = replaceAllInString(value, startIdx); count > 0) {
+          // The elements of the multiset are const, the frame is replaced
+          // at the same position among frames of the same type.
+          Frame frame(*it);
+          frame.setValueIfChanged(value);
+          it = frames.insert(frames.erase(it), frame);
+          replacement.count += count;
+          changed = true;
+        }
+      }
+    }
+    if (changed) {
+      replacement.frames[tagNr] = frames;
+      replacement.changedTags |= Frame::tagVersionFromNumber(tagNr);
+    }
+  }
+}
+
+/**
+ * Replace all occurrences in a string.
+ * Every match is replaced in the same way as replaceNext() would do it.
+ * @param str string, will be modified
+ * @param startIdx index where the search starts, text before it is kept
+ * @return number of replacements.
+ */
+int TagSearcher::replaceAllInString(QString& str, int startIdx) const
+{
+  int count = 0;
+  int idx = startIdx;
+  int len;
+  while (idx <= str.length() && (len = findInString(str, idx)) != -1) {
+    QString replaced = str.mid(idx, len);
+    replaceString(replaced);
+    str.replace(idx, len, replaced);
+    idx += replaced.length();
+    if (len == 0 && replaced.isEmpty()) {
+      // Avoid an endless loop for empty matches.
+      ++idx;
+    }
+    ++count;
   }
+  return count;
 }
 
 /**
@@ -447,6 +734,8 @@ void TagSearcher::setParameters(const Parameters& params)
     m_regExp.setPattern(QString());
     m_regExp.setPatternOptions(QRegularExpression::NoPatternOption);
   }
+  // Regular expressions cannot be looked up in the index.
+  m_searchIndex.setQuery(flags & RegExp ? QString() : m_params.getSearchText());
 }
 
 /**
@@ -32,6 +32,7 @@
 #include <QPersistentModelIndex>
 #include "iabortable.h"
 #include "frame.h"
+#include "tagsearchindex.h"
 #include "kid3api.h"
 
 class FileProxyModel;
@@ -314,6 +315,8 @@ signals:
   /**
    * Emitted when a text is replaced.
    * The position of the replaced text is available via getPosition().
+   * After replaceAll(), it is emitted once when all files have been
+   * processed, the position is then invalid.
    */
   void textReplaced();
 
@@ -325,12 +328,33 @@ signals:
 
 private slots:
   void searchNextFile(const QPersistentModelIndex& index);
-  void replaceThenFindNext();
 
 private:
+  friend class FileReplacer;
+  friend class TestTagSearcher;
+
+  /** Replacements in a file made by replaceAll(). */
+  struct FileReplacement {
+    /** New file name, null if not changed */
+    QString filename;
+    /** Frames of tags with changed values */
+    FrameCollection frames[Frame::Tag_NumValues];
+    /** Bit mask with Frame::TagVersion bits of changed tags */
+    int changedTags = 0;
+    /** Number of replacements */
+    int count = 0;
+  };
+
   void setParameters(const Parameters& params);
   void findNext(int advanceChars);
   void replaceNext();
+  void replaceInCollectedFiles();
+  void releaseReplaceAllFiles();
+  void replaceInFile(TaggedFile* taggedFile, FileReplacement& replacement,
+                     const Position* startPos = nullptr) const;
+  void applyFileReplacement(TaggedFile* taggedFile,
+                            const FileReplacement& replacement);
+  int replaceAllInString(QString& str, int startIdx = 0) const;
   void continueSearch(int advanceChars);
   bool searchInFile(TaggedFile* taggedFile, Position* pos,
                     int advanceChars) const;
@@ -347,6 +371,12 @@ private:
   Position m_currentPosition;
   Parameters m_params;
   QRegularExpression m_regExp;
+  /** Index to skip files which cannot contain the search text */
+  TagSearchIndex m_searchIndex;
+  /** Files collected by replaceAll() which are not yet processed, pinned */
+  QList<TaggedFile*> m_replaceAllFiles;
+  int m_replaceAllCount;
   bool m_aborted;
   bool m_started;
+  bool m_replacingAll;
 };
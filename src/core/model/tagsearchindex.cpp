@@ -0,0 +1,376 @@
+/**
+ * \file tagsearchindex.cpp
+ * Inverted index to find files which can contain a search text.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagsearchindex.h"
+#include <algorithm>
+#include "taggedfile.h"
+#include "performancetracer.h"
+
+namespace {
+
+/** Minimum number of dead documents before the posting lists are compacted. */
+constexpr int MIN_DEAD_DOCUMENTS_TO_COMPACT = 1024;
+
+}
+
+/**
+ * Constructor.
+ */
+TagSearchIndex::TagSearchIndex()
+  : m_numDeadDocuments(0), m_hasQuery(false)
+{
+}
+
+/**
+ * Set search text used by mayContain().
+ * @param text search text, null if files cannot be excluded using the
+ * index, e.g. for regular expressions
+ */
+void TagSearchIndex::setQuery(const QString& text)
+{
+  m_queryTrigrams.clear();
+  m_candidates.clear();
+  if (text.length() >= 3) {
+    addTrigrams(text, m_queryTrigrams);
+  }
+  // Texts with less than three characters cannot be looked up.
+  m_hasQuery = !m_queryTrigrams.isEmpty();
+  if (m_hasQuery) {
+    updateCandidates();
+  }
+}
+
+/**
+ * Check if a file can contain the search text set with setQuery().
+ * The tags of the file are not read, a file without up to date entry may
+ * contain the search text.
+ * @param taggedFile tagged file
+ * @return false if the file does not contain the search text,
+ * true if it may contain it.
+ */
+bool TagSearchIndex::mayContain(const TaggedFile* taggedFile) const
+{
+  if (!m_hasQuery)
+    return true;
+
+  FileState state;
+  if (!getFileState(taggedFile, state))
+    return true;
+
+  const int docId = findDocument(taggedFile->currentFilePath(), state);
+  return docId == -1 || isCandidate(docId);
+}
+
+/**
+ * Queue a file to be indexed by indexQueuedFiles().
+ * Nothing is done if the tags of the file have not been read or if it
+ * already has an up to date entry.
+ * @param taggedFile tagged file
+ */
+void TagSearchIndex::queueFile(const TaggedFile* taggedFile)
+{
+  FileState state;
+  if (!taggedFile->isTagInformationRead() ||
+      !getFileState(taggedFile, state))
+    return;
+
+  const QString filePath = taggedFile->currentFilePath();
+  if (filePath.isEmpty() || findDocument(filePath, state) != -1)
+    return;
+
+  // The frames have just been searched, so they are cached.
+  QStringList values;
+  FOR_ALL_TAGS(tagNr) {
+    const FrameCollection& frames = taggedFile->getAllFramesCached(tagNr);
+    for (const Frame& frame : frames) {
+      values.append(frame.getValue());
+    }
+  }
+  queueDocument(filePath, state, values);
+}
+
+/**
+ * Index the files queued with queueFile().
+ */
+void TagSearchIndex::indexQueuedFiles()
+{
+  if (m_queuedFiles.isEmpty())
+    return;
+
+  TraceSpan span("TagSearchIndex::indexQueuedFiles");
+  const QVector<QueuedFile> queuedFiles = std::move(m_queuedFiles);
+  m_queuedFiles.clear();
+  for (const QueuedFile& queued : queuedFiles) {
+    addDocument(queued.filePath, queued.state, queued.values);
+  }
+}
+
+/**
+ * Remove a file from the index.
+ * Has to be called before a tagged file in the index is deleted.
+ * @param filePath path of file
+ */
+void TagSearchIndex::removeFile(const QString& filePath)
+{
+  if (auto it = m_documentOfFile.find(filePath);
+      it != m_documentOfFile.end()) {
+    removeDocument(*it);
+    m_documentOfFile.erase(it);
+  }
+  m_queuedFiles.erase(std::remove_if(m_queuedFiles.begin(),
+                                     m_queuedFiles.end(),
+                                     [&filePath](const QueuedFile& queued) {
+                        return queued.filePath == filePath;
+                      }), m_queuedFiles.end());
+}
+
+/**
+ * Remove all files from the index.
+ * Has to be called when the tagged files are deleted.
+ */
+void TagSearchIndex::clear()
+{
+  m_documents.clear();
+  m_documentOfFile.clear();
+  m_postings.clear();
+  m_queuedFiles.clear();
+  m_candidates.clear();
+  m_numDeadDocuments = 0;
+}
+
+/**
+ * Get the state of a file which is compared with the state when it was
+ * indexed.
+ * @param taggedFile tagged file
+ * @param state the state is returned here
+ * @return false if the size and modification time of the file are not
+ * known.
+ */
+bool TagSearchIndex::getFileState(const TaggedFile* taggedFile,
+                                  FileState& state)
+{
+  state.filename = taggedFile->getFilename();
+  if (taggedFile->isChanged()) {
+    state.changedTaggedFile = taggedFile;
+    state.size = 0;
+    state.modified = 0;
+    state.tagChangeCount = taggedFile->getTagChangeCount();
+    return true;
+  }
+  state.changedTaggedFile = nullptr;
+  state.tagChangeCount = 0;
+  return taggedFile->getListedFileStamp(state.size, state.modified);
+}
+
+/**
+ * Get the up to date document of a file.
+ * @param filePath path of file
+ * @param state current state of file
+ * @return document ID, -1 if not found or outdated.
+ */
+int TagSearchIndex::findDocument(const QString& filePath,
+                                 const FileState& state) const
+{
+  if (auto it = m_documentOfFile.constFind(filePath);
+      it != m_documentOfFile.constEnd() &&
+      m_documents.at(*it).state == state) {
+    return *it;
+  }
+  return -1;
+}
+
+/**
+ * Queue a document to be indexed by indexQueuedFiles().
+ * @param filePath path of file
+ * @param state state of file
+ * @param values frame values
+ */
+void TagSearchIndex::queueDocument(const QString& filePath,
+                                   const FileState& state,
+                                   const QStringList& values)
+{
+  m_queuedFiles.append({filePath, state, values});
+}
+
+/**
+ * Index a file, an existing document for the same path is replaced.
+ * @param filePath path of file
+ * @param state state of file
+ * @param values frame values
+ * @return document ID.
+ */
+int TagSearchIndex::addDocument(const QString& filePath,
+                                const FileState& state,
+                                const QStringList& values)
+{
+  if (auto it = m_documentOfFile.constFind(filePath);
+      it != m_documentOfFile.constEnd()) {
+    removeDocument(*it);
+  }
+  if (m_numDeadDocuments >= MIN_DEAD_DOCUMENTS_TO_COMPACT &&
+      m_numDeadDocuments > m_documents.size() / 2) {
+    compact();
+  }
+
+  QSet<quint64> trigrams;
+  for (const QString& value : values) {
+    addTrigrams(value, trigrams);
+  }
+  addTrigrams(state.filename, trigrams);
+
+  // Document IDs are increasing, so the posting lists stay sorted.
+  const int docId = m_documents.size();
+  m_documents.append({state, true});
+  m_documentOfFile.insert(filePath, docId);
+  for (quint64 trigram : std::as_const(trigrams)) {
+    m_postings[trigram].append(docId);
+  }
+  if (m_hasQuery &&
+      std::all_of(m_queryTrigrams.constBegin(), m_queryTrigrams.constEnd(),
+                  [&trigrams](quint64 trigram) {
+                    return trigrams.contains(trigram);
+                  })) {
+    m_candidates.append(docId);
+  }
+  return docId;
+}
+
+/**
+ * Mark a document as dead.
+ * @param docId document ID
+ */
+void TagSearchIndex::removeDocument(int docId)
+{
+  if (Document& doc = m_documents[docId]; doc.alive) {
+    doc.alive = false;
+    doc.state.changedTaggedFile = nullptr;
+    ++m_numDeadDocuments;
+  }
+}
+
+/**
+ * Check if a document can contain the search text.
+ * @param docId document ID
+ * @return true if there is no query or the document contains all query
+ * trigrams.
+ */
+bool TagSearchIndex::isCandidate(int docId) const
+{
+  return !m_hasQuery ||
+      std::binary_search(m_candidates.constBegin(), m_candidates.constEnd(),
+                         docId);
+}
+
+/**
+ * Intersect the posting lists of the query trigrams.
+ */
+void TagSearchIndex::updateCandidates()
+{
+  QVector<const QVector<int>*> lists;
+  lists.reserve(m_queryTrigrams.size());
+  for (quint64 trigram : std::as_const(m_queryTrigrams)) {
+    auto it = m_postings.constFind(trigram);
+    if (it == m_postings.constEnd())
+      return;
+    lists.append(&*it);
+  }
+  // Start with the shortest list to check as few documents as possible.
+  std::sort(lists.begin(), lists.end(),
+            [](const QVector<int>* lhs, const QVector<int>* rhs) {
+    return lhs->size() < rhs->size();
+  });
+  for (int docId : *lists.first()) {
+    if (m_documents.at(docId).alive &&
+        std::all_of(lists.constBegin() + 1, lists.constEnd(),
+                    [docId](const QVector<int>* list) {
+                      return std::binary_search(list->constBegin(),
+                                                list->constEnd(), docId);
+                    })) {
+      m_candidates.append(docId);
+    }
+  }
+}
+
+/**
+ * Remove dead documents and renumber the remaining documents.
+ */
+void TagSearchIndex::compact()
+{
+  TraceSpan span("TagSearchIndex::compact");
+  // The order of the documents is kept, so the lists stay sorted.
+  QVector<int> newIds(m_documents.size(), -1);
+  QVector<Document> documents;
+  documents.reserve(m_documents.size() - m_numDeadDocuments);
+  for (int docId = 0; docId < static_cast<int>(m_documents.size()); ++docId) {
+    if (const Document& doc = m_documents.at(docId); doc.alive) {
+      newIds[docId] = static_cast<int>(documents.size());
+      documents.append(doc);
+    }
+  }
+  auto renumber = [&newIds](QVector<int>& docIds) {
+    int numIds = 0;
+    for (int docId : std::as_const(docIds)) {
+      if (int newId = newIds.at(docId); newId != -1) {
+        docIds[numIds++] = newId;
+      }
+    }
+    docIds.resize(numIds);
+  };
+  for (auto it = m_postings.begin(); it != m_postings.end();) {
+    renumber(*it);
+    if (it->isEmpty()) {
+      it = m_postings.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  renumber(m_candidates);
+  for (auto it = m_documentOfFile.begin(); it != m_documentOfFile.end(); ++it) {
+    *it = newIds.at(*it);
+  }
+  m_documents.swap(documents);
+  m_numDeadDocuments = 0;
+}
+
+/**
+ * Add the case folded trigrams of a string.
+ * @param str string
+ * @param trigrams trigrams are added to this set
+ */
+void TagSearchIndex::addTrigrams(const QString& str, QSet<quint64>& trigrams)
+{
+  if (str.length() < 3)
+    return;
+
+  const QString folded = str.toCaseFolded();
+  const QChar* chars = folded.constData();
+  const int numTrigrams = folded.length() - 2;
+  for (int i = 0; i < numTrigrams; ++i) {
+    trigrams.insert((static_cast<quint64>(chars[i].unicode()) << 32) |
+                    (static_cast<quint64>(chars[i + 1].unicode()) << 16) |
+                    chars[i + 2].unicode());
+  }
+}
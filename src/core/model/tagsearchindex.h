@@ -0,0 +1,168 @@
+/**
+ * \file tagsearchindex.h
+ * Inverted index to find files which can contain a search text.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include "kid3api.h"
+
+class TaggedFile;
+
+/**
+ * Inverted index to find files which can contain a search text.
+ *
+ * The file names and frame values of the indexed files are split into
+ * case folded trigrams, for each trigram a posting list with the files
+ * containing it is kept. A file can only contain a search text if it
+ * contains all trigrams of the text, so most files can be skipped without
+ * reading their tags.
+ *
+ * The entries are looked up by the path of the file and are up to date as
+ * long as the file name, size and modification time known by the file
+ * system model do not change, so they stay valid when the tags are evicted
+ * from memory. Entries of files with unsaved changes are only valid for
+ * the same tagged file and tag change counter.
+ *
+ * Files whose tags have been searched are queued with queueFile() and
+ * indexed with indexQueuedFiles() after the search, so that building the
+ * index does not slow down the search itself. Replaced entries are marked
+ * as dead and removed when there are many dead entries. Entries of files
+ * which are deleted have to be removed with removeFile().
+ */
+class KID3_CORE_EXPORT TagSearchIndex {
+public:
+  /**
+   * Constructor.
+   */
+  TagSearchIndex();
+
+  /**
+   * Set search text used by mayContain().
+   * @param text search text, null if files cannot be excluded using the
+   * index, e.g. for regular expressions
+   */
+  void setQuery(const QString& text);
+
+  /**
+   * Check if a file can contain the search text set with setQuery().
+   * The tags of the file are not read, a file without up to date entry may
+   * contain the search text.
+   * @param taggedFile tagged file
+   * @return false if the file does not contain the search text,
+   * true if it may contain it.
+   */
+  bool mayContain(const TaggedFile* taggedFile) const;
+
+  /**
+   * Queue a file to be indexed by indexQueuedFiles().
+   * Nothing is done if the tags of the file have not been read or if it
+   * already has an up to date entry.
+   * @param taggedFile tagged file
+   */
+  void queueFile(const TaggedFile* taggedFile);
+
+  /**
+   * Index the files queued with queueFile().
+   */
+  void indexQueuedFiles();
+
+  /**
+   * Remove a file from the index.
+   * Has to be called before a tagged file in the index is deleted.
+   * @param filePath path of file
+   */
+  void removeFile(const QString& filePath);
+
+  /**
+   * Remove all files from the index.
+   * Has to be called when the tagged files are deleted.
+   */
+  void clear();
+
+private:
+  friend class TestTagSearchIndex;
+
+  /** State of a file when it was indexed. */
+  struct FileState {
+    /** Tagged file with unsaved changes, only compared, never
+        dereferenced, null if unchanged */
+    const TaggedFile* changedTaggedFile;
+    QString filename;    /**< file name */
+    qint64 size;         /**< file size if unchanged */
+    qint64 modified;     /**< modification time in ms since epoch if
+                              unchanged */
+    uint tagChangeCount; /**< tag change counter if changed */
+
+    bool operator==(const FileState& other) const {
+      return changedTaggedFile == other.changedTaggedFile &&
+          size == other.size && modified == other.modified &&
+          tagChangeCount == other.tagChangeCount &&
+          filename == other.filename;
+    }
+  };
+
+  /** Indexed file. */
+  struct Document {
+    FileState state; /**< state of file when indexed */
+    bool alive;      /**< false if replaced or removed */
+  };
+
+  /** File waiting to be indexed. */
+  struct QueuedFile {
+    QString filePath;   /**< path of file */
+    FileState state;    /**< state of file */
+    QStringList values; /**< frame values */
+  };
+
+  static bool getFileState(const TaggedFile* taggedFile, FileState& state);
+  int findDocument(const QString& filePath, const FileState& state) const;
+  void queueDocument(const QString& filePath, const FileState& state,
+                     const QStringList& values);
+  int addDocument(const QString& filePath, const FileState& state,
+                  const QStringList& values);
+  void removeDocument(int docId);
+  bool isCandidate(int docId) const;
+  void updateCandidates();
+  void compact();
+
+  static void addTrigrams(const QString& str, QSet<quint64>& trigrams);
+
+  QVector<Document> m_documents;
+  /** Document IDs of alive documents indexed by file path */
+  QHash<QString, int> m_documentOfFile;
+  /** Ascending document IDs for trigrams */
+  QHash<quint64, QVector<int>> m_postings;
+  QVector<QueuedFile> m_queuedFiles;
+  QSet<quint64> m_queryTrigrams;
+  /** Ascending IDs of documents containing all query trigrams */
+  QVector<int> m_candidates;
+  int m_numDeadDocuments;
+  bool m_hasQuery;
+};
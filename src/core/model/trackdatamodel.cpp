@@ -327,6 +327,7 @@ void TrackDataModel::setTimeDifferenceCheck(bool enable, int maxDiff) {
 int TrackDataModel::calculateAccuracy() const
 {
   int numImportTracks = 0, numTracks = 0, numMismatches = 0, numMatches = 0;
+  WordIdMap wordIds;
   for (auto it = m_trackDataVector.constBegin();
        it != m_trackDataVector.constEnd();
        ++it) {
@@ -339,14 +340,15 @@ int TrackDataModel::calculateAccuracy() const
       }
     } else {
       // no durations available => try to match using file name and title
-      QSet<QString> titleWords = trackData.getTitleWords();
+      const QVector<int>& titleWords = trackData.getTitleWords(wordIds);
       if (int numWords = titleWords.size(); numWords > 0) {
-        QSet<QString> fileWords = trackData.getFilenameWords();
+        const QVector<int>& fileWords = trackData.getFilenameWords(wordIds);
         if (fileWords.size() < numWords) {
           numWords = fileWords.size();
         }
         if (int wordMatch = numWords > 0
-              ? 100 * (fileWords & titleWords).size() / numWords : 0;
+              ? 100 * ImportTrackData::countCommonWords(fileWords, titleWords)
+                / numWords : 0;
             wordMatch < 75) {
           ++numMismatches;
         } else {
@@ -1371,10 +1371,11 @@ quint64 FrameCollection::s_quickAccessFrames =
  * @param differentValues optional storage for the different values
  */
 void FrameCollection::filterDifferent(
-    FrameCollection& others,
+    const FrameCollection& others,
     QHash<Frame::ExtendedType, QSet<QString>>* differentValues)
 {
-  constexpr int ALREADY_HANDLED_INDEX = INT_MIN;
+  // Frames of others which have been compared with a frame of this collection.
+  QSet<const Frame*> handledOthers;
   QByteArray frameData, othersData;
   auto it = begin();
   while (it != end()) {
@@ -1403,21 +1404,18 @@ void FrameCollection::filterDifferent(
           }
           const_cast<Frame&>(*it).setDifferent();
         }
-        // Mark as already handled.
-        const_cast<Frame&>(*othersIt).setIndex(ALREADY_HANDLED_INDEX);
+        handledOthers.insert(&*othersIt);
         ++it;
         ++othersIt;
       }
     }
   }
 
-  // Insert frames which are in others but not in this (not marked as already
-  // handled by index ALREADY_HANDLED_INDEX) as different frames.
-  for (auto othersIt = others.begin();
-       othersIt != others.end();
-       ++othersIt) {
-    if (othersIt->getIndex() != ALREADY_HANDLED_INDEX) {
-      auto& frame = const_cast<Frame&>(*othersIt);
+  // Insert frames which are in others but not in this (not already handled)
+  // as different frames.
+  for (const Frame& othersFrame : others) {
+    if (!handledOthers.contains(&othersFrame)) {
+      Frame frame(othersFrame);
       frame.setIndex(-1);
       frame.setDifferent();
       insert(frame);
@@ -1044,10 +1044,10 @@ public:
   /**
    * Set values which are different inactive.
    *
-   * @param others frames to compare, will be modified!
+   * @param others frames to compare
    * @param differentValues optional storage for the different values
    */
-  void filterDifferent(FrameCollection& others,
+  void filterDifferent(const FrameCollection& others,
           QHash<Frame::ExtendedType, QSet<QString>>* differentValues = nullptr);
 
   /**
@@ -26,6 +26,8 @@
 
 #include "taggedfile.h"
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QString>
 #include <QRegularExpression>
 #ifdef Q_OS_WIN32
@@ -40,19 +42,39 @@
 #include "genres.h"
 #include "modeliterator.h"
 #include "saferename.h"
+#include "pictureframe.h"
 #include "taggedfilesystemmodel.h"
 
+namespace {
+
+/**
+ * Maximum size of picture data in the frame caches of all files.
+ * The pictures are also held by the tags, so only the frame caches of
+ * recently used files keep them.
+ */
+constexpr qint64 MAX_PICTURE_CACHE_SIZE = 32 * 1024 * 1024;
+
+}
+
+uint TaggedFile::s_frameCacheGeneration = 1;
+QList<QPair<const TaggedFile*, Frame::TagNumber>> TaggedFile::s_pictureCaches;
+qint64 TaggedFile::s_pictureCacheSize = 0;
+
 /**
  * Constructor.
  *
  * @param idx index in tagged file system model
  */
 TaggedFile::TaggedFile(const QPersistentModelIndex& idx)
-  : m_index(idx), m_truncation(0), m_modified(false), m_marked(false)
+  : m_index(idx), m_truncation(0), m_modified(false),
+    m_writtenFileTime(0), m_marked(false),
+    m_tagChangeCount(0), m_pinCount(0), m_modifiedBeforeConcurrentWrite(false)
 {
   FOR_ALL_TAGS(tagNr) {
     m_changedFrames[tagNr] = 0;
     m_changed[tagNr] = false;
+    m_frameCacheGeneration[tagNr] = 0;
+    m_frameCachePictureSize[tagNr] = 0;
   }
   Q_ASSERT(m_index.model()->metaObject() == &TaggedFileSystemModel::staticMetaObject);
   if (const TaggedFileSystemModel* model = getTaggedFileSystemModel()) {
@@ -61,6 +83,16 @@ TaggedFile::TaggedFile(const QPersistentModelIndex& idx)
   }
 }
 
+/**
+ * Destructor.
+ */
+TaggedFile::~TaggedFile()
+{
+  FOR_ALL_TAGS(tagNr) {
+    removeCachedPictureData(tagNr);
+  }
+}
+
 /**
  * Get tagged file model.
  * @return tagged file model.
@@ -78,6 +110,9 @@ const TaggedFileSystemModel* TaggedFile::getTaggedFileSystemModel() const
  */
 QString TaggedFile::getDirname() const
 {
+  if (!m_concurrentWriteDirname.isNull()) {
+    return m_concurrentWriteDirname;
+  }
   if (const TaggedFileSystemModel* model = getTaggedFileSystemModel()) {
     return model->filePath(m_index.parent());
   }
@@ -132,12 +167,108 @@ void TaggedFile::updateCurrentFilename()
  */
 QString TaggedFile::currentFilePath() const
 {
+  if (!m_concurrentWriteDirname.isNull()) {
+    return QDir(m_concurrentWriteDirname).filePath(m_filename);
+  }
   if (const TaggedFileSystemModel* model = getTaggedFileSystemModel()) {
     return model->filePath(m_index);
   }
   return QString();
 }
 
+/**
+ * Check if writeTags() can be called from a worker thread.
+ * If supported, writeTags() can be called for different files at the same
+ * time, enclosed in beginConcurrentWrite() and endConcurrentWrite().
+ * The default implementation returns false.
+ *
+ * @return true if concurrent writing is supported.
+ */
+bool TaggedFile::isConcurrentWriteSupported() const
+{
+  return false;
+}
+
+/**
+ * Prepare calling writeTags() from a worker thread.
+ * Has to be called in the thread of the model. The file handle is closed,
+ * until endConcurrentWrite() is called, the model is not accessed, the file
+ * path is taken from a copy and the notifications of the model are
+ * postponed.
+ */
+void TaggedFile::beginConcurrentWrite()
+{
+  // A file handle opened in this thread could be closed by this thread
+  // while the file is written in another thread.
+  closeFileHandle();
+  QString dirName = getDirname();
+  if (dirName.isNull()) {
+    dirName = QLatin1String("");
+  }
+  m_concurrentWriteDirname = dirName;
+  m_modifiedBeforeConcurrentWrite = m_modified;
+}
+
+/**
+ * Finish calling writeTags() from a worker thread.
+ * Has to be called in the thread of the model, closes a file handle left
+ * open by the worker thread and sends the notifications postponed since
+ * beginConcurrentWrite().
+ */
+void TaggedFile::endConcurrentWrite()
+{
+  // Handles are only closed by the thread which opened them when the limit
+  // of open files is reached, so none of the worker threads may be left.
+  closeFileHandle();
+  m_concurrentWriteDirname.clear();
+  if (m_modified != m_modifiedBeforeConcurrentWrite) {
+    if (const TaggedFileSystemModel* model = getTaggedFileSystemModel()) {
+      const_cast<TaggedFileSystemModel*>(model)->notifyModificationChanged(
+            m_index, m_modified);
+    }
+  }
+}
+
+/**
+ * Get size and modification time of the file from the file system model.
+ * The file system is not queried, the values are those of the last
+ * listing of the folder.
+ *
+ * @param size the size in bytes is returned here
+ * @param modified the modification time in ms since epoch is returned here
+ * @return true if available.
+ */
+bool TaggedFile::getListedFileStamp(qint64& size, qint64& modified) const
+{
+  if (const TaggedFileSystemModel* model = getTaggedFileSystemModel();
+      model && m_index.isValid()) {
+    const QDateTime lastModified = model->lastModified(m_index);
+    size = model->size(m_index);
+    modified = lastModified.isValid() ? lastModified.toMSecsSinceEpoch() : 0;
+    return size >= 0 && lastModified.isValid();
+  }
+  return false;
+}
+
+/**
+ * Check if a change of the modification time reported by the file system
+ * watcher is caused by writing the tags in the application.
+ * The first change reported after markTagsWritten() is considered to be
+ * caused by the write and its time is remembered, so that the file does not
+ * have to be queried when the tags are written.
+ *
+ * @param fileTime reported modification time in ms since epoch
+ * @return true if the file has not been modified by another application.
+ */
+bool TaggedFile::checkWrittenFileTime(qint64 fileTime)
+{
+  if (m_writtenFileTime == -1) {
+    m_writtenFileTime = fileTime;
+    return true;
+  }
+  return m_writtenFileTime == fileTime;
+}
+
 /**
  * Get features supported.
  * @return bit mask with Feature flags set.
@@ -270,6 +401,7 @@ void TaggedFile::markTagChanged(Frame::TagNumber tagNr,
 {
   Frame::Type type = extendedType.getType();
   m_changed[tagNr] = true;
+  invalidateFrameCache(tagNr);
   if (static_cast<unsigned>(type) < sizeof(m_changedFrames[tagNr]) * 8) {
     m_changedFrames[tagNr] |= 1ULL << type;
   }
@@ -290,6 +422,7 @@ void TaggedFile::markTagUnchanged(Frame::TagNumber tagNr) {
   m_changed[tagNr] = false;
   m_changedFrames[tagNr] = 0;
   m_changedOtherFrameNames[tagNr].clear();
+  invalidateFrameCache(tagNr);
   clearTrunctionFlags(tagNr);
   updateModifiedState();
 }
@@ -351,6 +484,7 @@ void TaggedFile::setChangedFrames(Frame::TagNumber tagNr,
     }
   }
   m_changed[tagNr] = mask != 0;
+  invalidateFrameCache(tagNr);
   updateModifiedState();
 }
 
@@ -366,6 +500,10 @@ void TaggedFile::updateModifiedState()
   modified = modified || m_newFilename != m_filename;
   if (m_modified != modified) {
     m_modified = modified;
+    if (!m_concurrentWriteDirname.isNull()) {
+      // Notified in endConcurrentWrite().
+      return;
+    }
     if (const TaggedFileSystemModel* model = getTaggedFileSystemModel()) {
       const_cast<TaggedFileSystemModel*>(model)->notifyModificationChanged(
             m_index, m_modified);
@@ -385,7 +523,12 @@ void TaggedFile::updateModifiedState()
  */
 void TaggedFile::notifyModelDataChanged(bool priorIsTagInformationRead) const
 {
-  if (isTagInformationRead() != priorIsTagInformationRead) {
+  // Called after the tags have been read or cleared.
+  FOR_ALL_TAGS(tagNr) {
+    invalidateFrameCache(tagNr);
+  }
+  if (isTagInformationRead() != priorIsTagInformationRead &&
+      m_concurrentWriteDirname.isNull()) {
     if (const TaggedFileSystemModel* model = getTaggedFileSystemModel()) {
       const_cast<TaggedFileSystemModel*>(model)->notifyModelDataChanged(m_index);
     }
@@ -402,7 +545,8 @@ void TaggedFile::notifyModelDataChanged(bool priorIsTagInformationRead) const
 void TaggedFile::notifyTruncationChanged(bool priorTruncation) const
 {
   if (bool currentTruncation = m_truncation != 0;
-      currentTruncation != priorTruncation) {
+      currentTruncation != priorTruncation &&
+      m_concurrentWriteDirname.isNull()) {
     if (const TaggedFileSystemModel* model = getTaggedFileSystemModel()) {
       const_cast<TaggedFileSystemModel*>(model)->notifyModelDataChanged(m_index);
     }
@@ -1058,6 +1202,117 @@ void TaggedFile::getAllFrames(Frame::TagNumber tagNr, FrameCollection& frames)
   }
 }
 
+/**
+ * Get all frames in tag using a cached snapshot.
+ * The frames are only fetched with getAllFrames() if the tag was changed,
+ * read or cleared since the last call.
+ *
+ * @param tagNr tag number
+ *
+ * @return frames of tag, the reference stays valid until the tag is
+ * modified.
+ */
+const FrameCollection& TaggedFile::getAllFramesCached(Frame::TagNumber tagNr)
+{
+  if (tagNr >= Frame::Tag_NumValues) {
+    static const FrameCollection noFrames;
+    return noFrames;
+  }
+  if (m_frameCacheGeneration[tagNr] != s_frameCacheGeneration) {
+    FrameCollection frames;
+    getAllFrames(tagNr, frames);
+    // getAllFrames() may read the tags and thereby invalidate the cache,
+    // so it is only stored after it has been fetched.
+    removeCachedPictureData(tagNr);
+    m_frameCache[tagNr].swap(frames);
+    m_frameCacheGeneration[tagNr] = s_frameCacheGeneration;
+    int pictureSize = 0;
+    QByteArray data;
+    for (auto it = m_frameCache[tagNr].findByExtendedType(
+           Frame::ExtendedType(Frame::FT_Picture));
+         it != m_frameCache[tagNr].cend() &&
+         it->getType() == Frame::FT_Picture;
+         ++it) {
+      if (PictureFrame::getData(*it, data)) {
+        pictureSize += static_cast<int>(data.size());
+      }
+    }
+    if (pictureSize > 0) {
+      addCachedPictureData(tagNr, pictureSize);
+    }
+  }
+  return m_frameCache[tagNr];
+}
+
+/**
+ * Invalidate the cached frames of all tagged files.
+ * Has to be called when the configuration affecting getAllFrames() changes.
+ */
+void TaggedFile::invalidateAllFrameCaches()
+{
+  if (++s_frameCacheGeneration == 0) {
+    // 0 is used for invalid caches.
+    s_frameCacheGeneration = 1;
+  }
+}
+
+/**
+ * Invalidate cached frames.
+ * @param tagNr tag number
+ */
+void TaggedFile::invalidateFrameCache(Frame::TagNumber tagNr) const
+{
+  ++m_tagChangeCount;
+  if (m_frameCacheGeneration[tagNr] != 0) {
+    m_frameCacheGeneration[tagNr] = 0;
+    m_frameCache[tagNr].clear();
+    removeCachedPictureData(tagNr);
+  }
+}
+
+/**
+ * Account for picture data in the frame cache of a tag.
+ * If too much picture data is cached, the oldest caches of files which are
+ * not pinned are invalidated. Their tags are not changed, so the tag change
+ * counter is not incremented.
+ * @param tagNr tag number
+ * @param size size of picture data in the cached frames
+ */
+void TaggedFile::addCachedPictureData(Frame::TagNumber tagNr, int size)
+{
+  m_frameCachePictureSize[tagNr] = size;
+  s_pictureCacheSize += size;
+  s_pictureCaches.append({this, tagNr});
+  auto it = s_pictureCaches.begin();
+  while (s_pictureCacheSize > MAX_PICTURE_CACHE_SIZE &&
+         it != s_pictureCaches.end()) {
+    const TaggedFile* taggedFile = it->first;
+    const Frame::TagNumber nr = it->second;
+    if (taggedFile != this && !taggedFile->isPinned()) {
+      s_pictureCacheSize -= taggedFile->m_frameCachePictureSize[nr];
+      taggedFile->m_frameCachePictureSize[nr] = 0;
+      taggedFile->m_frameCacheGeneration[nr] = 0;
+      taggedFile->m_frameCache[nr].clear();
+      it = s_pictureCaches.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * Remove picture data of the frame cache of a tag from the accounting.
+ * @param tagNr tag number
+ */
+void TaggedFile::removeCachedPictureData(Frame::TagNumber tagNr) const
+{
+  if (m_frameCachePictureSize[tagNr] != 0) {
+    s_pictureCacheSize -= m_frameCachePictureSize[tagNr];
+    m_frameCachePictureSize[tagNr] = 0;
+    s_pictureCaches.removeOne({this, tagNr});
+  }
+}
+
 /**
  * Update marked property of frames.
  * Mark frames which violate configured rules. This method should be called
@@ -1216,6 +1471,42 @@ bool TaggedFile::getFileTimeStamps(const QString& path,
   return false;
 }
 
+/**
+ * Get access and modification time of file from file information.
+ * This avoids another query of the file system if the file information
+ * has already been fetched, e.g. to check if the file is writable.
+ * @param fileInfo file information
+ * @param actime the last access time is returned here
+ * @param modtime the last modification time is returned here
+ * @return true if ok.
+ */
+bool TaggedFile::getFileTimeStamps(const QFileInfo& fileInfo,
+                                   quint64& actime, quint64& modtime)
+{
+  if (!fileInfo.exists())
+    return false;
+
+#if QT_VERSION >= 0x050a00
+  const QDateTime lastRead = fileInfo.fileTime(QFileDevice::FileAccessTime);
+  const QDateTime lastModified =
+      fileInfo.fileTime(QFileDevice::FileModificationTime);
+#else
+  const QDateTime lastRead = fileInfo.lastRead();
+  const QDateTime lastModified = fileInfo.lastModified();
+#endif
+  if (!lastRead.isValid() || !lastModified.isValid())
+    return false;
+
+#if QT_VERSION >= 0x050800
+  actime  = lastRead.toSecsSinceEpoch();
+  modtime = lastModified.toSecsSinceEpoch();
+#else
+  actime  = lastRead.toTime_t();
+  modtime = lastModified.toTime_t();
+#endif
+  return true;
+}
+
 /**
  * Set access and modification time of file.
  * @param path file path
@@ -29,10 +29,12 @@
 #include <QString>
 #include <QStringList>
 #include <QList>
+#include <QPair>
 #include <QSet>
 #include <QPersistentModelIndex>
 #include "frame.h"
 
+class QFileInfo;
 class TaggedFileSystemModel;
 
 /** Base class for tagged files. */
@@ -98,7 +100,7 @@ public:
   /**
    * Destructor.
    */
-  virtual ~TaggedFile() = default;
+  virtual ~TaggedFile();
 
   /**
    * Set file name.
@@ -309,6 +311,91 @@ public:
    */
   virtual void getAllFrames(Frame::TagNumber tagNr, FrameCollection& frames);
 
+  /**
+   * Get all frames in tag using a cached snapshot.
+   * The frames are only fetched with getAllFrames() if the tag was changed,
+   * read or cleared since the last call.
+   * The picture data held by the caches of all files is limited, if it is
+   * exceeded, the oldest caches with pictures of files which are not pinned
+   * are invalidated.
+   *
+   * @param tagNr tag number
+   *
+   * @return frames of tag, the reference stays valid until the tag is
+   * modified or the frames of another file are fetched.
+   */
+  const FrameCollection& getAllFramesCached(Frame::TagNumber tagNr);
+
+  /**
+   * Invalidate the cached frames of all tagged files.
+   * Has to be called when the configuration affecting getAllFrames() changes.
+   */
+  static void invalidateAllFrameCaches();
+
+  /**
+   * Check if writeTags() can be called from a worker thread.
+   * If supported, writeTags() can be called for different files at the same
+   * time, enclosed in beginConcurrentWrite() and endConcurrentWrite().
+   * The default implementation returns false.
+   *
+   * @return true if concurrent writing is supported.
+   */
+  virtual bool isConcurrentWriteSupported() const;
+
+  /**
+   * Prepare calling writeTags() from a worker thread.
+   * Has to be called in the thread of the model. The file handle is closed,
+   * until endConcurrentWrite() is called, the model is not accessed, the file
+   * path is taken from a copy and the notifications of the model are
+   * postponed.
+   */
+  void beginConcurrentWrite();
+
+  /**
+   * Finish calling writeTags() from a worker thread.
+   * Has to be called in the thread of the model, closes a file handle left
+   * open by the worker thread and sends the notifications postponed since
+   * beginConcurrentWrite().
+   */
+  void endConcurrentWrite();
+
+  /**
+   * Check if the file is written from a worker thread.
+   * @return true between beginConcurrentWrite() and endConcurrentWrite().
+   */
+  bool isConcurrentWriteInProgress() const {
+    return !m_concurrentWriteDirname.isNull();
+  }
+
+  /**
+   * Keep the tags in memory until unpin() is called.
+   * Has to be called in the thread of the model by operations which keep
+   * the file while they return to the event loop, so that the tags are not
+   * evicted in the meantime. Calls can be nested.
+   */
+  void pin() { ++m_pinCount; }
+
+  /**
+   * Allow the tags to be evicted again after pin().
+   */
+  void unpin() { --m_pinCount; }
+
+  /**
+   * Check if the tags are kept in memory by an operation.
+   * @return true between pin() and unpin().
+   */
+  bool isPinned() const { return m_pinCount > 0; }
+
+  /**
+   * Get number of changes of the tags.
+   * The counter is incremented whenever the frames of a tag are modified or
+   * read, so it can be used to check if data derived from the tags is still
+   * up to date.
+   *
+   * @return change counter.
+   */
+  uint getTagChangeCount() const { return m_tagChangeCount; }
+
   /**
    * Close any file handles which are held open by the tagged file object.
    * The default implementation does nothing. If a concrete subclass holds
@@ -365,6 +452,37 @@ public:
    */
   bool isChanged() const { return m_modified; }
 
+  /**
+   * Get size and modification time of the file from the file system model.
+   * The file system is not queried, the values are those of the last
+   * listing of the folder.
+   *
+   * @param size the size in bytes is returned here
+   * @param modified the modification time in ms since epoch is returned here
+   * @return true if available.
+   */
+  bool getListedFileStamp(qint64& size, qint64& modified) const;
+
+  /**
+   * Remember that the tags have been written to the file.
+   * Has to be called after writeTags() succeeded, so that the following
+   * change of the modification time is not taken as an external
+   * modification.
+   */
+  void markTagsWritten() { m_writtenFileTime = -1; }
+
+  /**
+   * Check if a change of the modification time reported by the file system
+   * watcher is caused by writing the tags in the application.
+   * The first change reported after markTagsWritten() is considered to be
+   * caused by the write and its time is remembered, so that the file does not
+   * have to be queried when the tags are written.
+   *
+   * @param fileTime reported modification time in ms since epoch
+   * @return true if the file has not been modified by another application.
+   */
+  bool checkWrittenFileTime(qint64 fileTime);
+
   /**
    * Check if filename is changed.
    *
@@ -474,6 +592,12 @@ public:
    */
   const QPersistentModelIndex& getIndex() const { return m_index; }
 
+  /**
+   * Get current path to file.
+   * @return absolute path.
+   */
+  QString currentFilePath() const;
+
   /**
    * Check if the file is marked.
    */
@@ -522,6 +646,18 @@ public:
   static bool getFileTimeStamps(const QString& path,
                                 quint64& actime, quint64& modtime);
 
+  /**
+   * Get access and modification time of file from file information.
+   * This avoids another query of the file system if the file information
+   * has already been fetched, e.g. to check if the file is writable.
+   * @param fileInfo file information
+   * @param actime the last access time is returned here
+   * @param modtime the last modification time is returned here
+   * @return true if ok.
+   */
+  static bool getFileTimeStamps(const QFileInfo& fileInfo,
+                                quint64& actime, quint64& modtime);
+
   /**
    * Set access and modification time of file.
    * @param path file path
@@ -575,10 +711,12 @@ protected:
   QString currentFilename() const { return m_filename; }
 
   /**
-   * Get current path to file.
-   * @return absolute path.
+   * Check if writeTags() is called from a worker thread.
+   * @return true between beginConcurrentWrite() and endConcurrentWrite().
    */
-  QString currentFilePath() const;
+  bool isWrittenConcurrently() const {
+    return !m_concurrentWriteDirname.isNull();
+  }
 
   /**
    * Mark filename as unchanged.
@@ -670,6 +808,9 @@ private:
   TaggedFile& operator=(const TaggedFile&);
 
   void updateModifiedState();
+  void invalidateFrameCache(Frame::TagNumber tagNr) const;
+  void addCachedPictureData(Frame::TagNumber tagNr, int size);
+  void removeCachedPictureData(Frame::TagNumber tagNr) const;
 
   /** Index of file in model */
   QPersistentModelIndex m_index;
@@ -689,6 +830,30 @@ private:
   bool m_changed[Frame::Tag_NumValues];
   /** true if tagged file is modified */
   bool m_modified;
+  /** File modification time after the tags have been written in ms since
+      epoch, -1 if not yet reported, 0 if unknown */
+  qint64 m_writtenFileTime;
   /** true if tagged file is marked */
   bool m_marked;
+  /** Frames cached by getAllFramesCached() */
+  mutable FrameCollection m_frameCache[Frame::Tag_NumValues];
+  /** Generation of m_frameCache, 0 if invalid */
+  mutable uint m_frameCacheGeneration[Frame::Tag_NumValues];
+  /** Size of picture data in m_frameCache */
+  mutable int m_frameCachePictureSize[Frame::Tag_NumValues];
+  /** Incremented when the tags are changed */
+  mutable uint m_tagChangeCount;
+  /** Directory name while writing from a worker thread, else null */
+  QString m_concurrentWriteDirname;
+  /** Number of pin() calls without unpin() */
+  int m_pinCount;
+  /** Modification state before beginConcurrentWrite() */
+  bool m_modifiedBeforeConcurrentWrite;
+
+  /** Current generation of frame caches */
+  static uint s_frameCacheGeneration;
+  /** Frame caches with picture data, oldest first */
+  static QList<QPair<const TaggedFile*, Frame::TagNumber>> s_pictureCaches;
+  /** Size of picture data in all frame caches */
+  static qint64 s_pictureCacheSize;
 };
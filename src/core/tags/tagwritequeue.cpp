@@ -0,0 +1,257 @@
+/**
+ * \file tagwritequeue.cpp
+ * Concurrent writing of tags to files on network file systems.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagwritequeue.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QStorageInfo>
+#include <QDir>
+#include <cerrno>
+#include "taggedfile.h"
+#include "performancetracer.h"
+
+namespace {
+
+/** Number of files written at the same time on a network share. */
+constexpr int WRITES_IN_FLIGHT_PER_SHARE = 8;
+
+/** Number of files per share written in a batch. */
+constexpr int FILES_PER_SHARE_IN_BATCH = 4 * WRITES_IN_FLIGHT_PER_SHARE;
+
+/**
+ * Check if a file system type is used for network shares.
+ * @param type file system type as returned by QStorageInfo::fileSystemType()
+ * @return true for a network file system.
+ */
+bool isNetworkFileSystemType(const QByteArray& type)
+{
+  static const QSet<QByteArray> networkTypes{
+    "nfs", "nfs4", "cifs", "smb2", "smb3", "smbfs", "ncpfs", "afs", "9p",
+    "ceph", "davfs", "afpfs", "webdav", "fuse.sshfs", "fuse.glusterfs",
+    "fuse.rclone", "glusterfs", "lustre"
+  };
+  return networkTypes.contains(type.toLower());
+}
+
+/**
+ * Get a network share configured in the environment variable
+ * KID3_NETWORK_SHARES.
+ * The variable contains paths separated like in PATH, which are used as
+ * network shares, e.g. for FUSE file systems which are not detected.
+ * @param dirName directory path
+ * @return configured share containing @a dirName, empty if not found.
+ */
+QString configuredNetworkShare(const QString& dirName)
+{
+  static const QStringList shares = [] {
+    QStringList paths;
+    const QString value =
+        QString::fromLocal8Bit(qgetenv("KID3_NETWORK_SHARES"));
+#ifdef Q_OS_WIN32
+    const QChar separator = QLatin1Char(';');
+#else
+    const QChar separator = QLatin1Char(':');
+#endif
+    const QStringList values = value.split(separator);
+    for (const QString& path : values) {
+      if (!path.isEmpty()) {
+        paths.append(QDir::cleanPath(QDir::fromNativeSeparators(path)));
+      }
+    }
+    return paths;
+  }();
+  for (const QString& share : shares) {
+    if (dirName == share ||
+        dirName.startsWith(share.endsWith(QLatin1Char('/'))
+                           ? share : share + QLatin1Char('/'))) {
+      return share;
+    }
+  }
+  return QString();
+}
+
+}
+
+/**
+ * Job writing the tags of a file.
+ */
+class TagWriter : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param queue queue
+   * @param entry entry of file to write
+   */
+  TagWriter(TagWriteQueue* queue, TagWriteQueue::Entry* entry)
+    : m_queue(queue), m_entry(entry) {
+  }
+
+  /**
+   * Write tags.
+   */
+  void run() override {
+    bool renamed = false;
+    errno = 0;
+    m_entry->ok = m_entry->taggedFile->writeTags(false, &renamed,
+                                                 m_queue->m_preserveTime);
+    m_entry->errorNumber = m_entry->ok ? 0 : errno;
+    if (m_entry->ok) {
+      m_entry->taggedFile->markTagsWritten();
+    }
+    m_entry->done = true;
+    m_queue->m_doneCount.ref();
+  }
+
+private:
+  TagWriteQueue* m_queue;
+  TagWriteQueue::Entry* m_entry;
+};
+
+
+/**
+ * Constructor.
+ * @param preserveTime true to preserve file time stamps
+ */
+TagWriteQueue::TagWriteQueue(bool preserveTime)
+  : m_nextEntry(0), m_preserveTime(preserveTime)
+{
+}
+
+/**
+ * Destructor.
+ */
+TagWriteQueue::~TagWriteQueue()
+{
+  qDeleteAll(m_threadPools);
+}
+
+/**
+ * Add a file to be written concurrently.
+ * @param taggedFile changed tagged file
+ * @return true if the file has been added, false if it has to be
+ * written sequentially.
+ */
+bool TagWriteQueue::enqueue(TaggedFile* taggedFile)
+{
+  // Renamed files are written sequentially because the caller may have to
+  // choose another name if a file with the new name already exists.
+  if (m_nextEntry > 0 || !taggedFile->isConcurrentWriteSupported() ||
+      taggedFile->isFilenameChanged())
+    return false;
+
+  QString share = shareOfDirectory(taggedFile->getDirname());
+  if (share.isEmpty())
+    return false;
+
+  m_entries.append({taggedFile, false, false, 0});
+  m_shares.append(share);
+  m_taggedFiles.insert(taggedFile);
+  if (!m_threadPools.contains(share)) {
+    // Every share gets its own threads, so that a slow share does not
+    // block the writes to other shares.
+    auto threadPool = new QThreadPool;
+    threadPool->setMaxThreadCount(WRITES_IN_FLIGHT_PER_SHARE);
+    m_threadPools.insert(share, threadPool);
+  }
+  return true;
+}
+
+/**
+ * Write the next batch of enqueued files.
+ * Returns when all files of the batch are written, no events are
+ * processed while waiting.
+ * @return true if there are more files to write.
+ */
+bool TagWriteQueue::writeNextBatch()
+{
+  const int numEntries = static_cast<int>(m_entries.size());
+  if (m_nextEntry >= numEntries)
+    return false;
+
+  TraceSpan span("TagWriteQueue::writeNextBatch");
+  const int batchBegin = m_nextEntry;
+  const int batchEnd = qMin(numEntries, batchBegin +
+      FILES_PER_SHARE_IN_BATCH * static_cast<int>(m_threadPools.size()));
+  Entry* entries = m_entries.data();
+  for (int i = batchBegin; i < batchEnd; ++i) {
+    entries[i].taggedFile->beginConcurrentWrite();
+    m_threadPools.value(m_shares.at(i))->start(new TagWriter(this, entries + i));
+  }
+  for (QThreadPool* threadPool : std::as_const(m_threadPools)) {
+    threadPool->waitForDone();
+  }
+  for (int i = batchBegin; i < batchEnd; ++i) {
+    const Entry& entry = entries[i];
+    entry.taggedFile->endConcurrentWrite();
+    if (!entry.ok) {
+      m_failures.append({entry.taggedFile, entry.errorNumber});
+    }
+  }
+  m_nextEntry = batchEnd;
+  return m_nextEntry < numEntries;
+}
+
+/**
+ * Get number of files which have been written.
+ * @return number of written files.
+ */
+int TagWriteQueue::doneCount() const
+{
+#if QT_VERSION >= 0x050e00
+  return m_doneCount.loadRelaxed();
+#else
+  return m_doneCount.load();
+#endif
+}
+
+/**
+ * Get the network share containing a directory.
+ * @param dirName directory path
+ * @return root path of network share, empty if not on a network share.
+ */
+QString TagWriteQueue::shareOfDirectory(const QString& dirName)
+{
+  auto it = m_shareOfDirectory.constFind(dirName);
+  if (it == m_shareOfDirectory.constEnd()) {
+    QString share;
+    if (QString configured = configuredNetworkShare(dirName);
+        !configured.isEmpty()) {
+      share = configured;
+    } else if (dirName.startsWith(QLatin1String("//")) ||
+               dirName.startsWith(QLatin1String("\\\\"))) {
+      // UNC path, use "//server/share" as the share.
+      QString path = dirName;
+      path.replace(QLatin1Char('\\'), QLatin1Char('/'));
+      share = path.section(QLatin1Char('/'), 0, 3);
+    } else if (QStorageInfo storage(dirName);
+               storage.isValid() &&
+               isNetworkFileSystemType(storage.fileSystemType())) {
+      share = storage.rootPath();
+    }
+    it = m_shareOfDirectory.insert(dirName, share);
+  }
+  return *it;
+}
@@ -0,0 +1,149 @@
+/**
+ * \file tagwritequeue.h
+ * Concurrent writing of tags to files on network file systems.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QAtomicInt>
+#include "kid3api.h"
+
+class QThreadPool;
+class TaggedFile;
+
+/**
+ * Concurrent writing of tags to files on network file systems.
+ *
+ * When saving files on a network share, the time is dominated by the
+ * latency of the round trips to the server and not by the bandwidth.
+ * Files which are enqueued are therefore written from several threads per
+ * share, so that multiple writes are in flight at the same time. Only files
+ * on network file systems which support concurrent writing and which are
+ * not renamed are enqueued, the others have to be written sequentially by
+ * the caller as before.
+ *
+ * The files are written in batches of a few files per share. While a batch
+ * is written, the calling thread is blocked without processing events, so
+ * that neither the model nor the user interface can access the files which
+ * are written by the worker threads. Progress can be reported and events
+ * processed between the batches.
+ *
+ * The tags which have been written stay in memory and are not read back
+ * from the share. Folders which are not detected as network shares can be
+ * listed in the environment variable KID3_NETWORK_SHARES.
+ *
+ * All methods have to be called from the thread of the file system model.
+ */
+class KID3_CORE_EXPORT TagWriteQueue {
+public:
+  /** File which could not be written. */
+  struct Failure {
+    TaggedFile* taggedFile; /**< tagged file */
+    int errorNumber;        /**< errno after writing failed, 0 if unknown */
+  };
+
+  /**
+   * Constructor.
+   * @param preserveTime true to preserve file time stamps
+   */
+  explicit TagWriteQueue(bool preserveTime);
+
+  /**
+   * Destructor.
+   */
+  ~TagWriteQueue();
+
+  /**
+   * Add a file to be written concurrently.
+   * @param taggedFile changed tagged file
+   * @return true if the file has been added, false if it has to be
+   * written sequentially.
+   */
+  bool enqueue(TaggedFile* taggedFile);
+
+  /**
+   * Check if a file has been added with enqueue().
+   * @param taggedFile tagged file
+   * @return true if the file is in the queue.
+   */
+  bool contains(TaggedFile* taggedFile) const {
+    return m_taggedFiles.contains(taggedFile);
+  }
+
+  /**
+   * Check if files have been added.
+   * @return true if queue is empty.
+   */
+  bool isEmpty() const { return m_entries.isEmpty(); }
+
+  /**
+   * Write the next batch of enqueued files.
+   * Returns when all files of the batch are written, no events are
+   * processed while waiting.
+   * @return true if there are more files to write.
+   */
+  bool writeNextBatch();
+
+  /**
+   * Get number of files which have been written.
+   * @return number of written files.
+   */
+  int doneCount() const;
+
+  /**
+   * Get files which could not be written.
+   * @return files which could not be written.
+   */
+  QList<Failure> failures() const { return m_failures; }
+
+private:
+  Q_DISABLE_COPY(TagWriteQueue)
+
+  friend class TagWriter;
+
+  /** File in queue. */
+  struct Entry {
+    TaggedFile* taggedFile; /**< tagged file */
+    bool done;              /**< true if written */
+    bool ok;                /**< true if written successfully */
+    int errorNumber;        /**< errno if not ok */
+  };
+
+  QString shareOfDirectory(const QString& dirName);
+
+  QVector<Entry> m_entries;
+  QList<QString> m_shares;
+  QSet<TaggedFile*> m_taggedFiles;
+  QHash<QString, QString> m_shareOfDirectory;
+  QHash<QString, QThreadPool*> m_threadPools;
+  QList<Failure> m_failures;
+  QAtomicInt m_doneCount;
+  int m_nextEntry;
+  bool m_preserveTime;
+};
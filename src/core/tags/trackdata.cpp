@@ -30,6 +30,8 @@
 #include <QDir>
 #include <QDateTime>
 #include <QCoreApplication>
+#include <QAtomicInt>
+#include <algorithm>
 #include "fileproxymodel.h"
 
 /**
@@ -171,8 +173,7 @@ QString TrackDataFormatReplacer::getReplacement(const QString& code) const
       } else if (name == QLatin1String("codec")) {
         result = info.format;
       } else if (name == QLatin1String("marked")) {
-        TaggedFile* taggedFile = m_trackData.getTaggedFile();
-        result = taggedFile && taggedFile->isMarked()
+        result = m_trackData.isMarked()
             ? QLatin1String("1") : QLatin1String("");
       }
     }
@@ -316,11 +317,9 @@ TrackData::TrackData(TaggedFile& taggedFile, Frame::TagVersion tagVersion)
 {
   for (Frame::TagNumber tagNr : Frame::tagNumbersFromMask(tagVersion)) {
     if (empty()) {
-      taggedFile.getAllFrames(tagNr, *this);
+      FrameCollection::operator=(taggedFile.getAllFramesCached(tagNr));
     } else {
-      FrameCollection frames;
-      taggedFile.getAllFrames(tagNr, frames);
-      merge(frames);
+      merge(taggedFile.getAllFramesCached(tagNr));
     }
   }
 }
@@ -333,12 +332,59 @@ TaggedFile* TrackData::getTaggedFile() const {
   return FileProxyModel::getTaggedFileOfIndex(m_taggedFileIndex);
 }
 
+/**
+ * Check if the file is marked.
+ * @return true if marked.
+ */
+bool TrackData::isMarked() const
+{
+  if (m_detachedFileInfo) {
+    return m_detachedFileInfo->marked;
+  }
+  TaggedFile* taggedFile = getTaggedFile();
+  return taggedFile && taggedFile->isMarked();
+}
+
+/**
+ * Copy the information about the file from the tagged file.
+ * Afterwards, the file information is taken from the copy instead of
+ * the tagged file, so that the track data can be formatted in a worker
+ * thread without accessing the model or the tagged file.
+ * Has to be called in the thread of the model.
+ *
+ * @param numTracksInDir total number of tracks in the directory,
+ * -1 if unavailable
+ */
+void TrackData::detachFromTaggedFile(int numTracksInDir)
+{
+  auto info = QSharedPointer<DetachedFileInfo>::create();
+  info->duration = 0;
+  info->numTracksInDir = numTracksInDir;
+  info->marked = false;
+  if (TaggedFile* taggedFile = getTaggedFile()) {
+    info->absFilename = taggedFile->getAbsFilename();
+    info->filename = taggedFile->getFilename();
+    info->dirname = taggedFile->getDirname();
+    info->fileExtension = taggedFile->getFileExtension();
+    FOR_ALL_TAGS(tagNr) {
+      info->tagFormats[tagNr] = taggedFile->getTagFormat(tagNr);
+    }
+    taggedFile->getDetailInfo(info->detailInfo);
+    info->duration = taggedFile->getDuration();
+    info->marked = taggedFile->isMarked();
+  }
+  m_detachedFileInfo = info;
+}
+
 /**
  * Get duration of file.
  * @return duration of file.
  */
 int TrackData::getFileDuration() const
 {
+  if (m_detachedFileInfo) {
+    return m_detachedFileInfo->duration;
+  }
   TaggedFile* taggedFile = getTaggedFile();
   return taggedFile ? taggedFile->getDuration() : 0;
 }
@@ -350,6 +396,9 @@ int TrackData::getFileDuration() const
  */
 QString TrackData::getAbsFilename() const
 {
+  if (m_detachedFileInfo) {
+    return m_detachedFileInfo->absFilename;
+  }
   TaggedFile* taggedFile = getTaggedFile();
   return taggedFile ? taggedFile->getAbsFilename() : QString();
 }
@@ -361,6 +410,9 @@ QString TrackData::getAbsFilename() const
  */
 QString TrackData::getFilename() const
 {
+  if (m_detachedFileInfo) {
+    return m_detachedFileInfo->filename;
+  }
   TaggedFile* taggedFile = getTaggedFile();
   return taggedFile ? taggedFile->getFilename() : QString();
 }
@@ -372,6 +424,9 @@ QString TrackData::getFilename() const
  */
 QString TrackData::getDirname() const
 {
+  if (m_detachedFileInfo) {
+    return m_detachedFileInfo->dirname;
+  }
   TaggedFile* taggedFile = getTaggedFile();
   return taggedFile ? taggedFile->getDirname() : QString();
 }
@@ -386,6 +441,10 @@ QString TrackData::getDirname() const
  */
 QString TrackData::getTagFormat(Frame::TagNumber tagNr) const
 {
+  if (m_detachedFileInfo) {
+    return tagNr < Frame::Tag_NumValues
+        ? m_detachedFileInfo->tagFormats[tagNr] : QString();
+  }
   TaggedFile* taggedFile = getTaggedFile();
   return taggedFile ? taggedFile->getTagFormat(tagNr) : QString();
 }
@@ -396,7 +455,9 @@ QString TrackData::getTagFormat(Frame::TagNumber tagNr) const
  */
 void TrackData::getDetailInfo(TaggedFile::DetailInfo& info) const
 {
-  if (TaggedFile* taggedFile = getTaggedFile()) {
+  if (m_detachedFileInfo) {
+    info = m_detachedFileInfo->detailInfo;
+  } else if (TaggedFile* taggedFile = getTaggedFile()) {
     taggedFile->getDetailInfo(info);
   }
 }
@@ -479,7 +540,10 @@ QString TrackData::getFileExtension(bool preferFromFilename) const
 {
   QString fileExtension;
   QString absFilename;
-  if (TaggedFile* taggedFile = getTaggedFile()) {
+  if (m_detachedFileInfo) {
+    fileExtension = m_detachedFileInfo->fileExtension;
+    absFilename = m_detachedFileInfo->absFilename;
+  } else if (TaggedFile* taggedFile = getTaggedFile()) {
     fileExtension = taggedFile->getFileExtension();
     absFilename = taggedFile->getAbsFilename();
   }
@@ -498,6 +562,9 @@ QString TrackData::getFileExtension(bool preferFromFilename) const
  */
 int TrackData::getTotalNumberOfTracksInDir() const
 {
+  if (m_detachedFileInfo) {
+    return m_detachedFileInfo->numTracksInDir;
+  }
   TaggedFile* taggedFile = getTaggedFile();
   return taggedFile ? taggedFile->getTotalNumberOfTracksInDir() : -1;
 }
@@ -521,54 +588,155 @@ int ImportTrackData::getTimeDifference() const
 namespace {
 
 /**
- * Get lower case words found in string.
- * @return lower case words.
+ * Check if a string is still the same as one stored before.
+ * The strings are implicitly shared and a string is detached before it is
+ * modified, so the same data means the same contents without comparing
+ * them.
+ * @param str string
+ * @param stored copy of the string stored before
+ * @return true if @a str has the same data as @a stored.
  */
-QSet<QString> getLowerCaseWords(const QString& str)
+bool isSameString(const QString& str, const QString& stored)
 {
-  if (!str.isEmpty()) {
-    QString normalized = str.normalized(QString::NormalizationForm_D).toLower();
-    QString simplified;
-    for (auto it = normalized.constBegin(); it != normalized.constEnd(); ++it) {
-      if (it->isLetter()) {
-        simplified += *it;
-      } else if (it->isPunct() || it->isSpace() || it->isSymbol()) {
-        simplified += QLatin1Char(' ');
-      }
+  return str.constData() == stored.constData() && str.size() == stored.size();
+}
+
+}
+
+/**
+ * Constructor.
+ */
+WordIdMap::WordIdMap()
+{
+  // 0 is used for word lists which have not been computed.
+  static QAtomicInt lastSerial;
+  do {
+    m_serial = static_cast<uint>(lastSerial.fetchAndAddRelaxed(1) + 1);
+  } while (m_serial == 0);
+}
+
+/**
+ * Get case folded words without diacritics.
+ * @param str string
+ * @return words of @a str in the order in which they occur.
+ */
+QStringList WordIdMap::words(const QString& str)
+{
+  QStringList result;
+  if (str.isEmpty())
+    return result;
+
+  // The decomposition separates the diacritics from the letters, they are
+  // skipped because they are not letters.
+  const QString normalized =
+      str.normalized(QString::NormalizationForm_D).toCaseFolded();
+  QString word;
+  for (auto it = normalized.constBegin(); it != normalized.constEnd(); ++it) {
+    if (it->isLetter()) {
+      word += *it;
+    } else if ((it->isPunct() || it->isSpace() || it->isSymbol()) &&
+               !word.isEmpty()) {
+      result.append(word);
+      word.clear();
     }
-#if QT_VERSION >= 0x050e00
-    const QStringList words =
-        simplified.split(QLatin1Char(' '), Qt::SkipEmptyParts);
-    return QSet(words.constBegin(), words.constEnd());
-#else
-    return simplified.split(QLatin1Char(' '), QString::SkipEmptyParts).toSet();
-#endif
   }
-  return QSet<QString>();
+  if (!word.isEmpty()) {
+    result.append(word);
+  }
+  return result;
+}
+
+/**
+ * Get words of a string.
+ * @param str string
+ * @return IDs of case folded words without diacritics found in @a str,
+ * in ascending order.
+ */
+QVector<int> WordIdMap::wordIds(const QString& str)
+{
+  const QStringList strWords = words(str);
+  QVector<int> ids;
+  ids.reserve(strWords.size());
+  for (const QString& word : strWords) {
+    auto it = m_ids.constFind(word);
+    if (it == m_ids.constEnd()) {
+      it = m_ids.insert(word, static_cast<int>(m_ids.size()));
+    }
+    ids.append(*it);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return ids;
 }
 
+/**
+ * Count the words which are contained in two word lists.
+ * @param lhs word IDs in ascending order, e.g. from getFilenameWords()
+ * @param rhs word IDs in ascending order, e.g. from getTitleWords() with
+ * the same WordIdMap
+ * @return number of common words.
+ */
+int ImportTrackData::countCommonWords(const QVector<int>& lhs,
+                                      const QVector<int>& rhs)
+{
+  int count = 0;
+  auto lit = lhs.constBegin();
+  auto rit = rhs.constBegin();
+  while (lit != lhs.constEnd() && rit != rhs.constEnd()) {
+    if (*lit < *rit) {
+      ++lit;
+    } else if (*rit < *lit) {
+      ++rit;
+    } else {
+      ++count;
+      ++lit;
+      ++rit;
+    }
+  }
+  return count;
 }
 
 /**
  * Get words of file name.
- * @return lower case words found in file name.
+ * The words are computed once and reused until the file name changes or
+ * another @a wordIds is used.
+ * @param wordIds IDs of words, the same for all tracks compared
+ * @return IDs of case folded words without diacritics found in file name,
+ * in ascending order.
  */
-QSet<QString> ImportTrackData::getFilenameWords() const
+const QVector<int>& ImportTrackData::getFilenameWords(WordIdMap& wordIds) const
 {
-  QString fileName = getFilename();
-  if (int endIndex = fileName.lastIndexOf(QLatin1Char('.')); endIndex > 0) {
-    fileName.truncate(endIndex);
+  if (QString fileName = getFilename();
+      m_filenameWordsSerial != wordIds.serial() ||
+      !isSameString(fileName, m_filenameOfWords)) {
+    m_filenameOfWords = fileName;
+    m_filenameWordsSerial = wordIds.serial();
+    if (int endIndex = fileName.lastIndexOf(QLatin1Char('.')); endIndex > 0) {
+      fileName.truncate(endIndex);
+    }
+    m_filenameWords = wordIds.wordIds(fileName);
   }
-  return getLowerCaseWords(fileName);
+  return m_filenameWords;
 }
 
 /**
  * Get words of title.
- * @return lower case words found in title.
+ * The words are computed once and reused until the title changes or
+ * another @a wordIds is used.
+ * @param wordIds IDs of words, the same for all tracks compared
+ * @return IDs of case folded words without diacritics found in title,
+ * in ascending order.
  */
-QSet<QString> ImportTrackData::getTitleWords() const
+const QVector<int>& ImportTrackData::getTitleWords(WordIdMap& wordIds) const
 {
-  return getLowerCaseWords(getTitle());
+  if (QString title = getTitle();
+      m_titleWordsSerial != wordIds.serial() ||
+      !isSameString(title, m_titleOfWords)) {
+    m_titleOfWords = title;
+    m_titleWordsSerial = wordIds.serial();
+    m_titleWords = wordIds.wordIds(title);
+  }
+  return m_titleWords;
 }
 
 
@@ -628,10 +796,8 @@ QString ImportTrackDataVector::getFrame(Frame::Type type) const
     if (!result.isEmpty())
       return result;
     TaggedFile* taggedFile = trackData.getTaggedFile();
-    FrameCollection frames;
     for (Frame::TagNumber tagNr : Frame::allTagNumbers()) {
-      taggedFile->getAllFrames(tagNr, frames);
-      result = frames.getValue(type);
+      result = taggedFile->getAllFramesCached(tagNr).getValue(type);
       if (!result.isEmpty())
         return result;
     }
@@ -652,11 +818,10 @@ void ImportTrackDataVector::readTags(Frame::TagVersion tagVersion)
       it->clear();
       for (Frame::TagNumber tagNr : Frame::tagNumbersFromMask(tagVersion)) {
         if (it->empty()) {
-          taggedFile->getAllFrames(tagNr, *it);
+          static_cast<FrameCollection&>(*it) =
+              taggedFile->getAllFramesCached(tagNr);
         } else {
-          FrameCollection frames;
-          taggedFile->getAllFrames(tagNr, frames);
-          it->merge(frames);
+          it->merge(taggedFile->getAllFramesCached(tagNr));
         }
       }
     }
@@ -29,7 +29,10 @@
 #include <QVector>
 #include <QString>
 #include <QSet>
+#include <QHash>
+#include <QStringList>
 #include <QUrl>
+#include <QSharedPointer>
 #include "frame.h"
 #include "taggedfile.h"
 #include "kid3api.h"
@@ -165,6 +168,24 @@ public:
    */
   TaggedFile* getTaggedFile() const;
 
+  /**
+   * Check if the file is marked.
+   * @return true if marked.
+   */
+  bool isMarked() const;
+
+  /**
+   * Copy the information about the file from the tagged file.
+   * Afterwards, the file information is taken from the copy instead of
+   * the tagged file, so that the track data can be formatted in a worker
+   * thread without accessing the model or the tagged file.
+   * Has to be called in the thread of the model.
+   *
+   * @param numTracksInDir total number of tracks in the directory,
+   * -1 if unavailable
+   */
+  void detachFromTaggedFile(int numTracksInDir);
+
   /**
    * Get help text for format codes supported by formatString().
    *
@@ -176,7 +197,60 @@ public:
   static QString getFormatToolTip(bool onlyRows = false);
 
 private:
+  /** Information copied from tagged file by detachFromTaggedFile(). */
+  struct DetachedFileInfo {
+    QString absFilename;
+    QString filename;
+    QString dirname;
+    QString fileExtension;
+    QString tagFormats[Frame::Tag_NumValues];
+    TaggedFile::DetailInfo detailInfo;
+    int duration;
+    int numTracksInDir;
+    bool marked;
+  };
+
   QPersistentModelIndex m_taggedFileIndex;
+  QSharedPointer<const DetachedFileInfo> m_detachedFileInfo;
+};
+
+/**
+ * IDs of words used to compare the words of file names and titles.
+ * Word lists can only be compared if they have been created by the same
+ * object, which is used for one matching run in one thread, so that the
+ * words do not accumulate and no locking is needed.
+ */
+class KID3_CORE_EXPORT WordIdMap {
+public:
+  /**
+   * Constructor.
+   */
+  WordIdMap();
+
+  /**
+   * Get words of a string.
+   * @param str string
+   * @return IDs of case folded words without diacritics found in @a str,
+   * in ascending order.
+   */
+  QVector<int> wordIds(const QString& str);
+
+  /**
+   * Get serial number identifying this object.
+   * @return serial number, unique in the process.
+   */
+  uint serial() const { return m_serial; }
+
+  /**
+   * Get case folded words without diacritics.
+   * @param str string
+   * @return words of @a str in the order in which they occur.
+   */
+  static QStringList words(const QString& str);
+
+private:
+  QHash<QString, int> m_ids;
+  uint m_serial;
 };
 
 /**
@@ -187,7 +261,9 @@ public:
   /**
    * Constructor.
    */
-  ImportTrackData() : m_importDuration(0), m_enabled(true) {}
+  ImportTrackData()
+    : m_filenameWordsSerial(0), m_titleWordsSerial(0), m_importDuration(0),
+      m_enabled(true) {}
 
   /**
    * Constructor.
@@ -198,7 +274,9 @@ public:
    * @param tagVersion source of frames
    */
   ImportTrackData(TaggedFile& taggedFile, Frame::TagVersion tagVersion)
-    : TrackData(taggedFile, tagVersion), m_importDuration(0), m_enabled(true) {}
+    : TrackData(taggedFile, tagVersion),
+      m_filenameWordsSerial(0), m_titleWordsSerial(0), m_importDuration(0),
+      m_enabled(true) {}
 
   /**
    * Get duration of import.
@@ -232,17 +310,41 @@ public:
 
   /**
    * Get words of file name.
-   * @return lower case words found in file name.
+   * The words are computed once and reused until the file name changes or
+   * another @a wordIds is used.
+   * @param wordIds IDs of words, the same for all tracks compared
+   * @return IDs of case folded words without diacritics found in file name,
+   * in ascending order.
    */
-  QSet<QString> getFilenameWords() const;
+  const QVector<int>& getFilenameWords(WordIdMap& wordIds) const;
 
   /**
    * Get words of title.
-   * @return lower case words found in title.
+   * The words are computed once and reused until the title changes or
+   * another @a wordIds is used.
+   * @param wordIds IDs of words, the same for all tracks compared
+   * @return IDs of case folded words without diacritics found in title,
+   * in ascending order.
+   */
+  const QVector<int>& getTitleWords(WordIdMap& wordIds) const;
+
+  /**
+   * Count the words which are contained in two word lists.
+   * @param lhs word IDs in ascending order, e.g. from getFilenameWords()
+   * @param rhs word IDs in ascending order, e.g. from getTitleWords() with
+   * the same WordIdMap
+   * @return number of common words.
    */
-  QSet<QString> getTitleWords() const;
+  static int countCommonWords(const QVector<int>& lhs,
+                              const QVector<int>& rhs);
 
 private:
+  mutable QString m_filenameOfWords;
+  mutable QString m_titleOfWords;
+  mutable QVector<int> m_filenameWords;
+  mutable QVector<int> m_titleWords;
+  mutable uint m_filenameWordsSerial;
+  mutable uint m_titleWordsSerial;
   int m_importDuration;
   bool m_enabled;
 };
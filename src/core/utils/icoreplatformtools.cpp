@@ -105,6 +105,24 @@ bool ICorePlatformTools::hasGui() const
   return false;
 }
 
+/**
+ * Scale image data so that it fits into a square.
+ * This method is called from worker threads and must be thread-safe.
+ * This default implementation does not support images and returns an
+ * empty byte array.
+ * @param data image data
+ * @param maxSize maximum width and height in pixels
+ * @return image data in the same format scaled to fit into @a maxSize,
+ * empty if the image already fits or could not be scaled.
+ */
+QByteArray ICorePlatformTools::scaleImageData(const QByteArray& data,
+                                              int maxSize) const
+{
+  Q_UNUSED(data)
+  Q_UNUSED(maxSize)
+  return QByteArray();
+}
+
 /**
  * Construct a name filter string suitable for file dialogs.
  * This function can be used to implement fileDialogNameFilter()
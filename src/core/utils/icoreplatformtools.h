@@ -27,6 +27,7 @@
 #pragma once
 
 #include <QList>
+#include <QByteArray>
 #include <QPair>
 #include "kid3api.h"
 
@@ -154,6 +155,18 @@ public:
    */
   virtual bool hasGui() const;
 
+  /**
+   * Scale image data so that it fits into a square.
+   * This method is called from worker threads and must be thread-safe.
+   * This default implementation does not support images and returns an
+   * empty byte array.
+   * @param data image data
+   * @param maxSize maximum width and height in pixels
+   * @return image data in the same format scaled to fit into @a maxSize,
+   * empty if the image already fits or could not be scaled.
+   */
+  virtual QByteArray scaleImageData(const QByteArray& data, int maxSize) const;
+
 protected:
   /**
    * Construct a name filter string suitable for file dialogs.
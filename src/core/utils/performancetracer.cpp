@@ -0,0 +1,293 @@
+/**
+ * \file performancetracer.cpp
+ * Low overhead tracing of time spent in hot code paths.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "performancetracer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QFile>
+#include <QTextStream>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <cstdio>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/** Finished span. */
+struct SpanEvent {
+  const char* name;
+  qint64 start;
+  qint64 duration;
+  quintptr threadId;
+  QString detail;
+};
+
+/**
+ * State of tracer, only allocated if tracing is enabled.
+ * It is never freed, so that spans which are added by worker threads while
+ * the application exits do not access freed memory.
+ */
+struct TracerState {
+  QElapsedTimer timer;
+  QMutex mutex;
+  QVector<SpanEvent> events;
+  QString traceFilePath;
+  bool finished = false;
+};
+
+std::atomic<TracerState*> s_state{nullptr};
+
+/**
+ * Escape a string for a JSON string literal.
+ * @param str string
+ * @return escaped string.
+ */
+QString escapeJson(const QString& str)
+{
+  QString result;
+  result.reserve(str.size());
+  for (QChar ch : str) {
+    if (ch == QLatin1Char('"') || ch == QLatin1Char('\\')) {
+      result += QLatin1Char('\\');
+      result += ch;
+    } else if (ch.unicode() < 0x20) {
+      result += QString(QLatin1String("\\u%1"))
+          .arg(ch.unicode(), 4, 16, QLatin1Char('0'));
+    } else {
+      result += ch;
+    }
+  }
+  return result;
+}
+
+/**
+ * Get percentile of sorted durations.
+ * @param sorted sorted durations
+ * @param percent percentile 0..100
+ * @return duration at percentile.
+ */
+qint64 percentile(const QVector<qint64>& sorted, int percent)
+{
+  if (sorted.isEmpty())
+    return 0;
+  int idx = static_cast<int>((static_cast<qint64>(sorted.size()) - 1) *
+                             percent / 100);
+  return sorted.at(idx);
+}
+
+}
+
+std::atomic<bool> PerformanceTracer::s_enabled{false};
+
+/**
+ * Enable tracing.
+ * The trace file is written and the summary printed when the
+ * application exits.
+ * @param traceFilePath path to Chrome trace JSON file, empty to only
+ * print the summary
+ */
+void PerformanceTracer::enable(const QString& traceFilePath)
+{
+  TracerState* state = s_state.load();
+  if (!state) {
+    state = new TracerState;
+    state->timer.start();
+    s_state.store(state);
+    qAddPostRoutine(finish);
+  }
+  {
+    QMutexLocker locker(&state->mutex);
+    state->traceFilePath = traceFilePath;
+    state->finished = false;
+  }
+  s_enabled.store(true);
+}
+
+/**
+ * Enable tracing if the environment variable KID3_TRACE_FILE is set.
+ */
+void PerformanceTracer::enableFromEnvironment()
+{
+  if (qEnvironmentVariableIsSet("KID3_TRACE_FILE")) {
+    enable(QFile::decodeName(qgetenv("KID3_TRACE_FILE")));
+  }
+}
+
+/**
+ * Get current time stamp.
+ * @return nanoseconds since tracing was enabled.
+ */
+qint64 PerformanceTracer::now()
+{
+  const TracerState* state = s_state.load();
+  return state ? state->timer.nsecsElapsed() : 0;
+}
+
+/**
+ * Add a finished span.
+ * Can be called from any thread.
+ * @param name name of span, must be a string literal
+ * @param startNs start time stamp returned by now()
+ * @param detail optional detail, e.g. file name
+ */
+void PerformanceTracer::addSpan(const char* name, qint64 startNs,
+                                const QString& detail)
+{
+  TracerState* state = s_state.load();
+  if (!state)
+    return;
+
+  qint64 duration = state->timer.nsecsElapsed() - startNs;
+  auto threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  QMutexLocker locker(&state->mutex);
+  // Spans finished after the trace was written are dropped.
+  if (!state->finished) {
+    state->events.append({name, startNs, duration, threadId, detail});
+  }
+}
+
+/**
+ * Write the spans collected so far as Chrome trace JSON.
+ * @param path path to file
+ * @return true if ok.
+ */
+bool PerformanceTracer::writeChromeTrace(const QString& path)
+{
+  TracerState* state = s_state.load();
+  if (!state)
+    return false;
+
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return false;
+
+  QMutexLocker locker(&state->mutex);
+  QHash<quintptr, int> threadNumbers;
+  QTextStream stream(&file);
+  stream << "{\"traceEvents\":[";
+  bool first = true;
+  for (const SpanEvent& event : std::as_const(state->events)) {
+    int tid = threadNumbers.value(event.threadId, -1);
+    if (tid == -1) {
+      tid = threadNumbers.size() + 1;
+      threadNumbers.insert(event.threadId, tid);
+    }
+    if (!first) {
+      stream << ",";
+    }
+    first = false;
+    stream << "\n{\"name\":\"" << event.name
+           << "\",\"cat\":\"kid3\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+           << ",\"ts\":" << QString::number(event.start / 1000.0, 'f', 3)
+           << ",\"dur\":" << QString::number(event.duration / 1000.0, 'f', 3);
+    if (!event.detail.isEmpty()) {
+      stream << ",\"args\":{\"detail\":\"" << escapeJson(event.detail)
+             << "\"}";
+    }
+    stream << "}";
+  }
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return stream.status() == QTextStream::Ok;
+}
+
+/**
+ * Get summary table with count, total, p50 and p99 per span name.
+ * @return summary as text.
+ */
+QString PerformanceTracer::summary()
+{
+  TracerState* state = s_state.load();
+  if (!state)
+    return QString();
+
+  QMap<QString, QVector<qint64>> durationsByName;
+  {
+    QMutexLocker locker(&state->mutex);
+    for (const SpanEvent& event : std::as_const(state->events)) {
+      durationsByName[QString::fromLatin1(event.name)].append(event.duration);
+    }
+  }
+
+  int nameWidth = 4;
+  for (auto it = durationsByName.constBegin();
+       it != durationsByName.constEnd();
+       ++it) {
+    nameWidth = qMax(nameWidth, static_cast<int>(it.key().size()));
+  }
+  QString result = QString(QLatin1String("%1 %2 %3 %4 %5\n"))
+      .arg(QLatin1String("Span"), -nameWidth)
+      .arg(QLatin1String("Count"), 8)
+      .arg(QLatin1String("Total ms"), 12)
+      .arg(QLatin1String("p50 ms"), 10)
+      .arg(QLatin1String("p99 ms"), 10);
+  for (auto it = durationsByName.begin(); it != durationsByName.end(); ++it) {
+    QVector<qint64>& durations = it.value();
+    std::sort(durations.begin(), durations.end());
+    qint64 total = 0;
+    for (qint64 duration : std::as_const(durations)) {
+      total += duration;
+    }
+    result += QString(QLatin1String("%1 %2 %3 %4 %5\n"))
+        .arg(it.key(), -nameWidth)
+        .arg(durations.size(), 8)
+        .arg(total / 1e6, 12, 'f', 3)
+        .arg(percentile(durations, 50) / 1e6, 10, 'f', 3)
+        .arg(percentile(durations, 99) / 1e6, 10, 'f', 3);
+  }
+  return result;
+}
+
+/**
+ * Write trace file and print summary, called when the application exits.
+ */
+void PerformanceTracer::finish()
+{
+  TracerState* state = s_state.load();
+  if (!state)
+    return;
+
+  s_enabled.store(false);
+  QString traceFilePath;
+  {
+    QMutexLocker locker(&state->mutex);
+    traceFilePath = state->traceFilePath;
+  }
+  if (!traceFilePath.isEmpty() && !writeChromeTrace(traceFilePath)) {
+    qWarning("Could not write trace file %s", qPrintable(traceFilePath));
+  }
+  std::fputs(summary().toLocal8Bit().constData(), stderr);
+
+  // The state is not freed because worker threads can still add spans,
+  // only the events are released.
+  QMutexLocker locker(&state->mutex);
+  state->finished = true;
+  state->events.clear();
+  state->events.squeeze();
+}
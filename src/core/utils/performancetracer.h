@@ -0,0 +1,167 @@
+/**
+ * \file performancetracer.h
+ * Low overhead tracing of time spent in hot code paths.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <type_traits>
+#include "kid3api.h"
+
+/**
+ * Collector for timing spans.
+ *
+ * Tracing is disabled by default, a disabled span only costs the check of a
+ * flag. It is enabled with the environment variable KID3_TRACE_FILE (or the
+ * kid3-cli option --trace) set to the path of a file. When the application
+ * exits, the spans are written to this file in the Chrome trace event format,
+ * which can be loaded into chrome://tracing or Perfetto, and a summary with
+ * count, total, p50 and p99 duration per span name is printed to the standard
+ * error.
+ */
+class KID3_CORE_EXPORT PerformanceTracer {
+public:
+  /**
+   * Check if tracing is enabled.
+   * @return true if enabled.
+   */
+  static bool isEnabled() {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Enable tracing.
+   * The trace file is written and the summary printed when the
+   * application exits.
+   * @param traceFilePath path to Chrome trace JSON file, empty to only
+   * print the summary
+   */
+  static void enable(const QString& traceFilePath);
+
+  /**
+   * Enable tracing if the environment variable KID3_TRACE_FILE is set.
+   */
+  static void enableFromEnvironment();
+
+  /**
+   * Get current time stamp.
+   * @return nanoseconds since tracing was enabled.
+   */
+  static qint64 now();
+
+  /**
+   * Add a finished span.
+   * Can be called from any thread.
+   * @param name name of span, must be a string literal
+   * @param startNs start time stamp returned by now()
+   * @param detail optional detail, e.g. file name
+   */
+  static void addSpan(const char* name, qint64 startNs,
+                      const QString& detail = QString());
+
+  /**
+   * Write the spans collected so far as Chrome trace JSON.
+   * @param path path to file
+   * @return true if ok.
+   */
+  static bool writeChromeTrace(const QString& path);
+
+  /**
+   * Get summary table with count, total, p50 and p99 per span name.
+   * @return summary as text.
+   */
+  static QString summary();
+
+private:
+  static void finish();
+
+  static std::atomic<bool> s_enabled;
+};
+
+/**
+ * Span measuring the time from construction to destruction.
+ * Usage: TraceSpan span("TaggedFile::readTags", fileName);
+ */
+class TraceSpan {
+public:
+  /**
+   * Constructor, starts the span if tracing is enabled.
+   * @param name name of span, must be a string literal
+   */
+  explicit TraceSpan(const char* name)
+    : m_name(name),
+      m_start(PerformanceTracer::isEnabled() ? PerformanceTracer::now() : -1) {
+  }
+
+  /**
+   * Constructor, starts the span if tracing is enabled.
+   * @param name name of span, must be a string literal
+   * @param detail detail, e.g. file name
+   */
+  TraceSpan(const char* name, const QString& detail)
+    : m_name(name),
+      m_start(PerformanceTracer::isEnabled() ? PerformanceTracer::now() : -1) {
+    if (m_start >= 0) {
+      m_detail = detail;
+    }
+  }
+
+  /**
+   * Constructor, starts the span if tracing is enabled.
+   * The detail is only built if tracing is enabled, so that it does not
+   * cost anything otherwise.
+   * Usage: TraceSpan span("M4aFile::readTags", [this] {
+   *          return currentFilePath(); });
+   * @param name name of span, must be a string literal
+   * @param detailFunc function returning the detail, e.g. file name
+   */
+  template <typename DetailFunc,
+            typename = std::enable_if_t<
+              std::is_invocable_r_v<QString, DetailFunc>>>
+  TraceSpan(const char* name, DetailFunc detailFunc)
+    : m_name(name),
+      m_start(PerformanceTracer::isEnabled() ? PerformanceTracer::now() : -1) {
+    if (m_start >= 0) {
+      m_detail = detailFunc();
+    }
+  }
+
+  /**
+   * Destructor, finishes the span.
+   */
+  ~TraceSpan() {
+    if (m_start >= 0) {
+      PerformanceTracer::addSpan(m_name, m_start, m_detail);
+    }
+  }
+
+private:
+  Q_DISABLE_COPY(TraceSpan)
+
+  const char* m_name;
+  qint64 m_start;
+  QString m_detail;
+};
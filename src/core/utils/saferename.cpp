@@ -6,7 +6,7 @@
  * \author Urs Fleisch
  * \date 16 Feb 2012
  *
- * Copyright (C) 2012-2024  Urs Fleisch
+ * Copyright (C) 2012-2026  Urs Fleisch
  *
  * This file is part of Kid3.
  *
@@ -26,8 +26,75 @@
 
 #include "saferename.h"
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include "formatconfig.h"
 
+#if defined Q_OS_LINUX && defined __GLIBC__ && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#include <unistd.h>
+#define HAVE_COPY_FILE_RANGE
+#endif
+
+namespace {
+
+/**
+ * Copy the contents, permissions and modification time of a file.
+ * @param srcName source file name
+ * @param destName destination file name, will be overwritten
+ * @return true if ok.
+ */
+bool copyFile(const QString& srcName, const QString& destName)
+{
+  QFile src(srcName);
+  QFile dest(destName);
+  if (!src.open(QIODevice::ReadOnly | QIODevice::Unbuffered) ||
+      !dest.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                 QIODevice::Unbuffered)) {
+    return false;
+  }
+#ifdef HAVE_COPY_FILE_RANGE
+  qint64 copied = 0;
+  // Let the kernel copy the data, which avoids passing it through user
+  // space and can use server side copies on network file systems.
+  const qint64 srcSize = src.size();
+  while (copied < srcSize) {
+    ssize_t len = ::copy_file_range(
+          src.handle(), nullptr, dest.handle(), nullptr,
+          static_cast<size_t>(qMin<qint64>(srcSize - copied, 1 << 30)), 0);
+    if (len <= 0) {
+      break;
+    }
+    copied += len;
+  }
+  // copy_file_range() has advanced the file descriptors but not the
+  // positions kept by QFile, so they are set explicitly. If not everything
+  // was copied, e.g. across file systems with older kernels, the rest is
+  // copied using buffers.
+  if (!src.seek(copied) || !dest.seek(copied)) {
+    return false;
+  }
+#endif
+  QByteArray buffer(1024 * 1024, Qt::Uninitialized);
+  qint64 len;
+  while ((len = src.read(buffer.data(), buffer.size())) > 0) {
+    if (dest.write(buffer.constData(), len) != len) {
+      return false;
+    }
+  }
+  if (len < 0) {
+    return false;
+  }
+  dest.setPermissions(src.permissions());
+#if QT_VERSION >= 0x050a00
+  dest.setFileTime(src.fileTime(QFileDevice::FileModificationTime),
+                   QFileDevice::FileModificationTime);
+#endif
+  return true;
+}
+
+}
+
 #ifdef Q_OS_WIN32
 
 bool Utils::hasIllegalFileNameCharacters(const QString& fileName)
@@ -70,6 +137,28 @@ bool Utils::safeRename(const QString& dirPath,
   return QDir(dirPath).rename(oldName, newName);
 }
 
+bool Utils::moveFile(const QString& oldName, const QString& newName)
+{
+  if (safeRename(oldName, newName))
+    return true;
+
+  if (hasIllegalFileNameCharacters(newName) ||
+      !QFileInfo(oldName).isFile() || QFileInfo::exists(newName))
+    return false;
+
+  const QString partName = newName + QLatin1String(".kid3part");
+  if (copyFile(oldName, partName) && QDir().rename(partName, newName)) {
+    if (QFile::remove(oldName))
+      return true;
+
+    // Do not leave two copies if the original cannot be removed.
+    QFile::remove(newName);
+    return false;
+  }
+  QFile::remove(partName);
+  return false;
+}
+
 bool Utils::replaceIllegalFileNameCharacters(
     QString& fileName, const QString& defaultReplacement,
     const char* illegalChars)
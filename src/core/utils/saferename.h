@@ -66,6 +66,20 @@ bool KID3_CORE_EXPORT safeRename(const QString& oldName, const QString& newName)
 bool KID3_CORE_EXPORT safeRename(const QString& dirPath,
                 const QString& oldName, const QString& newName);
 
+/**
+ * Move a file.
+ * Renames the file using safeRename(). If this fails, e.g. because
+ * @a newName is on another file system, the file is copied and the original
+ * removed. The copy is written to a temporary file with the suffix
+ * ".kid3part" next to @a newName, which is renamed when it is complete.
+ *
+ * @param oldName old file name
+ * @param newName new file name, must not exist
+ *
+ * @return true if ok.
+ */
+bool KID3_CORE_EXPORT moveFile(const QString& oldName, const QString& newName);
+
 /**
  * Replace illegal characters in a file name.
  * Use replacements from the file name format config if enabled,
@@ -0,0 +1,97 @@
+/**
+ * \file threadpooljobs.cpp
+ * Process ranges of items in jobs of a thread pool.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "threadpooljobs.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <memory>
+
+/**
+ * Split items into ranges processed by jobs.
+ * The items are divided into at most @a maxJobs ranges with at least
+ * MIN_ITEMS_PER_JOB items, fewer items result in a single range.
+ *
+ * @param numItems number of items
+ * @param maxJobs maximum number of jobs
+ *
+ * @return ranges with begin index and end index (exclusive), empty if
+ * there are no items.
+ */
+QVector<QPair<int, int>> Utils::jobRanges(int numItems, int maxJobs)
+{
+  QVector<QPair<int, int>> ranges;
+  if (numItems <= 0)
+    return ranges;
+
+  const int numJobs = qMax(1, qMin(maxJobs, numItems / MIN_ITEMS_PER_JOB));
+  const int itemsPerJob = (numItems + numJobs - 1) / numJobs;
+  ranges.reserve(numJobs);
+  for (int begin = 0; begin < numItems; begin += itemsPerJob) {
+    ranges.append({begin, qMin(begin + itemsPerJob, numItems)});
+  }
+  return ranges;
+}
+
+/**
+ * Start jobs processing ranges of items in a thread pool.
+ * The caller has to wait for the thread pool before using the results.
+ *
+ * @param threadPool thread pool, takes ownership of the jobs
+ * @param numItems number of items
+ * @param createJob function creating a job for a range of items
+ */
+void Utils::startJobs(QThreadPool& threadPool, int numItems,
+                      const JobFactory& createJob)
+{
+  const auto ranges = jobRanges(numItems, threadPool.maxThreadCount());
+  for (const auto& range : ranges) {
+    threadPool.start(createJob(range.first, range.second));
+  }
+}
+
+/**
+ * Process ranges of items in jobs and wait until they are done.
+ * If the items are not split into more than one job, the job is run in
+ * the calling thread.
+ *
+ * @param numItems number of items
+ * @param createJob function creating a job for a range of items
+ */
+void Utils::runJobs(int numItems, const JobFactory& createJob)
+{
+  const auto ranges = jobRanges(numItems, QThread::idealThreadCount());
+  if (ranges.size() == 1) {
+    std::unique_ptr<QRunnable> job(createJob(0, numItems));
+    job->run();
+  } else if (ranges.size() > 1) {
+    QThreadPool threadPool;
+    for (const auto& range : ranges) {
+      threadPool.start(createJob(range.first, range.second));
+    }
+    threadPool.waitForDone();
+  }
+}
@@ -0,0 +1,82 @@
+/**
+ * \file threadpooljobs.h
+ * Process ranges of items in jobs of a thread pool.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QPair>
+#include <functional>
+#include "kid3api.h"
+
+class QRunnable;
+class QThreadPool;
+
+namespace Utils {
+
+/** Minimum number of items per job, fewer are processed in one job. */
+constexpr int MIN_ITEMS_PER_JOB = 64;
+
+/**
+ * Function creating a job processing the items from @a begin up to
+ * @a end (exclusive).
+ */
+typedef std::function<QRunnable*(int begin, int end)> JobFactory;
+
+/**
+ * Split items into ranges processed by jobs.
+ * The items are divided into at most @a maxJobs ranges with at least
+ * MIN_ITEMS_PER_JOB items, fewer items result in a single range.
+ *
+ * @param numItems number of items
+ * @param maxJobs maximum number of jobs
+ *
+ * @return ranges with begin index and end index (exclusive), empty if
+ * there are no items.
+ */
+QVector<QPair<int, int>> KID3_CORE_EXPORT jobRanges(int numItems, int maxJobs);
+
+/**
+ * Start jobs processing ranges of items in a thread pool.
+ * The caller has to wait for the thread pool before using the results.
+ *
+ * @param threadPool thread pool, takes ownership of the jobs
+ * @param numItems number of items
+ * @param createJob function creating a job for a range of items
+ */
+void KID3_CORE_EXPORT startJobs(QThreadPool& threadPool, int numItems,
+                                const JobFactory& createJob);
+
+/**
+ * Process ranges of items in jobs and wait until they are done.
+ * If the items are not split into more than one job, the job is run in
+ * the calling thread.
+ *
+ * @param numItems number of items
+ * @param createJob function creating a job for a range of items
+ */
+void KID3_CORE_EXPORT runJobs(int numItems, const JobFactory& createJob);
+
+}
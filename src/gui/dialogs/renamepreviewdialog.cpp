@@ -0,0 +1,137 @@
+/**
+ * \file renamepreviewdialog.cpp
+ * Dialog to preview file names generated from tags.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "renamepreviewdialog.h"
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QComboBox>
+#include <QLabel>
+#include <QTableView>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QApplication>
+#include "kid3application.h"
+#include "renamepreviewmodel.h"
+#include "contexthelp.h"
+
+/**
+ * Constructor.
+ * @param app application context
+ * @param parent parent widget
+ */
+RenamePreviewDialog::RenamePreviewDialog(Kid3Application* app,
+                                         QWidget* parent)
+  : QDialog(parent), m_app(app)
+{
+  setObjectName(QLatin1String("RenamePreviewDialog"));
+  setModal(true);
+  setSizeGripEnabled(true);
+  setWindowTitle(tr("Filename from Tags"));
+
+  auto vlayout = new QVBoxLayout(this);
+  auto formLayout = new QFormLayout;
+  m_tagVersionComboBox = new QComboBox(this);
+  const QList<QPair<Frame::TagVersion, QString> > tagVersions =
+      Frame::availableTagVersions();
+  for (auto it = tagVersions.constBegin(); it != tagVersions.constEnd(); ++it) {
+    m_tagVersionComboBox->addItem(it->second, it->first);
+  }
+  m_tagVersionComboBox->setCurrentIndex(
+        m_tagVersionComboBox->findData(Frame::TagV2V1));
+  formLayout->addRow(tr("&Source:"), m_tagVersionComboBox);
+  vlayout->addLayout(formLayout);
+
+  m_tableView = new QTableView(this);
+  m_tableView->setModel(m_app->getRenamePreviewModel());
+  m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_tableView->horizontalHeader()->setSectionResizeMode(
+        QHeaderView::Stretch);
+  m_tableView->verticalHeader()->hide();
+  vlayout->addWidget(m_tableView);
+
+  m_countLabel = new QLabel(this);
+  vlayout->addWidget(m_countLabel);
+
+  auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Help |
+                                        QDialogButtonBox::Ok |
+                                        QDialogButtonBox::Cancel);
+  buttonBox->button(QDialogButtonBox::Ok)->setText(tr("&Apply"));
+  connect(buttonBox, &QDialogButtonBox::helpRequested,
+          this, &RenamePreviewDialog::showHelp);
+  connect(buttonBox, &QDialogButtonBox::accepted,
+          this, &RenamePreviewDialog::accept);
+  connect(buttonBox, &QDialogButtonBox::rejected,
+          this, &QDialog::reject);
+  vlayout->addWidget(buttonBox);
+  resize(fontMetrics().height() * 40, fontMetrics().height() * 25);
+
+  connect(m_tagVersionComboBox, static_cast<void (QComboBox::*)(int)>(
+            &QComboBox::activated), this, &RenamePreviewDialog::updatePreview);
+  updatePreview();
+}
+
+/**
+ * Apply the file names.
+ */
+void RenamePreviewDialog::accept()
+{
+  // The names generated for the preview are reused.
+  m_app->getFilenameFromTags(tagVersion());
+  QDialog::accept();
+}
+
+/**
+ * Generate the file names for the selected source.
+ */
+void RenamePreviewDialog::updatePreview()
+{
+  QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+  int changed = m_app->previewFilenameFromTags(tagVersion());
+  QApplication::restoreOverrideCursor();
+  m_countLabel->setText(tr("%1 of %2 files will be renamed")
+                        .arg(changed)
+                        .arg(m_app->getRenamePreviewModel()->rowCount()));
+}
+
+/**
+ * Show help.
+ */
+void RenamePreviewDialog::showHelp()
+{
+  ContextHelp::displayHelp(QLatin1String("preview-filename-from-tags"));
+}
+
+/**
+ * Get selected tag version.
+ * @return tag version.
+ */
+Frame::TagVersion RenamePreviewDialog::tagVersion() const
+{
+  return Frame::tagVersionCast(
+        m_tagVersionComboBox->itemData(
+          m_tagVersionComboBox->currentIndex()).toInt());
+}
@@ -0,0 +1,82 @@
+/**
+ * \file renamepreviewdialog.h
+ * Dialog to preview file names generated from tags.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QDialog>
+#include "frame.h"
+
+class QComboBox;
+class QLabel;
+class QTableView;
+class Kid3Application;
+
+/**
+ * Dialog to preview file names generated from tags.
+ * The names shown are applied to the selected files when the dialog is
+ * accepted.
+ */
+class RenamePreviewDialog : public QDialog {
+  Q_OBJECT
+public:
+  /**
+   * Constructor.
+   * @param app application context
+   * @param parent parent widget
+   */
+  explicit RenamePreviewDialog(Kid3Application* app,
+                               QWidget* parent = nullptr);
+
+  /**
+   * Destructor.
+   */
+  ~RenamePreviewDialog() override = default;
+
+public slots:
+  /**
+   * Apply the file names.
+   */
+  void accept() override;
+
+private slots:
+  /**
+   * Generate the file names for the selected source.
+   */
+  void updatePreview();
+
+  /**
+   * Show help.
+   */
+  void showHelp();
+
+private:
+  Frame::TagVersion tagVersion() const;
+
+  Kid3Application* m_app;
+  QComboBox* m_tagVersionComboBox;
+  QTableView* m_tableView;
+  QLabel* m_countLabel;
+};
@@ -59,6 +59,7 @@
 #include "numbertracksdialog.h"
 #include "filterdialog.h"
 #include "rendirdialog.h"
+#include "renamepreviewdialog.h"
 #include "downloadclient.h"
 #include "downloaddialog.h"
 #include "playlistdialog.h"
@@ -1094,6 +1095,7 @@ void BaseMainWindowImpl::showFoundText()
 
 /**
  * Update GUI controls after text has been replaced.
+ * The position is invalid after all occurrences have been replaced.
  */
 void BaseMainWindowImpl::updateReplacedText()
 {
@@ -1101,8 +1103,8 @@ void BaseMainWindowImpl::updateReplacedText()
       pos.isValid()) {
     m_app->getFileSelectionModel()->setCurrentIndex(pos.getFileIndex(),
         QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
-    updateGuiControls();
   }
+  updateGuiControls();
 }
 
 /**
@@ -1142,6 +1144,15 @@ void BaseMainWindowImpl::slotRenameDirectory()
   }
 }
 
+/**
+ * Preview and set file names from tags.
+ */
+void BaseMainWindowImpl::slotPreviewFilenameFromTags()
+{
+  RenamePreviewDialog dialog(m_app, m_w);
+  dialog.exec();
+}
+
 /**
  * Number tracks.
  */
@@ -325,6 +325,11 @@ public slots:
    */
   void slotRenameDirectory();
 
+  /**
+   * Preview and set file names from tags.
+   */
+  void slotPreviewFilenameFromTags();
+
   /**
    * Number tracks.
    */
@@ -0,0 +1,253 @@
+/**
+ * \file coverartcache.cpp
+ * Cache for decoded and scaled cover art.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "coverartcache.h"
+#include <QRunnable>
+#include <QBuffer>
+#include <QImageReader>
+#include <QHash>
+#include "performancetracer.h"
+
+namespace {
+
+/** Maximum total size of cached images in KiB. */
+constexpr int MAX_CACHE_KIB = 64 * 1024;
+
+}
+
+/**
+ * Job decoding an image in a background thread.
+ */
+class CoverArtDecoder : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param cache cache to add decoded image to
+   * @param data picture data
+   * @param size requested size
+   */
+  CoverArtDecoder(CoverArtCache* cache, const QByteArray& data,
+                  const QSize& size)
+    : m_cache(cache), m_data(data), m_size(size) {
+  }
+
+  /**
+   * Decode image, add it to the cache and notify about it.
+   */
+  void run() override {
+    m_cache->insert(CoverArtCache::keyOf(m_data, m_size),
+                    CoverArtCache::decode(m_data, m_size));
+    emit m_cache->imageReady();
+  }
+
+private:
+  CoverArtCache* m_cache;
+  QByteArray m_data;
+  QSize m_size;
+};
+
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+CoverArtCache::CoverArtCache(QObject* parent) : QObject(parent),
+  m_cache(MAX_CACHE_KIB)
+{
+  // Decoding is CPU bound, but the GUI thread shall not have to compete with
+  // too many decoding threads.
+  m_threadPool.setMaxThreadCount(2);
+}
+
+/**
+ * Destructor, waits for running decoding jobs.
+ */
+CoverArtCache::~CoverArtCache()
+{
+  m_threadPool.clear();
+  m_threadPool.waitForDone();
+}
+
+/**
+ * Get cache instance shared by the application.
+ * @return cover art cache.
+ */
+CoverArtCache* CoverArtCache::instance()
+{
+  static CoverArtCache cache;
+  return &cache;
+}
+
+/**
+ * Look up a decoded image in the cache.
+ * Can be called from any thread.
+ * @param data picture data
+ * @param size size to fit image into keeping the aspect ratio,
+ * invalid to keep the original size
+ * @param image the image is returned here, null if the data could not be
+ * decoded
+ * @param originalSize if not null, the size of the undecoded image is
+ * returned here
+ * @return true if found in the cache.
+ */
+bool CoverArtCache::findImage(const QByteArray& data, const QSize& size,
+                              QImage& image, QSize* originalSize)
+{
+  Key key = keyOf(data, size);
+  QMutexLocker locker(&m_mutex);
+  // The key is only a hash, so the data is compared to rule out collisions.
+  if (const Entry* entry = m_cache.object(key); entry && entry->data == data) {
+    image = entry->image;
+    if (originalSize) {
+      *originalSize = entry->originalSize;
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Get a decoded image, decode it if not found in the cache.
+ * Can be called from any thread.
+ * @param data picture data
+ * @param size size to fit image into keeping the aspect ratio,
+ * invalid to keep the original size
+ * @param originalSize if not null, the size of the undecoded image is
+ * returned here
+ * @return image, null if the data could not be decoded.
+ */
+QImage CoverArtCache::image(const QByteArray& data, const QSize& size,
+                            QSize* originalSize)
+{
+  QImage img;
+  if (!findImage(data, size, img, originalSize)) {
+    Entry entry = decode(data, size);
+    insert(keyOf(data, size), entry);
+    img = entry.image;
+    if (originalSize) {
+      *originalSize = entry.originalSize;
+    }
+  }
+  return img;
+}
+
+/**
+ * Decode an image in a background thread if it is not in the cache.
+ * imageReady() is emitted when the image has been added to the cache.
+ * @param data picture data
+ * @param size size to fit image into keeping the aspect ratio,
+ * invalid to keep the original size
+ */
+void CoverArtCache::requestImage(const QByteArray& data, const QSize& size)
+{
+  Key key = keyOf(data, size);
+  {
+    QMutexLocker locker(&m_mutex);
+    if (const Entry* entry = m_cache.object(key);
+        (entry && entry->data == data) || m_pending.contains(key))
+      return;
+
+    m_pending.insert(key);
+  }
+  m_threadPool.start(new CoverArtDecoder(this, data, size));
+}
+
+/**
+ * Get cache key.
+ * @param data picture data
+ * @param size requested size
+ * @return key.
+ */
+CoverArtCache::Key CoverArtCache::keyOf(const QByteArray& data,
+                                        const QSize& size)
+{
+  // qHash() returns size_t with Qt 6, which must not be narrowed in the
+  // braced initializer.
+  uint dataHash = qHash(data);
+  return {dataHash, static_cast<int>(data.size()),
+          size.isValid() ? size.width() : -1,
+          size.isValid() ? size.height() : -1};
+}
+
+/**
+ * Decode and scale image.
+ * @param data picture data
+ * @param size size to fit image into keeping the aspect ratio,
+ * invalid to keep the original size
+ * @return decoded image, original size and picture data.
+ */
+CoverArtCache::Entry CoverArtCache::decode(const QByteArray& data,
+                                           const QSize& size)
+{
+  TraceSpan span("CoverArtCache::decode");
+  Entry entry;
+  entry.data = data;
+  QBuffer buffer;
+  buffer.setData(data);
+  buffer.open(QIODevice::ReadOnly);
+  QImageReader reader(&buffer);
+  entry.originalSize = reader.size();
+  if (size.isValid() && entry.originalSize.isValid()) {
+    // Let the image handler scale while decoding, which for JPEG is much
+    // faster than decoding the full image and scaling it afterwards.
+    reader.setScaledSize(entry.originalSize.scaled(size, Qt::KeepAspectRatio));
+  }
+  if (QImage img; reader.read(&img)) {
+    if (!entry.originalSize.isValid()) {
+      entry.originalSize = img.size();
+    }
+    if (size.isValid()) {
+      if (QSize scaledSize = img.size().scaled(size, Qt::KeepAspectRatio);
+          scaledSize != img.size()) {
+        img = img.scaled(scaledSize, Qt::IgnoreAspectRatio,
+                         Qt::SmoothTransformation);
+      }
+    }
+    entry.image = img;
+  }
+  return entry;
+}
+
+/**
+ * Add decoded image to cache.
+ * @param key cache key
+ * @param entry decoded image
+ */
+void CoverArtCache::insert(const Key& key, const Entry& entry)
+{
+#if QT_VERSION >= 0x050a00
+  qint64 bytes = entry.image.sizeInBytes();
+#else
+  qint64 bytes = entry.image.byteCount();
+#endif
+  // The picture data is kept for comparison, it is usually shared with
+  // the frame, but counts nevertheless.
+  bytes += entry.data.size();
+  int cost = static_cast<int>(qBound<qint64>(1, bytes / 1024, MAX_CACHE_KIB));
+  QMutexLocker locker(&m_mutex);
+  m_pending.remove(key);
+  m_cache.insert(key, new Entry(entry), cost);
+}
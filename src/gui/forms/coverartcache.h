@@ -0,0 +1,171 @@
+/**
+ * \file coverartcache.h
+ * Cache for decoded and scaled cover art.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QImage>
+#include <QCache>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include "kid3api.h"
+
+/**
+ * Cache for decoded and scaled cover art.
+ *
+ * Decoding a large embedded picture takes much longer than displaying it,
+ * and the same pictures are displayed again and again when navigating
+ * through the files of an album. Therefore the images are cached with the
+ * hash of the picture data and the requested size as the key, the picture
+ * data is compared when an image is found to rule out collisions. The total
+ * size of the cached images is limited, the least recently used images are
+ * removed first. Images can be decoded in a background thread using
+ * requestImage(), imageReady() is emitted when the decoded image is in the
+ * cache.
+ *
+ * The images are returned as QImage, because QPixmap can only be used in
+ * the GUI thread.
+ */
+class KID3_GUI_EXPORT CoverArtCache : public QObject {
+  Q_OBJECT
+public:
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit CoverArtCache(QObject* parent = nullptr);
+
+  /**
+   * Destructor, waits for running decoding jobs.
+   */
+  ~CoverArtCache() override;
+
+  /**
+   * Get cache instance shared by the application.
+   * @return cover art cache.
+   */
+  static CoverArtCache* instance();
+
+  /**
+   * Look up a decoded image in the cache.
+   * Can be called from any thread.
+   * @param data picture data
+   * @param size size to fit image into keeping the aspect ratio,
+   * invalid to keep the original size
+   * @param image the image is returned here, null if the data could not be
+   * decoded
+   * @param originalSize if not null, the size of the undecoded image is
+   * returned here
+   * @return true if found in the cache.
+   */
+  bool findImage(const QByteArray& data, const QSize& size, QImage& image,
+                 QSize* originalSize = nullptr);
+
+  /**
+   * Get a decoded image, decode it if not found in the cache.
+   * Can be called from any thread.
+   * @param data picture data
+   * @param size size to fit image into keeping the aspect ratio,
+   * invalid to keep the original size
+   * @param originalSize if not null, the size of the undecoded image is
+   * returned here
+   * @return image, null if the data could not be decoded.
+   */
+  QImage image(const QByteArray& data, const QSize& size,
+               QSize* originalSize = nullptr);
+
+  /**
+   * Decode an image in a background thread if it is not in the cache.
+   * imageReady() is emitted when the image has been added to the cache.
+   * @param data picture data
+   * @param size size to fit image into keeping the aspect ratio,
+   * invalid to keep the original size
+   */
+  void requestImage(const QByteArray& data, const QSize& size);
+
+signals:
+  /**
+   * Emitted when an image requested with requestImage() has been decoded.
+   * The signal is emitted from the thread which decoded the image, so
+   * connected slots in the GUI thread are called using a queued connection.
+   */
+  void imageReady();
+
+private:
+  friend class CoverArtDecoder;
+
+  /** Key for cached image. */
+  struct Key {
+    /** Hash of picture data. */
+    uint dataHash;
+    /** Size of picture data. */
+    int dataSize;
+    /** Requested width. */
+    int width;
+    /** Requested height. */
+    int height;
+
+    /**
+     * Equality operator.
+     * @param rhs right hand side to compare
+     * @return true if this == rhs.
+     */
+    bool operator==(const Key& rhs) const {
+      return dataHash == rhs.dataHash && dataSize == rhs.dataSize &&
+          width == rhs.width && height == rhs.height;
+    }
+  };
+
+  /** Decoded image in cache. */
+  struct Entry {
+    /** Decoded and scaled image, null if data could not be decoded. */
+    QImage image;
+    /** Size of undecoded image. */
+    QSize originalSize;
+    /** Picture data, compared on a hit because the key is only a hash. */
+    QByteArray data;
+  };
+
+  /**
+   * Hash function for cache key.
+   * @param key key
+   * @return hash value.
+   */
+  friend uint qHash(const Key& key) {
+    return key.dataHash ^ static_cast<uint>(key.dataSize) ^
+        (static_cast<uint>(key.width) << 16) ^ static_cast<uint>(key.height);
+  }
+
+  static Key keyOf(const QByteArray& data, const QSize& size);
+  static Entry decode(const QByteArray& data, const QSize& size);
+  void insert(const Key& key, const Entry& entry);
+
+  QMutex m_mutex;
+  QCache<Key, Entry> m_cache;
+  QSet<Key> m_pending;
+  QThreadPool m_threadPool;
+};
@@ -27,6 +27,10 @@
 #include "guiplatformtools.h"
 #include <QGuiApplication>
 #include <QClipboard>
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
 #include "taggedfileiconprovider.h"
 #include "config.h"
 #ifdef HAVE_QTMULTIMEDIA
@@ -106,3 +110,45 @@ QObject* GuiPlatformTools::createAudioPlayer(Kid3Application* app,
   return nullptr;
 #endif
 }
+
+/**
+ * Scale image data so that it fits into a square.
+ * This method is thread-safe.
+ * @param data image data
+ * @param maxSize maximum width and height in pixels
+ * @return image data in the same format scaled to fit into @a maxSize,
+ * empty if the image already fits or could not be scaled.
+ */
+QByteArray GuiPlatformTools::scaleImageData(const QByteArray& data,
+                                            int maxSize) const
+{
+  QBuffer buffer;
+  buffer.setData(data);
+  if (!buffer.open(QIODevice::ReadOnly))
+    return QByteArray();
+
+  QImageReader reader(&buffer);
+  const QByteArray format = reader.format();
+  if (QSize size = reader.size(); size.isValid()) {
+    if (size.width() <= maxSize && size.height() <= maxSize)
+      return QByteArray();
+    // Let the image handler scale while decoding if it supports it,
+    // e.g. JPEG, which is much faster than decoding the full size.
+    reader.setScaledSize(size.scaled(maxSize, maxSize, Qt::KeepAspectRatio));
+  }
+  QImage image;
+  if (!reader.read(&image))
+    return QByteArray();
+  if (image.width() > maxSize || image.height() > maxSize) {
+    image = image.scaled(maxSize, maxSize, Qt::KeepAspectRatio,
+                         Qt::SmoothTransformation);
+  }
+
+  QByteArray scaledData;
+  QBuffer scaledBuffer(&scaledData);
+  if (!scaledBuffer.open(QIODevice::WriteOnly))
+    return QByteArray();
+  if (QImageWriter writer(&scaledBuffer, format); !writer.write(image))
+    return QByteArray();
+  return scaledData;
+}
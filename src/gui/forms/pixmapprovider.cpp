@@ -28,6 +28,7 @@
 #include <QHash>
 #include <QVariant>
 #include "coretaggedfileiconprovider.h"
+#include "coverartcache.h"
 
 /**
  * Constructor.
@@ -67,17 +68,18 @@ QPixmap PixmapProvider::getPixmap(const QString& id, QSize* size,
     if (QByteArray data = getImageData(); !data.isEmpty()) {
       if (uint hash = qHash(data);
           m_dataPixmap.isNull() || hash != m_pixmapHash) {
-        if (m_dataPixmap.loadFromData(data)) {
-          if (size) {
-            *size = m_dataPixmap.size();
-          }
-          if (requestedSize.isValid()) {
-            m_dataPixmap = m_dataPixmap.scaled(requestedSize,
-                                               Qt::KeepAspectRatio);
-          }
-          if (!m_dataPixmap.isNull()) {
-            m_pixmapHash = hash;
-          }
+        // The image is decoded in a background thread, when it is ready,
+        // the image is requested again using a new ID.
+        CoverArtCache* cache = CoverArtCache::instance();
+        if (QImage image; cache->findImage(data, requestedSize, image, size)) {
+          m_requestedData.clear();
+          m_dataPixmap = QPixmap::fromImage(image);
+          m_pixmapHash = hash;
+        } else {
+          m_requestedData = data;
+          m_requestedSize = requestedSize;
+          cache->requestImage(data, requestedSize);
+          m_dataPixmap = QPixmap();
         }
       }
       if (!m_dataPixmap.isNull()) {
@@ -93,3 +95,16 @@ QPixmap PixmapProvider::getPixmap(const QString& id, QSize* size,
   }
   return QPixmap();
 }
+
+/**
+ * Check if an image which was not in the cache when it was requested with
+ * getPixmap() has been decoded in the meantime.
+ * @return true if the image is now available and should be requested again.
+ */
+bool PixmapProvider::isRequestedImageReady() const
+{
+  QImage image;
+  return !m_requestedData.isEmpty() &&
+      CoverArtCache::instance()->findImage(m_requestedData, m_requestedSize,
+                                           image);
+}
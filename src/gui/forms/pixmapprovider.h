@@ -38,6 +38,10 @@ class CoreTaggedFileIconProvider;
  * - "fileicon/" followed by "null", "notag", "v1", "v2", "v1v2", or "modified",
  * - "data" followed by a changing string to force loading of the image set with
  *   CoreTaggedFileIconProvider::setImageData().
+ *
+ * Pictures are decoded in a background thread by CoverArtCache, until they
+ * are ready, an empty pixmap is returned, isRequestedImageReady() can be
+ * used to find out when they have to be requested again.
  */
 class KID3_GUI_EXPORT PixmapProvider : public ImageDataProvider {
 public:
@@ -62,8 +66,17 @@ public:
    */
   QPixmap getPixmap(const QString& id, QSize* size, const QSize& requestedSize);
 
+  /**
+   * Check if an image which was not in the cache when it was requested with
+   * getPixmap() has been decoded in the meantime.
+   * @return true if the image is now available and should be requested again.
+   */
+  bool isRequestedImageReady() const;
+
 private:
   CoreTaggedFileIconProvider* m_fileIconProvider;
   QPixmap m_dataPixmap;
+  QByteArray m_requestedData;
+  QSize m_requestedSize;
   uint m_pixmapHash;
 };
@@ -201,13 +201,23 @@ void TaggedFileIconProvider::createIcons()
  */
 QVariant TaggedFileIconProvider::iconForTaggedFile(const TaggedFile* taggedFile)
 {
-  if (taggedFile) {
-    if (m_iconMap.isEmpty()) {
-      createIcons();
-    }
-    return m_iconMap.value(iconIdForTaggedFile(taggedFile));
+  return taggedFile ? iconForIconId(iconIdForTaggedFile(taggedFile))
+                    : QVariant();
+}
+
+/**
+ * Get an icon for an icon ID.
+ *
+ * @param id icon ID as returned by iconIdForTaggedFile()
+ *
+ * @return icon for @a id.
+ */
+QVariant TaggedFileIconProvider::iconForIconId(const QByteArray& id)
+{
+  if (m_iconMap.isEmpty()) {
+    createIcons();
   }
-  return QVariant();
+  return m_iconMap.value(id);
 }
 
 /**
@@ -71,6 +71,15 @@ public:
    */
   QVariant iconForTaggedFile(const TaggedFile* taggedFile) override;
 
+  /**
+   * Get an icon for an icon ID.
+   *
+   * @param id icon ID as returned by iconIdForTaggedFile()
+   *
+   * @return icon for @a id.
+   */
+  QVariant iconForIconId(const QByteArray& id) override;
+
   /**
    * Get pixmap for an icon ID.
    * @param id icon ID as returned by iconIdForTaggedFile(), or data for image
@@ -35,6 +35,7 @@
 #include <QAction>
 #include <QCoreApplication>
 #include "pictureframe.h"
+#include "coverartcache.h"
 
 namespace {
 
@@ -117,6 +118,8 @@ PictureLabel::PictureLabel(QWidget* parent)
   hlayout->addWidget(m_nextButton);
   layout->addWidget(m_indexWidget);
 
+  connect(CoverArtCache::instance(), &CoverArtCache::imageReady,
+          this, &PictureLabel::updateControls);
   updateControls();
 }
 
@@ -216,17 +219,26 @@ void PictureLabel::updateControls()
         if (!m_pictureLabel->pixmap() || hash != m_pixmapHash)
 #endif
         {
-          // creating new pixmap
-          if (QPixmap pm; pm.loadFromData(data)) {
-            int dimension = m_pictureLabel->width();
-            if (QPixmap scaledPm = pm.scaled(dimension, dimension, Qt::KeepAspectRatio);
-                !scaledPm.isNull()) {
-              m_pixmapHash = hash;
-              m_pictureLabel->setContentsMargins(0, 0, 0, 0);
-              m_pictureLabel->setPixmap(scaledPm);
-              m_sizeLabel->setText(QString::number(pm.width()) + QLatin1Char('x') +
-                                   QString::number(pm.height()) + pictureTypeText);
-            }
+          int dimension = m_pictureLabel->width();
+          QSize size(dimension, dimension);
+          QImage image;
+          QSize originalSize;
+          if (CoverArtCache* cache = CoverArtCache::instance();
+              !cache->findImage(data, size, image, &originalSize)) {
+            // Do not show the picture of the previous file until the new one
+            // is decoded in the background, updateControls() is called again
+            // then.
+            m_pictureLabel->clear();
+            m_sizeLabel->setText(pictureTypeText.mid(1));
+            cache->requestImage(data, size);
+          } else if (!image.isNull()) {
+            m_pixmapHash = hash;
+            m_pictureLabel->setContentsMargins(0, 0, 0, 0);
+            m_pictureLabel->setPixmap(QPixmap::fromImage(image));
+            m_sizeLabel->setText(QString::number(originalSize.width()) +
+                                 QLatin1Char('x') +
+                                 QString::number(originalSize.height()) +
+                                 pictureTypeText);
           }
         }
       } else {
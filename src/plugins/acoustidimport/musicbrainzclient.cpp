@@ -31,6 +31,7 @@
 #include "httpclient.h"
 #include "trackdatamodel.h"
 #include "fingerprintcalculator.h"
+#include "fingerprintcache.h"
 
 namespace {
 
@@ -317,14 +318,11 @@ void MusicBrainzClient::receiveFingerprint(const QString& fingerprint,
                                            int duration, int error)
 {
   if (error == FingerprintCalculator::Ok) {
-    m_state = GettingIds;
-    emit statusChanged(m_currentIndex, tr("ID Lookup"));
-    QString path(
-      QLatin1String("/v2/lookup?client=LxDbFAXo&meta=recordingids&duration=") +
-      QString::number(duration) +
-      QLatin1String("&fingerprint=") + fingerprint);
-    httpClient()->sendRequest(QLatin1String("api.acoustid.org"), path,
-                              QLatin1String("https"));
+    if (m_currentIndex >= 0 && m_currentIndex < m_filenameOfTrack.size()) {
+      FingerprintCache::instance().insert(m_filenameOfTrack.at(m_currentIndex),
+                                          fingerprint, duration);
+    }
+    requestIds(fingerprint, duration);
   } else {
     emit statusChanged(m_currentIndex, tr("Error"));
     if (m_state != Idle) {
@@ -333,6 +331,24 @@ void MusicBrainzClient::receiveFingerprint(const QString& fingerprint,
   }
 }
 
+/**
+ * Look up the MusicBrainz IDs for a fingerprint.
+ *
+ * @param fingerprint Chromaprint fingerprint
+ * @param duration duration in seconds
+ */
+void MusicBrainzClient::requestIds(const QString& fingerprint, int duration)
+{
+  m_state = GettingIds;
+  emit statusChanged(m_currentIndex, tr("ID Lookup"));
+  QString path(
+    QLatin1String("/v2/lookup?client=LxDbFAXo&meta=recordingids&duration=") +
+    QString::number(duration) +
+    QLatin1String("&fingerprint=") + fingerprint);
+  httpClient()->sendRequest(QLatin1String("api.acoustid.org"), path,
+                            QLatin1String("https"));
+}
+
 /**
  * Process next step in importing from fingerprints.
  */
@@ -345,8 +361,17 @@ void MusicBrainzClient::processNextStep()
   {
     if (!verifyTrackIndex())
       return;
-    emit statusChanged(m_currentIndex, tr("Fingerprint"));
-    m_fingerprintCalculator->start(m_filenameOfTrack.at(m_currentIndex));
+    // Decoding the audio is only needed if the file has changed since its
+    // fingerprint was calculated.
+    QString fingerprint;
+    int duration;
+    if (FingerprintCache::instance().find(m_filenameOfTrack.at(m_currentIndex),
+                                          fingerprint, duration)) {
+      requestIds(fingerprint, duration);
+    } else {
+      emit statusChanged(m_currentIndex, tr("Fingerprint"));
+      m_fingerprintCalculator->start(m_filenameOfTrack.at(m_currentIndex));
+    }
     break;
   }
   case GettingMetadata:
@@ -104,6 +104,7 @@ private:
 
   bool verifyIdIndex();
   bool verifyTrackIndex();
+  void requestIds(const QString& fingerprint, int duration);
   void processNextStep();
   void processNextTrack();
 
@@ -45,6 +45,7 @@
 #include "id3libconfig.h"
 #include "genres.h"
 #include "attributedata.h"
+#include "performancetracer.h"
 
 #ifdef Q_OS_WIN32
 /**
@@ -128,6 +129,7 @@ int Mp3File::taggedFileFeatures() const
  */
 void Mp3File::readTags(bool force)
 {
+  TraceSpan span("Mp3File::readTags", [this] { return currentFilePath(); });
   bool priorIsTagInformationRead = isTagInformationRead();
   QByteArray fn = QFile::encodeName(currentFilePath());
 
@@ -174,6 +176,7 @@ void Mp3File::readTags(bool force)
 bool Mp3File::writeTags(bool force, bool* renamed, bool preserve)
 {
   QString fnStr(currentFilePath());
+  TraceSpan span("Mp3File::writeTags", fnStr);
   if (isChanged() && !QFileInfo(fnStr).isWritable()) {
     revertChangedFilename();
     return false;
@@ -31,6 +31,7 @@
 #include "kid3application.h"
 #include "guiplatformtools.h"
 #include "qmlimageprovider.h"
+#include "coverartcache.h"
 #include "fileproxymodel.h"
 #include "dirproxymodel.h"
 #include "genremodel.h"
@@ -45,6 +46,7 @@
 #include "playlistconfig.h"
 #include "tagconfig.h"
 #include "checkablelistmodel.h"
+#include "tagbatch.h"
 #include "dirrenamer.h"
 #include "filefilter.h"
 #include "batchimporter.h"
@@ -183,6 +185,7 @@ void Kid3QmlPlugin::registerTypes(const char *uri)
     qmlRegisterType<ScriptUtils>(uri, 1, 0, "ScriptUtils");
     qmlRegisterType<ConfigObjects>(uri, 1, 0, "ConfigObjects");
     qmlRegisterType<CheckableListModel>(uri, 1, 0, "CheckableListModel");
+    qmlRegisterType<TagBatch>(uri, 1, 1, "TagBatch");
     qmlRegisterUncreatableType<Frame>(uri, 1, 0, "Frame",
                                       QLatin1String("Only enum container"));
     qmlRegisterUncreatableType<FrameNotice>(uri, 1, 0, "FrameNotice",
@@ -233,6 +236,14 @@ void Kid3QmlPlugin::initializeEngine(QQmlEngine* engine, const char* uri)
     if (!m_imageProvider) {
       m_imageProvider = new QmlImageProvider(
             m_kid3App->getFileProxyModel()->getIconProvider());
+      // Cover art is decoded in a background thread, reload it when ready.
+      // The signal is emitted from the decoding thread and queued.
+      connect(CoverArtCache::instance(), &CoverArtCache::imageReady,
+              m_kid3App, [this] {
+        if (m_imageProvider && m_imageProvider->isRequestedImageReady()) {
+          m_kid3App->reloadCoverArtImage();
+        }
+      });
     }
     m_kid3App->setImageProvider(m_imageProvider);
     // The QQmlEngine takes ownership of m_imageProvider.
@@ -0,0 +1,411 @@
+/**
+ * \file tagbatch.cpp
+ * Bulk access to the tags of files for scripts.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagbatch.h"
+#include "kid3application.h"
+#include "fileproxymodel.h"
+#include "taggedfilesystemmodel.h"
+#include "modeliterator.h"
+#include "filefilter.h"
+#include "taggedfile.h"
+#include "pictureframe.h"
+#include "performancetracer.h"
+
+namespace {
+
+/**
+ * Find frame by name.
+ * @param frames frames to search
+ * @param name name of frame, prefix "!" to use the name of the frame in the
+ * tag
+ * @return iterator to frame, frames.cend() if not found.
+ */
+FrameCollection::const_iterator findFrame(const FrameCollection& frames,
+                                          const QString& name)
+{
+  if (name.startsWith(QLatin1Char('!'))) {
+    return frames.findByExtendedType(
+          Frame::ExtendedType(Frame::FT_Other, name.mid(1)));
+  }
+  return frames.findByName(name);
+}
+
+}
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+TagBatch::TagBatch(QObject* parent) : QObject(parent), m_app(nullptr)
+{
+}
+
+/**
+ * Set application.
+ * @param app application
+ */
+void TagBatch::setApp(Kid3Application* app)
+{
+  if (m_app != app) {
+    m_app = app;
+    setPaths({});
+    emit appChanged();
+  }
+}
+
+/**
+ * Set files of batch from paths.
+ * Paths which are not found in the opened folder or are not tagged files
+ * are skipped.
+ * @param paths absolute file paths
+ * @return number of files in batch.
+ */
+int TagBatch::setFiles(const QStringList& paths)
+{
+  QStringList taggedFilePaths;
+  if (m_app) {
+    taggedFilePaths.reserve(paths.size());
+    for (const QString& path : paths) {
+      if (TaggedFile* file = taggedFileOfPath(path)) {
+        taggedFilePaths.append(file->getAbsFilename());
+      }
+    }
+  }
+  setPaths(taggedFilePaths);
+  return count();
+}
+
+/**
+ * Set files of batch to all tagged files in the opened folder.
+ * @param filterExpression if not empty, only files passing this filter
+ * expression are added, see FileFilter
+ * @return number of files in batch, -1 if filter expression is invalid.
+ */
+int TagBatch::setAllFiles(const QString& filterExpression)
+{
+  QStringList paths;
+  if (m_app) {
+    FileFilter fileFilter;
+    if (!filterExpression.isEmpty()) {
+      fileFilter.setFilterExpression(filterExpression);
+      fileFilter.initParser();
+    }
+    TaggedFileIterator it(m_app->getRootIndex());
+    while (it.hasNext()) {
+      TaggedFile* taggedFile = it.next();
+      if (!filterExpression.isEmpty()) {
+        taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+        bool ok;
+        bool pass = fileFilter.filter(*taggedFile, &ok);
+        if (!ok) {
+          setPaths({});
+          return -1;
+        }
+        if (!pass) {
+          continue;
+        }
+      }
+      paths.append(taggedFile->getAbsFilename());
+    }
+  }
+  setPaths(paths);
+  return count();
+}
+
+/**
+ * Get path of file.
+ * @param handle index of file in batch
+ * @return absolute path, empty if @a handle is invalid.
+ */
+QString TagBatch::path(int handle) const
+{
+  return handle >= 0 && handle < count() ? m_paths.at(handle) : QString();
+}
+
+/**
+ * Get value of frame.
+ * @param handle index of file in batch
+ * @param tagMask tag bit (1 for tag 1, 2 for tag 2)
+ * @param name name of frame (e.g. "Artist"), prefix "!" to use the name
+ * of the frame in the tag
+ * @return frame value, empty if not found.
+ */
+QString TagBatch::get(int handle, Frame::TagVersion tagMask,
+                      const QString& name) const
+{
+  Frame::TagNumber tagNr = Frame::tagNumberFromMask(tagMask);
+  TaggedFile* file = taggedFile(handle);
+  if (!file || tagNr >= Frame::Tag_NumValues)
+    return QString();
+
+  const FrameCollection& frames = file->getAllFramesCached(tagNr);
+  if (auto it = findFrame(frames, name); it != frames.cend()) {
+    return it->getValue();
+  }
+  return QString();
+}
+
+/**
+ * Set value of frame.
+ * For tag 2 and 3, a frame is added if it does not exist, and deleted if
+ * @a value is empty. The file is only written when save() is called.
+ * @param handle index of file in batch
+ * @param tagMask tag bit (1 for tag 1, 2 for tag 2)
+ * @param name name of frame (e.g. "Artist"), prefix "!" to use the name
+ * of the frame in the tag
+ * @param value value of frame
+ * @return true if ok.
+ */
+bool TagBatch::set(int handle, Frame::TagVersion tagMask,
+                   const QString& name, const QString& value)
+{
+  Frame::TagNumber tagNr = Frame::tagNumberFromMask(tagMask);
+  TaggedFile* file = taggedFile(handle);
+  if (!file || tagNr >= Frame::Tag_NumValues || name.isEmpty())
+    return false;
+
+  const FrameCollection& frames = file->getAllFramesCached(tagNr);
+  if (auto it = findFrame(frames, name); it != frames.cend()) {
+    // Copy the frame, the cached frames are invalidated when the file
+    // is modified.
+    Frame frame(*it);
+    if (value.isEmpty() && tagNr != Frame::Tag_1) {
+      return file->deleteFrame(tagNr, frame);
+    }
+    frame.setValueIfChanged(value);
+    return !frame.isValueChanged() || file->setFrame(tagNr, frame);
+  }
+
+  Frame frame(name.startsWith(QLatin1Char('!'))
+              ? Frame::ExtendedType(Frame::FT_Other, name.mid(1))
+              : Frame::ExtendedType(name), value, -1);
+  if (tagNr == Frame::Tag_1) {
+    return file->setFrame(tagNr, frame);
+  }
+  if (value.isEmpty()) {
+    return true;
+  }
+  return file->addFrame(tagNr, frame) && file->setFrame(tagNr, frame);
+}
+
+/**
+ * Get names and values of all frames.
+ * @param handle index of file in batch
+ * @param tagMask tag bit (1 for tag 1, 2 for tag 2)
+ * @return map containing frame values.
+ */
+QVariantMap TagBatch::getAll(int handle, Frame::TagVersion tagMask) const
+{
+  QVariantMap map;
+  Frame::TagNumber tagNr = Frame::tagNumberFromMask(tagMask);
+  TaggedFile* file = taggedFile(handle);
+  if (!file || tagNr >= Frame::Tag_NumValues)
+    return map;
+
+  const FrameCollection& frames = file->getAllFramesCached(tagNr);
+  for (auto it = frames.cbegin(); it != frames.cend(); ++it) {
+    map.insert(it->getName(), it->getValue());
+  }
+  return map;
+}
+
+/**
+ * Get data of first picture.
+ * @param handle index of file in batch
+ * @return picture data, empty if not found.
+ */
+QByteArray TagBatch::getPictureData(int handle) const
+{
+  QByteArray data;
+  if (TaggedFile* file = taggedFile(handle)) {
+    const FrameCollection& frames = file->getAllFramesCached(Frame::Tag_Picture);
+    if (auto it = frames.findByExtendedType(
+          Frame::ExtendedType(Frame::FT_Picture));
+        it != frames.cend()) {
+      PictureFrame::getData(*it, data);
+    }
+  }
+  return data;
+}
+
+/**
+ * Set data of first picture.
+ * @param handle index of file in batch
+ * @param data picture data, empty to delete the picture
+ * @return true if ok.
+ */
+bool TagBatch::setPictureData(int handle, const QByteArray& data)
+{
+  TaggedFile* file = taggedFile(handle);
+  if (!file)
+    return false;
+
+  const FrameCollection& frames = file->getAllFramesCached(Frame::Tag_Picture);
+  if (auto it = frames.findByExtendedType(
+        Frame::ExtendedType(Frame::FT_Picture));
+      it != frames.cend()) {
+    Frame frame(*it);
+    if (data.isEmpty()) {
+      return file->deleteFrame(Frame::Tag_Picture, frame);
+    }
+    return PictureFrame::setData(frame, data) &&
+        file->setFrame(Frame::Tag_Picture, frame);
+  }
+  if (data.isEmpty()) {
+    return true;
+  }
+  PictureFrame frame;
+  PictureFrame::setData(frame, data);
+  return file->addFrame(Frame::Tag_Picture, frame) &&
+      file->setFrame(Frame::Tag_Picture, frame);
+}
+
+/**
+ * Check if file is modified.
+ * @param handle index of file in batch
+ * @return true if file has unsaved changes.
+ */
+bool TagBatch::isChanged(int handle) const
+{
+  TaggedFile* file = taggedFile(handle);
+  return file && file->isChanged();
+}
+
+/**
+ * Call a function for all files in the batch.
+ * @param callback function called with the handle of each file, the
+ * iteration is stopped if it returns false
+ * @return number of files processed.
+ */
+int TagBatch::forEach(QJSValue callback)
+{
+  if (!callback.isCallable())
+    return 0;
+
+  TraceSpan span("TagBatch::forEach");
+  int handle = 0;
+  const int numFiles = count();
+  while (handle < numFiles) {
+    QJSValue result = callback.call({QJSValue(handle)});
+    ++handle;
+    if (result.isError()) {
+      qWarning("TagBatch::forEach: %s",
+               qPrintable(result.toString()));
+      break;
+    }
+    if (result.isBool() && !result.toBool()) {
+      break;
+    }
+  }
+  return handle;
+}
+
+/**
+ * Write the changed files of the batch.
+ * Files are written like with app.saveDirectory(), if a file shall be
+ * renamed to a file name which already exists, a number is appended.
+ * @return paths of files which could not be written, empty if ok.
+ */
+QStringList TagBatch::save()
+{
+  TraceSpan span("TagBatch::save");
+  QStringList errorFiles;
+  m_errorDescriptions.clear();
+  bool written = false;
+  for (int handle = 0; handle < count(); ++handle) {
+    if (TaggedFile* file = taggedFileOfPath(m_paths.at(handle));
+        file && file->isChanged()) {
+      if (QString errorDescription;
+          Kid3Application::writeTaggedFile(file, &errorDescription)) {
+        written = true;
+      } else {
+        errorFiles.append(file->getAbsFilename());
+        m_errorDescriptions.append(errorDescription);
+      }
+    }
+  }
+  if (written && m_app) {
+    // The frame models are not updated while the batch is edited,
+    // bring them up to date for selected files which have been written.
+    m_app->tagsToFrameModels();
+  }
+  return errorFiles;
+}
+
+/**
+ * Get error descriptions of the last save().
+ * @return descriptions corresponding to the paths returned by save(),
+ * empty strings where no description is available.
+ */
+QStringList TagBatch::errorDescriptions() const
+{
+  return m_errorDescriptions;
+}
+
+/**
+ * Get tagged file with tags read.
+ * @param handle index of file in batch
+ * @return tagged file, null if @a handle is invalid.
+ */
+TaggedFile* TagBatch::taggedFile(int handle) const
+{
+  if (handle < 0 || handle >= count())
+    return nullptr;
+
+  if (TaggedFile* file = taggedFileOfPath(m_paths.at(handle))) {
+    return FileProxyModel::readTagsFromTaggedFile(file);
+  }
+  return nullptr;
+}
+
+/**
+ * Get tagged file of a path in the opened folder.
+ * The index is looked up in the source model, so that it is also found if
+ * the file is filtered out.
+ * @param path absolute file path
+ * @return tagged file, null if not found.
+ */
+TaggedFile* TagBatch::taggedFileOfPath(const QString& path) const
+{
+  if (!m_app || path.isEmpty())
+    return nullptr;
+
+  return FileProxyModel::getTaggedFileOfIndex(
+        m_app->getFileSystemModel()->index(path));
+}
+
+/**
+ * Set paths of files in batch.
+ * @param paths absolute file paths
+ */
+void TagBatch::setPaths(const QStringList& paths)
+{
+  const int oldCount = count();
+  m_paths = paths;
+  if (count() != oldCount) {
+    emit countChanged();
+  }
+}
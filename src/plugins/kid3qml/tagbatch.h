@@ -0,0 +1,215 @@
+/**
+ * \file tagbatch.h
+ * Bulk access to the tags of files for scripts.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QVariantMap>
+#include <QJSValue>
+#include "frame.h"
+
+class Kid3Application;
+class TaggedFile;
+
+/**
+ * Bulk access to the tags of files for scripts.
+ *
+ * In contrast to app.selectFile() and app.getFrame(), the files are not
+ * selected and the frame models and GUI are not updated, so that scripts
+ * processing many files are only limited by the file I/O. A file is
+ * addressed by a handle, which is its index in the list of files set with
+ * setFiles() or setAllFiles(). The batch stores the paths of the files,
+ * a handle becomes invalid if its file is renamed or the folder is changed.
+ *
+ * @code
+ * TagBatch {
+ *   id: batch
+ *   app: app
+ * }
+ * ...
+ * batch.setAllFiles()
+ * batch.forEach(function(handle) {
+ *   var title = batch.get(handle, tagv2, "title")
+ *   batch.set(handle, tagv2, "title", title.toUpperCase())
+ * })
+ * batch.save()
+ * @endcode
+ */
+class KID3_PLUGIN_EXPORT TagBatch : public QObject {
+  Q_OBJECT
+  /** Application, has to be set before files can be added. */
+  Q_PROPERTY(Kid3Application* app READ app WRITE setApp NOTIFY appChanged)
+  /** Number of files in batch. */
+  Q_PROPERTY(int count READ count NOTIFY countChanged)
+public:
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit TagBatch(QObject* parent = nullptr);
+
+  /**
+   * Destructor.
+   */
+  ~TagBatch() override = default;
+
+  /**
+   * Get application.
+   * @return application.
+   */
+  Kid3Application* app() const { return m_app; }
+
+  /**
+   * Set application.
+   * @param app application
+   */
+  void setApp(Kid3Application* app);
+
+  /**
+   * Get number of files in batch.
+   * @return number of files.
+   */
+  int count() const { return static_cast<int>(m_paths.size()); }
+
+  /**
+   * Set files of batch from paths.
+   * Paths which are not found in the opened folder or are not tagged files
+   * are skipped.
+   * @param paths absolute file paths
+   * @return number of files in batch.
+   */
+  Q_INVOKABLE int setFiles(const QStringList& paths);
+
+  /**
+   * Set files of batch to all tagged files in the opened folder.
+   * @param filterExpression if not empty, only files passing this filter
+   * expression are added, see FileFilter
+   * @return number of files in batch, -1 if filter expression is invalid.
+   */
+  Q_INVOKABLE int setAllFiles(const QString& filterExpression = QString());
+
+  /**
+   * Get path of file.
+   * @param handle index of file in batch
+   * @return absolute path, empty if @a handle is invalid.
+   */
+  Q_INVOKABLE QString path(int handle) const;
+
+  /**
+   * Get value of frame.
+   * @param handle index of file in batch
+   * @param tagMask tag bit (1 for tag 1, 2 for tag 2)
+   * @param name name of frame (e.g. "Artist"), prefix "!" to use the name
+   * of the frame in the tag
+   * @return frame value, empty if not found.
+   */
+  Q_INVOKABLE QString get(int handle, Frame::TagVersion tagMask,
+                          const QString& name) const;
+
+  /**
+   * Set value of frame.
+   * For tag 2 and 3, a frame is added if it does not exist, and deleted if
+   * @a value is empty. The file is only written when save() is called.
+   * @param handle index of file in batch
+   * @param tagMask tag bit (1 for tag 1, 2 for tag 2)
+   * @param name name of frame (e.g. "Artist"), prefix "!" to use the name
+   * of the frame in the tag
+   * @param value value of frame
+   * @return true if ok.
+   */
+  Q_INVOKABLE bool set(int handle, Frame::TagVersion tagMask,
+                       const QString& name, const QString& value);
+
+  /**
+   * Get names and values of all frames.
+   * @param handle index of file in batch
+   * @param tagMask tag bit (1 for tag 1, 2 for tag 2)
+   * @return map containing frame values.
+   */
+  Q_INVOKABLE QVariantMap getAll(int handle, Frame::TagVersion tagMask) const;
+
+  /**
+   * Get data of first picture.
+   * @param handle index of file in batch
+   * @return picture data, empty if not found.
+   */
+  Q_INVOKABLE QByteArray getPictureData(int handle) const;
+
+  /**
+   * Set data of first picture.
+   * @param handle index of file in batch
+   * @param data picture data, empty to delete the picture
+   * @return true if ok.
+   */
+  Q_INVOKABLE bool setPictureData(int handle, const QByteArray& data);
+
+  /**
+   * Check if file is modified.
+   * @param handle index of file in batch
+   * @return true if file has unsaved changes.
+   */
+  Q_INVOKABLE bool isChanged(int handle) const;
+
+  /**
+   * Call a function for all files in the batch.
+   * @param callback function called with the handle of each file, the
+   * iteration is stopped if it returns false
+   * @return number of files processed.
+   */
+  Q_INVOKABLE int forEach(QJSValue callback);
+
+  /**
+   * Write the changed files of the batch.
+   * Files are written like with app.saveDirectory(), if a file shall be
+   * renamed to a file name which already exists, a number is appended.
+   * @return paths of files which could not be written, empty if ok.
+   */
+  Q_INVOKABLE QStringList save();
+
+  /**
+   * Get error descriptions of the last save().
+   * @return descriptions corresponding to the paths returned by save(),
+   * empty strings where no description is available.
+   */
+  Q_INVOKABLE QStringList errorDescriptions() const;
+
+signals:
+  /** Emitted when the application is changed. */
+  void appChanged();
+
+  /** Emitted when the number of files is changed. */
+  void countChanged();
+
+private:
+  TaggedFile* taggedFile(int handle) const;
+  TaggedFile* taggedFileOfPath(const QString& path) const;
+  void setPaths(const QStringList& paths);
+
+  Kid3Application* m_app;
+  QStringList m_paths;
+  QStringList m_errorDescriptions;
+};
@@ -40,6 +40,7 @@
 #include <cstring>
 #include "genres.h"
 #include "pictureframe.h"
+#include "performancetracer.h"
 
 /** MPEG4IP version as 16-bit hex number with major and minor version. */
 #if defined MP4V2_PROJECT_version_major && defined MP4V2_PROJECT_version_minor
@@ -529,6 +530,7 @@ QString M4aFile::taggedFileKey() const
  */
 void M4aFile::readTags(bool force)
 {
+  TraceSpan span("M4aFile::readTags", [this] { return currentFilePath(); });
   bool priorIsTagInformationRead = isTagInformationRead();
   if (force || !m_fileRead) {
     m_metadata.clear();
@@ -743,6 +745,7 @@ bool M4aFile::writeTags(bool force, bool* renamed, bool preserve)
 {
   bool ok = true;
   QString fnStr(currentFilePath());
+  TraceSpan span("M4aFile::writeTags", fnStr);
   if (isChanged() && !QFileInfo(fnStr).isWritable()) {
     revertChangedFilename();
     return false;
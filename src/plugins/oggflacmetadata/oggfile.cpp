@@ -38,6 +38,7 @@
 #include "pictureframe.h"
 #include "tagconfig.h"
 #include "taggedfilesystemmodel.h"
+#include "performancetracer.h"
 
 #ifdef HAVE_VORBIS
 namespace {
@@ -175,6 +176,7 @@ int OggFile::taggedFileFeatures() const
  */
 void OggFile::readTags(bool force)
 {
+  TraceSpan span("OggFile::readTags", [this] { return currentFilePath(); });
   bool priorIsTagInformationRead = isTagInformationRead();
   if (force || !m_fileRead) {
     m_comments.clear();
@@ -231,6 +233,7 @@ void OggFile::readTags(bool force)
  */
 bool OggFile::writeTags(bool force, bool* renamed, bool preserve)
 {
+  TraceSpan span("OggFile::writeTags", [this] { return currentFilePath(); });
   QString dirname = getDirname();
   if (isChanged() &&
     !QFileInfo(currentFilePath()).isWritable()) {
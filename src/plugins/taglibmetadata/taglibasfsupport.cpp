@@ -212,13 +212,12 @@ bool parseAsfPicture(const TagLib::ASF::Picture& picture, Frame& frame)
   if (!picture.isValid())
     return false;
 
-  TagLib::ByteVector data = picture.picture();
   QString description(toQString(picture.description()));
   PictureFrame::setFields(frame, Frame::TE_ISO8859_1, QLatin1String("JPG"),
                           toQString(picture.mimeType()),
                           static_cast<PictureFrame::PictureType>(picture.type()),
                           description,
-                          QByteArray(data.data(), data.size()));
+                          toQByteArray(picture.picture()));
   frame.setType(Frame::FT_Picture);
   return true;
 }
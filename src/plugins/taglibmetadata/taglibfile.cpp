@@ -39,6 +39,7 @@
 #include "pictureframe.h"
 
 #include "taglibutils.h"
+#include "performancetracer.h"
 #include "taglibfileiostream.h"
 #include "taglibmpegsupport.h"
 #include "taglibmp4support.h"
@@ -171,6 +172,7 @@ void TagLibFile::readTags(bool force)
 {
   bool priorIsTagInformationRead = isTagInformationRead();
   QString fileName = currentFilePath();
+  TraceSpan span("TagLibFile::readTags", fileName);
 
   if (force || m_fileRef.isNull()) {
     delete m_stream;
@@ -284,6 +286,15 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve)
   return writeTags(force, renamed, preserve, id3v2Version);
 }
 
+/**
+ * Check if writeTags() can be called from a worker thread.
+ * @return true, files can be written concurrently.
+ */
+bool TagLibFile::isConcurrentWriteSupported() const
+{
+  return true;
+}
+
 /**
  * Write tags to file and rename it if necessary.
  *
@@ -302,7 +313,11 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
                            int id3v2Version)
 {
   QString fnStr(currentFilePath());
-  if (isChanged() && !QFileInfo(fnStr).isWritable()) {
+  TraceSpan span("TagLibFile::writeTags", fnStr);
+  // The same file information is used for the writability check and the
+  // time stamps, every query is a round trip on network file systems.
+  QFileInfo fileInfo(fnStr);
+  if (isChanged() && !fileInfo.isWritable()) {
     closeFile(false);
     revertChangedFilename();
     return false;
@@ -310,8 +325,8 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
 
   // store time stamp if it has to be preserved
   quint64 actime = 0, modtime = 0;
-  if (preserve) {
-    getFileTimeStamps(fnStr, actime, modtime);
+  if (preserve && isChanged()) {
+    getFileTimeStamps(fileInfo, actime, modtime);
   }
 
   bool fileChanged = false;
@@ -345,14 +360,24 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
   // => double ID3v2 tags.
   // On Windows it is necessary to close the file before renaming it,
   // so it is done even if the file is not changed.
+  // Files written in a batch to a network share keep the tags which have
+  // been written, reading them back would be another round trip to the
+  // share. Only the file handle is closed, which also writes the file to
+  // disk. An ID3v2.3.0 tag is read back because its frames are converted.
+  const bool keepTags = fileChanged && isWrittenConcurrently() &&
+      m_id3v2Version != 3;
+  if (keepTags) {
+    closeFile(false);
+  } else {
 #ifndef Q_OS_WIN32
-  closeFile(fileChanged);
+    closeFile(fileChanged);
 #else
-  closeFile(true);
+    closeFile(true);
 #endif
+  }
 
   // restore time stamp
-  if (actime || modtime) {
+  if (fileChanged && (actime || modtime)) {
     setFileTimeStamps(fnStr, actime, modtime);
   }
 
@@ -367,10 +392,32 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
 #ifndef Q_OS_WIN32
   if (fileChanged)
 #endif
-    makeFileOpen(true);
+  {
+    if (keepTags) {
+      updateTagInformationAfterWrite();
+    } else {
+      makeFileOpen(true);
+    }
+  }
   return true;
 }
 
+/**
+ * Update the information cached by readTags() from the tags which have been
+ * written, without reading the file again.
+ * The tags stay in memory, so that they can be accessed without opening the
+ * file.
+ */
+void TagLibFile::updateTagInformationAfterWrite()
+{
+  bool priorIsTagInformationRead = isTagInformationRead();
+  FOR_TAGLIB_TAGS(tagNr) {
+    m_hasTag[tagNr] = m_tag[tagNr] && !m_tag[tagNr]->isEmpty();
+    m_tagFormat[tagNr] = getTagFormat(m_tag[tagNr], m_tagType[tagNr]);
+  }
+  notifyModelDataChanged(priorIsTagInformationRead);
+}
+
 namespace {
 
 /**
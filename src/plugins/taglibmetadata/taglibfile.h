@@ -121,6 +121,12 @@ public:
    */
   bool writeTags(bool force, bool* renamed, bool preserve) override;
 
+  /**
+   * Check if writeTags() can be called from a worker thread.
+   * @return true, files can be written concurrently.
+   */
+  bool isConcurrentWriteSupported() const override;
+
   /**
    * Free resources allocated when calling readTags().
    *
@@ -331,6 +337,12 @@ private:
    */
   void closeFile(bool force = false);
 
+  /**
+   * Update the information cached by readTags() from the tags which have been
+   * written, without reading the file again.
+   */
+  void updateTagInformationAfterWrite();
+
   /**
    * Make sure that file is open.
    * This method should be called before accessing m_fileRef, m_tag.
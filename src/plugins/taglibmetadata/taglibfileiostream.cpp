@@ -27,15 +27,19 @@
 #include "taglibfileiostream.h"
 #include <QFile>
 #include <QList>
+#include <QThread>
 #include <QMimeDatabase>
 #include <tfilestream.h>
 #include "taglibformatsupport.h"
 
 QList<FileIOStream*> FileIOStream::s_openFiles;
+QMutex FileIOStream::s_mutex;
 QList<TagLibFormatSupport*> FileIOStream::s_formats;
+QHash<QByteArray, TagLibFormatSupport*> FileIOStream::s_formatForExtension;
 
 FileIOStream::FileIOStream(const QString& fileName)
-  : m_fileName(nullptr), m_fileStream(nullptr), m_offset(0)
+  : m_fileName(nullptr), m_fileStream(nullptr), m_offset(0),
+    m_threadId(nullptr)
 {
   setName(fileName);
 }
@@ -229,12 +233,102 @@ TagLib::File* FileIOStream::createFromExtension(TagLib::IOStream* stream)
 TagLib::File* FileIOStream::createFromExtension(TagLib::IOStream* stream,
                                                 const TagLib::String& ext)
 {
+  // The format support for an extension is only searched the first time,
+  // then it is looked up.
+  const QByteArray key = QByteArray::fromStdString(ext.to8Bit());
+  QMutexLocker locker(&s_mutex);
+  if (auto it = s_formatForExtension.constFind(key);
+      it != s_formatForExtension.constEnd()) {
+    TagLibFormatSupport* format = *it;
+    locker.unlock();
+    return format ? format->createFromExtension(stream, ext) : nullptr;
+  }
+  locker.unlock();
+  TagLibFormatSupport* foundFormat = nullptr;
+  TagLib::File* file = nullptr;
   for (auto format : s_formats) {
-    if (TagLib::File* file = format->createFromExtension(stream, ext)) {
-      return file;
+    if ((file = format->createFromExtension(stream, ext)) != nullptr) {
+      foundFormat = format;
+      break;
     }
   }
-  return nullptr;
+  locker.relock();
+  s_formatForExtension.insert(key, foundFormat);
+  return file;
+}
+
+TagLib::String FileIOStream::extensionFromMagic(const TagLib::ByteVector& data)
+{
+  auto hasAt = [&data](const char* magic, unsigned int len,
+                       unsigned int offset = 0) {
+    return data.containsAt(TagLib::ByteVector(magic, len), offset);
+  };
+  auto byteAt = [&data](unsigned int offset) {
+    return offset < data.size()
+        ? static_cast<unsigned char>(data[offset]) : 0U;
+  };
+
+  if (data.size() < 12) {
+    return TagLib::String();
+  }
+  if (hasAt("ID3", 3)) {
+    // Skip the ID3v2 tag (synchsafe size) to check for FLAC with ID3v2.
+    unsigned int offset = 10 +
+        ((byteAt(6) & 0x7f) << 21) + ((byteAt(7) & 0x7f) << 14) +
+        ((byteAt(8) & 0x7f) << 7) + (byteAt(9) & 0x7f);
+    if (byteAt(5) & 0x10) {
+      offset += 10;
+    }
+    return hasAt("fLaC", 4, offset) ? "FLAC" : "MP3";
+  }
+  if (hasAt("fLaC", 4))
+    return "FLAC";
+  if (hasAt("OggS", 4)) {
+    // The first packet follows the 27 byte page header and the segment table.
+    unsigned int packetPos = 27 + byteAt(26);
+    if (hasAt("\x7f" "FLAC", 5, packetPos))
+      return "OGA";
+    if (hasAt("OpusHead", 8, packetPos))
+      return "OPUS";
+    if (hasAt("Speex   ", 8, packetPos))
+      return "SPX";
+    return "OGG";
+  }
+  if (hasAt("ftyp", 4, 4))
+    return "MP4";
+  if (hasAt("RIFF", 4) && hasAt("WAVE", 4, 8))
+    return "WAV";
+  if (hasAt("FORM", 4) && (hasAt("AIFF", 4, 8) || hasAt("AIFC", 4, 8)))
+    return "AIFF";
+  if (hasAt("\x30\x26\xb2\x75\x8e\x66\xcf\x11", 8))
+    return "WMA";
+  if (hasAt("MAC ", 4))
+    return "APE";
+  if (hasAt("MPCK", 4) || hasAt("MP+", 3))
+    return "MPC";
+  if (hasAt("wvpk", 4))
+    return "WV";
+  if (hasAt("TTA1", 4))
+    return "TTA";
+  if (hasAt("DSD ", 4))
+    return "DSF";
+  if (hasAt("FRM8", 4))
+    return "DFF";
+  if (hasAt("IMPM", 4))
+    return "IT";
+  if (hasAt("Extended Module: ", 17))
+    return "XM";
+  if (hasAt("SCRM", 4, 44))
+    return "S3M";
+#if TAGLIB_VERSION >= 0x020200
+  if (hasAt("\x1a\x45\xdf\xa3", 4))
+    return "MKA";
+#endif
+  if (byteAt(0) == 0xff && (byteAt(1) & 0xe0) == 0xe0) {
+    // MPEG audio frame sync, layer bits 0 are used by ADTS AAC.
+    return (byteAt(1) & 0x06) == 0 ? "AAC" : "MP3";
+  }
+  return TagLib::String();
 }
 
 TagLib::File* FileIOStream::createFromContents(TagLib::IOStream* stream)
@@ -282,6 +376,17 @@ TagLib::File* FileIOStream::createFromContents(TagLib::IOStream* stream)
   stream->seek(0);
   TagLib::ByteVector bv = stream->readBlock(4096);
   stream->seek(0);
+  if (TagLib::String ext = extensionFromMagic(bv); !ext.isEmpty()) {
+    if (TagLib::File* file = createFromExtension(stream, ext)) {
+      if (file->isValid()) {
+        return file;
+      }
+      delete file;
+      stream->seek(0);
+    }
+  }
+
+  // Fall back to the MIME type detection for formats without known signature.
   QMimeDatabase mimeDb;
   auto mimeType =
       mimeDb.mimeTypeForData(QByteArray(bv.data(), static_cast<int>(bv.size())));
@@ -293,19 +398,37 @@ TagLib::File* FileIOStream::createFromContents(TagLib::IOStream* stream)
 
 void FileIOStream::registerOpenFile(FileIOStream* stream)
 {
-  if (s_openFiles.contains(stream))
-    return;
-
-  if (int numberOfFilesToClose = static_cast<int>(s_openFiles.size()) - 15;
-      numberOfFilesToClose > 5) {
-    for (auto it = s_openFiles.begin(); it != s_openFiles.end(); ++it) { // clazy:exclude=detaching-member
-      (*it)->closeFileHandle();
-      if (--numberOfFilesToClose <= 0) {
-        break;
+  // Files can be written from worker threads, only the handles of files
+  // opened in the current thread are closed, the others could be in use.
+  // TaggedFile::endConcurrentWrite() closes the handles of the worker
+  // threads, so outside of a write batch all handles can be closed here.
+  const Qt::HANDLE threadId = QThread::currentThreadId();
+  QList<FileIOStream*> filesToClose;
+  {
+    QMutexLocker locker(&s_mutex);
+    if (s_openFiles.contains(stream))
+      return;
+
+    if (int numberOfFilesToClose = static_cast<int>(s_openFiles.size()) - 15;
+        numberOfFilesToClose > 5) {
+      for (auto it = s_openFiles.begin(); it != s_openFiles.end();) {
+        if ((*it)->m_threadId == threadId) {
+          filesToClose.append(*it);
+          it = s_openFiles.erase(it);
+          if (--numberOfFilesToClose <= 0) {
+            break;
+          }
+        } else {
+          ++it;
+        }
       }
     }
+    stream->m_threadId = threadId;
+    s_openFiles.append(stream);
+  }
+  for (FileIOStream* file : std::as_const(filesToClose)) {
+    file->closeFileHandle();
   }
-  s_openFiles.append(stream);
 }
 
 /**
@@ -315,10 +438,13 @@ void FileIOStream::registerOpenFile(FileIOStream* stream)
  */
 void FileIOStream::deregisterOpenFile(FileIOStream* stream)
 {
+  QMutexLocker locker(&s_mutex);
   s_openFiles.removeAll(stream);
 }
 
 void FileIOStream::registerFormatSupport(const QList<TagLibFormatSupport*>& formats)
 {
+  QMutexLocker locker(&s_mutex);
   s_formats = formats;
+  s_formatForExtension.clear();
 }
@@ -27,6 +27,9 @@
 #pragma once
 
 #include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QMutex>
 #include <tiostream.h>
 
 #include "taglibutils.h"
@@ -167,9 +170,17 @@ private:
    */
   static TagLib::File* createFromContents(IOStream* stream);
 
+  /**
+   * Get file type from the signature at the start of a file.
+   * @param data first bytes of file
+   * @return uppercase extension for file type, empty if not detected.
+   */
+  static TagLib::String extensionFromMagic(const TagLib::ByteVector& data);
+
   /**
    * Register open files, so that the number of open files can be limited.
-   * If the number of open files exceeds a limit, files are closed.
+   * If the number of open files exceeds a limit, files which have been opened
+   * in the same thread are closed.
    *
    * @param stream new open file to be registered
    */
@@ -189,9 +200,15 @@ private:
 #endif
   TagLib::FileStream* m_fileStream;
   long m_offset;
+  /** thread which opened the file descriptor */
+  Qt::HANDLE m_threadId;
 
   /** list of file streams with open file descriptor */
   static QList<FileIOStream*> s_openFiles;
+  /** protects s_openFiles and s_formatForExtension */
+  static QMutex s_mutex;
   /** format support */
   static QList<TagLibFormatSupport*> s_formats;
+  /** format support for uppercase extension, null if not supported */
+  static QHash<QByteArray, TagLibFormatSupport*> s_formatForExtension;
 };
@@ -528,7 +528,7 @@ void TagLibMp4Support::putPicturesAndChaptersInExtraFrames(
 #endif
       int i = 0;
       for (const auto& coverArt : pics) {
-        TagLib::ByteVector bv = coverArt.data();
+        const TagLib::ByteVector bv = coverArt.data();
         QString mimeType, imgFormat;
         switch (coverArt.format()) {
         case TagLib::MP4::CoverArt::PNG:
@@ -550,7 +550,7 @@ void TagLibMp4Support::putPicturesAndChaptersInExtraFrames(
           imgFormat = QLatin1String("JPG");
         }
         PictureFrame frame(
-          QByteArray(bv.data(), static_cast<int>(bv.size())),
+          toQByteArray(bv),
           QLatin1String(""), PictureFrame::PT_CoverFront, mimeType,
           Frame::TE_ISO8859_1, imgFormat);
         frame.setIndex(Frame::toNegativeIndex(i++));
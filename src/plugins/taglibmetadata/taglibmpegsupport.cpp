@@ -706,9 +706,7 @@ QString getFieldsFromApicFrame(
   fields.push_back(field);
 
   field.m_id = Frame::ID_Data;
-  TagLib::ByteVector pic = apicFrame->picture();
-  QByteArray ba = QByteArray(pic.data(), pic.size());
-  field.m_value = ba;
+  field.m_value = toQByteArray(apicFrame->picture());
   fields.push_back(field);
 
   return text;
@@ -811,9 +809,7 @@ QString getFieldsFromGeobFrame(
   fields.push_back(field);
 
   field.m_id = Frame::ID_Data;
-  TagLib::ByteVector obj = geobFrame->object();
-  QByteArray ba = QByteArray(obj.data(), obj.size());
-  field.m_value = ba;
+  field.m_value = toQByteArray(geobFrame->object());
   fields.push_back(field);
 
   return text;
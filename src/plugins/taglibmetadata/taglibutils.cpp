@@ -26,7 +26,80 @@
 
 #include "taglibutils.h"
 
+#include <cstring>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
 #include <tstring.h>
+#include <tbytevector.h>
+
+namespace {
+
+/**
+ * Cache for byte arrays converted from large TagLib byte vectors.
+ *
+ * An entry is keyed by the address of the data in the TagLib buffer. As the
+ * entry keeps a reference to the TagLib buffer, the address cannot be reused
+ * for other data while the entry exists. When TagLib sets new data, e.g.
+ * when a picture is replaced, it gets a different buffer. The contents are
+ * nevertheless compared on a hit, which is still much cheaper than allocating
+ * and copying the data, so that a wrong picture can never be returned.
+ */
+class ByteArrayCache {
+public:
+  /** Minimum size of data to be cached. */
+  static constexpr unsigned int MIN_SIZE = 64 * 1024;
+  /**
+   * Maximum total size of cached data, oldest entries are dropped.
+   * Every entry is counted twice, as the TagLib buffer is kept too.
+   */
+  static constexpr qint64 MAX_TOTAL_SIZE = 32 * 1024 * 1024;
+
+  QByteArray get(const TagLib::ByteVector& bv);
+
+private:
+  struct Entry {
+    TagLib::ByteVector buffer;
+    QByteArray byteArray;
+  };
+
+  QMutex m_mutex;
+  QHash<const char*, Entry> m_entries;
+  QQueue<const char*> m_order;
+  qint64 m_totalSize = 0;
+};
+
+QByteArray ByteArrayCache::get(const TagLib::ByteVector& bv)
+{
+  const char* data = bv.data();
+  const auto size = static_cast<int>(bv.size());
+  if (bv.size() < MIN_SIZE) {
+    return QByteArray(data, size);
+  }
+
+  QMutexLocker locker(&m_mutex);
+  if (auto it = m_entries.constFind(data);
+      it != m_entries.constEnd() && it->byteArray.size() == size &&
+      std::memcmp(it->byteArray.constData(), data, size) == 0) {
+    return it->byteArray;
+  }
+  if (m_entries.contains(data)) {
+    m_totalSize -= 2 * m_entries.value(data).byteArray.size();
+    m_entries.remove(data);
+    m_order.removeOne(data);
+  }
+  while (!m_order.isEmpty() && m_totalSize + 2 * size > MAX_TOTAL_SIZE) {
+    m_totalSize -= 2 * m_entries.take(m_order.dequeue()).byteArray.size();
+  }
+  QByteArray ba(data, size);
+  m_entries.insert(data, {bv, ba});
+  m_order.enqueue(data);
+  m_totalSize += 2 * size;
+  return ba;
+}
+
+}
 
 namespace TagLibUtils {
 
@@ -48,6 +121,13 @@ TagLib::String toTString(const QString& s)
   return TagLib::String(ws);
 }
 
+/** Convert binary data @a bv to a QByteArray, sharing large data. */
+QByteArray toQByteArray(const TagLib::ByteVector& bv)
+{
+  static ByteArrayCache cache;
+  return cache.get(bv);
+}
+
 /** Convert TagLib::String @a s to a QString. */
 QString toQString(const TagLib::String& s)
 {
@@ -56,6 +56,17 @@ namespace TagLibUtils {
   /** Convert TagLib::String @a s to a QString. */
   QString toQString(const TagLib::String& s);
 
+  /**
+   * Convert binary data, e.g. a picture, to a QByteArray.
+   * Large data is only copied the first time, further calls return a shared
+   * copy as long as the TagLib buffer is not changed.
+   *
+   * @param bv TagLib byte vector
+   *
+   * @return byte array with the contents of @a bv.
+   */
+  QByteArray toQByteArray(const TagLib::ByteVector& bv);
+
   /**
    * Convert TagLib::StringList @a tstrs to QString joining with
    * Frame::stringListSeparator().
@@ -52,8 +52,7 @@ namespace {
  */
 void flacPictureToFrame(const TagLib::FLAC::Picture* pic, Frame& frame)
 {
-  TagLib::ByteVector picData(pic->data());
-  QByteArray ba(picData.data(), picData.size());
+  QByteArray ba(toQByteArray(pic->data()));
   PictureFrame::ImageProperties imgProps(
         pic->width(), pic->height(), pic->colorDepth(),
         pic->numColors(), ba);
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""Benchmark tag operations of kid3-cli on a synthetic corpus.
+
+A reproducible corpus with MP3 (ID3v2.3 and ID3v2.4), FLAC, Ogg and MP4 files,
+with and without large embedded pictures, is generated into a temporary
+folder. Then opening, reading, filtering, formatting, saving and renaming is
+timed for every metadata plugin which supports the format. The results are
+written as JSON, so that they can be compared between builds.
+
+Usage:
+  bench_cli_functions.py [-n files] [-r repeats] [-o results.json]
+  bench_cli_functions.py --compare baseline.json results.json
+"""
+import argparse
+import json
+import os
+import platform
+import random
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from kid3testsupport import kid3_cli_path, call_kid3_cli, create_test_file, \
+    Kid3ConfigFileUsingOnlyTagLib, Kid3ConfigFileUsingOnlyId3lib, \
+    Kid3ConfigFileUsingOnlyOggFlac, Kid3ConfigFileUsingOnlyMp4v2
+
+
+# Corpus name, file extension, ID3v2 version to write.
+CORPORA = (
+    ('mp3v23', 'mp3', 'ID3v2_3_0'),
+    ('mp3v24', 'mp3', 'ID3v2_4_0'),
+    ('flac', 'flac', None),
+    ('ogg', 'ogg', None),
+    ('mp4', 'm4a', None),
+)
+
+# Plugin name, configuration context, corpora supported by plugin.
+PLUGINS = (
+    ('TaglibMetadata', Kid3ConfigFileUsingOnlyTagLib,
+     ('mp3v23', 'mp3v24', 'flac', 'ogg', 'mp4')),
+    ('Id3libMetadata', Kid3ConfigFileUsingOnlyId3lib, ('mp3v23',)),
+    ('OggFlacMetadata', Kid3ConfigFileUsingOnlyOggFlac, ('flac', 'ogg')),
+    ('Mp4v2Metadata', Kid3ConfigFileUsingOnlyMp4v2, ('mp4',)),
+)
+
+PICTURE_SIZE = 2 * 1024 * 1024
+
+
+def create_picture_file(path, size, seed):
+    """Create a JPEG file padded with reproducible pseudo-random data."""
+    create_test_file(path)
+    block_size = 64 * 1024
+    block = random.Random(seed).getrandbits(8 * block_size).to_bytes(
+        block_size, 'little')
+    with open(path, 'ab') as fh:
+        fh.write(block * (size // block_size) + block[:size % block_size])
+
+
+def create_corpus(rootdir, num_files):
+    """Create a tagged corpus in rootdir, return dict with corpus folders."""
+    picpath = os.path.join(rootdir, 'cover.jpg')
+    create_picture_file(picpath, PICTURE_SIZE, 3)
+    folders = {}
+    for name, ext, id3v2_version in CORPORA:
+        for with_pictures in (False, True):
+            corpus = name + ('-pictures' if with_pictures else '')
+            folder = os.path.join(rootdir, corpus)
+            os.mkdir(folder)
+            for nr in range(num_files):
+                create_test_file(os.path.join(folder, 'track%04d.%s' % (nr, ext)))
+            cmds = []
+            if id3v2_version:
+                cmds += ['-c', 'config Tag.id3v2Version %s' % id3v2_version]
+            for nr in range(num_files):
+                cmds += ['-c', 'select track%04d.%s' % (nr, ext),
+                         '-c', 'set title "Title %d" 2' % nr,
+                         '-c', 'set artist "Artist %d" 2' % (nr % 7),
+                         '-c', 'set album "Album %d" 2' % (nr % 3),
+                         '-c', 'set track %d 2' % (nr + 1)]
+                if with_pictures:
+                    cmds += ['-c', 'set picture:"%s" "Cover" 2' % picpath]
+                cmds += ['-c', 'select none']
+            with Kid3ConfigFileUsingOnlyTagLib():
+                call_kid3_cli(cmds + [folder])
+            folders[corpus] = folder
+    os.remove(picpath)
+    return folders
+
+
+# Operation name, kid3-cli commands, true if the folder has to be restored
+# from the corpus before every run because the operation renames the files.
+# "{run}" in a command is replaced by the number of the run, so that every run
+# really modifies the files. "{first}" is replaced by the path of the first
+# file, which is then passed instead of the folder.
+OPERATIONS = (
+    ('startup', ['-c', 'exit'], False),
+    ('getone', ['-c', 'get title', '{first}'], False),
+    ('open', ['-c', 'pwd'], False),
+    ('read', ['-c', 'ls'], False),
+    ('filter', ['-c', 'filter "%{artist} contains 3"'], False),
+    ('format', ['-c', 'select all', '-c', 'tagformat'], False),
+    ('save', ['-c', 'select all', '-c', 'set comment "Benchmark {run}" 2',
+              '-c', 'save'], False),
+    ('rename', ['-c', 'select all',
+                '-c', 'fromtag "%{track} %{title} {run}" 2', '-c', 'save'],
+     True),
+)
+
+
+def time_kid3_cli(args, folder, repeats, corpus_folder=None):
+    """Run kid3-cli repeats times, return list of elapsed seconds.
+
+    If corpus_folder is given, folder is recreated as a copy of it before
+    every run, so that every run starts with the same files.
+    """
+    cli = kid3_cli_path()
+    times = []
+    for run in range(repeats):
+        if corpus_folder:
+            shutil.rmtree(folder)
+            shutil.copytree(corpus_folder, folder)
+        first = os.path.join(folder, sorted(os.listdir(folder))[0])
+        cmd = [cli] + [arg.replace('{run}', str(run)).replace('{first}', first)
+                       for arg in args]
+        if '{first}' not in args:
+            cmd.append(folder)
+        start = time.perf_counter()
+        subprocess.check_call(cmd, stdout=subprocess.DEVNULL)
+        times.append(time.perf_counter() - start)
+    return times
+
+
+def run_benchmarks(num_files, repeats):
+    results = []
+    with tempfile.TemporaryDirectory() as rootdir:
+        folders = create_corpus(rootdir, num_files)
+        for plugin, config_context, supported in PLUGINS:
+            for corpus, folder in sorted(folders.items()):
+                name = corpus.split('-')[0]
+                if name not in supported:
+                    continue
+                # Work on a copy, the benchmark modifies the files.
+                workdir = os.path.join(rootdir, 'work')
+                shutil.copytree(folder, workdir)
+                try:
+                    with config_context():
+                        for operation, cmds, restore in OPERATIONS:
+                            times = time_kid3_cli(
+                                cmds, workdir, repeats,
+                                folder if restore else None)
+                            median = statistics.median(times)
+                            results.append({
+                                'plugin': plugin,
+                                'corpus': corpus,
+                                'operation': operation,
+                                'files': num_files,
+                                'repeats': repeats,
+                                'median': median,
+                                'min': min(times),
+                                'max': max(times),
+                                'filesPerSecond':
+                                    num_files / median if median > 0 else 0.0
+                            })
+                            print('%-16s %-16s %-8s %8.3f s' %
+                                  (plugin, corpus, operation, median),
+                                  file=sys.stderr)
+                finally:
+                    shutil.rmtree(workdir)
+    return {
+        'kid3cli': call_kid3_cli('-h').splitlines()[0],
+        'platform': platform.platform(),
+        'results': results
+    }
+
+
+def compare_results(baseline_path, results_path):
+    """Print relative change of median times, return number of regressions."""
+    with open(baseline_path) as fh:
+        baseline = json.load(fh)
+    with open(results_path) as fh:
+        current = json.load(fh)
+
+    def key(r):
+        return r['plugin'], r['corpus'], r['operation']
+
+    base_by_key = dict((key(r), r) for r in baseline['results'])
+    regressions = 0
+    for r in current['results']:
+        b = base_by_key.get(key(r))
+        if not b or b['median'] <= 0:
+            continue
+        change = (r['median'] - b['median']) / b['median'] * 100.0
+        marker = ''
+        if change > 10.0:
+            marker = ' <--'
+            regressions += 1
+        print('%-16s %-16s %-8s %8.3f s %8.3f s %+7.1f %%%s' %
+              (r['plugin'], r['corpus'], r['operation'],
+               b['median'], r['median'], change, marker))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Benchmark tag operations of kid3-cli.')
+    parser.add_argument('-n', '--files', type=int, default=100,
+                        help='number of files per corpus folder')
+    parser.add_argument('-r', '--repeats', type=int, default=3,
+                        help='number of runs per operation')
+    parser.add_argument('-o', '--output',
+                        help='JSON file for results, default is stdout')
+    parser.add_argument('--compare', nargs=2,
+                        metavar=('BASELINE', 'RESULTS'),
+                        help='compare two result files')
+    args = parser.parse_args()
+
+    if args.compare:
+        return 1 if compare_results(*args.compare) else 0
+
+    # Use an invalid config file to use a default configuration.
+    os.environ['KID3_CONFIG_FILE'] = ''
+    os.environ['LANGUAGE'] = 'en_US.UTF-8'
+    os.environ['LANG'] = 'en_US.UTF-8'
+    data = run_benchmarks(args.files, args.repeats)
+    if args.output:
+        with open(args.output, 'w') as fh:
+            json.dump(data, fh, indent=2)
+    else:
+        json.dump(data, sys.stdout, indent=2)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -33,6 +33,14 @@
 #include "testmusicbrainzreleaseimporter.h"
 #include "testdiscogsimporter.h"
 #include "testamazonimporter.h"
+#include "testtagsearcher.h"
+#include "testtagsearchindex.h"
+#include "testtaggedfilecolumnstore.h"
+#include "testfingerprintcache.h"
+#include "testdirrenamer.h"
+#include "testcoverartcache.h"
+#include "testrenamepreviewmodel.h"
+#include "testframecache.h"
 
 /**
  * Main routine for test runner.
@@ -52,6 +60,14 @@ int main(int argc, char *argv[])
     new TestMusicBrainzReleaseImporter,
     new TestDiscogsImporter,
     new TestAmazonImporter,
+    new TestTagSearcher,
+    new TestTagSearchIndex,
+    new TestTaggedFileColumnStore,
+    new TestFingerprintCache,
+    new TestDirRenamer,
+    new TestCoverArtCache,
+    new TestRenamePreviewModel,
+    new TestFrameCache,
     nullptr
   };
 
@@ -0,0 +1,154 @@
+/**
+ * \file memorytaggedfile.cpp
+ * Tagged file stub with frames in memory for tests.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memorytaggedfile.h"
+
+/**
+ * Constructor.
+ * @param idx index in tagged file system model
+ */
+MemoryTaggedFile::MemoryTaggedFile(const QPersistentModelIndex& idx)
+  : TaggedFile(idx)
+{
+  FOR_ALL_TAGS(tagNr) {
+    m_fetchCount[tagNr] = 0;
+  }
+}
+
+/**
+ * Get key of tagged file format.
+ * @return "MemoryMetadata".
+ */
+QString MemoryTaggedFile::taggedFileKey() const
+{
+  return QLatin1String("MemoryMetadata");
+}
+
+/**
+ * Read tags from file, does nothing.
+ */
+void MemoryTaggedFile::readTags(bool)
+{
+}
+
+/**
+ * Write tags to file, not supported.
+ * @return false.
+ */
+bool MemoryTaggedFile::writeTags(bool, bool*, bool)
+{
+  return false;
+}
+
+/**
+ * Free resources allocated when calling readTags(), does nothing.
+ */
+void MemoryTaggedFile::clearTags(bool)
+{
+}
+
+/**
+ * Check if tag information has already been read.
+ * @return true.
+ */
+bool MemoryTaggedFile::isTagInformationRead() const
+{
+  return true;
+}
+
+/**
+ * Get technical detail information, not available.
+ */
+void MemoryTaggedFile::getDetailInfo(DetailInfo&) const
+{
+}
+
+/**
+ * Get duration of file.
+ * @return 0.
+ */
+unsigned MemoryTaggedFile::getDuration() const
+{
+  return 0;
+}
+
+/**
+ * Get file extension including the dot.
+ * @return ".mp3".
+ */
+QString MemoryTaggedFile::getFileExtension() const
+{
+  return QLatin1String(".mp3");
+}
+
+/**
+ * Get a specific frame from the tags, not supported.
+ * @return false.
+ */
+bool MemoryTaggedFile::getFrame(Frame::TagNumber, Frame::Type, Frame&) const
+{
+  return false;
+}
+
+/**
+ * Set a frame in the tags.
+ * A frame of the same type is replaced and the tag is marked as changed.
+ * @param tagNr tag number
+ * @param frame frame to set
+ * @return true.
+ */
+bool MemoryTaggedFile::setFrame(Frame::TagNumber tagNr, const Frame& frame)
+{
+  FrameCollection& frames = m_frames[tagNr];
+  if (auto it = frames.findByExtendedType(frame.getExtendedType());
+      it != frames.end()) {
+    frames.erase(it);
+  }
+  frames.insert(frame);
+  markTagChanged(tagNr, frame.getExtendedType());
+  return true;
+}
+
+/**
+ * Get a list of frame IDs which can be added.
+ * @return empty list.
+ */
+QStringList MemoryTaggedFile::getFrameIds(Frame::TagNumber) const
+{
+  return {};
+}
+
+/**
+ * Get all frames in tag.
+ * @param tagNr tag number
+ * @param frames frame collection to set
+ */
+void MemoryTaggedFile::getAllFrames(Frame::TagNumber tagNr,
+                                    FrameCollection& frames)
+{
+  ++m_fetchCount[tagNr];
+  frames = m_frames[tagNr];
+}
@@ -0,0 +1,139 @@
+/**
+ * \file memorytaggedfile.h
+ * Tagged file stub with frames in memory for tests.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "taggedfile.h"
+
+/**
+ * Tagged file stub with frames in memory for tests.
+ * It counts how often the frames are fetched with getAllFrames().
+ */
+class MemoryTaggedFile : public TaggedFile {
+public:
+  /**
+   * Constructor.
+   * @param idx index in tagged file system model
+   */
+  explicit MemoryTaggedFile(const QPersistentModelIndex& idx);
+
+  /**
+   * Destructor.
+   */
+  ~MemoryTaggedFile() override = default;
+
+  MemoryTaggedFile(const MemoryTaggedFile& other) = delete;
+  MemoryTaggedFile &operator=(const MemoryTaggedFile& other) = delete;
+
+  /**
+   * Get key of tagged file format.
+   * @return "MemoryMetadata".
+   */
+  QString taggedFileKey() const override;
+
+  /**
+   * Read tags from file, does nothing.
+   * @param force true to force reading even if tags were already read.
+   */
+  void readTags(bool force) override;
+
+  /**
+   * Write tags to file, not supported.
+   * @param force true to force writing even if file was not changed.
+   * @param renamed will be set to true if the file was renamed
+   * @param preserve true to preserve file time stamps
+   * @return false.
+   */
+  bool writeTags(bool force, bool* renamed, bool preserve) override;
+
+  /**
+   * Free resources allocated when calling readTags(), does nothing.
+   * @param force true to force clearing even if the tags are modified
+   */
+  void clearTags(bool force) override;
+
+  /**
+   * Check if tag information has already been read.
+   * @return true.
+   */
+  bool isTagInformationRead() const override;
+
+  /**
+   * Get technical detail information, not available.
+   * @param info the detail information is returned here
+   */
+  void getDetailInfo(DetailInfo& info) const override;
+
+  /**
+   * Get duration of file.
+   * @return 0.
+   */
+  unsigned getDuration() const override;
+
+  /**
+   * Get file extension including the dot.
+   * @return ".mp3".
+   */
+  QString getFileExtension() const override;
+
+  /**
+   * Get a specific frame from the tags, not supported.
+   * @param tagNr tag number
+   * @param type frame type
+   * @param frame the frame is returned here
+   * @return false.
+   */
+  bool getFrame(Frame::TagNumber tagNr, Frame::Type type,
+                Frame& frame) const override;
+
+  /**
+   * Set a frame in the tags.
+   * A frame of the same type is replaced and the tag is marked as changed.
+   * @param tagNr tag number
+   * @param frame frame to set
+   * @return true.
+   */
+  bool setFrame(Frame::TagNumber tagNr, const Frame& frame) override;
+
+  /**
+   * Get a list of frame IDs which can be added.
+   * @param tagNr tag number
+   * @return empty list.
+   */
+  QStringList getFrameIds(Frame::TagNumber tagNr) const override;
+
+  /**
+   * Get all frames in tag.
+   * @param tagNr tag number
+   * @param frames frame collection to set
+   */
+  void getAllFrames(Frame::TagNumber tagNr, FrameCollection& frames) override;
+
+  /** Frames returned by getAllFrames() */
+  FrameCollection m_frames[Frame::Tag_NumValues];
+  /** Number of getAllFrames() calls */
+  int m_fetchCount[Frame::Tag_NumValues];
+};
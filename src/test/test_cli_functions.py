@@ -7,6 +7,11 @@ import subprocess
 import tempfile
 import platform
 import json
+import re
+import time
+import socket
+import struct
+import zlib
 from kid3testsupport import kid3_cli_path, call_kid3_cli, create_test_file, ignore_audio_properties, \
     Kid3ConfigFileUsingOnlyTagLib, Kid3ConfigFileUsingOnlyId3lib, Kid3ConfigFileUsingOnlyOggFlac, \
     Kid3ConfigFileUsingOnlyMp4v2
@@ -20,6 +25,25 @@ def setUpModule():
     os.environ['LANG'] = 'en_US.UTF-8'
 
 
+def write_png(path, width, height):
+    """Write a gray PNG image with the given dimensions."""
+    def chunk(tag, data):
+        return struct.pack('>I', len(data)) + tag + data + \
+            struct.pack('>I', zlib.crc32(tag + data) & 0xffffffff)
+    rows = b''.join(b'\x00' + b'\x80' * width for _ in range(height))
+    with open(path, 'wb') as fh:
+        fh.write(b'\x89PNG\r\n\x1a\n' +
+                 chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 0, 0, 0, 0)) +
+                 chunk(b'IDAT', zlib.compress(rows)) +
+                 chunk(b'IEND', b''))
+
+
+def png_size(path):
+    """Get width and height of a PNG image."""
+    with open(path, 'rb') as fh:
+        return struct.unpack('>II', fh.read(24)[16:24])
+
+
 class CliFunctionsTestCase(unittest.TestCase):
     def test_help(self):
         full_help = call_kid3_cli('-h')
@@ -183,6 +207,219 @@ class CliFunctionsTestCase(unittest.TestCase):
             create_test_file(os.path.join(tmpdir, 'test.mp3'))
             self.assertEqual(call_kid3_cli(['-c', 'ls', tmpdir]), '  --- test.mp3\n')
 
+    def test_resizeart(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            pngpath = os.path.join(tmpdir, 'cover.png')
+            picpath = os.path.join(tmpdir, 'out.png')
+            write_png(pngpath, 80, 40)
+            for name in ('a.mp3', 'b.mp3'):
+                create_test_file(os.path.join(tmpdir, name))
+            call_kid3_cli(
+                ['-c', 'select all',
+                 '-c', 'set picture:"%s" "" 2' % pngpath,
+                 '-c', 'save', tmpdir])
+            call_kid3_cli(
+                ['-c', 'select all',
+                 '-c', 'resizeart 20',
+                 '-c', 'save', tmpdir])
+            for name in ('a.mp3', 'b.mp3'):
+                call_kid3_cli(
+                    ['-c', 'get picture:"%s" 2' % picpath,
+                     os.path.join(tmpdir, name)])
+                self.assertEqual(png_size(picpath), (20, 10))
+            # Pictures which are small enough are not changed.
+            os.remove(picpath)
+            call_kid3_cli(
+                ['-c', 'resizeart 500',
+                 '-c', 'get picture:"%s" 2' % picpath,
+                 os.path.join(tmpdir, 'a.mp3')])
+            self.assertEqual(png_size(picpath), (20, 10))
+
+    def test_save_rename_to_existing_file(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            create_test_file(os.path.join(tmpdir, 'a.mp3'))
+            create_test_file(os.path.join(tmpdir, 'b.mp3'))
+            self.assertEqual(call_kid3_cli(
+                ['-c', 'select b.mp3',
+                 '-c', 'set title a',
+                 '-c', 'fromtag "%{title}" 2',
+                 '-c', 'save', tmpdir]), '')
+            self.assertEqual(sorted(os.listdir(tmpdir)),
+                             ['a(1).mp3', 'a.mp3'])
+
+    def test_save_network_share_keeps_tags(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tmpdir = os.path.realpath(tmpdir)
+            create_test_file(os.path.join(tmpdir, 'a.mp3'))
+            trace_path = os.path.join(tmpdir, 'trace.json')
+            os.environ['KID3_NETWORK_SHARES'] = tmpdir
+            try:
+                self.assertEqual(call_kid3_cli(
+                    ['--trace', trace_path,
+                     '-c', 'select a.mp3', '-c', 'set title "Saved"',
+                     '-c', 'save', '-c', 'get title', tmpdir]), 'Saved\n')
+            finally:
+                del os.environ['KID3_NETWORK_SHARES']
+            with open(trace_path) as fh:
+                names = [event['name'] for event in json.load(fh)['traceEvents']]
+            # The tags written to the share are not read back from the file.
+            self.assertEqual(names.count('TagLibFile::writeTags'), 1)
+            self.assertEqual(names.count('TagLibFile::readTags'), 1)
+            self.assertEqual(call_kid3_cli(
+                ['-c', 'select a.mp3', '-c', 'get title', tmpdir]), 'Saved\n')
+
+    def test_serve_and_connect(self):
+        if sys.platform == 'win32':
+            self.skipTest('Local socket given as file path')
+        with tempfile.TemporaryDirectory() as tmpdir:
+            create_test_file(os.path.join(tmpdir, 'test.mp3'))
+            socket_path = os.path.join(tmpdir, 'kid3.sock')
+            server = subprocess.Popen([kid3_cli_path(), '--serve', socket_path, tmpdir])
+            try:
+                for _ in range(100):
+                    if os.path.exists(socket_path):
+                        break
+                    time.sleep(0.1)
+                self.assertEqual(call_kid3_cli(
+                    ['--connect', socket_path, '-c', 'select test.mp3',
+                     '-c', 'set title "Served"', '-c', 'get title']),
+                    'Served\n')
+                # The tags stay in memory between the client processes.
+                self.assertEqual(call_kid3_cli(
+                    ['--connect', socket_path, '-c', '{"method":"get","params":["title"]}']),
+                    'Served\n')
+                # A second server must not remove the socket of the running server.
+                p = subprocess.Popen([kid3_cli_path(), '--serve', socket_path, tmpdir],
+                                     stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+                stdout, stderr = p.communicate(timeout=10)
+                self.assertIn(b'already running', stderr)
+                self.assertEqual(p.returncode, 1)
+                self.assertEqual(call_kid3_cli(
+                    ['--connect', socket_path, '-c', 'get title']), 'Served\n')
+                p = subprocess.Popen([kid3_cli_path(), '--connect', socket_path, '-c', 'invalid'],
+                                     stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+                stdout, stderr = p.communicate()
+                self.assertEqual(stdout, b'')
+                self.assertIn(b"Unknown command 'invalid'", stderr)
+                self.assertEqual(p.returncode, 1)
+                self.assertEqual(call_kid3_cli(
+                    ['--connect', socket_path, '-c', 'revert', '-c', 'exit']), '')
+                self.assertEqual(server.wait(timeout=10), 0)
+            finally:
+                if server.poll() is None:
+                    server.kill()
+                    server.wait()
+
+    def test_serve_concurrent_clients(self):
+        if sys.platform == 'win32':
+            self.skipTest('Local socket given as file path')
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tmpdir = os.path.realpath(tmpdir)
+            subdir = os.path.join(tmpdir, 'sub')
+            os.mkdir(subdir)
+            create_test_file(os.path.join(tmpdir, 'first.mp3'))
+            create_test_file(os.path.join(subdir, 'second.mp3'))
+            socket_path = os.path.join(tmpdir, 'kid3.sock')
+            server = subprocess.Popen([kid3_cli_path(), '--serve', socket_path, tmpdir])
+            try:
+                for _ in range(100):
+                    if os.path.exists(socket_path):
+                        break
+                    time.sleep(0.1)
+                first = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                first.connect(socket_path)
+                first_file = first.makefile('rwb')
+
+                def request(method, *params):
+                    first_file.write(json.dumps(
+                        {'method': method, 'params': list(params)}).encode() + b'\n')
+                    first_file.flush()
+                    return json.loads(first_file.readline())
+
+                request('select', 'first.mp3')
+                request('set', 'title', 'First')
+                self.assertNotIn('error', request('save'))
+                # The idle first client must not block the second client.
+                out = subprocess.check_output(
+                    [kid3_cli_path(), '--connect', socket_path, '-c', 'cd sub',
+                     '-c', 'select second.mp3', '-c', 'set title "Second"',
+                     '-c', 'get title'], timeout=20)
+                self.assertEqual(out.decode().replace('\r\n', '\n'), 'Second\n')
+                # The first client continues in its folder with its selection.
+                self.assertEqual(request('pwd')['result'], tmpdir)
+                self.assertEqual(request('get', 'title')['result'], 'First')
+                first_file.close()
+                first.close()
+                self.assertEqual(call_kid3_cli(
+                    ['--connect', socket_path, '-c', 'exit']), '')
+                self.assertEqual(server.wait(timeout=10), 0)
+            finally:
+                if server.poll() is None:
+                    server.kill()
+                    server.wait()
+
+    def test_import_tag_table(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tmpdir = os.path.realpath(tmpdir)
+            for name in ('a.mp3', 'b.mp3'):
+                create_test_file(os.path.join(tmpdir, name))
+            csvpath = os.path.join(tmpdir, 'import.csv')
+            with open(csvpath, 'w') as csvfh:
+                csvfh.write('File Path\tArtist\tTitle\n'
+                            '%s\tArtist B\tTitle B\n'
+                            '%s\tArtist A\t"Title ""A"""\n' %
+                            (os.path.join(tmpdir, 'b.mp3'),
+                             os.path.join(tmpdir, 'a.mp3')))
+            self.assertEqual(call_kid3_cli(
+                ['-c', 'import "%s" table 2' % csvpath,
+                 '-c', 'select a.mp3', '-c', 'get title', '-c', 'get artist',
+                 '-c', 'select b.mp3', '-c', 'get title', tmpdir]),
+                'Title "A"\nArtist A\nTitle B\n')
+            os.remove(csvpath)
+            # Without file paths, the rows are assigned in the order of the files.
+            jsonpath = os.path.join(tmpdir, 'import.json')
+            with open(jsonpath, 'w') as jsonfh:
+                jsonfh.write('{"data":[{"Title":"First"},{"Title":"Second"}]}')
+            self.assertEqual(call_kid3_cli(
+                ['-c', 'import "%s" table 2' % jsonpath,
+                 '-c', 'select a.mp3', '-c', 'get title',
+                 '-c', 'select b.mp3', '-c', 'get title', tmpdir]),
+                'First\nSecond\n')
+            os.remove(jsonpath)
+
+    def test_duplicates(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tmpdir = os.path.realpath(tmpdir)
+            for name in ('a.mp3', 'b.mp3', 'c.mp3', 'd.mp3'):
+                create_test_file(os.path.join(tmpdir, name))
+            actual = call_kid3_cli(
+                ['-c', 'select a.mp3', '-c', 'set artist "The Band"',
+                 '-c', 'set title "Same Song"',
+                 '-c', 'select b.mp3', '-c', 'set artist "The Band"',
+                 '-c', 'set title "Other Song"',
+                 '-c', 'select c.mp3', '-c', 'set artist "band, the"',
+                 '-c', 'set title "Same song!"',
+                 '-c', 'select d.mp3', '-c', 'set artist "The Band"',
+                 '-c', 'set title "Song Same"',
+                 '-c', 'select none', '-c', 'duplicates', tmpdir])
+            self.assertRegex(actual,
+                '^The Band - Same Song\n'
+                '  (?:\\d+:\\d+ )?%s\n'
+                '  (?:\\d+:\\d+ )?%s\n$' %
+                (re.escape(os.path.join(tmpdir, 'a.mp3')),
+                 re.escape(os.path.join(tmpdir, 'c.mp3'))))
+
+    def test_memory(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            for name in ('a.mp3', 'b.mp3'):
+                create_test_file(os.path.join(tmpdir, name))
+            actual = call_kid3_cli(
+                ['-c', 'select all', '-c', 'memory', tmpdir])
+            self.assertRegex(actual,
+                '^Limit: \\d+\n'
+                'Files with tags in memory: \\d+\n'
+                'Evicted files: 0\n$')
+
     def test_id3v1_taglib(self):
         with Kid3ConfigFileUsingOnlyTagLib():
             self._run_id3v1_tests()
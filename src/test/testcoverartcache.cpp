@@ -0,0 +1,111 @@
+/**
+ * \file testcoverartcache.cpp
+ * Test cache for decoded and scaled cover art.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testcoverartcache.h"
+#include <QTest>
+#include <QSignalSpy>
+#include <QBuffer>
+#include <QImage>
+#include "coverartcache.h"
+
+namespace {
+
+/**
+ * Create PNG picture data.
+ * @param width width of image
+ * @param height height of image
+ * @param color fill color
+ * @return PNG data.
+ */
+QByteArray pngData(int width, int height, QRgb color)
+{
+  QImage image(width, height, QImage::Format_RGB32);
+  image.fill(color);
+  QByteArray data;
+  QBuffer buffer(&data);
+  buffer.open(QIODevice::WriteOnly);
+  image.save(&buffer, "PNG");
+  return data;
+}
+
+}
+
+void TestCoverArtCache::testHitAndMiss()
+{
+  CoverArtCache cache;
+  const QByteArray data = pngData(400, 200, qRgb(255, 0, 0));
+  const QSize size(100, 100);
+  QImage image;
+  QSize originalSize;
+  QVERIFY(!cache.findImage(data, size, image, &originalSize));
+
+  image = cache.image(data, size, &originalSize);
+  QCOMPARE(image.size(), QSize(100, 50));
+  QCOMPARE(originalSize, QSize(400, 200));
+
+  image = QImage();
+  originalSize = QSize();
+  QVERIFY(cache.findImage(data, size, image, &originalSize));
+  QCOMPARE(image.size(), QSize(100, 50));
+  QCOMPARE(originalSize, QSize(400, 200));
+
+  // Another size and other data are not found.
+  QVERIFY(!cache.findImage(data, QSize(), image));
+  const QByteArray otherData = pngData(400, 200, qRgb(0, 0, 255));
+  QVERIFY(!cache.findImage(otherData, size, image));
+  QCOMPARE(cache.image(data, QSize()).size(), QSize(400, 200));
+  QVERIFY(cache.findImage(data, QSize(), image));
+  QCOMPARE(image.size(), QSize(400, 200));
+}
+
+void TestCoverArtCache::testUndecodableData()
+{
+  CoverArtCache cache;
+  const QByteArray data("not a picture");
+  QVERIFY(cache.image(data, QSize(100, 100)).isNull());
+  // The failure is cached, so that the data is not decoded again.
+  QImage image;
+  QVERIFY(cache.findImage(data, QSize(100, 100), image));
+  QVERIFY(image.isNull());
+}
+
+void TestCoverArtCache::testRequestImage()
+{
+  CoverArtCache cache;
+  const QByteArray data = pngData(64, 64, qRgb(0, 255, 0));
+  const QSize size(32, 32);
+  QSignalSpy spy(&cache, &CoverArtCache::imageReady);
+  cache.requestImage(data, size);
+  QVERIFY(spy.count() == 1 || spy.wait());
+  QImage image;
+  QVERIFY(cache.findImage(data, size, image));
+  QCOMPARE(image.size(), size);
+
+  // A cached image is not decoded again.
+  cache.requestImage(data, size);
+  QTest::qWait(50);
+  QCOMPARE(spy.count(), 1);
+}
@@ -0,0 +1,269 @@
+/**
+ * \file testdirrenamer.cpp
+ * Test journal of directory renamer and moving files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testdirrenamer.h"
+#include <QTest>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QStorageInfo>
+#include <QTemporaryDir>
+#include "dirrenamer.h"
+#include "saferename.h"
+
+namespace {
+
+/**
+ * Write a file.
+ * @param filePath path of file
+ * @param data contents of file
+ * @return true if OK.
+ */
+bool writeFile(const QString& filePath, const QByteArray& data)
+{
+  QFile file(filePath);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+/**
+ * Read a file.
+ * @param filePath path of file
+ * @return contents of file, empty if not found.
+ */
+QByteArray readFile(const QString& filePath)
+{
+  QFile file(filePath);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Create a journal record.
+ * @param record JSON array
+ * @return line for journal.
+ */
+QByteArray journalLine(const QJsonArray& record)
+{
+  return QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n';
+}
+
+/**
+ * Get the journals in the journal directory.
+ * @param journalDir journal directory
+ * @return file names of journals.
+ */
+QStringList journalNames(const QString& journalDir)
+{
+  return QDir(journalDir).entryList({QLatin1String("renamejournal-*.jsonl")},
+                                    QDir::Files);
+}
+
+}
+
+void TestDirRenamer::initTestCase()
+{
+  // Do not touch the journals of the user.
+  QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestDirRenamer::cleanup()
+{
+  const QString journalDir = QFileInfo(DirRenamer::journalPath()).absolutePath();
+  const QStringList names = journalNames(journalDir);
+  for (const QString& name : names) {
+    QFile::remove(journalDir + QLatin1Char('/') + name);
+  }
+}
+
+void TestDirRenamer::testJournalPathIsUnique()
+{
+  const QString path1 = DirRenamer::journalPath();
+  const QString path2 = DirRenamer::journalPath();
+  QVERIFY(path1 != path2);
+  const QString pidPrefix = QLatin1String("renamejournal-") +
+      QString::number(QCoreApplication::applicationPid()) + QLatin1Char('-');
+  QVERIFY(QFileInfo(path1).fileName().startsWith(pidPrefix));
+  QVERIFY(path1.endsWith(QLatin1String(".jsonl")));
+}
+
+void TestDirRenamer::testInterruptedJournalIsKept()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString dir = tmpDir.path();
+  QVERIFY(writeFile(dir + QLatin1String("/a.mp3"), "a"));
+  QVERIFY(writeFile(dir + QLatin1String("/c.mp3"), "c"));
+
+  // A journal left by an interrupted process with the same process ID.
+  const QString interruptedPath = DirRenamer::journalPath();
+  QVERIFY(QDir().mkpath(QFileInfo(interruptedPath).absolutePath()));
+  const QByteArray interrupted = journalLine(
+        {QLatin1String("action"), DirRenamer::RenameAction::RenameFile,
+         dir + QLatin1String("/c.mp3"), dir + QLatin1String("/d.mp3")});
+  QVERIFY(writeFile(interruptedPath, interrupted));
+
+  DirRenamer renamer;
+  renamer.m_actions.append(DirRenamer::RenameAction(
+        DirRenamer::RenameAction::RenameFile, dir + QLatin1String("/a.mp3"),
+        dir + QLatin1String("/b.mp3"), QPersistentModelIndex()));
+  QString errorMsg;
+  renamer.performActions(&errorMsg);
+  QVERIFY(errorMsg.isEmpty());
+  QVERIFY(QFileInfo::exists(dir + QLatin1String("/b.mp3")));
+  QCOMPARE(readFile(interruptedPath), interrupted);
+
+  QVERIFY(renamer.scheduleJournalActions(false));
+  QCOMPARE(renamer.m_actions.size(), 1);
+  QCOMPARE(renamer.m_actions.at(0).m_dest, dir + QLatin1String("/d.mp3"));
+}
+
+void TestDirRenamer::testResume()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString dir = tmpDir.path();
+  // a.mp3 has been renamed to b.mp3, c.mp3 has not been renamed yet.
+  QVERIFY(writeFile(dir + QLatin1String("/b.mp3"), "a"));
+  QVERIFY(writeFile(dir + QLatin1String("/c.mp3"), "c"));
+  const QString journal = DirRenamer::journalPath();
+  QVERIFY(QDir().mkpath(QFileInfo(journal).absolutePath()));
+  QVERIFY(writeFile(journal, journalLine(
+    {QLatin1String("action"), DirRenamer::RenameAction::CreateDirectory,
+     QString(), dir + QLatin1String("/sub")}) + journalLine(
+    {QLatin1String("action"), DirRenamer::RenameAction::RenameFile,
+     dir + QLatin1String("/a.mp3"), dir + QLatin1String("/b.mp3")}) +
+    journalLine(
+    {QLatin1String("action"), DirRenamer::RenameAction::RenameFile,
+     dir + QLatin1String("/c.mp3"), dir + QLatin1String("/sub/d.mp3")}) +
+    journalLine({QLatin1String("done"), 1})));
+
+  DirRenamer renamer;
+  QVERIFY(renamer.scheduleJournalActions(false));
+  QCOMPARE(renamer.m_actions.size(), 2);
+  QCOMPARE(renamer.m_actions.at(0).m_type,
+           DirRenamer::RenameAction::CreateDirectory);
+  QCOMPARE(renamer.m_actions.at(1).m_src, dir + QLatin1String("/c.mp3"));
+
+  QString errorMsg;
+  renamer.performActions(&errorMsg);
+  QVERIFY(errorMsg.isEmpty());
+  QVERIFY(!QFileInfo::exists(dir + QLatin1String("/c.mp3")));
+  QCOMPARE(readFile(dir + QLatin1String("/sub/d.mp3")), QByteArray("c"));
+  QCOMPARE(readFile(dir + QLatin1String("/b.mp3")), QByteArray("a"));
+  QVERIFY(journalNames(QFileInfo(journal).absolutePath()).isEmpty());
+  QVERIFY(!renamer.scheduleJournalActions(false));
+}
+
+void TestDirRenamer::testRollback()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString dir = tmpDir.path();
+  // a.mp3 has been renamed and recorded, c.mp3 has been renamed without
+  // being recorded, e.mp3 has not been renamed.
+  QVERIFY(QDir(dir).mkdir(QLatin1String("sub")));
+  QVERIFY(writeFile(dir + QLatin1String("/sub/b.mp3"), "a"));
+  QVERIFY(writeFile(dir + QLatin1String("/sub/d.mp3"), "c"));
+  QVERIFY(writeFile(dir + QLatin1String("/e.mp3"), "e"));
+  const QString journal = DirRenamer::journalPath();
+  QVERIFY(QDir().mkpath(QFileInfo(journal).absolutePath()));
+  QVERIFY(writeFile(journal, journalLine(
+    {QLatin1String("action"), DirRenamer::RenameAction::CreateDirectory,
+     QString(), dir + QLatin1String("/sub")}) + journalLine(
+    {QLatin1String("action"), DirRenamer::RenameAction::RenameFile,
+     dir + QLatin1String("/a.mp3"), dir + QLatin1String("/sub/b.mp3")}) +
+    journalLine(
+    {QLatin1String("action"), DirRenamer::RenameAction::RenameFile,
+     dir + QLatin1String("/c.mp3"), dir + QLatin1String("/sub/d.mp3")}) +
+    journalLine(
+    {QLatin1String("action"), DirRenamer::RenameAction::RenameFile,
+     dir + QLatin1String("/e.mp3"), dir + QLatin1String("/sub/f.mp3")}) +
+    journalLine({QLatin1String("done"), 0}) +
+    journalLine({QLatin1String("done"), 1})));
+  // Partial copy of an interrupted move across file systems.
+  QVERIFY(writeFile(dir + QLatin1String("/sub/f.mp3.kid3part"), "e"));
+
+  DirRenamer renamer;
+  QVERIFY(renamer.scheduleJournalActions(true));
+  QCOMPARE(renamer.m_actions.size(), 3);
+  QCOMPARE(renamer.m_actions.at(0).m_src, dir + QLatin1String("/sub/d.mp3"));
+  QCOMPARE(renamer.m_actions.at(1).m_src, dir + QLatin1String("/sub/b.mp3"));
+  QCOMPARE(renamer.m_actions.at(2).m_type,
+           DirRenamer::RenameAction::RemoveDirectory);
+  QVERIFY(!QFileInfo::exists(dir + QLatin1String("/sub/f.mp3.kid3part")));
+
+  QString errorMsg;
+  renamer.performActions(&errorMsg);
+  QVERIFY(errorMsg.isEmpty());
+  QCOMPARE(readFile(dir + QLatin1String("/a.mp3")), QByteArray("a"));
+  QCOMPARE(readFile(dir + QLatin1String("/c.mp3")), QByteArray("c"));
+  QCOMPARE(readFile(dir + QLatin1String("/e.mp3")), QByteArray("e"));
+  QVERIFY(!QFileInfo::exists(dir + QLatin1String("/sub")));
+  QVERIFY(journalNames(QFileInfo(journal).absolutePath()).isEmpty());
+}
+
+void TestDirRenamer::testMoveFileAcrossFileSystems()
+{
+  QTemporaryDir srcDir;
+  QVERIFY(srcDir.isValid());
+  const QByteArray srcDevice = QStorageInfo(srcDir.path()).device();
+  QString otherFileSystemPath;
+  const QStringList candidates = {
+    QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation),
+    QLatin1String("/dev/shm"),
+    QDir::homePath()
+  };
+  for (const QString& candidate : candidates) {
+    if (!candidate.isEmpty() && QFileInfo(candidate).isWritable() &&
+        QStorageInfo(candidate).device() != srcDevice) {
+      otherFileSystemPath = candidate;
+      break;
+    }
+  }
+  if (otherFileSystemPath.isEmpty()) {
+    QSKIP("No writable folder on another file system");
+  }
+  QTemporaryDir destDir(otherFileSystemPath + QLatin1String("/kid3test-XXXXXX"));
+  QVERIFY(destDir.isValid());
+
+  const QString src = srcDir.path() + QLatin1String("/a.mp3");
+  const QString dest = destDir.path() + QLatin1String("/b.mp3");
+  const QByteArray data(100000, 'x');
+  QVERIFY(writeFile(src, data));
+  QVERIFY(Utils::moveFile(src, dest));
+  QVERIFY(!QFileInfo::exists(src));
+  QCOMPARE(readFile(dest), data);
+  QVERIFY(!QFileInfo::exists(dest + QLatin1String(".kid3part")));
+
+  // An existing destination is not overwritten.
+  QVERIFY(writeFile(src, "new"));
+  QVERIFY(!Utils::moveFile(src, dest));
+  QCOMPARE(readFile(src), QByteArray("new"));
+  QCOMPARE(readFile(dest), data);
+}
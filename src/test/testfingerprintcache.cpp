@@ -0,0 +1,275 @@
+/**
+ * \file testfingerprintcache.cpp
+ * Test cache for audio fingerprints.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testfingerprintcache.h"
+#include <QTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include "fingerprintcache.h"
+
+namespace {
+
+/**
+ * Write a file.
+ * @param filePath path of file
+ * @param data contents of file
+ * @return true if OK.
+ */
+bool writeFile(const QString& filePath, const QByteArray& data)
+{
+  QFile file(filePath);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+/**
+ * Read a file.
+ * @param filePath path of file
+ * @return contents of file, empty if not found.
+ */
+QByteArray readFile(const QString& filePath)
+{
+  QFile file(filePath);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Create an ID3v2.4 tag with 255 bytes of frame data.
+ * @param withFooter true to add a footer
+ * @return ID3v2 tag.
+ */
+QByteArray id3v2Tag(bool withFooter)
+{
+  QByteArray tag("ID3\x04\x00", 5);
+  tag.append(withFooter ? '\x10' : '\x00');
+  // Synchsafe size 0x00 0x00 0x01 0x7f is 255.
+  tag.append(QByteArray("\x00\x00\x01\x7f", 4));
+  tag.append(QByteArray(255, '\0'));
+  if (withFooter) {
+    tag.append(QByteArray("3DI\x04\x00\x10\x00\x00\x01\x7f", 10));
+  }
+  return tag;
+}
+
+/**
+ * Create FLAC metadata with a STREAMINFO block of 34 bytes and a last
+ * PADDING block of 10 bytes.
+ * @return FLAC marker and metadata blocks, 56 bytes.
+ */
+QByteArray flacMetadata()
+{
+  QByteArray data("fLaC");
+  data.append(QByteArray("\x00\x00\x00\x22", 4));
+  data.append(QByteArray(34, '\x01'));
+  data.append(QByteArray("\x81\x00\x00\x0a", 4));
+  data.append(QByteArray(10, '\0'));
+  return data;
+}
+
+}
+
+void TestFingerprintCache::testReadFileKeyId3v2()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString filePath = tmpDir.filePath(QLatin1String("a.mp3"));
+  FingerprintCache::FileKey key;
+  QVERIFY(!FingerprintCache::readFileKey(filePath, key));
+
+  const QByteArray audio(100, '\xff');
+  QVERIFY(writeFile(filePath, id3v2Tag(false) + audio));
+  QVERIFY(FingerprintCache::readFileKey(filePath, key));
+  QCOMPARE(key.size, qint64(265 + 100));
+  QCOMPARE(key.audioOffset, qint64(265));
+
+  QVERIFY(writeFile(filePath, id3v2Tag(true) + audio));
+  QVERIFY(FingerprintCache::readFileKey(filePath, key));
+  QCOMPARE(key.size, qint64(275 + 100));
+  QCOMPARE(key.audioOffset, qint64(275));
+
+  QVERIFY(writeFile(filePath, audio));
+  QVERIFY(FingerprintCache::readFileKey(filePath, key));
+  QCOMPARE(key.audioOffset, qint64(0));
+}
+
+void TestFingerprintCache::testReadFileKeyFlac()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString filePath = tmpDir.filePath(QLatin1String("a.flac"));
+  const QByteArray audio(100, '\xff');
+  FingerprintCache::FileKey key;
+
+  QVERIFY(writeFile(filePath, flacMetadata() + audio));
+  QVERIFY(FingerprintCache::readFileKey(filePath, key));
+  QCOMPARE(key.audioOffset, qint64(56));
+
+  // FLAC files can start with an ID3v2 tag.
+  QVERIFY(writeFile(filePath, id3v2Tag(true) + flacMetadata() + audio));
+  QVERIFY(FingerprintCache::readFileKey(filePath, key));
+  QCOMPARE(key.audioOffset, qint64(275 + 56));
+
+  // Without last metadata block, the offset after the ID3v2 tag is used.
+  QByteArray truncated = flacMetadata();
+  truncated.truncate(42);
+  QVERIFY(writeFile(filePath, id3v2Tag(false) + truncated));
+  QVERIFY(FingerprintCache::readFileKey(filePath, key));
+  QCOMPARE(key.audioOffset, qint64(265));
+}
+
+void TestFingerprintCache::testParseEntryLine()
+{
+  FingerprintCache::Entry entry;
+  entry.key.size = 1234567;
+  entry.key.modified = 1760000000000;
+  entry.key.audioOffset = 4096;
+  entry.duration = 215;
+  entry.fingerprint = QLatin1String("AQADtEmUSUkSJck");
+  const QString filePath = QString::fromUtf8("/music/Ärzte/01 Song.mp3");
+  const QString line = FingerprintCache::entryLine(filePath, entry);
+
+  QString parsedPath;
+  FingerprintCache::Entry parsed;
+  QVERIFY(FingerprintCache::parseEntryLine(line.toUtf8(), parsedPath, parsed));
+  QCOMPARE(parsedPath, filePath);
+  QVERIFY(parsed.key == entry.key);
+  QCOMPARE(parsed.duration, entry.duration);
+  QCOMPARE(parsed.fingerprint, entry.fingerprint);
+
+  // Incomplete line of a file which is being appended.
+  QVERIFY(!FingerprintCache::parseEntryLine(
+            line.toUtf8().chopped(1), parsedPath, parsed));
+  QVERIFY(!FingerprintCache::parseEntryLine(
+            "/a.mp3\t1\t2\t3\t4\n", parsedPath, parsed));
+  QVERIFY(!FingerprintCache::parseEntryLine(
+            "/a.mp3\t1\t2\t3\t4\t\n", parsedPath, parsed));
+  QVERIFY(!FingerprintCache::parseEntryLine(
+            "/a.mp3\t1\tx\t3\t4\tAQAD\n", parsedPath, parsed));
+  QVERIFY(!FingerprintCache::parseEntryLine(
+            "\t1\t2\t3\t4\tAQAD\n", parsedPath, parsed));
+}
+
+void TestFingerprintCache::testInsertAndLoad()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString cachePath = tmpDir.filePath(QLatin1String("cache/fp.tsv"));
+  const QString filePath = tmpDir.filePath(QLatin1String("a.mp3"));
+  QVERIFY(writeFile(filePath, id3v2Tag(false) + QByteArray(100, '\xff')));
+
+  FingerprintCache cache(cachePath);
+  QCOMPARE(cache.size(), 0);
+  cache.insert(filePath, QLatin1String("AQADtEmUSUkSJck"), 215);
+  cache.insert(tmpDir.filePath(QLatin1String("missing.mp3")),
+               QLatin1String("AQAD"), 100);
+  QCOMPARE(cache.size(), 1);
+  QVERIFY(readFile(cachePath).startsWith(FingerprintCache::fileHeader()));
+  QVERIFY(!QFile::exists(cachePath + QLatin1String(".lock")));
+
+  FingerprintCache loaded(cachePath);
+  QString fingerprint;
+  int duration = 0;
+  QVERIFY(loaded.find(filePath, fingerprint, duration));
+  QCOMPARE(fingerprint, QLatin1String("AQADtEmUSUkSJck"));
+  QCOMPARE(duration, 215);
+
+  // A modified file is no longer found.
+  QVERIFY(writeFile(filePath, id3v2Tag(true) + QByteArray(100, '\xff')));
+  QVERIFY(!loaded.find(filePath, fingerprint, duration));
+  QCOMPARE(loaded.size(), 0);
+
+  loaded.clear();
+  QVERIFY(!QFile::exists(cachePath));
+}
+
+void TestFingerprintCache::testCompaction()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString cachePath = tmpDir.filePath(QLatin1String("fp.tsv"));
+  const QString filePath = tmpDir.filePath(QLatin1String("a.mp3"));
+  const QString deletedPath = tmpDir.filePath(QLatin1String("deleted.mp3"));
+  QVERIFY(writeFile(filePath, QByteArray(100, '\xff')));
+  FingerprintCache::Entry entry;
+  QVERIFY(FingerprintCache::readFileKey(filePath, entry.key));
+  entry.duration = 215;
+
+  // Lines for the same file replace earlier lines.
+  QByteArray data = FingerprintCache::fileHeader();
+  for (int i = 0; i < 70; ++i) {
+    entry.fingerprint = QLatin1String("AQAD") + QString::number(i);
+    data += FingerprintCache::entryLine(filePath, entry).toUtf8();
+  }
+  data += FingerprintCache::entryLine(deletedPath, entry).toUtf8();
+  data += "invalid line\n";
+  QVERIFY(writeFile(cachePath, data));
+
+  // A few outdated lines do not cause compaction.
+  QByteArray fewOutdated = FingerprintCache::fileHeader() +
+      FingerprintCache::entryLine(filePath, entry).toUtf8() +
+      FingerprintCache::entryLine(filePath, entry).toUtf8();
+  const QString fewOutdatedPath = tmpDir.filePath(QLatin1String("few.tsv"));
+  QVERIFY(writeFile(fewOutdatedPath, fewOutdated));
+  QCOMPARE(FingerprintCache(fewOutdatedPath).size(), 1);
+  QCOMPARE(readFile(fewOutdatedPath), fewOutdated);
+
+  // The file is compacted and the entry of the deleted file is removed.
+  FingerprintCache cache(cachePath);
+  QCOMPARE(cache.size(), 1);
+  QString fingerprint;
+  int duration = 0;
+  QVERIFY(cache.find(filePath, fingerprint, duration));
+  QCOMPARE(fingerprint, QLatin1String("AQAD69"));
+  QCOMPARE(readFile(cachePath), FingerprintCache::fileHeader() +
+           FingerprintCache::entryLine(filePath, entry).toUtf8());
+}
+
+void TestFingerprintCache::testFileFormatVersion()
+{
+  QTemporaryDir tmpDir;
+  QVERIFY(tmpDir.isValid());
+  const QString cachePath = tmpDir.filePath(QLatin1String("fp.tsv"));
+  const QString filePath = tmpDir.filePath(QLatin1String("a.mp3"));
+  QVERIFY(writeFile(filePath, QByteArray(100, '\xff')));
+  FingerprintCache::Entry entry;
+  QVERIFY(FingerprintCache::readFileKey(filePath, entry.key));
+  entry.duration = 215;
+  entry.fingerprint = QLatin1String("AQAD");
+  const QByteArray line = FingerprintCache::entryLine(filePath, entry).toUtf8();
+
+  // A file without header is not used and replaced.
+  QVERIFY(writeFile(cachePath, line));
+  QCOMPARE(FingerprintCache(cachePath).size(), 0);
+  QCOMPARE(readFile(cachePath), FingerprintCache::fileHeader());
+
+  // A file written by a newer version is not used and not modified.
+  const QByteArray newer = QByteArray("kid3-fingerprints\t99\n") + line;
+  QVERIFY(writeFile(cachePath, newer));
+  FingerprintCache cache(cachePath);
+  QCOMPARE(cache.size(), 0);
+  cache.insert(filePath, QLatin1String("AQADtEmUSUkSJck"), 215);
+  QCOMPARE(cache.size(), 1);
+  QCOMPARE(readFile(cachePath), newer);
+}
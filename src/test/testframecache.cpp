@@ -0,0 +1,123 @@
+/**
+ * \file testframecache.cpp
+ * Test cached frames of tagged files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testframecache.h"
+#include <QTest>
+#include <QFile>
+#include <memory>
+#include "memorytaggedfile.h"
+#include "taggedfilesystemmodel.h"
+#include "coretaggedfileiconprovider.h"
+#include "pictureframe.h"
+
+void TestFrameCache::initTestCase()
+{
+  QVERIFY(m_tempDir.isValid());
+  for (int i = 0; i < 4; ++i) {
+    QFile file(m_tempDir.filePath(QString::number(i) + QLatin1String(".mp3")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+  }
+}
+
+void TestFrameCache::testPictureDataIsLimited()
+{
+  CoreTaggedFileIconProvider iconProvider;
+  TaggedFileSystemModel model(&iconProvider);
+  // Three pictures exceed the limit of the picture data in all caches.
+  const PictureFrame picture(QByteArray(12 * 1024 * 1024, 'x'));
+  std::unique_ptr<MemoryTaggedFile> files[4];
+  for (int i = 0; i < 4; ++i) {
+    const QModelIndex index = model.index(
+          m_tempDir.filePath(QString::number(i) + QLatin1String(".mp3")));
+    QVERIFY(index.isValid());
+    files[i].reset(new MemoryTaggedFile(index));
+    files[i]->m_frames[Frame::Tag_1].insert(
+          Frame(Frame::FT_Title, QString::number(i), QString(), -1));
+    files[i]->m_frames[Frame::Tag_Picture].insert(picture);
+  }
+  auto fetchCount = [&files](int i, Frame::TagNumber tagNr) {
+    files[i]->getAllFramesCached(tagNr);
+    return files[i]->m_fetchCount[tagNr];
+  };
+
+  QCOMPARE(fetchCount(0, Frame::Tag_1), 1);
+  QCOMPARE(fetchCount(0, Frame::Tag_Picture), 1);
+  QCOMPARE(fetchCount(1, Frame::Tag_Picture), 1);
+  QCOMPARE(fetchCount(2, Frame::Tag_Picture), 1);
+  // The pictures of the oldest file have been dropped.
+  QCOMPARE(fetchCount(1, Frame::Tag_Picture), 1);
+  QCOMPARE(fetchCount(2, Frame::Tag_Picture), 1);
+  QCOMPARE(fetchCount(0, Frame::Tag_Picture), 2);
+  // Frames without pictures stay cached.
+  QCOMPARE(fetchCount(0, Frame::Tag_1), 1);
+
+  // Pinned files keep their pictures.
+  files[2]->pin();
+  QCOMPARE(fetchCount(3, Frame::Tag_Picture), 1);
+  QCOMPARE(fetchCount(2, Frame::Tag_Picture), 1);
+  QCOMPARE(fetchCount(1, Frame::Tag_Picture), 2);
+  files[2]->unpin();
+
+  // Destroyed files are no longer accounted for.
+  files[1].reset();
+  files[3].reset();
+  QCOMPARE(fetchCount(0, Frame::Tag_Picture), 3);
+  QCOMPARE(fetchCount(2, Frame::Tag_Picture), 1);
+}
+
+void TestFrameCache::testFilterDifferentKeepsOthers()
+{
+  FrameCollection frames;
+  frames.insert(Frame(Frame::FT_Title, QLatin1String("A"), QString(), 1));
+  frames.insert(Frame(Frame::FT_Artist, QLatin1String("X"), QString(), 2));
+  FrameCollection others;
+  others.insert(Frame(Frame::FT_Title, QLatin1String("B"), QString(), 3));
+  others.insert(Frame(Frame::FT_Artist, QLatin1String("X"), QString(), 4));
+  others.insert(Frame(Frame::FT_Album, QLatin1String("Y"), QString(), 5));
+  const FrameCollection othersBefore(others);
+
+  frames.filterDifferent(others);
+  QCOMPARE(frames.size(), others.size());
+  const auto titleIt =
+      frames.findByExtendedType(Frame::ExtendedType(Frame::FT_Title));
+  const auto artistIt =
+      frames.findByExtendedType(Frame::ExtendedType(Frame::FT_Artist));
+  const auto albumIt =
+      frames.findByExtendedType(Frame::ExtendedType(Frame::FT_Album));
+  QVERIFY(titleIt != frames.cend() && titleIt->isDifferent());
+  QVERIFY(artistIt != frames.cend());
+  QCOMPARE(artistIt->getValue(), QString(QLatin1String("X")));
+  QVERIFY(albumIt != frames.cend() && albumIt->isDifferent());
+  QCOMPARE(albumIt->getIndex(), -1);
+
+  // The compared frames, e.g. cached frames of a file, are not modified.
+  auto beforeIt = othersBefore.cbegin();
+  for (const Frame& frame : others) {
+    QCOMPARE(frame.getValue(), beforeIt->getValue());
+    QCOMPARE(frame.getIndex(), beforeIt->getIndex());
+    ++beforeIt;
+  }
+}
@@ -0,0 +1,189 @@
+/**
+ * \file testrenamepreviewmodel.cpp
+ * Test generation of file names for the rename preview.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testrenamepreviewmodel.h"
+#include <QTest>
+#include <QFile>
+#include "renamepreviewmodel.h"
+#include "taggedfilesystemmodel.h"
+#include "coretaggedfileiconprovider.h"
+#include "memorytaggedfile.h"
+#include "configstore.h"
+#include "dummysettings.h"
+#include "trackdata.h"
+#include "formatconfig.h"
+#include "threadpooljobs.h"
+
+TestRenamePreviewModel::TestRenamePreviewModel(QObject* parent)
+  : QObject(parent), m_settings(nullptr), m_configStore(nullptr)
+{
+}
+
+TestRenamePreviewModel::~TestRenamePreviewModel()
+{
+  delete m_configStore;
+  delete m_settings;
+}
+
+void TestRenamePreviewModel::initTestCase()
+{
+  // The file name format configuration is used by setFilenamesFromTags().
+  if (!ConfigStore::instance()) {
+    m_settings = new DummySettings;
+    m_configStore = new ConfigStore(m_settings);
+  }
+  QVERIFY(m_tempDir.isValid());
+  for (const char* name : {"a.mp3", "b.mp3"}) {
+    QFile file(m_tempDir.filePath(QLatin1String(name)));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+  }
+}
+
+void TestRenamePreviewModel::testJobRanges_data()
+{
+  QTest::addColumn<int>("numItems");
+  QTest::addColumn<int>("maxJobs");
+  QTest::addColumn<int>("numRanges");
+
+  const int minItems = Utils::MIN_ITEMS_PER_JOB;
+  QTest::newRow("no items") << 0 << 4 << 0;
+  QTest::newRow("one item") << 1 << 4 << 1;
+  QTest::newRow("too few for two jobs") << 2 * minItems - 1 << 4 << 1;
+  QTest::newRow("two jobs") << 2 * minItems << 4 << 2;
+  QTest::newRow("limited by jobs") << 10 * minItems + 3 << 4 << 4;
+  QTest::newRow("single thread") << 10 * minItems << 1 << 1;
+}
+
+void TestRenamePreviewModel::testJobRanges()
+{
+  QFETCH(int, numItems);
+  QFETCH(int, maxJobs);
+  QFETCH(int, numRanges);
+
+  const auto ranges = Utils::jobRanges(numItems, maxJobs);
+  QCOMPARE(static_cast<int>(ranges.size()), numRanges);
+  // The ranges are adjacent and cover all items.
+  int begin = 0;
+  for (const auto& range : ranges) {
+    QCOMPARE(range.first, begin);
+    QVERIFY(range.second > range.first);
+    if (ranges.size() > 1) {
+      QVERIFY(range.second - range.first >= Utils::MIN_ITEMS_PER_JOB);
+    }
+    begin = range.second;
+  }
+  QCOMPARE(begin, numItems);
+}
+
+void TestRenamePreviewModel::testFilenamesFromTrackData_data()
+{
+  QTest::addColumn<int>("numFiles");
+
+  // Processed in the calling thread and in multiple jobs.
+  QTest::newRow("inline") << 5;
+  QTest::newRow("jobs") << 8 * Utils::MIN_ITEMS_PER_JOB + 1;
+}
+
+void TestRenamePreviewModel::testFilenamesFromTrackData()
+{
+  QFETCH(int, numFiles);
+
+  FormatConfig fnCfg(QLatin1String("TestFilenameFormat"));
+  fnCfg.setCaseConversion(FormatConfig::AllFirstLettersUppercase);
+  fnCfg.setFormatWhileEditing(true);
+  const QString format(QLatin1String("%{artist} - %{title}"));
+
+  QVector<TrackData> trackDataVector;
+  trackDataVector.reserve(numFiles);
+  for (int i = 0; i < numFiles; ++i) {
+    TrackData trackData;
+    // Every third file has empty tags and is not renamed.
+    if (i % 3 != 0) {
+      trackData.setArtist(QLatin1String("artist"));
+      trackData.setTitle(QLatin1String("title ") + QString::number(i));
+    }
+    trackData.detachFromTaggedFile(-1);
+    trackDataVector.append(trackData);
+  }
+
+  const QVector<QString> newNames =
+      RenamePreviewModel::filenamesFromTrackData(trackDataVector, format,
+                                                 fnCfg);
+  QCOMPARE(static_cast<int>(newNames.size()), numFiles);
+  for (int i = 0; i < numFiles; ++i) {
+    if (i % 3 != 0) {
+      QCOMPARE(newNames.at(i),
+               QString(QLatin1String("Artist - Title ") + QString::number(i)));
+    } else {
+      QVERIFY(newNames.at(i).isNull());
+    }
+    QCOMPARE(newNames.at(i), RenamePreviewModel::filenameFromTrackData(
+               trackDataVector.at(i), format, fnCfg));
+  }
+}
+
+void TestRenamePreviewModel::testFindFilename()
+{
+  CoreTaggedFileIconProvider iconProvider;
+  TaggedFileSystemModel model(&iconProvider);
+  MemoryTaggedFile fileA(
+        model.index(m_tempDir.filePath(QLatin1String("a.mp3"))));
+  MemoryTaggedFile fileB(
+        model.index(m_tempDir.filePath(QLatin1String("b.mp3"))));
+  fileA.setFrame(Frame::Tag_2,
+                 Frame(Frame::FT_Title, QLatin1String("x"), QString(), -1));
+  // File B has no tags and is not renamed.
+  const QString format(QLatin1String("%{title}"));
+
+  RenamePreviewModel previewModel;
+  previewModel.setFilenamesFromTags({&fileA, &fileB}, Frame::TagV2, format);
+  QCOMPARE(previewModel.rowCount(), 2);
+  QCOMPARE(previewModel.changedCount(), 1);
+  QString newName;
+  QVERIFY(previewModel.findFilename(&fileA, Frame::TagV2, format, newName));
+  QCOMPARE(newName, QString(QLatin1String("x")));
+  QVERIFY(previewModel.findFilename(&fileB, Frame::TagV2, format, newName));
+  QVERIFY(newName.isNull());
+
+  // Another tag version or format needs a new preview.
+  QVERIFY(!previewModel.findFilename(&fileA, Frame::TagV1, format, newName));
+  QVERIFY(!previewModel.findFilename(&fileA, Frame::TagV2,
+                                     QLatin1String("%{artist}"), newName));
+
+  // The preview of a file is invalid after its tags have been changed.
+  fileA.setFrame(Frame::Tag_2,
+                 Frame(Frame::FT_Title, QLatin1String("y"), QString(), -1));
+  QVERIFY(!previewModel.findFilename(&fileA, Frame::TagV2, format, newName));
+  QVERIFY(previewModel.findFilename(&fileB, Frame::TagV2, format, newName));
+
+  // The preview of a renamed file is invalid.
+  fileB.setFilename(QLatin1String("c.mp3"));
+  QVERIFY(!previewModel.findFilename(&fileB, Frame::TagV2, format, newName));
+
+  previewModel.clear();
+  QCOMPARE(previewModel.rowCount(), 0);
+  QVERIFY(!previewModel.findFilename(&fileB, Frame::TagV2, format, newName));
+}
@@ -0,0 +1,133 @@
+/**
+ * \file testtaggedfilecolumnstore.cpp
+ * Test column store of the file list.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtaggedfilecolumnstore.h"
+#include <QTest>
+#include "taggedfilecolumnstore.h"
+
+namespace {
+
+/**
+ * Get the rows with tags in memory.
+ * @param store column store
+ * @return rows from the least to the most recently used.
+ */
+QList<int> residentRows(const TaggedFileColumnStore& store)
+{
+  QList<int> rows;
+  for (int row = store.leastRecentlyUsedResidentRow();
+       row != -1;
+       row = store.moreRecentlyUsedResidentRow(row)) {
+    rows.append(row);
+  }
+  return rows;
+}
+
+}
+
+void TestTaggedFileColumnStore::testLeastRecentlyUsedOrder()
+{
+  TaggedFileColumnStore store({Frame::FT_Title});
+  const int row0 = store.addRow(nullptr);
+  const int row1 = store.addRow(nullptr);
+  const int row2 = store.addRow(nullptr);
+  QCOMPARE(store.residentRowCount(), 0);
+  QCOMPARE(store.leastRecentlyUsedResidentRow(), -1);
+
+  store.touchResidentRow(row0);
+  store.touchResidentRow(row1);
+  store.touchResidentRow(row2);
+  QCOMPARE(residentRows(store), QList<int>({row0, row1, row2}));
+  QCOMPARE(store.residentRowCount(), 3);
+
+  // Touching a row again makes it the most recently used row.
+  store.touchResidentRow(row0);
+  QCOMPARE(residentRows(store), QList<int>({row1, row2, row0}));
+  store.touchResidentRow(row2);
+  QCOMPARE(residentRows(store), QList<int>({row1, row0, row2}));
+  // Touching the most recently used row does not change anything.
+  store.touchResidentRow(row2);
+  QCOMPARE(residentRows(store), QList<int>({row1, row0, row2}));
+  QCOMPARE(store.residentRowCount(), 3);
+}
+
+void TestTaggedFileColumnStore::testRemoveResidentRows()
+{
+  TaggedFileColumnStore store({Frame::FT_Title});
+  const int row0 = store.addRow(nullptr);
+  const int row1 = store.addRow(nullptr);
+  const int row2 = store.addRow(nullptr);
+  const int row3 = store.addRow(nullptr);
+  for (int row : {row0, row1, row2, row3}) {
+    store.touchResidentRow(row);
+  }
+
+  // Middle, tail and head of the list.
+  store.removeResidentRow(row1);
+  QCOMPARE(residentRows(store), QList<int>({row0, row2, row3}));
+  store.removeResidentRow(row0);
+  QCOMPARE(residentRows(store), QList<int>({row2, row3}));
+  store.removeResidentRow(row3);
+  QCOMPARE(residentRows(store), QList<int>({row2}));
+  QCOMPARE(store.residentRowCount(), 1);
+
+  // Removing a row which is not resident does not change anything.
+  store.removeResidentRow(row3);
+  QCOMPARE(store.residentRowCount(), 1);
+
+  store.removeResidentRow(row2);
+  QCOMPARE(store.residentRowCount(), 0);
+  QCOMPARE(store.leastRecentlyUsedResidentRow(), -1);
+
+  store.touchResidentRow(row1);
+  QCOMPARE(residentRows(store), QList<int>({row1}));
+  store.clear();
+  QCOMPARE(store.residentRowCount(), 0);
+  QCOMPARE(store.leastRecentlyUsedResidentRow(), -1);
+}
+
+void TestTaggedFileColumnStore::testReuseRemovedRow()
+{
+  TaggedFileColumnStore store({Frame::FT_Title});
+  const int row0 = store.addRow(nullptr);
+  const int row1 = store.addRow(nullptr);
+  store.touchResidentRow(row0);
+  store.touchResidentRow(row1);
+
+  // A removed row is no longer resident and not resident when reused.
+  store.removeRow(row0);
+  QCOMPARE(residentRows(store), QList<int>({row1}));
+  const int row2 = store.addRow(nullptr);
+  QCOMPARE(row2, row0);
+  QCOMPARE(residentRows(store), QList<int>({row1}));
+  store.touchResidentRow(row2);
+  QCOMPARE(residentRows(store), QList<int>({row1, row2}));
+
+  // Replacing the tagged file of a row removes it from the resident rows.
+  store.setTaggedFile(row1, nullptr);
+  QCOMPARE(residentRows(store), QList<int>({row2}));
+  QCOMPARE(store.residentRowCount(), 1);
+}
@@ -0,0 +1,81 @@
+/**
+ * \file testtagsearcher.cpp
+ * Test search and replace in tags.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtagsearcher.h"
+#include <QTest>
+#include "tagsearcher.h"
+
+void TestTagSearcher::testReplaceAllInString_data()
+{
+  QTest::addColumn<QString>("searchText");
+  QTest::addColumn<QString>("replaceText");
+  QTest::addColumn<int>("flags");
+  QTest::addColumn<QString>("str");
+  QTest::addColumn<int>("startIdx");
+  QTest::addColumn<QString>("result");
+  QTest::addColumn<int>("count");
+
+  const int allFrames = TagSearcher::AllFrames;
+  QTest::newRow("case insensitive")
+      << "a" << "bb" << allFrames << "a-A-a" << 0 << "bb-bb-bb" << 3;
+  QTest::newRow("case sensitive")
+      << "a" << "b" << (allFrames | TagSearcher::CaseSensitive)
+      << "Aa" << 0 << "Ab" << 1;
+  QTest::newRow("replacement contains search text")
+      << "a" << "aa" << allFrames << "aXa" << 0 << "aaXaa" << 2;
+  QTest::newRow("start index")
+      << "abc" << "x" << allFrames << "abc abc abc" << 4 << "abc x x" << 2;
+  QTest::newRow("start index at end")
+      << "abc" << "x" << allFrames << "abc" << 3 << "abc" << 0;
+  QTest::newRow("no match")
+      << "z" << "x" << allFrames << "abc" << 0 << "abc" << 0;
+  QTest::newRow("regexp")
+      << "(\\d+)" << "<\\1>" << (allFrames | TagSearcher::RegExp)
+      << "1 22 333" << 0 << "<1> <22> <333>" << 3;
+  QTest::newRow("regexp with start index")
+      << "(\\d+)" << "<\\1>" << (allFrames | TagSearcher::RegExp)
+      << "1 22 333" << 2 << "1 <22> <333>" << 2;
+}
+
+void TestTagSearcher::testReplaceAllInString()
+{
+  QFETCH(QString, searchText);
+  QFETCH(QString, replaceText);
+  QFETCH(int, flags);
+  QFETCH(QString, str);
+  QFETCH(int, startIdx);
+  QFETCH(QString, result);
+  QFETCH(int, count);
+
+  TagSearcher::Parameters params;
+  params.setSearchText(searchText);
+  params.setReplaceText(replaceText);
+  params.setFlags(TagSearcher::SearchFlags(flags));
+  TagSearcher searcher;
+  searcher.setParameters(params);
+  QCOMPARE(searcher.replaceAllInString(str, startIdx), count);
+  QCOMPARE(str, result);
+}
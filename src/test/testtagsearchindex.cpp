@@ -0,0 +1,193 @@
+/**
+ * \file testtagsearchindex.cpp
+ * Test trigram index used to skip files when searching.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtagsearchindex.h"
+#include <QTest>
+#include "tagsearchindex.h"
+
+namespace {
+
+/**
+ * Create state of an unchanged file.
+ * @param filename file name
+ * @param modified modification time
+ * @return file state.
+ */
+TagSearchIndex::FileState unchangedState(const QString& filename,
+                                         qint64 modified = 1000)
+{
+  return {nullptr, filename, 4096, modified, 0};
+}
+
+}
+
+void TestTagSearchIndex::testCandidates()
+{
+  TagSearchIndex index;
+  const int loveMeDo = index.addDocument(
+        QLatin1String("/m/01.mp3"), unchangedState(QLatin1String("01.mp3")),
+        {QLatin1String("Love Me Do"), QLatin1String("The Beatles")});
+  const int glove = index.addDocument(
+        QLatin1String("/m/02.mp3"), unchangedState(QLatin1String("02.mp3")),
+        {QLatin1String("GLOVE")});
+  const int spaced = index.addDocument(
+        QLatin1String("/m/03.mp3"), unchangedState(QLatin1String("03.mp3")),
+        {QLatin1String("Lo ve")});
+  const int scattered = index.addDocument(
+        QLatin1String("/m/04.mp3"), unchangedState(QLatin1String("04.mp3")),
+        {QLatin1String("lov"), QLatin1String("ove")});
+  const int inFilename = index.addDocument(
+        QLatin1String("/m/love.mp3"), unchangedState(QLatin1String("love.mp3")),
+        {});
+
+  index.setQuery(QLatin1String("Love"));
+  QVERIFY(index.isCandidate(loveMeDo));
+  // Case folded
+  QVERIFY(index.isCandidate(glove));
+  QVERIFY(!index.isCandidate(spaced));
+  // The index can only exclude files, all trigrams in different values
+  // still make a candidate.
+  QVERIFY(index.isCandidate(scattered));
+  QVERIFY(index.isCandidate(inFilename));
+
+  index.setQuery(QLatin1String("beatles"));
+  QVERIFY(index.isCandidate(loveMeDo));
+  QVERIFY(!index.isCandidate(glove));
+  QVERIFY(!index.isCandidate(inFilename));
+}
+
+void TestTagSearchIndex::testDocumentsAddedAfterQuery()
+{
+  TagSearchIndex index;
+  index.setQuery(QLatin1String("yesterday"));
+  const int match = index.addDocument(
+        QLatin1String("/m/01.mp3"), unchangedState(QLatin1String("01.mp3")),
+        {QLatin1String("Yesterday")});
+  const int longer = index.addDocument(
+        QLatin1String("/m/02.mp3"), unchangedState(QLatin1String("02.mp3")),
+        {QLatin1String("Yesterdays")});
+  const int other = index.addDocument(
+        QLatin1String("/m/03.mp3"), unchangedState(QLatin1String("03.mp3")),
+        {QLatin1String("Today")});
+  QVERIFY(index.isCandidate(match));
+  QVERIFY(index.isCandidate(longer));
+  QVERIFY(!index.isCandidate(other));
+}
+
+void TestTagSearchIndex::testShortQuery()
+{
+  TagSearchIndex index;
+  const int docId = index.addDocument(
+        QLatin1String("/m/01.mp3"), unchangedState(QLatin1String("01.mp3")),
+        {QLatin1String("Help")});
+  // Texts with less than three characters and regular expressions,
+  // which are passed as null, cannot be looked up.
+  index.setQuery(QLatin1String("xy"));
+  QVERIFY(index.isCandidate(docId));
+  index.setQuery(QString());
+  QVERIFY(index.isCandidate(docId));
+}
+
+void TestTagSearchIndex::testReplaceAndRemove()
+{
+  TagSearchIndex index;
+  index.setQuery(QLatin1String("help"));
+  const QString path = QLatin1String("/m/01.mp3");
+  const int oldId = index.addDocument(
+        path, unchangedState(QLatin1String("01.mp3")), {QLatin1String("Help")});
+  QVERIFY(index.isCandidate(oldId));
+  QCOMPARE(index.m_documentOfFile.value(path), oldId);
+
+  const int newId = index.addDocument(
+        path, unchangedState(QLatin1String("01.mp3"), 1001), {QLatin1String("Girl")});
+  QVERIFY(newId != oldId);
+  QVERIFY(!index.isCandidate(newId));
+  QCOMPARE(index.m_documentOfFile.value(path), newId);
+  QVERIFY(!index.m_documents.at(oldId).alive);
+
+  index.setQuery(QLatin1String("help"));
+  QVERIFY(!index.isCandidate(newId));
+
+  index.removeFile(path);
+  QVERIFY(!index.m_documentOfFile.contains(path));
+  QVERIFY(!index.m_documents.at(newId).alive);
+  QCOMPARE(index.m_numDeadDocuments, 2);
+}
+
+void TestTagSearchIndex::testCompaction()
+{
+  TagSearchIndex index;
+  index.setQuery(QLatin1String("help"));
+  const QString keptPath = QLatin1String("/m/kept.mp3");
+  const QString path = QLatin1String("/m/01.mp3");
+  index.addDocument(keptPath, unchangedState(QLatin1String("kept.mp3")),
+                    {QLatin1String("Help")});
+  for (int i = 0; i < 2100; ++i) {
+    index.addDocument(path, unchangedState(QLatin1String("01.mp3"), i),
+                      {QLatin1String("Girl")});
+  }
+  QVERIFY(index.m_documents.size() < 2101);
+  QVERIFY(index.m_numDeadDocuments < 1024);
+
+  const int keptId = index.m_documentOfFile.value(keptPath);
+  QVERIFY(index.m_documents.at(keptId).alive);
+  QVERIFY(index.isCandidate(keptId));
+  QCOMPARE(index.findDocument(
+             keptPath, unchangedState(QLatin1String("kept.mp3"))), keptId);
+  const int lastId = index.m_documentOfFile.value(path);
+  QCOMPARE(lastId, index.m_documents.size() - 1);
+  QVERIFY(!index.isCandidate(lastId));
+
+  // The remapped posting lists must still give the kept document.
+  index.setQuery(QLatin1String("help"));
+  QCOMPARE(index.m_candidates, QVector<int>{keptId});
+}
+
+void TestTagSearchIndex::testQueuedFiles()
+{
+  TagSearchIndex index;
+  index.setQuery(QLatin1String("help"));
+  const QString path = QLatin1String("/m/01.mp3");
+  const QString removedPath = QLatin1String("/m/02.mp3");
+  const TagSearchIndex::FileState state =
+      unchangedState(QLatin1String("01.mp3"));
+  index.queueDocument(path, state, {QLatin1String("Help")});
+  index.queueDocument(removedPath, unchangedState(QLatin1String("02.mp3")),
+                      {QLatin1String("Help")});
+  QCOMPARE(index.findDocument(path, state), -1);
+
+  index.removeFile(removedPath);
+  index.indexQueuedFiles();
+  QVERIFY(index.m_queuedFiles.isEmpty());
+  const int docId = index.findDocument(path, state);
+  QVERIFY(docId != -1);
+  QVERIFY(index.isCandidate(docId));
+  QVERIFY(!index.m_documentOfFile.contains(removedPath));
+
+  // A changed stamp makes the document outdated.
+  QCOMPARE(index.findDocument(path, unchangedState(QLatin1String("01.mp3"),
+                                                   2000)), -1);
+}